@@ -11,7 +11,8 @@
 char *Cpu_modes[] = {"Unknown","Portable C","x86 Multi Media Extensions (MMX)",
 		   "x86 Streaming SIMD Extensions (SSE)",
 		   "x86 Streaming SIMD Extensions 2 (SSE2)",
-		   "PowerPC G4/G5 Altivec/Velocity Engine"};
+		   "PowerPC G4/G5 Altivec/Velocity Engine",
+		   "x86 Advanced Vector Extensions 2 (AVX2)"};
 
 enum cpu_mode Cpu_mode;
 
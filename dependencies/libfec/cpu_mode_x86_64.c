@@ -4,22 +4,36 @@
  * Modified in 2012 by Matthias P. Braendli, HB9EGM
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include "fec.h"
 
 /* Various SIMD instruction set names */
 char *Cpu_modes[] = {"Unknown","Portable C","x86 Multi Media Extensions (MMX)",
 		   "x86 Streaming SIMD Extensions (SSE)",
 		   "x86 Streaming SIMD Extensions 2 (SSE2)",
-		   "PowerPC G4/G5 Altivec/Velocity Engine"};
+		   "PowerPC G4/G5 Altivec/Velocity Engine",
+		   "x86 Advanced Vector Extensions 2 (AVX2)"};
 
 enum cpu_mode Cpu_mode;
 
 void find_cpu_mode(void){
 
-  int f;
   if(Cpu_mode != UNKNOWN)
     return;
 
+  /* The K=7 decoder has an AVX2 version, selected at run time so one
+   * build runs everywhere; set FEC_NO_AVX2 in the environment to fall
+   * back to the portable code
+   */
+#if defined(__GNUC__)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2") && getenv("FEC_NO_AVX2") == NULL){
+    Cpu_mode = AVX2;
+    fprintf(stderr,"CPU: x86-64, using AVX2 for K=7 Viterbi, portable C otherwise\n");
+    return;
+  }
+#endif
+
   /* According to the wikipedia entry x86-64, all x86-64 processors have SSE2 */
   /* The same assumption is also in other source files ! */
   Cpu_mode = SSE2;
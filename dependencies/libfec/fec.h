@@ -52,6 +52,15 @@ void delete_viterbi27_sse2(void *p);
 int update_viterbi27_blk_sse2(void *p,unsigned char *syms,int nbits);
 #endif
 
+#ifdef __x86_64__
+void *create_viterbi27_avx2(int len);
+void set_viterbi27_polynomial_avx2(int polys[2]);
+int init_viterbi27_avx2(void *p,int starting_state);
+int chainback_viterbi27_avx2(void *p,unsigned char *data,unsigned int nbits,unsigned int endstate);
+void delete_viterbi27_avx2(void *p);
+int update_viterbi27_blk_avx2(void *p,unsigned char *syms,int nbits);
+#endif
+
 void *create_viterbi27_port(int len);
 void set_viterbi27_polynomial_port(int polys[2]);
 int init_viterbi27_port(void *p,int starting_state);
@@ -257,7 +266,7 @@ extern unsigned char Taltab[],Tal1tab[];
 
 
 /* CPU SIMD instruction set available */
-extern enum cpu_mode {UNKNOWN=0,PORT,MMX,SSE,SSE2,ALTIVEC} Cpu_mode;
+extern enum cpu_mode {UNKNOWN=0,PORT,MMX,SSE,SSE2,ALTIVEC,AVX2} Cpu_mode;
 void find_cpu_mode(void); /* Call this once at startup to set Cpu_mode */
 
 /* Determine parity of argument: 1 = odd, 0 = even */
@@ -29,6 +29,8 @@ void *create_viterbi27(int len){
 #ifdef __x86_64__
   case SSE2:
     return create_viterbi27_port(len);
+  case AVX2:
+    return create_viterbi27_avx2(len);
 #endif
   }
 }
@@ -59,6 +61,9 @@ void set_viterbi27_polynomial(int polys[2]){
   case SSE2:
     set_viterbi27_polynomial_port(polys);
     break;
+  case AVX2:
+    set_viterbi27_polynomial_avx2(polys);
+    break;
 #endif
   }
 }
@@ -84,6 +89,8 @@ int init_viterbi27(void *p,int starting_state){
 #ifdef __x86_64__
     case SSE2:
       return init_viterbi27_port(p,starting_state);
+    case AVX2:
+      return init_viterbi27_avx2(p,starting_state);
 #endif
     }
 }
@@ -114,6 +121,8 @@ int chainback_viterbi27(
 #ifdef __x86_64__
     case SSE2:
       return chainback_viterbi27_port(p,data,nbits,endstate);
+    case AVX2:
+      return chainback_viterbi27_avx2(p,data,nbits,endstate);
 #endif
     }
 }
@@ -145,6 +154,9 @@ void delete_viterbi27(void *p){
     case SSE2:
       delete_viterbi27_port(p);
       break;
+    case AVX2:
+      delete_viterbi27_avx2(p);
+      break;
 #endif
     }
 }
@@ -182,6 +194,9 @@ int update_viterbi27_blk(void *p,unsigned char syms[],int nbits){
   case SSE2:
     update_viterbi27_blk_port(p,syms,nbits);
     break;
+  case AVX2:
+    update_viterbi27_blk_avx2(p,syms,nbits);
+    break;
 #endif
   }
   return 0;
@@ -0,0 +1,188 @@
+/* K=7 r=1/2 Viterbi decoder for AVX2
+ * Derived from viterbi27_port.c and viterbi27_sse2.c, Phil Karn, KA9Q
+ * May be used under the terms of the GNU Lesser General Public License (LGPL)
+ *
+ * 16 butterflies per instruction on 16-bit path metrics. The metrics
+ * are never renormalized; like the portable version they are compared
+ * through their modular difference, which is exact because the spread
+ * of K=7 path metrics stays far below 2^15. Decisions, and therefore
+ * decoded data, are bit-exact with viterbi27_port.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <immintrin.h>
+#include "fec.h"
+
+#pragma GCC target("avx2")
+
+typedef union { unsigned short s[64]; __m256i v[4]; } metric_t;
+typedef union { unsigned int w[2]; } decision_t;
+static union branchtab27 { unsigned short s[32]; __m256i v[2]; } Branchtab27_avx2[2];
+static int Init = 0;
+
+/* State info for instance of Viterbi decoder */
+struct v27 {
+  metric_t metrics;        /* path metrics, carried between update calls */
+  decision_t *dp;          /* Pointer to current decision */
+  decision_t *decisions;   /* Beginning of decisions for block */
+};
+
+/* Initialize Viterbi decoder for start of new frame */
+int init_viterbi27_avx2(void *p,int starting_state){
+  struct v27 *vp = p;
+  int i;
+
+  if(p == NULL)
+    return -1;
+  for(i=0;i<64;i++)
+    vp->metrics.s[i] = 63;
+
+  vp->dp = vp->decisions;
+  vp->metrics.s[starting_state & 63] = 0; /* Bias known start state */
+  return 0;
+}
+
+void set_viterbi27_polynomial_avx2(int polys[2]){
+  int state;
+
+  for(state=0;state < 32;state++){
+    Branchtab27_avx2[0].s[state] = (polys[0] < 0) ^ parity((2*state) & abs(polys[0])) ? 255 : 0;
+    Branchtab27_avx2[1].s[state] = (polys[1] < 0) ^ parity((2*state) & abs(polys[1])) ? 255 : 0;
+  }
+  Init++;
+}
+
+/* Create a new instance of a Viterbi decoder */
+void *create_viterbi27_avx2(int len){
+  void *p;
+  struct v27 *vp;
+
+  if(!Init){
+    int polys[2] = { V27POLYA, V27POLYB };
+    set_viterbi27_polynomial_avx2(polys);
+  }
+  /* Ordinary malloc() only returns 16-byte alignment, we need 32 */
+  if(posix_memalign(&p, sizeof(__m256i),sizeof(struct v27)))
+    return NULL;
+  vp = (struct v27 *)p;
+
+  if((p = malloc((len+6)*sizeof(decision_t))) == NULL){
+    free(vp);
+    return NULL;
+  }
+  vp->decisions = (decision_t *)p;
+  init_viterbi27_avx2(vp,0);
+
+  return vp;
+}
+
+/* Viterbi chainback */
+int chainback_viterbi27_avx2(
+      void *p,
+      unsigned char *data, /* Decoded output data */
+      unsigned int nbits, /* Number of data bits */
+      unsigned int endstate){ /* Terminal encoder state */
+  struct v27 *vp = p;
+  decision_t *d;
+
+  if(p == NULL)
+    return -1;
+  d = vp->decisions;
+  /* Make room beyond the end of the encoder register so we can
+   * accumulate a full byte of decoded data
+   */
+  endstate %= 64;
+  endstate <<= 2;
+
+  d += 6; /* Look past tail */
+  while(nbits-- != 0){
+    int k;
+
+    k = (d[nbits].w[(endstate>>2)/32] >> ((endstate>>2)%32)) & 1;
+    data[nbits>>3] = endstate = (endstate >> 1) | (k << 7);
+  }
+  return 0;
+}
+
+/* Delete instance of a Viterbi decoder */
+void delete_viterbi27_avx2(void *p){
+  struct v27 *vp = p;
+
+  if(vp != NULL){
+    free(vp->decisions);
+    free(vp);
+  }
+}
+
+/* Update decoder with a block of demodulated symbols
+ * Note that nbits is the number of decoded data bits, not the number
+ * of symbols!
+ */
+int update_viterbi27_blk_avx2(void *p,unsigned char *syms,int nbits){
+  struct v27 *vp = p;
+  decision_t *d;
+  __m256i old[4],new[4];
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i c510 = _mm256_set1_epi16(510);
+  int i;
+
+  if(p == NULL)
+    return -1;
+  d = vp->dp;
+  for(i=0;i<4;i++)
+    old[i] = vp->metrics.v[i];
+
+  while(nbits--){
+    __m256i sym0v,sym1v;
+
+    /* Splat the 0th symbol across sym0v, the 1st symbol across sym1v */
+    sym0v = _mm256_set1_epi16(syms[0]);
+    sym1v = _mm256_set1_epi16(syms[1]);
+    syms += 2;
+
+    /* Butterflies 0-15 give states 0-31, 16-31 give states 32-63 */
+    for(i=0;i<2;i++){
+      __m256i decision0,decision1,metric,m_metric,m0,m1,m2,m3,survivor0,survivor1,lo,hi;
+
+      /* Form branch metrics */
+      metric = _mm256_add_epi16(_mm256_xor_si256(Branchtab27_avx2[0].v[i],sym0v),
+				_mm256_xor_si256(Branchtab27_avx2[1].v[i],sym1v));
+      m_metric = _mm256_sub_epi16(c510,metric);
+
+      /* Add branch metrics to path metrics */
+      m0 = _mm256_add_epi16(old[i],metric);
+      m1 = _mm256_add_epi16(old[2+i],m_metric);
+      m2 = _mm256_add_epi16(old[i],m_metric);
+      m3 = _mm256_add_epi16(old[2+i],metric);
+
+      /* Compare and select, using modulo arithmetic */
+      decision0 = _mm256_cmpgt_epi16(_mm256_sub_epi16(m0,m1),zero);
+      decision1 = _mm256_cmpgt_epi16(_mm256_sub_epi16(m2,m3),zero);
+      survivor0 = _mm256_blendv_epi8(m0,m1,decision0);
+      survivor1 = _mm256_blendv_epi8(m2,m3,decision1);
+
+      /* Interleave survivors into state order (2i, 2i+1); unpack works
+       * within 128-bit lanes, so swap the middle lanes back afterwards
+       */
+      lo = _mm256_unpacklo_epi16(survivor0,survivor1);
+      hi = _mm256_unpackhi_epi16(survivor0,survivor1);
+      new[2*i]   = _mm256_permute2x128_si256(lo,hi,0x20);
+      new[2*i+1] = _mm256_permute2x128_si256(lo,hi,0x31);
+
+      /* Same for the decisions, then pack to one bit per state */
+      lo = _mm256_unpacklo_epi16(decision0,decision1);
+      hi = _mm256_unpackhi_epi16(decision0,decision1);
+      lo = _mm256_packs_epi16(_mm256_permute2x128_si256(lo,hi,0x20),
+			      _mm256_permute2x128_si256(lo,hi,0x31));
+      d->w[i] = _mm256_movemask_epi8(_mm256_permute4x64_epi64(lo,0xd8));
+    }
+    d++;
+    for(i=0;i<4;i++)
+      old[i] = new[i];
+  }
+  for(i=0;i<4;i++)
+    vp->metrics.v[i] = old[i];
+  vp->dp = d;
+  return 0;
+}
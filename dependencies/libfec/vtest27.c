@@ -25,6 +25,8 @@ struct option Options[] = {
   {"force-mmx",0,NULL,'m'},
   {"force-sse",0,NULL,'s'},
   {"force-sse2",0,NULL,'t'},
+  {"force-avx2",0,NULL,'x'},
+  {"compare-port",0,NULL,'c'},
   {NULL},
 };
 #endif
@@ -50,14 +52,17 @@ int main(int argc,char *argv[]){
   double gain,esn0,ebn0;
   time_t t;
   int badframes=0;
+  int compare=0,mismatches=0;
+  void *vp_port = NULL;
+  unsigned char data_port[MAXBYTES];
 
   time(&t);
   srandom(t);
   ebn0 = -100;
 #if HAVE_GETOPT_LONG
-  while((d = getopt_long(argc,argv,"l:n:te:g:vapmst",Options,NULL)) != EOF){
+  while((d = getopt_long(argc,argv,"l:n:te:g:vapmstxc",Options,NULL)) != EOF){
 #else
-  while((d = getopt(argc,argv,"l:n:te:g:vapmst")) != EOF){
+  while((d = getopt(argc,argv,"l:n:te:g:vapmstxc")) != EOF){
 #endif
     switch(d){
     case 'a':
@@ -75,6 +80,12 @@ int main(int argc,char *argv[]){
     case 't':
       Cpu_mode = SSE2;
       break;
+    case 'x':
+      Cpu_mode = AVX2;
+      break;
+    case 'c':
+      compare = 1;
+      break;
     case 'l':
       framebits = atoi(optarg);
       break;
@@ -100,6 +111,13 @@ int main(int argc,char *argv[]){
     printf("create_viterbi27 failed\n");
     exit(1);
   }
+  /* Optionally decode every frame with the portable decoder as well and
+   * require identical output
+   */
+  if(compare && (vp_port = create_viterbi27_port(framebits)) == NULL){
+    printf("create_viterbi27_port failed\n");
+    exit(1);
+  }
   if(ebn0 != -100){
     esn0 = ebn0 + 10*log10((double)RATE); /* Es/No in dB */
     /* Compute noise voltage. The 0.5 factor accounts for BPSK seeing
@@ -137,6 +155,13 @@ int main(int argc,char *argv[]){
       }
       if(errcnt != 0)
 	badframes++;
+      if(compare){
+	init_viterbi27_port(vp_port,0);
+	update_viterbi27_blk_port(vp_port,symbols,framebits+6);
+	chainback_viterbi27_port(vp_port,data_port,framebits,0);
+	if(memcmp(data,data_port,framebits/8) != 0)
+	  mismatches++;
+      }
       if(Verbose > 1 && errcnt != 0){
 	printf("frame %d, %d errors: ",tr,errcnt);
 	for(i=0;i<framebits/8;i++){
@@ -158,6 +183,11 @@ int main(int argc,char *argv[]){
 	     badframes,tr+1,(double)badframes/(tr+1));
     else
       printf("\n");
+    if(compare){
+      printf("%d/%d frames differ from portable decoder\n",mismatches,trials);
+      if(mismatches != 0)
+	exit(1);
+    }
 
   } else {
     /* Do time trials */
@@ -178,7 +208,8 @@ int main(int argc,char *argv[]){
     extime = finish.ru_utime.tv_sec - start.ru_utime.tv_sec + 1e-6*(finish.ru_utime.tv_usec - start.ru_utime.tv_usec);
     printf("Execution time for %d %d-bit frames: %.2f sec\n",trials,
 	   framebits,extime);
-    printf("decoder speed: %g bits/s\n",trials*framebits/extime);
+    printf("decoder speed: %g bits/s (%.2f Mbit/s)\n",trials*framebits/extime,
+	   1e-6*trials*framebits/extime);
   }
   exit(0);
 }
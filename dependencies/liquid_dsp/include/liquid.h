@@ -1069,6 +1069,24 @@ void FFT(_shift)(TC *         _x,                               \
 
 LIQUID_FFT_DEFINE_API(LIQUID_FFT_MANGLE_FLOAT,float,liquid_float_complex)
 
+// FFT plan cache: OFDM frame generators/synchronizers and polyphase
+// filterbank channelizers of the same size share one transform plan.
+// With FFTW these are measured plans, and the wisdom gathered measuring
+// them can be saved and loaded on the next start so planning is instant.
+// Without FFTW the wisdom methods do nothing and return 0.
+
+// destroy cached plans no longer used by any object
+void liquid_fft_plan_cache_clear(void);
+
+// number of plans in the cache
+unsigned int liquid_fft_plan_cache_size(void);
+
+// load FFTW wisdom from file, returning 1 on success
+int liquid_fft_import_wisdom(const char * _filename);
+
+// save accumulated FFTW wisdom to file, returning 1 on success
+int liquid_fft_export_wisdom(const char * _filename);
+
 // antiquated fft methods
 // FFT(plan) FFT(_create_plan_mdct)(unsigned int _n,
 //                                  T * _x,
@@ -2957,6 +2975,71 @@ LIQUID_MSRESAMP_DEFINE_API(MSRESAMP_MANGLE_CCCF,
                            liquid_float_complex,
                            liquid_float_complex)
 
+//
+// Rational-rate polyphase resampler
+//
+#define RRESAMP_MANGLE_RRRF(name)     LIQUID_CONCAT(rresamp_rrrf,name)
+#define RRESAMP_MANGLE_CRCF(name)     LIQUID_CONCAT(rresamp_crcf,name)
+#define RRESAMP_MANGLE_CCCF(name)     LIQUID_CONCAT(rresamp_cccf,name)
+
+#define LIQUID_RRESAMP_DEFINE_API(RRESAMP,TO,TC,TI)             \
+typedef struct RRESAMP(_s) * RRESAMP();                         \
+                                                                \
+/* create rational-rate resampler, rate _P/_Q               */  \
+/*  _P      :   interpolation factor, _P > 0                */  \
+/*  _Q      :   decimation factor, _Q > 0                   */  \
+/*  _m      :   filter semi-length (lower-rate samples)     */  \
+/*  _bw     :   cutoff relative to lower Nyquist, (0,1)     */  \
+/*  _As     :   stop-band attenuation [dB]                  */  \
+RRESAMP() RRESAMP(_create)(unsigned int _P,                     \
+                           unsigned int _Q,                     \
+                           unsigned int _m,                     \
+                           float        _bw,                    \
+                           float        _As);                   \
+                                                                \
+/* destroy rational-rate resampler                          */  \
+void RRESAMP(_destroy)(RRESAMP() _q);                           \
+                                                                \
+/* print rresamp object internals to stdout                 */  \
+void RRESAMP(_print)(RRESAMP() _q);                             \
+                                                                \
+/* reset rresamp object internal state                      */  \
+void RRESAMP(_reset)(RRESAMP() _q);                             \
+                                                                \
+/* get interpolation/decimation factors (lowest terms)      */  \
+unsigned int RRESAMP(_get_P)(RRESAMP() _q);                     \
+unsigned int RRESAMP(_get_Q)(RRESAMP() _q);                     \
+                                                                \
+/* get filter delay (output samples)                        */  \
+float RRESAMP(_get_delay)(RRESAMP() _q);                        \
+                                                                \
+/* execute resampler, computing only the retained outputs   */  \
+/*  _q      :   rresamp object                              */  \
+/*  _x      :   input sample array  [size: _nx x 1]         */  \
+/*  _nx     :   input sample array size                     */  \
+/*  _y      :   output sample array [size: variable]        */  \
+/*  _ny     :   number of samples written to _y             */  \
+void RRESAMP(_execute)(RRESAMP()      _q,                       \
+                       TI *           _x,                       \
+                       unsigned int   _nx,                      \
+                       TO *           _y,                       \
+                       unsigned int * _ny);                     \
+
+LIQUID_RRESAMP_DEFINE_API(RRESAMP_MANGLE_RRRF,
+                          float,
+                          float,
+                          float)
+
+LIQUID_RRESAMP_DEFINE_API(RRESAMP_MANGLE_CRCF,
+                          liquid_float_complex,
+                          float,
+                          liquid_float_complex)
+
+LIQUID_RRESAMP_DEFINE_API(RRESAMP_MANGLE_CCCF,
+                          liquid_float_complex,
+                          liquid_float_complex,
+                          liquid_float_complex)
+
 
 // 
 // Symbol timing recovery (symbol synchronizer)
@@ -3618,6 +3701,29 @@ void ofdmflexframegen_multi_user_update_data(ofdmflexframegen _q,
                                unsigned int _payload_len,
                                unsigned int user);
 
+// get/set the modulation and FEC schemes of one user; the header of each
+// frame carries them to that user's synchronizer. Set between frames; a
+// NULL _props restores the frame-wide properties, and
+// ofdmflexframegen_setprops() resets every user to them.
+void ofdmflexframegen_get_user_props(ofdmflexframegen          _q,
+                                     unsigned int              _user,
+                                     ofdmflexframegenprops_s * _props);
+void ofdmflexframegen_set_user_props(ofdmflexframegen          _q,
+                                     unsigned int              _user,
+                                     ofdmflexframegenprops_s * _props);
+
+// divide the data subcarriers that are not deallocated between the users
+// in proportion to _shares [size: num_users x 1], interleaving each user's
+// subcarriers across the band; the subcarrier map in the frame header
+// tells the synchronizers. Every user with a non-zero share gets at least
+// one subcarrier, users with a zero share get none and send no payload,
+// and all-zero shares restore the even split. Set between frames.
+void ofdmflexframegen_set_user_shares(ofdmflexframegen _q,
+                                      unsigned int *   _shares);
+// number of data subcarriers given to a user in the next frame
+unsigned int ofdmflexframegen_get_user_num_subcarriers(ofdmflexframegen _q,
+                                                       unsigned int     _user);
+
 
 
  
@@ -3659,9 +3765,17 @@ void ofdmflexframesync_debug_disable(ofdmflexframesync _q);
 void ofdmflexframesync_debug_print(ofdmflexframesync _q,
                                    const char *      _filename);
 
+// enable/disable soft-decision payload decoding (disabled by default):
+// soft bits from modem_demodulate_soft(), weighted by each subcarrier's
+// error vector magnitude over the frame, go to packetizer_decode_soft()
+void ofdmflexframesync_set_payload_soft(ofdmflexframesync _q,
+                                        int               _soft);
+
 
 //OFDMA Functions
 float * ofdmflexframesync_get_evm_db(ofdmflexframesync _q);
+// change the subcarrier allocation in place; a frame in progress is
+// finished with the old allocation and the new one applies from the next
 void ofdmflexframesync_update_subcarrier_allocation(ofdmflexframesync _q, unsigned char* new_allocation);
 void ofdmflexframegen_update_subcarrier_allocation(ofdmflexframegen _q, unsigned char* new_allocation);
 unsigned char* ofdmflexframegen_get_subcarrier_map(ofdmflexframegen _q);
@@ -4554,6 +4668,36 @@ void MODEM(_demodulate_soft)(MODEM() _q,                        \
                              unsigned int  * _s,                \
                              unsigned char * _soft_bits);       \
                                                                 \
+/* hard-decision demodulation of a block of samples; QPSK    */  \
+/* and square QAM are vectorized where the CPU supports it   */  \
+/*  _q      :   modem object                                */  \
+/*  _x      :   input samples [size: _n x 1]                */  \
+/*  _n      :   number of input samples                     */  \
+/*  _s      :   output symbols [size: _n x 1]               */  \
+/*  _evm    :   output error vector magnitudes [size: _n x 1], */ \
+/*              ignored if NULL                             */  \
+void MODEM(_demodulate_block)(MODEM()        _q,                \
+                              TC *           _x,                \
+                              unsigned int   _n,                \
+                              unsigned int * _s,                \
+                              T *            _evm);             \
+                                                                \
+/* soft-decision demodulation of a block of samples; QPSK is */  \
+/* vectorized where the CPU supports it                      */  \
+/*  _q          :   modem object                            */  \
+/*  _x          :   input samples [size: _n x 1]            */  \
+/*  _n          :   number of input samples                 */  \
+/*  _s          :   output hard symbols [size: _n x 1]      */  \
+/*  _soft_bits  :   output soft bits [size: _n*bps x 1]     */  \
+/*  _evm        :   output error vector magnitudes [size: _n x 1], */ \
+/*                  ignored if NULL                         */  \
+void MODEM(_demodulate_soft_block)(MODEM()         _q,          \
+                                   TC *            _x,          \
+                                   unsigned int    _n,          \
+                                   unsigned int *  _s,          \
+                                   unsigned char * _soft_bits,  \
+                                   T *             _evm);       \
+                                                                \
 /* get demodulator's estimated transmit sample */               \
 void MODEM(_get_demodulator_sample)(MODEM() _q,                 \
                                     TC * _x_hat);               \
@@ -4967,6 +5111,12 @@ void ofdmframegen_print(ofdmframegen _q);
 
 void ofdmframegen_reset(ofdmframegen _q);
 
+// change the subcarrier allocation in place, between frames
+//  _q      :   OFDM frame generator object
+//  _p      :   subcarrier allocation (null, pilot, data), [size: _M x 1]
+void ofdmframegen_set_allocation(ofdmframegen    _q,
+                                 unsigned char * _p);
+
 // write first S0 symbol
 void ofdmframegen_write_S0a(ofdmframegen _q,
                             liquid_float_complex *_y);
@@ -5017,6 +5167,16 @@ void ofdmframesync_execute(ofdmframesync _q,
                            liquid_float_complex * _x,
                            unsigned int _n);
 
+// change the subcarrier allocation in place, dropping any frame being
+// received
+//  _q      :   OFDM frame synchronizer object
+//  _p      :   subcarrier allocation (null, pilot, data), [size: _M x 1]
+void ofdmframesync_set_allocation(ofdmframesync   _q,
+                                  unsigned char * _p);
+
+// is a frame being received (PLCP detected, not yet reset)?
+int ofdmframesync_is_frame_open(ofdmframesync _q);
+
 // query methods
 float ofdmframesync_get_rssi(ofdmframesync _q); // received signal strength indication
 float ofdmframesync_get_cfo(ofdmframesync _q);  // carrier offset estimate
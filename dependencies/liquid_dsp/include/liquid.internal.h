@@ -70,6 +70,23 @@
 // MODULE : dotprod
 //
 
+// AVX2/FMA kernels for the x86 (mmx) dot products and the modem block
+// demodulators: compiled with a function target attribute alongside the
+// portable/SSE code, so the library still runs on older processors, and
+// selected at run time if the CPU supports both extensions
+#if HAVE_IMMINTRIN_H && defined(__GNUC__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#  define LIQUID_AVX2           1
+#  define LIQUID_AVX2_TARGET    __attribute__((target("avx2,fma")))
+#else
+#  define LIQUID_AVX2           0
+#endif
+
+// returns 1 if the AVX2/FMA kernels should be used; set the environment
+// variable LIQUID_NO_AVX2 to force the others, e.g. to compare the two in
+// the benchmarks
+int liquid_avx2_enabled();
+
 
 //
 // MODULE : fec (forward error-correction)
@@ -88,6 +105,21 @@ unsigned int crc16_generate_key(unsigned char * _msg, unsigned int _msg_len);
 unsigned int crc24_generate_key(unsigned char * _msg, unsigned int _msg_len);
 unsigned int crc32_generate_key(unsigned char * _msg, unsigned int _msg_len);
 
+// CRC-32 implementations behind crc32_generate_key(), which uses the
+// carry-less multiply (PCLMULQDQ) folding for long messages when the CPU
+// supports it and slice-by-8 tables otherwise; all are bit-exact
+extern const unsigned int crc32_gentab[8][256];
+unsigned int crc32_generate_key_bitwise(unsigned char * _msg, unsigned int _msg_len);
+unsigned int crc32_generate_key_slice8(unsigned char * _msg, unsigned int _msg_len);
+#if HAVE_IMMINTRIN_H && defined(__GNUC__) && (__GNUC__ >= 5)
+#  define LIQUID_CRC32_PCLMUL   1
+// returns 1 if the CPU supports PCLMULQDQ and SSE4.1
+int crc32_pclmul_supported();
+unsigned int crc32_generate_key_pclmul(unsigned char * _msg, unsigned int _msg_len);
+#else
+#  define LIQUID_CRC32_PCLMUL   0
+#endif
+
 
 // fec : basic object
 struct fec_s {
@@ -653,6 +685,27 @@ struct packetizer_s {
     unsigned char * buffer_1;
 };
 
+// Number of previously used packetizers kept by the flexible frame
+// generators and synchronizers, whose payload length moves between a few
+// values (data, padding-only, control) from frame to frame
+#define PACKETIZER_CACHE_LEN    (4)
+
+// re-create packetizer object, first swapping in the entry of _cache with
+// the requested properties if there is one; _p goes to the front of the
+// cache and the least recently used entry is re-created otherwise
+//  _p      :   packetizer object (or NULL)
+//  _cache  :   previously used objects [size: PACKETIZER_CACHE_LEN x 1],
+//              NULL where empty
+packetizer packetizer_recreate_cached(packetizer      _p,
+                                      packetizer *    _cache,
+                                      unsigned int    _dec_msg_len,
+                                      int             _crc,
+                                      int             _fec0,
+                                      int             _fec1);
+
+// destroy every packetizer object in _cache
+void packetizer_cache_destroy(packetizer * _cache);
+
 
 //
 // MODULE : fft (fast discrete Fourier transform)
@@ -762,6 +815,18 @@ LIQUID_FFT_DEFINE_INTERNAL_API(LIQUID_FFT_MANGLE_FLOAT, float, liquid_float_comp
 #   define FFT_DIR_FORWARD      FFTW_FORWARD
 #   define FFT_DIR_BACKWARD     FFTW_BACKWARD
 #   define FFT_METHOD           FFTW_ESTIMATE
+
+// shared plans (see src/fft/src/fft_plan_cache.c)
+fftwf_plan liquid_fft_plan_cache_create(unsigned int           _n,
+                                        liquid_float_complex * _x,
+                                        liquid_float_complex * _y,
+                                        int                    _dir);
+void liquid_fft_plan_cache_destroy(fftwf_plan _plan);
+#   define FFT_CREATE_PLAN_SHARED(N,X,Y,DIR)    liquid_fft_plan_cache_create(N,X,Y,DIR)
+#   define FFT_DESTROY_PLAN_SHARED(P)           liquid_fft_plan_cache_destroy(P)
+#   define FFT_EXECUTE_SHARED(P,X,Y)            fftwf_execute_dft(P,X,Y)
+#   define FFT_MALLOC           fftwf_malloc
+#   define FFT_FREE             fftwf_free
 #else
 #   define FFT_PLAN             fftplan
 #   define FFT_CREATE_PLAN      fft_create_plan
@@ -770,6 +835,13 @@ LIQUID_FFT_DEFINE_INTERNAL_API(LIQUID_FFT_MANGLE_FLOAT, float, liquid_float_comp
 #   define FFT_DIR_FORWARD      LIQUID_FFT_FORWARD
 #   define FFT_DIR_BACKWARD     LIQUID_FFT_BACKWARD
 #   define FFT_METHOD           0
+
+// shared plans fall back to one internal plan per object
+#   define FFT_CREATE_PLAN_SHARED(N,X,Y,DIR)    fft_create_plan(N,X,Y,DIR,0)
+#   define FFT_DESTROY_PLAN_SHARED(P)           fft_destroy_plan(P)
+#   define FFT_EXECUTE_SHARED(P,X,Y)            fft_execute(P)
+#   define FFT_MALLOC           malloc
+#   define FFT_FREE             free
 #endif
 
 
@@ -1162,6 +1234,11 @@ void bpacketsync_reconfig(bpacketsync _q);
 #define OFDMFLEXFRAME_H_BPS     (1)                         // modulation depth
 #define OFDMFLEXFRAME_H_SYM     (288)                       // number of symbols
 
+// multi-user (OFDMA) header: after the user-defined array and the
+// subcarrier map, each user has its payload length (2 bytes), modulation
+// scheme and inner and outer FEC schemes (1 byte each)
+#define OFDMFLEXFRAME_H_USER_PROPS  (5)
+
 // 
 // ofdmflexframegen
 //
@@ -1170,6 +1247,11 @@ void bpacketsync_reconfig(bpacketsync _q);
 void ofdmflexframegen_reconfigure(ofdmflexframegen _q);
 //ofdma version
 void ofdmflexframegen_reconfigure_multi_user(ofdmflexframegen _q, unsigned int user);
+// re-compute the number of payload symbols from every user's share
+void ofdmflexframegen_update_num_symbols_payload(ofdmflexframegen _q);
+
+// switch to the pending subcarrier allocation
+void ofdmflexframegen_apply_subcarrier_allocation(ofdmflexframegen _q);
 
 
 // encode header
@@ -1215,6 +1297,17 @@ void ofdmflexframesync_rxheader(ofdmflexframesync _q,
 // decode header
 void ofdmflexframesync_decode_header(ofdmflexframesync _q);
 
+// rebuild the list of subcarriers carrying this receiver's payload
+void ofdmflexframesync_update_payload_subcarriers(ofdmflexframesync _q);
+
+// switch to the pending subcarrier allocation
+void ofdmflexframesync_apply_subcarrier_allocation(ofdmflexframesync _q);
+
+// store the weighted soft bits of one payload symbol
+void ofdmflexframesync_store_soft_bits(ofdmflexframesync _q,
+                                       unsigned int      _i,
+                                       unsigned char *   _soft_bits);
+
 // receive payload data
 void ofdmflexframesync_rxpayload(ofdmflexframesync _q,
                                 float complex * _X);
@@ -1526,7 +1619,7 @@ extern const float complex modem_arb256opt[256];
 //  _p      :   subcarrier allocation array
 //  _M      :   total number of subcarriers
 //  _S0     :   output symbol (freq)
-//  _s0     :   output symbol (time)
+//  _s0     :   output symbol (time), NULL to skip the transform
 //  _M_S0   :   total number of enabled subcarriers in S0
 void ofdmframe_init_S0(unsigned char * _p,
                        unsigned int    _M,
@@ -1538,7 +1631,7 @@ void ofdmframe_init_S0(unsigned char * _p,
 //  _p      :   subcarrier allocation array
 //  _M      :   total number of subcarriers
 //  _S1     :   output symbol (freq)
-//  _s1     :   output symbol (time)
+//  _s1     :   output symbol (time), NULL to skip the transform
 //  _M_S1   :   total number of enabled subcarriers in S1
 void ofdmframe_init_S1(unsigned char * _p,
                        unsigned int    _M,
@@ -1564,6 +1657,24 @@ void ofdmframesync_S0_metrics(ofdmframesync _q,
                               float complex * _G,
                               float complex * _s_hat);
 
+// delay-and-correlate metric of the short sequence, which repeats every
+// M/2 samples: correlation of _x[0:_n) with _x[_n:2*_n), and energy of
+// _x[0:2*_n)
+//  _x      :   input array (time), [size: 2*_n x 1]
+//  _n      :   correlation lag (half the window)
+//  _r      :   output correlation
+//  _e      :   output energy
+void ofdmframesync_S0_autocorr(float complex * _x,
+                               unsigned int    _n,
+                               float complex * _r,
+                               float *         _e);
+#if LIQUID_AVX2
+void ofdmframesync_S0_autocorr_avx2(float complex * _x,
+                                    unsigned int    _n,
+                                    float complex * _r,
+                                    float *         _e);
+#endif
+
 // estimate short sequence gain
 //  _q      :   ofdmframesync object
 //  _x      :   input array (time)
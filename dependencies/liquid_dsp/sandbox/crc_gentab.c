@@ -18,13 +18,14 @@
  */
 
 //
-// CRC table generator
+// CRC-32 table generator: prints src/fec/src/crc32_gentab.c, the
+// slice-by-8 tables used by crc32_generate_key()
 //
 
 #include <stdio.h>
 #include <stdlib.h>
 
-// generator polynomial
+// generator polynomial (reversed)
 #define CRC32_POLY 0xEDB88320 // 0x04C11DB7
 
 int main() {
@@ -32,9 +33,9 @@ int main() {
     unsigned int mask;
     unsigned int crcpoly = CRC32_POLY;
 
-    unsigned int crc_gentab[256];
+    unsigned int crc_gentab[8][256];
 
-    // generate table
+    // generate table: first slice is the byte-at-a-time table
     unsigned int i, j;
     for (i=0; i<256; i++) {
         crc = i;
@@ -42,23 +43,35 @@ int main() {
             mask = -(crc & 0x01);
             crc = (crc >> 1) ^ (crcpoly & mask);
         }
-        crc_gentab[i] = crc;
+        crc_gentab[0][i] = crc;
     }
 
-    printf("\n");
-    printf("unsigned char crc_gentab[%u] = {\n    ", 256);
-    for (i=0; i<256; i++) {
-        printf("0x%.2x", crc_gentab[i]);
-        if (i==255)
-            printf("};\n");
-        else if (((i+1)%8)==0)
-            printf(",\n    ");
-        else
-            printf(", ");
+    // slice k advances a byte k further through the register
+    unsigned int k;
+    for (k=1; k<8; k++) {
+        for (i=0; i<256; i++) {
+            crc = crc_gentab[k-1][i];
+            crc_gentab[k][i] = (crc >> 8) ^ crc_gentab[0][crc & 0xff];
+        }
     }
 
-    // test it...
+    printf("//\n");
+    printf("// CRC-32 generated tables (sandbox/crc_gentab.c)\n");
+    printf("//\n\n");
+    printf("// slice-by-8 tables, reversed polynomial 0x%.8X\n", CRC32_POLY);
+    printf("const unsigned int crc32_gentab[8][256] = {\n");
+    for (k=0; k<8; k++) {
+        printf("  { ");
+        for (i=0; i<256; i++) {
+            printf("0x%.8x", crc_gentab[k][i]);
+            if (i==255)
+                printf(" }%s\n", k==7 ? "};" : ",");
+            else if (((i+1)%6)==0)
+                printf(",\n    ");
+            else
+                printf(", ");
+        }
+    }
 
     return 0;
 }
-
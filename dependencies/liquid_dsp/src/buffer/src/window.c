@@ -218,9 +218,23 @@ void WINDOW(_write)(WINDOW()     _q,
                     T *          _v,
                     unsigned int _n)
 {
-    // TODO make this more efficient
-    unsigned int i;
-    for (i=0; i<_n; i++)
-        WINDOW(_push)(_q, _v[i]);
+    while (_n > 0) {
+        // number of values that can be appended before the read index
+        // wraps around
+        unsigned int k = _q->mask - _q->read_index;
+        if (k == 0) {
+            WINDOW(_push)(_q, *_v++);
+            _n--;
+            continue;
+        }
+        if (k > _n)
+            k = _n;
+
+        // append values to end of buffer
+        memmove(_q->v + _q->read_index + _q->len, _v, k*sizeof(T));
+        _q->read_index += k;
+        _v += k;
+        _n -= k;
+    }
 }
 
@@ -138,3 +138,38 @@ void autotest_windowf()
     printf("done.\n");
 }
 
+
+//
+// AUTOTEST: writing blocks of values onto a window leaves it as pushing
+// them one at a time would, across many wrap-arounds of the read index
+//
+void autotest_windowcf_write_block()
+{
+    unsigned int n = 23;    // window length (not a power of two)
+    windowcf w0 = windowcf_create(n);
+    windowcf w1 = windowcf_create(n);
+
+    float complex v[100];
+    float complex * r0;
+    float complex * r1;
+    unsigned int i, j, k = 0;
+    for (i=0; i<40; i++) {
+        // block lengths 0 through 40
+        unsigned int len = (7*i) % 41;
+        for (j=0; j<len; j++) {
+            v[j] = (float)k + _Complex_I*(float)(1000 - k);
+            k++;
+        }
+
+        windowcf_write(w0, v, len);
+        for (j=0; j<len; j++)
+            windowcf_push(w1, v[j]);
+
+        windowcf_read(w0, &r0);
+        windowcf_read(w1, &r1);
+        CONTEND_SAME_DATA(r0, r1, n*sizeof(float complex));
+    }
+
+    windowcf_destroy(w0);
+    windowcf_destroy(w1);
+}
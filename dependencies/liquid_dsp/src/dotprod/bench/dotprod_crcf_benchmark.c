@@ -69,7 +69,12 @@ void dotprod_crcf_bench(struct rusage *_start,
 { dotprod_crcf_bench(_start, _finish, _num_iterations, N); }
 
 void benchmark_dotprod_crcf_4      DOTPROD_CRCF_BENCHMARK_API(4)
+
 void benchmark_dotprod_crcf_16     DOTPROD_CRCF_BENCHMARK_API(16)
+
+// multichannelrx/tx channelizer sub-filters (m=7) and the U4 rx prefilter
+void benchmark_dotprod_crcf_14     DOTPROD_CRCF_BENCHMARK_API(14)
+void benchmark_dotprod_crcf_31     DOTPROD_CRCF_BENCHMARK_API(31)
 void benchmark_dotprod_crcf_64     DOTPROD_CRCF_BENCHMARK_API(64)
 void benchmark_dotprod_crcf_256    DOTPROD_CRCF_BENCHMARK_API(256)
 
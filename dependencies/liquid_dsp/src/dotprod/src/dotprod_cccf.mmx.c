@@ -46,6 +46,10 @@
 #include <pmmintrin.h>  // SSE3
 #endif
 
+#if LIQUID_AVX2
+#include <immintrin.h>  // AVX2, FMA
+#endif
+
 #define DEBUG_DOTPROD_CCCF_MMX   0
 
 // forward declaration of internal methods
@@ -57,6 +61,12 @@ void dotprod_cccf_execute_mmx4(dotprod_cccf    _q,
                                float complex * _x,
                                float complex * _y);
 
+#if LIQUID_AVX2
+void dotprod_cccf_execute_avx2(dotprod_cccf    _q,
+                               float complex * _x,
+                               float complex * _y);
+#endif
+
 // basic dot product (ordinal calculation)
 void dotprod_cccf_run(float complex * _h,
                       float complex * _x,
@@ -106,6 +116,7 @@ struct dotprod_cccf_s {
     unsigned int n;     // length
     float * hi;         // in-phase
     float * hq;         // quadrature
+    int avx2;           // use AVX2/FMA kernel?
 };
 
 dotprod_cccf dotprod_cccf_create(float complex * _h,
@@ -113,10 +124,11 @@ dotprod_cccf dotprod_cccf_create(float complex * _h,
 {
     dotprod_cccf q = (dotprod_cccf)malloc(sizeof(struct dotprod_cccf_s));
     q->n = _n;
+    q->avx2 = liquid_avx2_enabled();
 
-    // allocate memory for coefficients, 16-byte aligned
-    q->hi = (float*) _mm_malloc( 2*q->n*sizeof(float), 16 );
-    q->hq = (float*) _mm_malloc( 2*q->n*sizeof(float), 16 );
+    // allocate memory for coefficients, 32-byte aligned for AVX
+    q->hi = (float*) _mm_malloc( 2*q->n*sizeof(float), 32 );
+    q->hq = (float*) _mm_malloc( 2*q->n*sizeof(float), 32 );
 
     // set coefficients, repeated
     //  hi = { crealf(_h[0]), crealf(_h[0]), ... crealf(_h[n-1]), crealf(_h[n-1])}
@@ -154,7 +166,7 @@ void dotprod_cccf_destroy(dotprod_cccf _q)
 
 void dotprod_cccf_print(dotprod_cccf _q)
 {
-    printf("dotprod_cccf [mmx, %u coefficients]\n", _q->n);
+    printf("dotprod_cccf [%s, %u coefficients]\n", _q->avx2 ? "avx2" : "mmx", _q->n);
     unsigned int i;
     for (i=0; i<_q->n; i++)
         printf("  %3u : %12.9f +j%12.9f\n", i, _q->hi[i], _q->hq[i]);
@@ -168,6 +180,13 @@ void dotprod_cccf_execute(dotprod_cccf    _q,
                           float complex * _x,
                           float complex * _y)
 {
+#if LIQUID_AVX2
+    if (_q->avx2) {
+        dotprod_cccf_execute_avx2(_q, _x, _y);
+        return;
+    }
+#endif
+
     // switch based on size
     if (_q->n < 32) {
         dotprod_cccf_execute_mmx(_q, _x, _y);
@@ -377,3 +396,62 @@ void dotprod_cccf_execute_mmx4(dotprod_cccf    _q,
     *_y = total;
 }
 
+#if LIQUID_AVX2
+// use AVX2/FMA extensions: the in-phase and quadrature products of 4
+// complex samples are accumulated per step as in the mmx4 kernel above,
+// and combined with a single add/sub at the end
+LIQUID_AVX2_TARGET
+void dotprod_cccf_execute_avx2(dotprod_cccf    _q,
+                               float complex * _x,
+                               float complex * _y)
+{
+    // type cast input as floating point array
+    float * x = (float*) _x;
+
+    // double effective length
+    unsigned int n = 2*_q->n;
+
+    // load zeros into sum registers
+    __m256 sumi = _mm256_setzero_ps();
+    __m256 sumq = _mm256_setzero_ps();
+
+    unsigned int i = 0;
+    for ( ; i+8 <= n; i+=8) {
+        // load inputs into register (unaligned)
+        __m256 v = _mm256_loadu_ps(&x[i]);
+
+        // multiply-accumulate with the coefficients (aligned)
+        sumi = _mm256_fmadd_ps(v, _mm256_load_ps(&_q->hi[i]), sumi);
+        sumq = _mm256_fmadd_ps(v, _mm256_load_ps(&_q->hq[i]), sumq);
+    }
+
+    // fold down to 4-element registers
+    __m128 si = _mm_add_ps(_mm256_castps256_ps128(sumi),
+                           _mm256_extractf128_ps(sumi, 1));
+    __m128 sq = _mm_add_ps(_mm256_castps256_ps128(sumq),
+                           _mm256_extractf128_ps(sumq, 1));
+    if (i+4 <= n) {
+        __m128 v = _mm_loadu_ps(&x[i]);
+        si = _mm_fmadd_ps(v, _mm_load_ps(&_q->hi[i]), si);
+        sq = _mm_fmadd_ps(v, _mm_load_ps(&_q->hq[i]), sq);
+        i += 4;
+    }
+
+    // swap quadrature pairs and combine: [ac - bd, bc + ad, ...]
+    sq = _mm_shuffle_ps( sq, sq, _MM_SHUFFLE(2,3,0,1) );
+    __m128 s = _mm_addsub_ps( si, sq );
+
+    // unload packed array
+    float w[4] __attribute__((aligned(16)));
+    _mm_store_ps(w, s);
+    float complex total = (w[0] + w[2]) + (w[1] + w[3]) * _Complex_I;
+
+    // cleanup (at most one sample remains)
+    for (i/=2; i<_q->n; i++)
+        total += _x[i] * ( _q->hi[2*i] + _q->hq[2*i]*_Complex_I );
+
+    // set return value
+    *_y = total;
+}
+#endif
+
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// dotprod_cpu.c : run-time selection of the AVX2 kernels (dot products,
+//                 modem block demodulators)
+//
+
+#include <stdlib.h>
+
+#include "liquid.internal.h"
+
+// returns 1 if the AVX2/FMA kernels should be used
+int liquid_avx2_enabled()
+{
+#if LIQUID_AVX2
+    // CPUID, checked once
+    static int cpu_support = -1;
+    if (cpu_support < 0) {
+        __builtin_cpu_init();
+        cpu_support = __builtin_cpu_supports("avx2") &&
+                      __builtin_cpu_supports("fma");
+    }
+
+    // read each time so that a benchmark or test can switch kernels
+    if (getenv("LIQUID_NO_AVX2") != NULL)
+        return 0;
+
+    return cpu_support;
+#else
+    return 0;
+#endif
+}
+
@@ -29,6 +29,10 @@
 
 #include "liquid.internal.h"
 
+#if LIQUID_AVX2
+#include <immintrin.h>  // AVX2, FMA
+#endif
+
 #define DEBUG_DOTPROD_CRCF_MMX   0
 
 // forward declaration of internal methods
@@ -38,6 +42,11 @@ void dotprod_crcf_execute_mmx(dotprod_crcf    _q,
 void dotprod_crcf_execute_mmx4(dotprod_crcf    _q,
                                float complex * _x,
                                float complex * _y);
+#if LIQUID_AVX2
+void dotprod_crcf_execute_avx2(dotprod_crcf    _q,
+                               float complex * _x,
+                               float complex * _y);
+#endif
 
 // basic dot product (ordinal calculation)
 void dotprod_crcf_run(float *         _h,
@@ -87,6 +96,7 @@ void dotprod_crcf_run4(float *         _h,
 struct dotprod_crcf_s {
     unsigned int n;     // length
     float * h;          // coefficients array
+    int avx2;           // use AVX2/FMA kernel?
 };
 
 dotprod_crcf dotprod_crcf_create(float *      _h,
@@ -94,9 +104,10 @@ dotprod_crcf dotprod_crcf_create(float *      _h,
 {
     dotprod_crcf q = (dotprod_crcf)malloc(sizeof(struct dotprod_crcf_s));
     q->n = _n;
+    q->avx2 = liquid_avx2_enabled();
 
-    // allocate memory for coefficients, 16-byte aligned
-    q->h = (float*) _mm_malloc( 2*q->n*sizeof(float), 16 );
+    // allocate memory for coefficients, 32-byte aligned for AVX
+    q->h = (float*) _mm_malloc( 2*q->n*sizeof(float), 32 );
 
     // set coefficients, repeated
     //  h = { _h[0], _h[0], _h[1], _h[1], ... _h[n-1], _h[n-1]}
@@ -131,7 +142,7 @@ void dotprod_crcf_print(dotprod_crcf _q)
 {
     // print coefficients to screen, skipping odd entries (due
     // to repeated coefficients)
-    printf("dotprod_crcf [mmx, %u coefficients]\n", _q->n);
+    printf("dotprod_crcf [%s, %u coefficients]\n", _q->avx2 ? "avx2" : "mmx", _q->n);
     unsigned int i;
     for (i=0; i<_q->n; i++)
         printf("  %3u : %12.9f\n", i, _q->h[2*i]);
@@ -142,6 +153,13 @@ void dotprod_crcf_execute(dotprod_crcf    _q,
                           float complex * _x,
                           float complex * _y)
 {
+#if LIQUID_AVX2
+    if (_q->avx2) {
+        dotprod_crcf_execute_avx2(_q, _x, _y);
+        return;
+    }
+#endif
+
     // switch based on size
     if (_q->n < 32) {
         dotprod_crcf_execute_mmx(_q, _x, _y);
@@ -282,3 +300,59 @@ void dotprod_crcf_execute_mmx4(dotprod_crcf    _q,
     *_y = w[0] + w[1]*_Complex_I;
 }
 
+#if LIQUID_AVX2
+// use AVX2/FMA extensions: 16 floats (8 complex samples) per iteration
+// into two accumulators, then a single 8-float and a 4-float step so the
+// short filters in the channelizers and resamplers stay vectorized
+LIQUID_AVX2_TARGET
+void dotprod_crcf_execute_avx2(dotprod_crcf    _q,
+                               float complex * _x,
+                               float complex * _y)
+{
+    // type cast input as floating point array
+    float * x = (float*) _x;
+
+    // double effective length
+    unsigned int n = 2*_q->n;
+
+    // load zeros into sum registers
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+
+    unsigned int i = 0;
+    for ( ; i+16 <= n; i+=16) {
+        // inputs unaligned, coefficients aligned; multiply-accumulate
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i  ]), _mm256_load_ps(&_q->h[i  ]), sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i+8]), _mm256_load_ps(&_q->h[i+8]), sum1);
+    }
+    if (i+8 <= n) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i]), _mm256_load_ps(&_q->h[i]), sum0);
+        i += 8;
+    }
+
+    // fold down to [re, im, re, im]
+    sum0 = _mm256_add_ps(sum0, sum1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum0),
+                            _mm256_extractf128_ps(sum0, 1));
+    if (i+4 <= n) {
+        sum = _mm_fmadd_ps(_mm_loadu_ps(&x[i]), _mm_load_ps(&_q->h[i]), sum);
+        i += 4;
+    }
+
+    // aligned output array
+    float w[4] __attribute__((aligned(16)));
+    _mm_store_ps(w, sum);
+    w[0] += w[2];
+    w[1] += w[3];
+
+    // cleanup (at most one sample remains)
+    for ( ; i<n; i+=2) {
+        w[0] += x[i  ] * _q->h[i  ];
+        w[1] += x[i+1] * _q->h[i+1];
+    }
+
+    // set return value
+    *_y = w[0] + w[1]*_Complex_I;
+}
+#endif
+
@@ -47,6 +47,10 @@
 #include <pmmintrin.h>  // SSE3
 #endif
 
+#if LIQUID_AVX2
+#include <immintrin.h>  // AVX2, FMA
+#endif
+
 #define DEBUG_DOTPROD_RRRF_MMX   0
 
 // internal methods
@@ -56,6 +60,11 @@ void dotprod_rrrf_execute_mmx(dotprod_rrrf _q,
 void dotprod_rrrf_execute_mmx4(dotprod_rrrf _q,
                                float *      _x,
                                float *      _y);
+#if LIQUID_AVX2
+void dotprod_rrrf_execute_avx2(dotprod_rrrf _q,
+                               float *      _x,
+                               float *      _y);
+#endif
 
 // basic dot product (ordinal calculation)
 void dotprod_rrrf_run(float *      _h,
@@ -105,6 +114,7 @@ void dotprod_rrrf_run4(float *      _h,
 struct dotprod_rrrf_s {
     unsigned int n;     // length
     float * h;          // coefficients array
+    int avx2;           // use AVX2/FMA kernel?
 };
 
 dotprod_rrrf dotprod_rrrf_create(float *      _h,
@@ -112,9 +122,10 @@ dotprod_rrrf dotprod_rrrf_create(float *      _h,
 {
     dotprod_rrrf q = (dotprod_rrrf)malloc(sizeof(struct dotprod_rrrf_s));
     q->n = _n;
+    q->avx2 = liquid_avx2_enabled();
 
-    // allocate memory for coefficients, 16-byte aligned
-    q->h = (float*) _mm_malloc( q->n*sizeof(float), 16);
+    // allocate memory for coefficients, 32-byte aligned for AVX
+    q->h = (float*) _mm_malloc( q->n*sizeof(float), 32);
 
     // set coefficients
     memmove(q->h, _h, _n*sizeof(float));
@@ -142,7 +153,7 @@ void dotprod_rrrf_destroy(dotprod_rrrf _q)
 
 void dotprod_rrrf_print(dotprod_rrrf _q)
 {
-    printf("dotprod_rrrf [mmx, %u coefficients]\n", _q->n);
+    printf("dotprod_rrrf [%s, %u coefficients]\n", _q->avx2 ? "avx2" : "mmx", _q->n);
     unsigned int i;
     for (i=0; i<_q->n; i++)
         printf("%3u : %12.9f\n", i, _q->h[i]);
@@ -153,6 +164,13 @@ void dotprod_rrrf_execute(dotprod_rrrf _q,
                           float *      _x,
                           float *      _y)
 {
+#if LIQUID_AVX2
+    if (_q->avx2) {
+        dotprod_rrrf_execute_avx2(_q, _x, _y);
+        return;
+    }
+#endif
+
     // switch based on size
     if (_q->n < 16) {
         dotprod_rrrf_execute_mmx(_q, _x, _y);
@@ -296,3 +314,51 @@ void dotprod_rrrf_execute_mmx4(dotprod_rrrf _q,
     *_y = total;
 }
 
+#if LIQUID_AVX2
+// use AVX2/FMA extensions: 16 values per iteration into two accumulators,
+// then a single 8-value and 4-value step
+LIQUID_AVX2_TARGET
+void dotprod_rrrf_execute_avx2(dotprod_rrrf _q,
+                               float *      _x,
+                               float *      _y)
+{
+    unsigned int n = _q->n;
+
+    // load zeros into sum registers
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+
+    unsigned int i = 0;
+    for ( ; i+16 <= n; i+=16) {
+        // inputs unaligned, coefficients aligned; multiply-accumulate
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(&_x[i  ]), _mm256_load_ps(&_q->h[i  ]), sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(&_x[i+8]), _mm256_load_ps(&_q->h[i+8]), sum1);
+    }
+    if (i+8 <= n) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(&_x[i]), _mm256_load_ps(&_q->h[i]), sum0);
+        i += 8;
+    }
+
+    // fold down into single 4-element register
+    sum0 = _mm256_add_ps(sum0, sum1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum0),
+                            _mm256_extractf128_ps(sum0, 1));
+    if (i+4 <= n) {
+        sum = _mm_fmadd_ps(_mm_loadu_ps(&_x[i]), _mm_load_ps(&_q->h[i]), sum);
+        i += 4;
+    }
+
+    // fold down to single value
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    float total = _mm_cvtss_f32(sum);
+
+    // cleanup
+    for ( ; i<n; i++)
+        total += _x[i] * _q->h[i];
+
+    // set return value
+    *_y = total;
+}
+#endif
+
@@ -17,6 +17,8 @@
  * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
+
 #include "autotest/autotest.h"
 #include "liquid.internal.h"
 
@@ -162,3 +164,14 @@ void autotest_dotprod_crcf_struct_vs_ordinal()
         runtest_dotprod_crcf(i);
 }
 
+// same, with the SSE kernels forced; processors with AVX2/FMA otherwise
+// never run them
+void autotest_dotprod_crcf_struct_vs_ordinal_sse()
+{
+    setenv("LIQUID_NO_AVX2", "1", 1);
+    unsigned int i;
+    for (i=1; i<=512; i++)
+        runtest_dotprod_crcf(i);
+    unsetenv("LIQUID_NO_AVX2");
+}
+
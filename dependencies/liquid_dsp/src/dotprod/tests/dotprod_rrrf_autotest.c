@@ -19,6 +19,8 @@
 
 #include <string.h>
 
+#include <stdlib.h>
+
 #include "autotest/autotest.h"
 #include "liquid.internal.h"
 
@@ -367,3 +369,14 @@ void autotest_dotprod_rrrf_struct_vs_ordinal()
         runtest_dotprod_rrrf(i);
 }
 
+// same, with the SSE kernels forced; processors with AVX2/FMA otherwise
+// never run them
+void autotest_dotprod_rrrf_struct_vs_ordinal_sse()
+{
+    setenv("LIQUID_NO_AVX2", "1", 1);
+    unsigned int i;
+    for (i=1; i<=512; i++)
+        runtest_dotprod_rrrf(i);
+    unsetenv("LIQUID_NO_AVX2");
+}
+
@@ -73,3 +73,53 @@ void benchmark_crc_crc16_n256       CRC_BENCH_API(LIQUID_CRC_16,        256)
 void benchmark_crc_crc24_n256       CRC_BENCH_API(LIQUID_CRC_24,        256)
 void benchmark_crc_crc32_n256       CRC_BENCH_API(LIQUID_CRC_32,        256)
 
+// CRC-32 implementations at the frame sizes the radio runs (frame_size
+// of 1024 to 2103 bytes); bytes/s is the message length times trials/s
+void crc32_bench(struct rusage *_start,
+                 struct rusage *_finish,
+                 unsigned long int *_num_iterations,
+                 unsigned int (*_crc32)(unsigned char *, unsigned int),
+                 unsigned int _n)
+{
+    // normalize number of iterations
+    *_num_iterations /= 8;
+    *_num_iterations = (*_num_iterations * 256) / _n;
+    if (*_num_iterations < 1) *_num_iterations = 1;
+
+    unsigned long int i;
+
+    // create arrays
+    unsigned char msg[_n];
+    unsigned int key = 0;
+
+    // initialze message
+    for (i=0; i<_n; i++)
+        msg[i] = rand() & 0xff;
+
+    // start trials
+    getrusage(RUSAGE_SELF, _start);
+    for (i=0; i<(*_num_iterations); i++) {
+        key ^= _crc32(msg, _n);
+        key ^= _crc32(msg, _n);
+        key ^= _crc32(msg, _n);
+        key ^= _crc32(msg, _n);
+    }
+    getrusage(RUSAGE_SELF, _finish);
+    *_num_iterations *= 4;
+
+    // keep the result live
+    if (key == 0x12345678)
+        printf("  (key %.8x)\n", key);
+}
+
+#define CRC32_BENCH_API(FUNC,N)             \
+(   struct rusage *_start,                  \
+    struct rusage *_finish,                 \
+    unsigned long int *_num_iterations)     \
+{ crc32_bench(_start, _finish, _num_iterations, FUNC, N); }
+
+void benchmark_crc_crc32_n1024          CRC32_BENCH_API(crc32_generate_key,         1024)
+void benchmark_crc_crc32_n2103          CRC32_BENCH_API(crc32_generate_key,         2103)
+void benchmark_crc_crc32_slice8_n1024   CRC32_BENCH_API(crc32_generate_key_slice8,  1024)
+void benchmark_crc_crc32_slice8_n2103   CRC32_BENCH_API(crc32_generate_key_slice8,  2103)
+void benchmark_crc_crc32_bitwise_n2103  CRC32_BENCH_API(crc32_generate_key_bitwise, 2103)
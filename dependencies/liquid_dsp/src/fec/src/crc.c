@@ -27,6 +27,10 @@
 
 #include "liquid.internal.h"
 
+#if LIQUID_CRC32_PCLMUL
+#include <immintrin.h>  // PCLMULQDQ, SSE4.1
+#endif
+
 
 // object-independent methods
 
@@ -260,15 +264,32 @@ unsigned int crc24_generate_key(unsigned char *_msg,
 // CRC-32
 //
 
+// generate 32-bit cyclic redundancy check key
+//
+//  _msg    :   input data message [size: _n x 1]
+//  _n      :   input data message size
+unsigned int crc32_generate_key(unsigned char *_msg,
+                                unsigned int _n)
+{
+#if LIQUID_CRC32_PCLMUL
+    // folding needs at least 64 bytes; headers and other short messages
+    // are as fast through the tables
+    if (_n >= 64 && crc32_pclmul_supported())
+        return crc32_generate_key_pclmul(_msg, _n);
+#endif
+    return crc32_generate_key_slice8(_msg, _n);
+}
+
 // generate 32-bit cyclic redundancy check key.
 //
-// slow method, operates one bit at a time
+// slow method, operates one bit at a time; the reference for the
+// faster methods below
 // algorithm from: http://www.hackersdelight.org/crc.pdf
 //
 //  _msg    :   input data message [size: _n x 1]
 //  _n      :   input data message size
-unsigned int crc32_generate_key(unsigned char *_msg,
-                                unsigned int _n)
+unsigned int crc32_generate_key_bitwise(unsigned char *_msg,
+                                        unsigned int _n)
 {
     unsigned int i, j, b, mask, key32=~0;
     unsigned int poly = liquid_reverse_uint32(CRC32_POLY);
@@ -283,6 +304,180 @@ unsigned int crc32_generate_key(unsigned char *_msg,
     return (~key32) & 0xffffffff;
 }
 
+// advance CRC-32 register eight bytes at a time (slice-by-8)
+//
+//  _key32  :   register (not inverted)
+//  _msg    :   input data message [size: _n x 1]
+//  _n      :   input data message size
+static unsigned int crc32_update_slice8(unsigned int    _key32,
+                                        unsigned char * _msg,
+                                        unsigned int    _n)
+{
+    unsigned int i;
+    unsigned int key32 = _key32;
+    unsigned int t = (_n >> 3) << 3;
+    for (i=0; i<t; i+=8) {
+        // assembled byte by byte so the result does not depend on
+        // the host's endianness
+        unsigned int w0 = key32 ^ ( (unsigned int)_msg[i  ]        |
+                                   ((unsigned int)_msg[i+1] <<  8) |
+                                   ((unsigned int)_msg[i+2] << 16) |
+                                   ((unsigned int)_msg[i+3] << 24) );
+        unsigned int w1 =         ( (unsigned int)_msg[i+4]        |
+                                   ((unsigned int)_msg[i+5] <<  8) |
+                                   ((unsigned int)_msg[i+6] << 16) |
+                                   ((unsigned int)_msg[i+7] << 24) );
+        key32 = crc32_gentab[7][ w0        & 0xff] ^
+                crc32_gentab[6][(w0 >>  8) & 0xff] ^
+                crc32_gentab[5][(w0 >> 16) & 0xff] ^
+                crc32_gentab[4][(w0 >> 24) & 0xff] ^
+                crc32_gentab[3][ w1        & 0xff] ^
+                crc32_gentab[2][(w1 >>  8) & 0xff] ^
+                crc32_gentab[1][(w1 >> 16) & 0xff] ^
+                crc32_gentab[0][(w1 >> 24) & 0xff];
+    }
+
+    // remaining bytes, one at a time
+    for ( ; i<_n; i++)
+        key32 = (key32 >> 8) ^ crc32_gentab[0][(key32 ^ _msg[i]) & 0xff];
+
+    return key32 & 0xffffffff;
+}
+
+// generate 32-bit cyclic redundancy check key, slice-by-8 tables
+//
+//  _msg    :   input data message [size: _n x 1]
+//  _n      :   input data message size
+unsigned int crc32_generate_key_slice8(unsigned char *_msg,
+                                       unsigned int _n)
+{
+    return (~crc32_update_slice8(~0, _msg, _n)) & 0xffffffff;
+}
+
+#if LIQUID_CRC32_PCLMUL
+// returns 1 if the CPU supports PCLMULQDQ and SSE4.1 (checked once)
+int crc32_pclmul_supported()
+{
+    static int support = -1;
+    if (support < 0) {
+        __builtin_cpu_init();
+        support = __builtin_cpu_supports("pclmul") &&
+                  __builtin_cpu_supports("sse4.1");
+    }
+    return support;
+}
+
+// generate 32-bit cyclic redundancy check key, folding 64 bytes at a
+// time with carry-less multiplies and reducing with Barrett's method
+// (Gopal et al., "Fast CRC Computation for Generic Polynomials Using
+// PCLMULQDQ Instruction", Intel, 2009), bit-reflected constants for
+// the 0x04C11DB7 polynomial.  The bytes past the last multiple of 16
+// go through the tables.
+//
+//  _msg    :   input data message [size: _n x 1]
+//  _n      :   input data message size
+__attribute__((target("pclmul,sse4.1")))
+unsigned int crc32_generate_key_pclmul(unsigned char *_msg,
+                                       unsigned int _n)
+{
+    if (_n < 64)
+        return crc32_generate_key_slice8(_msg, _n);
+
+    unsigned int n = _n & ~15u;
+    unsigned char * p = _msg;
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    // first 64-byte block, with the initial register value
+    x1 = _mm_loadu_si128((__m128i *)(p + 0x00));
+    x2 = _mm_loadu_si128((__m128i *)(p + 0x10));
+    x3 = _mm_loadu_si128((__m128i *)(p + 0x20));
+    x4 = _mm_loadu_si128((__m128i *)(p + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(~0));
+    p += 64;
+    n -= 64;
+
+    // fold by 4: k1, k2
+    x0 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+    while (n >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128((__m128i *)(p + 0x00));
+        y6 = _mm_loadu_si128((__m128i *)(p + 0x10));
+        y7 = _mm_loadu_si128((__m128i *)(p + 0x20));
+        y8 = _mm_loadu_si128((__m128i *)(p + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        p += 64;
+        n -= 64;
+    }
+
+    // fold into 128 bits: k3, k4
+    x0 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // remaining 16-byte blocks
+    while (n >= 16) {
+        x2 = _mm_loadu_si128((__m128i *)p);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        p += 16;
+        n -= 16;
+    }
+
+    // fold 128 bits to 64 bits: k4, k5
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_set_epi64x(0, 0x0163cd6124LL);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits: P', mu
+    x0 = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    unsigned int key32 = (unsigned int)_mm_extract_epi32(x1, 1);
+
+    // tail
+    key32 = crc32_update_slice8(key32, p, _n & 15);
+    return (~key32) & 0xffffffff;
+}
+#endif
+
 #if 0
 void crc32_generate_key(unsigned char *_msg,
                         unsigned int _n,
@@ -170,6 +170,53 @@ packetizer packetizer_recreate(packetizer _p,
     }
 }
 
+// does packetizer _p have these properties?
+static int packetizer_matches(packetizer   _p,
+                              unsigned int _n,
+                              int          _crc,
+                              int          _fec0,
+                              int          _fec1)
+{
+    return _p              !=  NULL    &&
+           _p->msg_len     ==  _n      &&
+           _p->check       ==  _crc    &&
+           _p->plan[0].fs  ==  _fec0   &&
+           _p->plan[1].fs  ==  _fec1;
+}
+
+packetizer packetizer_recreate_cached(packetizer      _p,
+                                      packetizer *    _cache,
+                                      unsigned int    _n,
+                                      int             _crc,
+                                      int             _fec0,
+                                      int             _fec1)
+{
+    if (packetizer_matches(_p, _n, _crc, _fec0, _fec1))
+        return _p;
+
+    // find a match, leaving i at the least recently used entry otherwise
+    unsigned int i;
+    for (i=0; i<PACKETIZER_CACHE_LEN-1; i++) {
+        if (packetizer_matches(_cache[i], _n, _crc, _fec0, _fec1))
+            break;
+    }
+    packetizer q = _cache[i];
+    memmove(&_cache[1], &_cache[0], i*sizeof(packetizer));
+    _cache[0] = _p;
+
+    return packetizer_recreate(q, _n, _crc, _fec0, _fec1);
+}
+
+void packetizer_cache_destroy(packetizer * _cache)
+{
+    unsigned int i;
+    for (i=0; i<PACKETIZER_CACHE_LEN; i++) {
+        if (_cache[i] != NULL)
+            packetizer_destroy(_cache[i]);
+        _cache[i] = NULL;
+    }
+}
+
 // destroy packetizer object
 void packetizer_destroy(packetizer _p)
 {
@@ -322,35 +369,51 @@ int packetizer_decode_soft(packetizer _p,
     // copy coded message to internal buffer[0]
     memmove(_p->buffer_0, _pkt, 8*_p->packet_len);
 
-    // 
-    // decode outer level using soft decoding
-    //
+    // an outer level without error correction is a pass-through (its
+    // interleaver has zero depth), so carry the soft bits on to the inner
+    // level rather than slicing them there
+    if (_p->plan[1].fs == LIQUID_FEC_NONE) {
+        // run the de-interleaver: buffer[0] > buffer[1]
+        interleaver_decode_soft(_p->plan[0].q,
+                                _p->buffer_0,
+                                _p->buffer_1);
 
-    // run the de-interleaver: buffer[0] > buffer[1]
-    interleaver_decode_soft(_p->plan[1].q,
-                            _p->buffer_0,
-                            _p->buffer_1);
+        // run the decoder: buffer[1] > buffer[0]
+        fec_decode_soft(_p->plan[0].f,
+                        _p->plan[0].dec_msg_len,
+                        _p->buffer_1,
+                        _p->buffer_0);
+    } else {
+        // 
+        // decode outer level using soft decoding
+        //
 
-    // run the decoder: buffer[1] > buffer[0]
-    fec_decode_soft(_p->plan[1].f,
-                    _p->plan[1].dec_msg_len,
-                    _p->buffer_1,
-                    _p->buffer_0);
+        // run the de-interleaver: buffer[0] > buffer[1]
+        interleaver_decode_soft(_p->plan[1].q,
+                                _p->buffer_0,
+                                _p->buffer_1);
 
-    // 
-    // decode inner level using hard decoding
-    //
+        // run the decoder: buffer[1] > buffer[0]
+        fec_decode_soft(_p->plan[1].f,
+                        _p->plan[1].dec_msg_len,
+                        _p->buffer_1,
+                        _p->buffer_0);
 
-    // run the de-interleaver: buffer[0] > buffer[1]
-    interleaver_decode(_p->plan[0].q,
-                       _p->buffer_0,
-                       _p->buffer_1);
+        // 
+        // decode inner level using hard decoding
+        //
 
-    // run the decoder: buffer[1] > buffer[0]
-    fec_decode(_p->plan[0].f,
-               _p->plan[0].dec_msg_len,
-               _p->buffer_1,
-               _p->buffer_0);
+        // run the de-interleaver: buffer[0] > buffer[1]
+        interleaver_decode(_p->plan[0].q,
+                           _p->buffer_0,
+                           _p->buffer_1);
+
+        // run the decoder: buffer[1] > buffer[0]
+        fec_decode(_p->plan[0].f,
+                   _p->plan[0].dec_msg_len,
+                   _p->buffer_1,
+                   _p->buffer_0);
+    }
 
     // strip crc, validate message
     unsigned int key = 0;
@@ -20,7 +20,7 @@
 #include <string.h>
 
 #include "autotest/autotest.h"
-#include "liquid.h"
+#include "liquid.internal.h"
 
 //
 // AUTOTEST: reverse byte
@@ -116,4 +116,40 @@ void autotest_crc16()    { validate_crc(LIQUID_CRC_16,          64); }
 void autotest_crc24()    { validate_crc(LIQUID_CRC_24,          64); }
 void autotest_crc32()    { validate_crc(LIQUID_CRC_32,          64); }
 
+//
+// AUTOTEST : CRC-32 implementations against the bit-at-a-time reference
+//
+void autotest_crc32_implementations()
+{
+    // known answer: standard "123456789" check value
+    unsigned char check[9] = {'1','2','3','4','5','6','7','8','9'};
+    CONTEND_EQUALITY(crc32_generate_key_bitwise(check, 9), 0xcbf43926);
+    CONTEND_EQUALITY(crc32_generate_key(check, 9),         0xcbf43926);
+
+    // pseudo-random data, with room for misaligned starts
+    unsigned int n_max = 2200;
+    unsigned char data[n_max + 8];
+    unsigned int i;
+    msequence ms = msequence_create_default(11);
+    for (i=0; i<n_max+8; i++)
+        data[i] = msequence_generate_symbol(ms,8);
+    msequence_destroy(ms);
 
+    // every length through 300 (all head/tail cases), then the payload
+    // sizes the radio sends: frame_size, and frame_size plus padding
+    unsigned int lengths[5] = {1024, 1037, 2103, 2116, 2200};
+    unsigned int k;
+    for (k=0; k<301+5; k++) {
+        unsigned int n = k < 301 ? k : lengths[k-301];
+        unsigned int offset = k % 8;
+        unsigned int key = crc32_generate_key_bitwise(data+offset, n);
+
+        CONTEND_EQUALITY(crc32_generate_key_slice8(data+offset, n), key);
+        CONTEND_EQUALITY(crc32_generate_key(data+offset, n),        key);
+#if LIQUID_CRC32_PCLMUL
+        if (crc32_pclmul_supported()) {
+            CONTEND_EQUALITY(crc32_generate_key_pclmul(data+offset, n), key);
+        }
+#endif
+    }
+}
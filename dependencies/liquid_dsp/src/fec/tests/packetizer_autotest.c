@@ -18,7 +18,7 @@
  */
 
 #include "autotest/autotest.h"
-#include "liquid.h"
+#include "liquid.internal.h"
 
 // Help function to keep code base small
 void packetizer_test_codec(unsigned int _n,
@@ -62,3 +62,44 @@ void autotest_packetizer_n16_0_0()  { packetizer_test_codec(16, LIQUID_CRC_32, L
 void autotest_packetizer_n16_0_1()  { packetizer_test_codec(16, LIQUID_CRC_32, LIQUID_FEC_NONE, LIQUID_FEC_REP3);       }
 void autotest_packetizer_n16_0_2()  { packetizer_test_codec(16, LIQUID_CRC_32, LIQUID_FEC_NONE, LIQUID_FEC_HAMMING74);  }
 
+//
+// AUTOTEST: packetizer_recreate_cached swaps previously used objects back
+// in rather than re-creating them
+//
+void autotest_packetizer_recreate_cached()
+{
+    packetizer cache[PACKETIZER_CACHE_LEN];
+    unsigned int i;
+    for (i=0; i<PACKETIZER_CACHE_LEN; i++)
+        cache[i] = NULL;
+
+    int crc  = LIQUID_CRC_32;
+    int fec0 = LIQUID_FEC_CONV_V27;
+    int fec1 = LIQUID_FEC_RS_M8;
+    packetizer p = packetizer_recreate_cached(NULL, cache, 100, crc, fec0, fec1);
+    packetizer p100 = p;
+    p = packetizer_recreate_cached(p, cache, 0, crc, fec0, fec1);
+    packetizer p0 = p;
+    p = packetizer_recreate_cached(p, cache, 113, crc, fec0, fec1);
+    packetizer p113 = p;
+
+    // cycling through the three lengths returns the same three objects
+    for (i=0; i<10; i++) {
+        p = packetizer_recreate_cached(p, cache, 100, crc, fec0, fec1);
+        CONTEND_EQUALITY( p == p100, 1 );
+        p = packetizer_recreate_cached(p, cache, 0, crc, fec0, fec1);
+        CONTEND_EQUALITY( p == p0, 1 );
+        p = packetizer_recreate_cached(p, cache, 113, crc, fec0, fec1);
+        CONTEND_EQUALITY( p == p113, 1 );
+    }
+    CONTEND_EQUALITY( packetizer_get_dec_msg_len(p), 113 );
+
+    // a change of properties is not a match
+    p = packetizer_recreate_cached(p, cache, 100, crc, fec0, LIQUID_FEC_NONE);
+    CONTEND_EQUALITY( packetizer_get_dec_msg_len(p), 100 );
+    CONTEND_EQUALITY( packetizer_get_enc_msg_len(p) <
+                      packetizer_get_enc_msg_len(p113), 1 );
+
+    packetizer_destroy(p);
+    packetizer_cache_destroy(cache);
+}
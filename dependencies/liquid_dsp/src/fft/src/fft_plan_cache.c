@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// fft_plan_cache.c : transform plans shared between objects, and FFTW
+//                    wisdom persistence
+//
+// The OFDM frame generator and synchronizer and the polyphase filterbank
+// channelizers all run one complex transform of a fixed size, and radios
+// create (and re-create) many of them with the same size. With FFTW these
+// objects share one measured plan per (size, direction, array alignment),
+// executed on each object's own buffers through the new-array interface.
+// Measuring is only paid the first time a size is seen; importing wisdom
+// saved by a previous run makes even that instant.
+//
+// Plans stay cached when their last user is destroyed, so objects that are
+// torn down and re-created do not re-plan; liquid_fft_plan_cache_clear()
+// releases the unreferenced ones. The cache, like the FFTW planner itself,
+// must not be used from several threads at once.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "liquid.internal.h"
+
+#if HAVE_FFTW3_H && !defined LIQUID_FFTOVERRIDE
+
+// planner flags for shared plans
+#define LIQUID_FFT_PLAN_CACHE_FLAGS (FFTW_MEASURE)
+
+struct liquid_fft_plan_cache_entry_s {
+    unsigned int n;             // transform size
+    int          dir;           // transform direction
+    int          in_place;      // input and output arrays are the same?
+    int          align_x;       // fftwf_alignment_of() input array
+    int          align_y;       // fftwf_alignment_of() output array
+    fftwf_plan   plan;          // transform plan
+    unsigned int num_refs;      // number of objects using this plan
+    struct liquid_fft_plan_cache_entry_s * next;
+};
+
+static struct liquid_fft_plan_cache_entry_s * liquid_fft_plan_cache = NULL;
+
+// get shared plan for a transform of size _n from _x to _y
+//  _n      :   transform size
+//  _x      :   input array of the calling object [size: _n x 1]
+//  _y      :   output array of the calling object [size: _n x 1]
+//  _dir    :   direction (FFT_DIR_FORWARD, FFT_DIR_BACKWARD)
+fftwf_plan liquid_fft_plan_cache_create(unsigned int          _n,
+                                        liquid_float_complex * _x,
+                                        liquid_float_complex * _y,
+                                        int                   _dir)
+{
+    int in_place = (_x == _y);
+    int align_x  = fftwf_alignment_of((float*)_x);
+    int align_y  = fftwf_alignment_of((float*)_y);
+
+    // look for a plan valid for these arrays
+    struct liquid_fft_plan_cache_entry_s * e;
+    for (e=liquid_fft_plan_cache; e!=NULL; e=e->next) {
+        if (e->n == _n && e->dir == _dir && e->in_place == in_place &&
+            e->align_x == align_x && e->align_y == align_y)
+        {
+            e->num_refs++;
+            return e->plan;
+        }
+    }
+
+    // plan on scratch arrays of the same alignment; measuring overwrites
+    // its arrays and the caller's may already hold data
+    size_t pad = 64;
+    char * scratch_x = (char*) fftwf_malloc(_n*sizeof(liquid_float_complex) + pad);
+    char * scratch_y = in_place ? scratch_x :
+                       (char*) fftwf_malloc(_n*sizeof(liquid_float_complex) + pad);
+    liquid_float_complex * x = (liquid_float_complex*)(scratch_x + align_x);
+    liquid_float_complex * y = (liquid_float_complex*)(scratch_y + align_y);
+
+    e = (struct liquid_fft_plan_cache_entry_s*) malloc(sizeof(struct liquid_fft_plan_cache_entry_s));
+    e->n        = _n;
+    e->dir      = _dir;
+    e->in_place = in_place;
+    e->align_x  = align_x;
+    e->align_y  = align_y;
+    e->plan     = fftwf_plan_dft_1d(_n, x, y, _dir, LIQUID_FFT_PLAN_CACHE_FLAGS);
+    e->num_refs = 1;
+    e->next     = liquid_fft_plan_cache;
+    liquid_fft_plan_cache = e;
+
+    fftwf_free(scratch_x);
+    if (!in_place)
+        fftwf_free(scratch_y);
+
+    return e->plan;
+}
+
+// release shared plan
+void liquid_fft_plan_cache_destroy(fftwf_plan _plan)
+{
+    struct liquid_fft_plan_cache_entry_s * e;
+    for (e=liquid_fft_plan_cache; e!=NULL; e=e->next) {
+        if (e->plan == _plan) {
+            if (e->num_refs == 0) {
+                fprintf(stderr,"warning: liquid_fft_plan_cache_destroy(), plan already released\n");
+                return;
+            }
+            e->num_refs--;
+            return;
+        }
+    }
+
+    fprintf(stderr,"warning: liquid_fft_plan_cache_destroy(), plan not in cache\n");
+}
+
+// destroy cached plans no longer used by any object
+void liquid_fft_plan_cache_clear(void)
+{
+    struct liquid_fft_plan_cache_entry_s ** p = &liquid_fft_plan_cache;
+    while (*p != NULL) {
+        struct liquid_fft_plan_cache_entry_s * e = *p;
+        if (e->num_refs > 0) {
+            p = &e->next;
+            continue;
+        }
+        *p = e->next;
+        fftwf_destroy_plan(e->plan);
+        free(e);
+    }
+}
+
+// number of plans in the cache
+unsigned int liquid_fft_plan_cache_size(void)
+{
+    unsigned int n = 0;
+    struct liquid_fft_plan_cache_entry_s * e;
+    for (e=liquid_fft_plan_cache; e!=NULL; e=e->next)
+        n++;
+    return n;
+}
+
+// load FFTW wisdom from a file, returning 1 on success
+int liquid_fft_import_wisdom(const char * _filename)
+{
+    return fftwf_import_wisdom_from_filename(_filename) ? 1 : 0;
+}
+
+// save accumulated FFTW wisdom to a file, returning 1 on success
+int liquid_fft_export_wisdom(const char * _filename)
+{
+    return fftwf_export_wisdom_to_filename(_filename) ? 1 : 0;
+}
+
+#else
+
+// without FFTW, each object keeps its own plan of the internal transform
+// and there is no wisdom to persist
+
+void liquid_fft_plan_cache_clear(void)
+{
+}
+
+unsigned int liquid_fft_plan_cache_size(void)
+{
+    return 0;
+}
+
+int liquid_fft_import_wisdom(const char * _filename)
+{
+    return 0;
+}
+
+int liquid_fft_export_wisdom(const char * _filename)
+{
+    return 0;
+}
+
+#endif
+
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "autotest/autotest.h"
+#include "liquid.h"
+
+//
+// AUTOTEST: channelizers of the same size share a transform plan, give
+// the same output as each other, and re-created objects do not re-plan
+//
+void autotest_fft_plan_cache_reuse()
+{
+    unsigned int M   = 16;   // number of channels
+    unsigned int m   = 4;    // filter semi-length
+    float        As  = 60.0f;
+    float        tol = 1e-6f;
+
+    liquid_fft_plan_cache_clear();
+    unsigned int n0 = liquid_fft_plan_cache_size();
+
+    firpfbch_crcf q0 = firpfbch_crcf_create_kaiser(LIQUID_SYNTHESIZER, M, m, As);
+    firpfbch_crcf q1 = firpfbch_crcf_create_kaiser(LIQUID_SYNTHESIZER, M, m, As);
+    unsigned int n1 = liquid_fft_plan_cache_size();
+
+    // same input to both
+    float complex x[M];
+    float complex y0[M];
+    float complex y1[M];
+    unsigned int i, k;
+    for (k=0; k<8; k++) {
+        for (i=0; i<M; i++)
+            x[i] = randnf() + _Complex_I*randnf();
+        firpfbch_crcf_synthesizer_execute(q0, x, y0);
+        firpfbch_crcf_synthesizer_execute(q1, x, y1);
+        for (i=0; i<M; i++) {
+            CONTEND_DELTA( crealf(y0[i]), crealf(y1[i]), tol );
+            CONTEND_DELTA( cimagf(y0[i]), cimagf(y1[i]), tol );
+        }
+    }
+
+    // re-creating an object re-uses the cached plan
+    firpfbch_crcf_destroy(q1);
+    q1 = firpfbch_crcf_create_kaiser(LIQUID_SYNTHESIZER, M, m, As);
+    CONTEND_EQUALITY( liquid_fft_plan_cache_size(), n1 );
+
+    // plans in use survive clearing; unused ones do not
+    liquid_fft_plan_cache_clear();
+    CONTEND_EQUALITY( liquid_fft_plan_cache_size(), n1 );
+
+    firpfbch_crcf_destroy(q0);
+    firpfbch_crcf_destroy(q1);
+    liquid_fft_plan_cache_clear();
+    CONTEND_EQUALITY( liquid_fft_plan_cache_size(), n0 );
+}
+
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/resource.h>
+#include "liquid.h"
+
+// number of input samples per execute() call
+#define RRESAMP_CRCF_BENCH_BLOCK (256)
+
+// Helper function to keep code base small; iterations are counted in
+// input samples
+void rresamp_crcf_bench(struct rusage *     _start,
+                        struct rusage *     _finish,
+                        unsigned long int * _num_iterations,
+                        unsigned int        _P,
+                        unsigned int        _Q,
+                        unsigned int        _m)
+{
+    *_num_iterations /= 4*_m;
+    if (*_num_iterations < RRESAMP_CRCF_BENCH_BLOCK)
+        *_num_iterations = RRESAMP_CRCF_BENCH_BLOCK;
+
+    rresamp_crcf q = rresamp_crcf_create(_P, _Q, _m, 0.8f, 60.0f);
+
+    float complex x[RRESAMP_CRCF_BENCH_BLOCK];
+    float complex y[RRESAMP_CRCF_BENCH_BLOCK*_P/_Q + 2];
+    unsigned long int i;
+    for (i=0; i<RRESAMP_CRCF_BENCH_BLOCK; i++)
+        x[i] = randnf() + _Complex_I*randnf();
+
+    unsigned int ny;
+    unsigned long int num_blocks = *_num_iterations / RRESAMP_CRCF_BENCH_BLOCK;
+
+    getrusage(RUSAGE_SELF, _start);
+    for (i=0; i<num_blocks; i++)
+        rresamp_crcf_execute(q, x, RRESAMP_CRCF_BENCH_BLOCK, y, &ny);
+    getrusage(RUSAGE_SELF, _finish);
+    *_num_iterations = num_blocks * RRESAMP_CRCF_BENCH_BLOCK;
+
+    rresamp_crcf_destroy(q);
+}
+
+// reference: 31-tap Kaiser pre-filter at the input rate followed by a
+// multi-stage resampler at rate 1/2
+void benchmark_rresamp_crcf_prefilt_msresamp_r2(struct rusage *     _start,
+                                                struct rusage *     _finish,
+                                                unsigned long int * _num_iterations)
+{
+    *_num_iterations /= 48;
+    if (*_num_iterations < RRESAMP_CRCF_BENCH_BLOCK)
+        *_num_iterations = RRESAMP_CRCF_BENCH_BLOCK;
+
+    firfilt_crcf  f = firfilt_crcf_create_kaiser(31, 0.24f, 60.0f, 0.0f);
+    msresamp_crcf r = msresamp_crcf_create(0.5f, 60.0f);
+
+    float complex x[RRESAMP_CRCF_BENCH_BLOCK];
+    float complex v[RRESAMP_CRCF_BENCH_BLOCK];
+    float complex y[RRESAMP_CRCF_BENCH_BLOCK];
+    unsigned long int i;
+    for (i=0; i<RRESAMP_CRCF_BENCH_BLOCK; i++)
+        x[i] = randnf() + _Complex_I*randnf();
+
+    unsigned int ny;
+    unsigned long int num_blocks = *_num_iterations / RRESAMP_CRCF_BENCH_BLOCK;
+
+    getrusage(RUSAGE_SELF, _start);
+    for (i=0; i<num_blocks; i++) {
+        firfilt_crcf_execute_block(f, x, RRESAMP_CRCF_BENCH_BLOCK, v);
+        msresamp_crcf_execute(r, v, RRESAMP_CRCF_BENCH_BLOCK, y, &ny);
+    }
+    getrusage(RUSAGE_SELF, _finish);
+    *_num_iterations = num_blocks * RRESAMP_CRCF_BENCH_BLOCK;
+
+    firfilt_crcf_destroy(f);
+    msresamp_crcf_destroy(r);
+}
+
+#define RRESAMP_CRCF_BENCHMARK_API(P,Q,M)       \
+(   struct rusage *_start,                      \
+    struct rusage *_finish,                     \
+    unsigned long int *_num_iterations)         \
+{ rresamp_crcf_bench(_start, _finish, _num_iterations, P, Q, M); }
+
+void benchmark_rresamp_crcf_P1_Q2_m12   RRESAMP_CRCF_BENCHMARK_API(1, 2, 12)
+void benchmark_rresamp_crcf_P3_Q4_m12   RRESAMP_CRCF_BENCHMARK_API(3, 4, 12)
+void benchmark_rresamp_crcf_P4_Q5_m12   RRESAMP_CRCF_BENCHMARK_API(4, 5, 12)
+void benchmark_rresamp_crcf_P2_Q1_m12   RRESAMP_CRCF_BENCHMARK_API(2, 1, 12)
@@ -43,6 +43,7 @@
 #define MSRESAMP2(name)     LIQUID_CONCAT(msresamp2_cccf,name)
 #define RESAMP(name)        LIQUID_CONCAT(resamp_cccf,name)
 #define RESAMP2(name)       LIQUID_CONCAT(resamp2_cccf,name)
+#define RRESAMP(name)       LIQUID_CONCAT(rresamp_cccf,name)
 //#define SYMSYNC(name)       LIQUID_CONCAT(symsync_cccf,name)
 
 #define T                   float complex   // general
@@ -77,4 +78,5 @@
 #include "msresamp2.c"
 #include "resamp.c"
 #include "resamp2.c"
+#include "rresamp.c"
 //#include "symsync.c"
@@ -43,6 +43,7 @@
 #define MSRESAMP2(name)     LIQUID_CONCAT(msresamp2_crcf,name)
 #define RESAMP(name)        LIQUID_CONCAT(resamp_crcf,name)
 #define RESAMP2(name)       LIQUID_CONCAT(resamp2_crcf,name)
+#define RRESAMP(name)       LIQUID_CONCAT(rresamp_crcf,name)
 #define SYMSYNC(name)       LIQUID_CONCAT(symsync_crcf,name)
 
 #define T                   float complex   // general
@@ -78,4 +79,5 @@
 #include "resamp.c"         // floating-point phase version
 //#include "resamp.fixed.c" // fixed-point phase version
 #include "resamp2.c"
+#include "rresamp.c"
 #include "symsync.c"
@@ -44,6 +44,7 @@
 #define MSRESAMP2(name)     LIQUID_CONCAT(msresamp2_rrrf,name)
 #define RESAMP(name)        LIQUID_CONCAT(resamp_rrrf,name)
 #define RESAMP2(name)       LIQUID_CONCAT(resamp2_rrrf,name)
+#define RRESAMP(name)       LIQUID_CONCAT(rresamp_rrrf,name)
 #define SYMSYNC(name)       LIQUID_CONCAT(symsync_rrrf,name)
 
 #define T                   float   // general
@@ -79,4 +80,5 @@
 #include "msresamp2.c"
 #include "resamp.c"
 #include "resamp2.c"
+#include "rresamp.c"
 #include "symsync.c"
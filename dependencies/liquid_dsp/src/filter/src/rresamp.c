@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// rresamp.c
+//
+// rational-rate polyphase resampler
+//
+// Resamples by exactly _P/_Q with a single low-pass prototype running at
+// _P times the input rate, decomposed into _P polyphase branches. Output
+// sample k sits at prototype time k*_Q = a*_P + b, so it is the dot
+// product of branch b with the input window ending at sample a; only the
+// retained outputs are ever computed. The dot product is the usual
+// DOTPROD() object, so it picks up the SIMD kernels of the platform.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "liquid.internal.h"
+
+struct RRESAMP(_s) {
+    unsigned int P;         // interpolation factor
+    unsigned int Q;         // decimation factor
+    unsigned int m;         // filter semi-length (lower-rate samples)
+    float        bw;        // normalized bandwidth
+    float        As;        // stop-band attenuation [dB]
+
+    unsigned int h_len;     // prototype filter length
+    unsigned int L;         // taps per polyphase branch
+    TC *         h;         // branch coefficients [size: P x L], reversed
+    DOTPROD() *  dp;        // dot product object for each branch
+    WINDOW()     w;         // input buffer
+
+    unsigned int phase;     // position of next output relative to next
+                            // input, in units of 1/P input samples
+};
+
+// greatest common divisor
+static unsigned int RRESAMP(_gcd)(unsigned int _a,
+                                  unsigned int _b)
+{
+    while (_b != 0) {
+        unsigned int t = _a % _b;
+        _a = _b;
+        _b = t;
+    }
+    return _a;
+}
+
+// create rational-rate resampler object
+//  _P      :   interpolation factor, _P > 0
+//  _Q      :   decimation factor, _Q > 0
+//  _m      :   filter semi-length (samples at lower of the two rates), _m > 0
+//  _bw     :   cutoff relative to the Nyquist rate of the lower rate, 0 < _bw < 1
+//  _As     :   stop-band attenuation [dB]
+RRESAMP() RRESAMP(_create)(unsigned int _P,
+                           unsigned int _Q,
+                           unsigned int _m,
+                           float        _bw,
+                           float        _As)
+{
+    // validate input
+    if (_P == 0 || _Q == 0) {
+        fprintf(stderr,"error: rresamp_%s_create(), interpolation/decimation factors must be greater than zero\n", EXTENSION_FULL);
+        exit(1);
+    } else if (_m == 0) {
+        fprintf(stderr,"error: rresamp_%s_create(), filter semi-length must be greater than zero\n", EXTENSION_FULL);
+        exit(1);
+    } else if (_bw <= 0.0f || _bw >= 1.0f) {
+        fprintf(stderr,"error: rresamp_%s_create(), normalized bandwidth must be in (0,1)\n", EXTENSION_FULL);
+        exit(1);
+    } else if (_As < 0.0f) {
+        fprintf(stderr,"error: rresamp_%s_create(), stop-band attenuation must be positive\n", EXTENSION_FULL);
+        exit(1);
+    }
+
+    // reduce rate to lowest terms
+    unsigned int d = RRESAMP(_gcd)(_P, _Q);
+
+    RRESAMP() q = (RRESAMP()) malloc(sizeof(struct RRESAMP(_s)));
+    q->P  = _P / d;
+    q->Q  = _Q / d;
+    q->m  = _m;
+    q->bw = _bw;
+    q->As = _As;
+
+    // prototype runs at P times the input rate; the lower of the two
+    // rates has its Nyquist frequency at 1/(2*max(P,Q)) there
+    unsigned int D = q->P > q->Q ? q->P : q->Q;
+    q->L     = 2*q->m*((D + q->P - 1) / q->P);
+    q->h_len = q->P*q->L;
+    float fc = 0.5f*q->bw / (float)D;
+    float hf[q->h_len];
+    liquid_firdes_kaiser(q->h_len, fc, q->As, 0.0f, hf);
+
+    // split prototype into branches, reversed for the dot product and
+    // scaled so that the branches have unity gain at DC on average
+    unsigned int b, i;
+    float hsum = 0.0f;
+    for (i=0; i<q->h_len; i++)
+        hsum += hf[i];
+    float g = (float)q->P / hsum;
+    q->h = (TC*) malloc(q->P*q->L*sizeof(TC));
+    for (b=0; b<q->P; b++) {
+        for (i=0; i<q->L; i++)
+            q->h[b*q->L + q->L-i-1] = hf[b + i*q->P] * g;
+    }
+
+    // create dot product objects and input buffer
+    q->dp = (DOTPROD()*) malloc(q->P*sizeof(DOTPROD()));
+    for (b=0; b<q->P; b++)
+        q->dp[b] = DOTPROD(_create)(&q->h[b*q->L], q->L);
+    q->w = WINDOW(_create)(q->L);
+
+    // reset object and return
+    RRESAMP(_reset)(q);
+    return q;
+}
+
+// destroy rational-rate resampler object
+void RRESAMP(_destroy)(RRESAMP() _q)
+{
+    unsigned int b;
+    for (b=0; b<_q->P; b++)
+        DOTPROD(_destroy)(_q->dp[b]);
+    free(_q->dp);
+    WINDOW(_destroy)(_q->w);
+    free(_q->h);
+    free(_q);
+}
+
+// print rational-rate resampler object internals
+void RRESAMP(_print)(RRESAMP() _q)
+{
+    printf("rresamp_%s:\n", EXTENSION_FULL);
+    printf("    rate                : %u/%u\n", _q->P, _q->Q);
+    printf("    filter semi-length  : %u\n", _q->m);
+    printf("    bandwidth           : %12.8f\n", _q->bw);
+    printf("    stop-band atten.    : %.2f dB\n", _q->As);
+    printf("    prototype length    : %u (%u branches x %u taps)\n", _q->h_len, _q->P, _q->L);
+}
+
+// reset rational-rate resampler object internal state
+void RRESAMP(_reset)(RRESAMP() _q)
+{
+    WINDOW(_clear)(_q->w);
+    _q->phase = 0;
+}
+
+// get interpolation factor (after reduction to lowest terms)
+unsigned int RRESAMP(_get_P)(RRESAMP() _q)
+{
+    return _q->P;
+}
+
+// get decimation factor (after reduction to lowest terms)
+unsigned int RRESAMP(_get_Q)(RRESAMP() _q)
+{
+    return _q->Q;
+}
+
+// get filter delay (output samples)
+float RRESAMP(_get_delay)(RRESAMP() _q)
+{
+    return 0.5f*(float)(_q->h_len - 1) / (float)_q->Q;
+}
+
+// execute rational-rate resampler on a block of input samples; as with
+// msresamp, the input block may be any length and the number of output
+// samples written varies between calls (at most ceil(_nx*P/Q))
+//  _q      :   rresamp object
+//  _x      :   input sample array  [size: _nx x 1]
+//  _nx     :   input sample array size
+//  _y      :   output sample array [size: variable]
+//  _ny     :   number of samples written to _y
+void RRESAMP(_execute)(RRESAMP()      _q,
+                       TI *           _x,
+                       unsigned int   _nx,
+                       TO *           _y,
+                       unsigned int * _ny)
+{
+    unsigned int P = _q->P;
+    unsigned int n = 0;     // input samples consumed
+    unsigned int ny = 0;    // output samples written
+    TI * r;                 // buffer read pointer
+
+    while (n < _nx) {
+        // inputs to push before the next output is due
+        unsigned int k = _q->phase / P + 1;
+        if (k > _nx - n) {
+            WINDOW(_write)(_q->w, &_x[n], _nx - n);
+            _q->phase -= (_nx - n)*P;
+            break;
+        }
+        WINDOW(_write)(_q->w, &_x[n], k);
+        n += k;
+        _q->phase -= (k-1)*P;
+
+        // compute every output falling before the next input sample
+        WINDOW(_read)(_q->w, &r);
+        while (_q->phase < P) {
+            DOTPROD(_execute)(_q->dp[_q->phase], r, &_y[ny++]);
+            _q->phase += _q->Q;
+        }
+        _q->phase -= P;
+    }
+
+    *_ny = ny;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "autotest/autotest.h"
+#include "liquid.h"
+
+//
+// AUTOTEST : rational-rate resampler; a tone in the pass band comes out
+// at unity gain and the right frequency, while images (interpolation) and
+// a strong interferer in the stop band (decimation) are suppressed by at
+// least the design attenuation
+//
+void rresamp_crcf_test(unsigned int _P,
+                       unsigned int _Q,
+                       unsigned int _m,
+                       float        _bw,
+                       float        _As)
+{
+    unsigned int n = 2400;      // number of input samples
+    float r  = (float)_P / (float)_Q;
+    float fl = r < 1.0f ? 0.5f*r : 0.5f;    // lower Nyquist (input-relative)
+    float fx = 0.3f*_bw*fl;     // pass-band tone frequency (input-relative)
+    float fi = fl + 0.8f*(0.5f - fl);       // stop-band interferer
+    float gi = _Q > _P ? 1.0f : 0.0f;       // interferer only when decimating
+
+    unsigned int i;
+
+    // number of input samples (zero-padded)
+    unsigned int nx = n + 2*_m*_Q;
+
+    // output buffer with extra padding for good measure
+    unsigned int y_len = (unsigned int) ceilf(nx * r) + 4;
+
+    // arrays
+    float complex x[nx];
+    float complex y[y_len];
+
+    // create resampler
+    rresamp_crcf q = rresamp_crcf_create(_P, _Q, _m, _bw, _As);
+
+    // generate input signal
+    float wsum = 0.0f;
+    for (i=0; i<nx; i++) {
+        float w = i < n ? kaiser(i, n, 12.0f, 0.0f) : 0.0f;
+        x[i] = (cexpf(_Complex_I*2*M_PI*fx*i) + gi*cexpf(_Complex_I*2*M_PI*fi*i)) * w;
+        wsum += w;
+    }
+
+    // resample in blocks of varying size
+    unsigned int ny=0;
+    unsigned int nw;
+    i = 0;
+    while (i < nx) {
+        unsigned int k = 1 + (i % 37);
+        if (k > nx - i) k = nx - i;
+        rresamp_crcf_execute(q, &x[i], k, &y[ny], &nw);
+        ny += nw;
+        i  += k;
+    }
+    rresamp_crcf_destroy(q);
+
+    // output count is exact
+    CONTEND_EQUALITY( ny, (nx*_P + _Q - 1) / _Q );
+
+    // run FFT and ensure that carrier has moved and that images and the
+    // interferer have been adequately suppressed
+    float fy = fx / r;      // expected output frequency
+    unsigned int nfft = 2 << liquid_nextpow2(ny);   // zero-pad to limit scalloping
+    float complex yfft[nfft];
+    float complex Yfft[nfft];
+    for (i=0; i<nfft; i++)
+        yfft[i] = i < ny ? y[i] : 0.0f;
+    fft_run(nfft, yfft, Yfft, LIQUID_FFT_FORWARD, 0);
+    fft_shift(Yfft, nfft);
+
+    float Ypeak = 0.0f;
+    float fpeak = 0.0f;
+    float max_sidelobe = -1e9f;
+    float main_lobe_width = 0.05f;
+    for (i=0; i<nfft; i++) {
+        float f = (float)i/(float)nfft - 0.5f;
+        Yfft[i] /= (r * wsum);
+        float Ymag = 20*log10f( cabsf(Yfft[i]) );
+        if (Ymag > Ypeak || i==0) {
+            Ypeak = Ymag;
+            fpeak = f;
+        }
+        if ( fabsf(f-fy) > main_lobe_width )
+            max_sidelobe = Ymag > max_sidelobe ? Ymag : max_sidelobe;
+    }
+
+    if (liquid_autotest_verbose) {
+        printf("  rresamp %u/%u, m=%u, bw=%.2f\n", _P, _Q, _m, _bw);
+        printf("  output samples            :   %u (%u in)\n", ny, nx);
+        printf("  peak spectrum             :   %12.8f dB (expected 0.0 dB)\n", Ypeak);
+        printf("  peak frequency            :   %12.8f    (expected %-12.8f)\n", fpeak, fy);
+        printf("  max sidelobe              :   %12.8f dB (expected at least %.2f dB)\n", max_sidelobe, -_As);
+    }
+    CONTEND_DELTA(     Ypeak,    0.0f, 0.25f );
+    CONTEND_DELTA(     fpeak,    fy,   0.01f );
+    CONTEND_LESS_THAN( max_sidelobe, -_As );
+}
+
+void autotest_rresamp_crcf_P1_Q2() { rresamp_crcf_test(1, 2, 12, 0.8f, 60.0f); }
+void autotest_rresamp_crcf_P3_Q4() { rresamp_crcf_test(3, 4, 12, 0.8f, 60.0f); }
+void autotest_rresamp_crcf_P2_Q5() { rresamp_crcf_test(2, 5, 12, 0.8f, 60.0f); }
+void autotest_rresamp_crcf_P2_Q1() { rresamp_crcf_test(2, 1, 12, 0.8f, 60.0f); }
+void autotest_rresamp_crcf_P5_Q3() { rresamp_crcf_test(5, 3, 12, 0.8f, 60.0f); }
+
+//
+// AUTOTEST : block execution matches sample-by-sample execution, a
+// reducible rate behaves as its lowest terms, and reset restores the
+// initial state
+//
+void autotest_rresamp_crcf_block()
+{
+    unsigned int nx = 500;
+    float complex x[nx];
+    float complex y0[nx];
+    float complex y1[nx];
+    float complex y2[nx];
+    unsigned int i;
+    for (i=0; i<nx; i++)
+        x[i] = randnf() + _Complex_I*randnf();
+
+    rresamp_crcf q0 = rresamp_crcf_create(3, 4, 8, 0.7f, 60.0f);
+    rresamp_crcf q1 = rresamp_crcf_create(6, 8, 8, 0.7f, 60.0f);
+    CONTEND_EQUALITY( rresamp_crcf_get_P(q1), 3 );
+    CONTEND_EQUALITY( rresamp_crcf_get_Q(q1), 4 );
+
+    // sample by sample
+    unsigned int n0 = 0, n1 = 0, n2 = 0, nw;
+    for (i=0; i<nx; i++) {
+        rresamp_crcf_execute(q0, &x[i], 1, &y0[n0], &nw);
+        n0 += nw;
+    }
+
+    // one block, after running some other input and resetting
+    rresamp_crcf_execute(q1, x, 101, y1, &nw);
+    rresamp_crcf_reset(q1);
+    rresamp_crcf_execute(q1, x, nx, y1, &n1);
+
+    // irregular blocks
+    rresamp_crcf_reset(q0);
+    for (i=0; i<nx; ) {
+        unsigned int k = 1 + (i*7) % 23;
+        if (k > nx - i) k = nx - i;
+        rresamp_crcf_execute(q0, &x[i], k, &y2[n2], &nw);
+        n2 += nw;
+        i  += k;
+    }
+
+    CONTEND_EQUALITY( n0, 375 );
+    CONTEND_EQUALITY( n1, n0 );
+    CONTEND_EQUALITY( n2, n0 );
+    for (i=0; i<n0; i++) {
+        CONTEND_DELTA( crealf(y1[i]), crealf(y0[i]), 1e-5f );
+        CONTEND_DELTA( cimagf(y1[i]), cimagf(y0[i]), 1e-5f );
+        CONTEND_DELTA( crealf(y2[i]), crealf(y0[i]), 1e-5f );
+        CONTEND_DELTA( cimagf(y2[i]), cimagf(y0[i]), 1e-5f );
+    }
+
+    rresamp_crcf_destroy(q0);
+    rresamp_crcf_destroy(q1);
+}
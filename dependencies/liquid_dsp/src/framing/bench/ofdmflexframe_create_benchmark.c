@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Creation cost of the multi-user OFDM flexframe objects; radio bring-up
+// creates several 512-subcarrier generators/synchronizers back to back
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include "liquid.h"
+
+#define OFDMFLEXFRAME_CREATE_BENCH_API(M,NUM_USERS,SYNC)    \
+(   struct rusage *_start,                                  \
+    struct rusage *_finish,                                 \
+    unsigned long int *_num_iterations)                     \
+{ ofdmflexframe_create_bench(_start, _finish, _num_iterations, M, NUM_USERS, SYNC); }
+
+// Helper function to keep code base small
+void ofdmflexframe_create_bench(struct rusage *     _start,
+                                struct rusage *     _finish,
+                                unsigned long int * _num_iterations,
+                                unsigned int        _M,
+                                unsigned int        _num_users,
+                                int                 _sync)
+{
+    // options
+    unsigned int cp_len    = 6;
+    unsigned int taper_len = 4;
+
+    // subcarrier allocation with 5% guard bands
+    unsigned char p[_M];
+    ofdmframe_init_sctype(_M, p, 0.05f);
+
+    ofdmflexframegenprops_s fgprops;
+    ofdmflexframegenprops_init_default(&fgprops);
+    fgprops.check      = LIQUID_CRC_32;
+    fgprops.fec0       = LIQUID_FEC_CONV_V27;
+    fgprops.fec1       = LIQUID_FEC_RS_M8;
+    fgprops.mod_scheme = LIQUID_MODEM_QPSK;
+
+    // creation is expensive; scale iterations accordingly
+    *_num_iterations /= 20*_M;
+    if (*_num_iterations < 1) *_num_iterations = 1;
+
+    unsigned long int i;
+    getrusage(RUSAGE_SELF, _start);
+    for (i=0; i<(*_num_iterations); i++) {
+        if (_sync) {
+            ofdmflexframesync fs = ofdmflexframesync_create_multi_user(_M, cp_len, taper_len, p,
+                                                                       NULL, NULL, 0, _num_users);
+            ofdmflexframesync_destroy(fs);
+        } else {
+            ofdmflexframegen fg = ofdmflexframegen_create_multi_user(_M, cp_len, taper_len, p,
+                                                                     &fgprops, _num_users);
+            ofdmflexframegen_destroy_multi_user(fg);
+        }
+    }
+    getrusage(RUSAGE_SELF, _finish);
+}
+
+//
+void benchmark_ofdmflexframegen_create_n512_u2     OFDMFLEXFRAME_CREATE_BENCH_API(512, 2, 0)
+void benchmark_ofdmflexframegen_create_n512_u4     OFDMFLEXFRAME_CREATE_BENCH_API(512, 4, 0)
+void benchmark_ofdmflexframesync_create_n512_u2    OFDMFLEXFRAME_CREATE_BENCH_API(512, 2, 1)
+void benchmark_ofdmflexframesync_create_n512_u4    OFDMFLEXFRAME_CREATE_BENCH_API(512, 4, 1)
+
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Receive cost of the multi-user OFDM flexframe synchronizer: one user's
+// share of a 512-subcarrier downlink frame, as run by each mobile
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include "liquid.h"
+
+#define OFDMFLEXFRAMESYNC_BENCH_API(M,NUM_USERS)    \
+(   struct rusage *_start,                          \
+    struct rusage *_finish,                         \
+    unsigned long int *_num_iterations)             \
+{ ofdmflexframesync_bench(_start, _finish, _num_iterations, M, NUM_USERS); }
+
+static int ofdmflexframesync_bench_callback(unsigned char *  _header,
+                                            int              _header_valid,
+                                            unsigned char *  _payload,
+                                            unsigned int     _payload_len,
+                                            int              _payload_valid,
+                                            framesyncstats_s _stats,
+                                            void *           _userdata)
+{
+    unsigned int * num_payloads_valid = (unsigned int*) _userdata;
+    if (_payload_valid)
+        (*num_payloads_valid)++;
+    return 0;
+}
+
+// Helper function to keep code base small
+void ofdmflexframesync_bench(struct rusage *     _start,
+                             struct rusage *     _finish,
+                             unsigned long int * _num_iterations,
+                             unsigned int        _M,
+                             unsigned int        _num_users)
+{
+    // options
+    unsigned int cp_len      = 6;
+    unsigned int taper_len   = 4;
+    unsigned int payload_len = 256;
+    unsigned int symbol_len  = _M + cp_len;
+
+    // subcarrier allocation with 5% guard bands
+    unsigned char p[_M];
+    ofdmframe_init_sctype(_M, p, 0.05f);
+
+    ofdmflexframegenprops_s fgprops;
+    ofdmflexframegenprops_init_default(&fgprops);
+    fgprops.check      = LIQUID_CRC_32;
+    fgprops.fec0       = LIQUID_FEC_NONE;
+    fgprops.fec1       = LIQUID_FEC_NONE;
+    fgprops.mod_scheme = LIQUID_MODEM_QPSK;
+    ofdmflexframegen fg = ofdmflexframegen_create_multi_user(_M, cp_len, taper_len, p,
+                                                             &fgprops, _num_users);
+
+    // generate one frame carrying a payload for each user, preceded by
+    // a few symbols of silence
+    unsigned char header[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    unsigned char payload[payload_len];
+    unsigned long int i;
+    for (i=0; i<payload_len; i++)
+        payload[i] = rand() & 0xff;
+    ofdmflexframegen_reset_multi_user(fg);
+    for (i=0; i<_num_users; i++)
+        ofdmflexframegen_multi_user_update_data(fg, payload, payload_len, i);
+    ofdmflexframegen_assemble_multi_user(fg, header);
+
+    unsigned int frame_cap = 4*symbol_len;
+    float complex * frame = (float complex*) calloc(frame_cap, sizeof(float complex));
+    unsigned int frame_len = 4*symbol_len;
+    int last_symbol = 0;
+    while (!last_symbol) {
+        if (frame_len + symbol_len > frame_cap) {
+            frame_cap *= 2;
+            frame = (float complex*) realloc(frame, frame_cap*sizeof(float complex));
+        }
+        last_symbol = ofdmflexframegen_writesymbol(fg, &frame[frame_len]);
+        frame_len += symbol_len;
+    }
+    for (i=0; i<frame_len; i++)
+        frame[i] += 0.01f*(randnf() + _Complex_I*randnf());
+
+    unsigned int num_payloads_valid = 0;
+    ofdmflexframesync fs = ofdmflexframesync_create_multi_user(_M, cp_len, taper_len, p,
+                                ofdmflexframesync_bench_callback, (void*)&num_payloads_valid,
+                                0, _num_users);
+
+    // scale iterations to the frame length
+    *_num_iterations /= frame_len / 4;
+    if (*_num_iterations < 1) *_num_iterations = 1;
+
+    getrusage(RUSAGE_SELF, _start);
+    for (i=0; i<(*_num_iterations); i++)
+        ofdmflexframesync_execute(fs, frame, frame_len);
+    getrusage(RUSAGE_SELF, _finish);
+
+    if (num_payloads_valid != *_num_iterations)
+        fprintf(stderr,"warning: ofdmflexframesync_bench(), %u of %lu payloads valid\n",
+                num_payloads_valid, *_num_iterations);
+
+    ofdmflexframegen_destroy_multi_user(fg);
+    ofdmflexframesync_destroy(fs);
+    free(frame);
+}
+
+//
+void benchmark_ofdmflexframesync_n512_u1   OFDMFLEXFRAMESYNC_BENCH_API(512, 1)
+void benchmark_ofdmflexframesync_n512_u4   OFDMFLEXFRAMESYNC_BENCH_API(512, 4)
+void benchmark_ofdmflexframesync_n512_u8   OFDMFLEXFRAMESYNC_BENCH_API(512, 8)
+
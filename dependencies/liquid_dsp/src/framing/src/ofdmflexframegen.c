@@ -62,6 +62,8 @@ struct ofdmflexframegen_s {
     unsigned int cp_len;    // cyclic prefix length
     unsigned int taper_len; // taper length
     unsigned char * p;      // subcarrier allocation (null, pilot, data)
+    unsigned char * p_pending;  // allocation to switch to after this frame
+    int allocation_pending;     // is p_pending waiting to be applied?
 
     // constants
     unsigned int M_null;    // number of null subcarriers
@@ -99,6 +101,9 @@ struct ofdmflexframegen_s {
     unsigned char * payload_mod;        // payload data (modulated symbols)
     unsigned int payload_enc_len;       // length of encoded payload
     unsigned int payload_mod_len;       // number of modulated symbols in payload
+    packetizer p_payload_cache[PACKETIZER_CACHE_LEN]; // previously used payload packetizers
+    unsigned int payload_enc_cap;       // allocated size of payload_enc
+    unsigned int payload_mod_cap;       // allocated size of payload_mod
 
     //separate user payloads
     packetizer * user_packetizers;
@@ -110,6 +115,13 @@ struct ofdmflexframegen_s {
     unsigned int * user_payload_enc_lens;
     unsigned int * user_payload_mod_lens;
     unsigned int * user_payload_symbol_indices;
+    // The payload length moves between a few values from frame to frame,
+    // so the buffers only ever grow and each user keeps its previously used
+    // packetizers [size: num_users*PACKETIZER_CACHE_LEN x 1]
+    packetizer * user_packetizer_caches;
+    unsigned int * user_payload_caps;
+    unsigned int * user_payload_enc_caps;
+    unsigned int * user_payload_mod_caps;
     
     //stuff related to multi-user
     int ofdma; //boolean, used to indicate single or multi-user mode
@@ -121,11 +133,10 @@ struct ofdmflexframegen_s {
     unsigned int * frames_sent_since_last_use;//the number of frames generated since a subcarrier was last used
     unsigned int reallocation_delay; //the number of frames to wait before reallocating deallocated subcarriers
 
-    //These 3 variables are used to determine the minimum number of ofdm symbols needed to 
-    //transmit all user payloads successfully
-    unsigned int largest_payload;//size of the largest payload
-    unsigned int index_of_user_with_largest_payload;
     unsigned int index_of_user_with_least_subcarriers;
+    // per-user modulation and FEC; each starts out as (and is reset by)
+    // the frame-wide properties [size: num_users x 1]
+    ofdmflexframegenprops_s * user_props;
 
     //When using multiple users, the size of the header is variable
     //these variable replace the #defined constants that are used
@@ -236,9 +247,177 @@ void ofdmflexframegen_reallocate_subcarrier(ofdmflexframegen _q, unsigned int su
     }
 }
 
+// divide the usable data subcarriers between the users in proportion to
+// _shares. The counts are the largest-remainder split of what is left
+// after each user with a non-zero share has been given one subcarrier,
+// and a smooth weighted round robin lays them out so that each user's
+// subcarriers are spread evenly over the band; equal shares give the same
+// round-robin map as the generator starts out with.
+void ofdmflexframegen_set_user_shares(ofdmflexframegen _q,
+                                      unsigned int *   _shares)
+{
+    if (!_q->ofdma) {
+        fprintf(stderr,"error: ofdmflexframegen_set_user_shares(), not a multi-user frame generator\n");
+        exit(1);
+    }
+
+    unsigned int U = _q->num_users;
+    unsigned int i;
+    unsigned int u;
+
+    // data subcarriers not deallocated
+    unsigned int n = 0;
+    for (i=0; i<_q->M; i++) {
+        if (_q->subcarrier_map[i] < U)
+            n++;
+    }
+
+    // users with a share; all-zero shares count as equal ones
+    unsigned long share_total = 0;
+    unsigned int num_active = 0;
+    for (u=0; u<U; u++) {
+        share_total += _shares[u];
+        num_active  += _shares[u] > 0 ? 1 : 0;
+    }
+    unsigned int shares[U];
+    for (u=0; u<U; u++)
+        shares[u] = share_total > 0 ? _shares[u] : 1;
+    if (share_total == 0) {
+        share_total = U;
+        num_active  = U;
+    }
+
+    // one subcarrier for each user with a share (when there are enough),
+    // then split the rest, handing leftovers to the largest remainders
+    unsigned int floor_min = (n >= num_active) ? 1 : 0;
+    unsigned int n_split = n - floor_min*num_active;
+    unsigned long remainder[U];
+    unsigned int n_given = 0;
+    for (u=0; u<U; u++) {
+        unsigned long long t = (unsigned long long)n_split * shares[u];
+        _q->num_subcarriers[u] = shares[u] > 0 ?
+            floor_min + (unsigned int)(t / share_total) : 0;
+        remainder[u] = (unsigned long)(t % share_total);
+        n_given += _q->num_subcarriers[u];
+    }
+    while (n_given < n) {
+        unsigned int best = U;
+        for (u=0; u<U; u++) {
+            if (shares[u] > 0 && (best == U || remainder[u] > remainder[best]))
+                best = u;
+        }
+        _q->num_subcarriers[best]++;
+        remainder[best] = 0;
+        n_given++;
+    }
+
+    // lay out: each subcarrier goes to the user furthest behind its share
+    long credit[U];
+    for (u=0; u<U; u++)
+        credit[u] = 0;
+    for (i=0; i<_q->M; i++) {
+        if (_q->subcarrier_map[i] >= U)
+            continue;
+        unsigned int best = U;
+        for (u=0; u<U; u++) {
+            if (_q->num_subcarriers[u] == 0)
+                continue;
+            credit[u] += _q->num_subcarriers[u];
+            if (best == U || credit[u] > credit[best])
+                best = u;
+        }
+        credit[best] -= n;
+        _q->subcarrier_map[i] = best;
+    }
+
+    // keep the anti-jam reallocation pointing at the smallest share
+    for (u=0; u<U; u++) {
+        if (_q->num_subcarriers[u] < _q->num_subcarriers[_q->index_of_user_with_least_subcarriers])
+            _q->index_of_user_with_least_subcarriers = u;
+    }
+
+    ofdmflexframegen_update_num_symbols_payload(_q);
+}
+
+// number of data subcarriers given to a user
+unsigned int ofdmflexframegen_get_user_num_subcarriers(ofdmflexframegen _q,
+                                                       unsigned int     _user)
+{
+    if (!_q->ofdma || _user >= _q->num_users) {
+        fprintf(stderr,"error: ofdmflexframegen_get_user_num_subcarriers(), invalid user %u\n", _user);
+        exit(1);
+    }
+    return _q->num_subcarriers[_user];
+}
+
+// change the subcarrier allocation without re-creating the generator. If a
+// frame is assembled the change is held until it has been written out;
+// otherwise it takes effect immediately.
 void ofdmflexframegen_update_subcarrier_allocation(ofdmflexframegen _q, unsigned char* new_allocation)
 {
-    memmove(_q->p, new_allocation, _q->M*sizeof(unsigned char));
+    memmove(_q->p_pending, new_allocation, _q->M*sizeof(unsigned char));
+    _q->allocation_pending = 1;
+
+    if (!_q->frame_assembled)
+        ofdmflexframegen_apply_subcarrier_allocation(_q);
+}
+
+// switch to the pending subcarrier allocation, re-computing only what
+// depends on it: the PLCP sequences, the number of header and payload
+// symbols and, in multi-user mode, the subcarrier map
+void ofdmflexframegen_apply_subcarrier_allocation(ofdmflexframegen _q)
+{
+    _q->allocation_pending = 0;
+    if (memcmp(_q->p, _q->p_pending, _q->M*sizeof(unsigned char)) == 0)
+        return;
+
+    memmove(_q->p, _q->p_pending, _q->M*sizeof(unsigned char));
+    ofdmframe_validate_sctype(_q->p, _q->M, &_q->M_null, &_q->M_pilot, &_q->M_data);
+    ofdmframegen_set_allocation(_q->fg, _q->p);
+
+    if (!_q->ofdma) {
+        // re-compute number of header symbols
+        div_t d = div(OFDMFLEXFRAME_H_SYM, _q->M_data);
+        _q->num_symbols_header = d.quot + (d.rem ? 1 : 0);
+
+        ofdmflexframegen_reconfigure(_q);
+        return;
+    }
+
+    // re-compute number of header symbols
+    div_t d = div(_q->ofdmflexframe_h_sym_dynamic, _q->M_data);
+    _q->num_symbols_header = d.quot + (d.rem ? 1 : 0);
+
+    // hand the data subcarriers out to the users again, as on create
+    unsigned int i;
+    unsigned int current_user = 0;
+    for(i = 0; i < _q->num_users; i++)
+        _q->num_subcarriers[i] = 0;
+    for(i = 0; i < _q->M; i++)
+    {
+        if(_q->p[i] == OFDMFRAME_SCTYPE_DATA)
+        {
+            _q->subcarrier_map[i] = current_user;
+            _q->num_subcarriers[current_user]++;
+            current_user = (current_user + 1) % _q->num_users;
+        }
+        else
+            _q->subcarrier_map[i] = RESERVED;
+
+        _q->frames_sent_since_last_use[i] = 0;
+    }
+    unsigned int least = _q->M;
+    for(i = 0; i < _q->num_users; i++)
+    {
+        if(_q->num_subcarriers[i] < least)
+        {
+            least = _q->num_subcarriers[i];
+            _q->index_of_user_with_least_subcarriers = i;
+        }
+    }
+
+    // re-compute number of payload symbols
+    ofdmflexframegen_reconfigure_multi_user(_q, _q->index_of_user_with_least_subcarriers);
 }
 
 unsigned char* ofdmflexframegen_get_subcarrier_map(ofdmflexframegen _q)
@@ -280,6 +459,8 @@ ofdmflexframegen ofdmflexframegen_create(unsigned int              _M,
 
     // allocate memory for subcarrier allocation IDs
     q->p = (unsigned char*) malloc((q->M)*sizeof(unsigned char));
+    q->p_pending = (unsigned char*) malloc((q->M)*sizeof(unsigned char));
+    q->allocation_pending = 0;
     // allocate memory for header, encoded header, and modulated header
     q->header = (unsigned char*) malloc(OFDMFLEXFRAME_H_DEC*sizeof(unsigned char));
     q->header_enc = (unsigned char*) malloc(OFDMFLEXFRAME_H_ENC*sizeof(unsigned char));
@@ -322,6 +503,9 @@ ofdmflexframegen ofdmflexframegen_create(unsigned int              _M,
 
     q->payload_mod_len = 1;
     q->payload_mod = (unsigned char*) malloc(q->payload_mod_len*sizeof(unsigned char));
+    memset(q->p_payload_cache, 0, sizeof(q->p_payload_cache));
+    q->payload_enc_cap = q->payload_enc_len;
+    q->payload_mod_cap = q->payload_mod_len;
 
     // create payload modem (initially QPSK, overridden by properties)
     q->mod_payload = modem_create(LIQUID_MODEM_QPSK);
@@ -372,6 +556,8 @@ ofdmflexframegen ofdmflexframegen_create_multi_user(unsigned int              _M
 
     // allocate memory for subcarrier allocation IDs
     q->p = (unsigned char*) malloc((q->M)*sizeof(unsigned char));
+    q->p_pending = (unsigned char*) malloc((q->M)*sizeof(unsigned char));
+    q->allocation_pending = 0;
 
 
     if (_p == NULL) {
@@ -395,9 +581,9 @@ ofdmflexframegen ofdmflexframegen_create_multi_user(unsigned int              _M
     //                                      OFDMFLEXFRAME_H_FEC,
     //                                      LIQUID_FEC_NONE);
 
-    //8 bytes for user-supplied header, +q->M for the subcarrier map + 2*_num_users for
-    //user-specfic payload_lens
-    q->ofdmflexframe_h_user_dynamic = 8 + q->M + (2*_num_users);
+    //8 bytes for user-supplied header, +q->M for the subcarrier map + 5*_num_users for
+    //user-specific payload_lens, modulation and FEC schemes
+    q->ofdmflexframe_h_user_dynamic = 8 + q->M + (OFDMFLEXFRAME_H_USER_PROPS*_num_users);
     q->ofdmflexframe_h_dec_dynamic = q->ofdmflexframe_h_user_dynamic + 6;
 
     q->p_header = packetizer_create(q->ofdmflexframe_h_dec_dynamic,
@@ -430,6 +616,9 @@ ofdmflexframegen ofdmflexframegen_create_multi_user(unsigned int              _M
 
     q->payload_mod_len = 1;
     q->payload_mod = (unsigned char*) malloc(q->payload_mod_len*sizeof(unsigned char));
+    memset(q->p_payload_cache, 0, sizeof(q->p_payload_cache));
+    q->payload_enc_cap = q->payload_enc_len;
+    q->payload_mod_cap = q->payload_mod_len;
 
     // create payload modem (initially QPSK, overridden by properties)
     q->mod_payload = modem_create(LIQUID_MODEM_QPSK);
@@ -472,9 +661,7 @@ ofdmflexframegen ofdmflexframegen_create_multi_user(unsigned int              _M
         }
     }
 
-    q->index_of_user_with_largest_payload = 0;
-    q->largest_payload = 0;
-
+    q->user_props = (ofdmflexframegenprops_s*) malloc(q->num_users*sizeof(ofdmflexframegenprops_s));
     q->user_payload_dec_lens = (unsigned int*) malloc(q->num_users*sizeof(unsigned
                 int));
     q->user_packetizers = (packetizer*) malloc(q->num_users*sizeof(packetizer));
@@ -491,6 +678,11 @@ ofdmflexframegen ofdmflexframegen_create_multi_user(unsigned int              _M
         malloc(q->num_users*sizeof(unsigned int));
     q->user_payloads = (unsigned char**) malloc(q->num_users*sizeof(unsigned
                 char*));
+    q->user_packetizer_caches = (packetizer*)
+        calloc(q->num_users*PACKETIZER_CACHE_LEN, sizeof(packetizer));
+    q->user_payload_caps = (unsigned int*) malloc(q->num_users*sizeof(unsigned int));
+    q->user_payload_enc_caps = (unsigned int*) malloc(q->num_users*sizeof(unsigned int));
+    q->user_payload_mod_caps = (unsigned int*) malloc(q->num_users*sizeof(unsigned int));
 
     for(i = 0; i < q->num_users; i++)
     {
@@ -509,6 +701,9 @@ ofdmflexframegen ofdmflexframegen_create_multi_user(unsigned int              _M
         q->user_payloads[i] = (unsigned char*)
             malloc(q->user_payload_dec_lens[i]*sizeof(unsigned char));
         q->user_payload_modems[i] = modem_create(LIQUID_MODEM_QPSK);
+        q->user_payload_caps[i] = q->user_payload_dec_lens[i];
+        q->user_payload_enc_caps[i] = q->user_payload_enc_lens[i];
+        q->user_payload_mod_caps[i] = q->user_payload_mod_lens[i];
     }
 
 
@@ -530,6 +725,7 @@ void ofdmflexframegen_destroy(ofdmflexframegen _q)
     packetizer_destroy(_q->p_header);   // header packetizer
     modem_destroy(_q->mod_header);      // header modulator
     packetizer_destroy(_q->p_payload);  // payload packetizer
+    packetizer_cache_destroy(_q->p_payload_cache);
     modem_destroy(_q->mod_payload);     // payload modulator
 
     // free buffers/arrays
@@ -541,6 +737,7 @@ void ofdmflexframegen_destroy(ofdmflexframegen _q)
     free(_q->payload_mod);              // modulated payload symbols
     free(_q->X);                        // frequency-domain buffer
     free(_q->p);                        // subcarrier allocation
+    free(_q->p_pending);                // pending subcarrier allocation
 
     // free main object memory
     free(_q);
@@ -553,6 +750,7 @@ void ofdmflexframegen_destroy_multi_user(ofdmflexframegen _q)
     packetizer_destroy(_q->p_header);   // header packetizer
     modem_destroy(_q->mod_header);      // header modulator
     packetizer_destroy(_q->p_payload);  // payload packetizer
+    packetizer_cache_destroy(_q->p_payload_cache);
     modem_destroy(_q->mod_payload);     // payload modulator
 
     // free buffers/arrays
@@ -563,13 +761,16 @@ void ofdmflexframegen_destroy_multi_user(ofdmflexframegen _q)
     free(_q->payload_mod);              // modulated payload symbols
     free(_q->X);                        // frequency-domain buffer
     free(_q->p);                        // subcarrier allocation
+    free(_q->p_pending);                // pending subcarrier allocation
 
     unsigned int i;
     for(i = 0; i < _q->num_users; i++)
     {
         free(_q->user_payload_encs[i]);
         free(_q->user_payload_mods[i]);
+        free(_q->user_payloads[i]);
         packetizer_destroy(_q->user_packetizers[i]);
+        packetizer_cache_destroy(&_q->user_packetizer_caches[i*PACKETIZER_CACHE_LEN]);
         modem_destroy(_q->user_payload_modems[i]);
     }
 
@@ -580,6 +781,13 @@ void ofdmflexframegen_destroy_multi_user(ofdmflexframegen _q)
     free(_q->user_payload_mod_lens);
     free(_q->user_payload_mods);
     free(_q->user_payload_modems);
+    free(_q->user_payload_symbol_indices);
+    free(_q->user_payloads);
+    free(_q->user_packetizer_caches);
+    free(_q->user_payload_caps);
+    free(_q->user_payload_enc_caps);
+    free(_q->user_payload_mod_caps);
+    free(_q->user_props);
     free(_q->subcarrier_map);
     free(_q->num_subcarriers);
     free(_q->frames_sent_since_last_use);
@@ -598,6 +806,10 @@ void ofdmflexframegen_reset(ofdmflexframegen _q)
     _q->header_symbol_index = 0;
     _q->payload_symbol_index = 0;
 
+    // switch to a subcarrier allocation held back during the last frame
+    if (_q->allocation_pending)
+        ofdmflexframegen_apply_subcarrier_allocation(_q);
+
     // reset internal OFDM frame generator object
     // NOTE: this is important for appropriately setting the pilot phases
     ofdmframegen_reset(_q->fg);
@@ -617,6 +829,10 @@ void ofdmflexframegen_reset_multi_user(ofdmflexframegen _q)
     for(i = 0; i < _q->num_users; i++)
         _q->user_payload_symbol_indices[i] = 0;
 
+    // switch to a subcarrier allocation held back during the last frame
+    if (_q->allocation_pending)
+        ofdmflexframegen_apply_subcarrier_allocation(_q);
+
     // reset internal OFDM frame generator object
     // NOTE: this is important for appropriately setting the pilot phases
     ofdmframegen_reset(_q->fg);
@@ -704,6 +920,7 @@ void ofdmflexframegen_setprops(ofdmflexframegen _q,
         unsigned int i;
         for(i = 0; i < _q->num_users; i++)
         {
+            memmove(&_q->user_props[i], _props, sizeof(ofdmflexframegenprops_s));
             ofdmflexframegen_reconfigure_multi_user(_q, i);
         }
     }
@@ -712,6 +929,64 @@ void ofdmflexframegen_setprops(ofdmflexframegen _q,
 
 }
 
+// get the modulation and FEC schemes of one user (multi-user mode)
+//  _q      :   frame generator object
+//  _user   :   user index
+//  _props  :   frame generator properties structure pointer
+void ofdmflexframegen_get_user_props(ofdmflexframegen          _q,
+                                     unsigned int              _user,
+                                     ofdmflexframegenprops_s * _props)
+{
+    if (!_q->ofdma || _user >= _q->num_users) {
+        fprintf(stderr, "error: ofdmflexframegen_get_user_props(), invalid user %u\n", _user);
+        exit(1);
+    }
+    memmove(_props, &_q->user_props[_user], sizeof(ofdmflexframegenprops_s));
+}
+
+// set the modulation and FEC schemes of one user (multi-user mode); the
+// CRC stays frame-wide. Like ofdmflexframegen_multi_user_update_data(),
+// call between frames: the next assembled frame carries the schemes in
+// its header for the user's synchronizer. A NULL _props restores the
+// frame-wide properties.
+//  _q      :   frame generator object
+//  _user   :   user index
+//  _props  :   frame generator properties structure pointer
+void ofdmflexframegen_set_user_props(ofdmflexframegen          _q,
+                                     unsigned int              _user,
+                                     ofdmflexframegenprops_s * _props)
+{
+    if (!_q->ofdma || _user >= _q->num_users) {
+        fprintf(stderr, "error: ofdmflexframegen_set_user_props(), invalid user %u\n", _user);
+        exit(1);
+    }
+    if (_props == NULL) {
+        ofdmflexframegen_set_user_props(_q, _user, &_q->props);
+        return;
+    }
+
+    // validate input
+    if (_props->fec0 == LIQUID_FEC_UNKNOWN || _props->fec0 >= LIQUID_FEC_NUM_SCHEMES ||
+        _props->fec1 == LIQUID_FEC_UNKNOWN || _props->fec1 >= LIQUID_FEC_NUM_SCHEMES) {
+        fprintf(stderr, "error: ofdmflexframegen_set_user_props(), invalid/unsupported FEC scheme\n");
+        exit(1);
+    } else if (_props->mod_scheme == LIQUID_MODEM_UNKNOWN || _props->mod_scheme >= LIQUID_MODEM_NUM_SCHEMES) {
+        fprintf(stderr, "error: ofdmflexframegen_set_user_props(), invalid/unsupported modulation scheme\n");
+        exit(1);
+    }
+
+    // nothing to do if the schemes are unchanged, as they are on most frames
+    ofdmflexframegenprops_s * p = &_q->user_props[_user];
+    if (p->mod_scheme == _props->mod_scheme &&
+        p->fec0 == _props->fec0 && p->fec1 == _props->fec1)
+        return;
+
+    p->mod_scheme = _props->mod_scheme;
+    p->fec0       = _props->fec0;
+    p->fec1       = _props->fec1;
+    ofdmflexframegen_reconfigure_multi_user(_q, _user);
+}
+
 // get length of frame (symbols)
 //  _q              :   OFDM frame generator object
 unsigned int ofdmflexframegen_getframelen(ofdmflexframegen _q)
@@ -781,12 +1056,6 @@ void ofdmflexframegen_multi_user_update_data(ofdmflexframegen _q,
         unsigned int _payload_len,
         unsigned int _user)
 {
-    if(_payload_len > _q->largest_payload)
-    {
-        _q->largest_payload = _payload_len;
-        _q->index_of_user_with_largest_payload = _user;
-    }
-
     if (_payload_len != _q->user_payload_dec_lens[_user]) {
         _q->user_payload_dec_lens[_user] = _payload_len;
         ofdmflexframegen_reconfigure_multi_user(_q, _user);
@@ -806,7 +1075,8 @@ void ofdmflexframegen_assemble_multi_user(ofdmflexframegen _q,
 
     //header structure in ofdma mode:
     //|8 bytes of user configurable data||_q->M bytes for subcarrier map|...
-    //...|2*_q->num_users bytes for user payload lens||6 bytes for framing info(ofdmflexframe_encode_header() writes this)|
+    //...|5*_q->num_users bytes for user payload lens, mod and fec schemes|...
+    //...|6 bytes for framing info(ofdmflexframe_encode_header() writes this)|
     //first we copy in the user header data, which should always be 8
     unsigned int n = OFDMFLEXFRAME_H_USER;
     memmove(_q->header, _header, n*sizeof(unsigned char));
@@ -814,13 +1084,16 @@ void ofdmflexframegen_assemble_multi_user(ofdmflexframegen _q,
     // then we copy in the subcarrier map, size _q->M
     memmove(_q->header + n, _q->subcarrier_map, _q->M*sizeof(unsigned char)); 
 
-    //then copy user-specific payload_lens into header
+    //then copy user-specific payload_lens, mod and fec schemes into header
     unsigned int i;
     unsigned int current_user = 0;
-    for(i = n + _q->M; current_user < _q->num_users; i+=2)
+    for(i = n + _q->M; current_user < _q->num_users; i+=OFDMFLEXFRAME_H_USER_PROPS)
     {
         _q->header[i] = (_q->user_payload_dec_lens[current_user] >> 8) & 0xff;
         _q->header[i + 1] = (_q->user_payload_dec_lens[current_user] ) & 0xff;
+        _q->header[i + 2] = _q->user_props[current_user].mod_scheme;
+        _q->header[i + 3] = _q->user_props[current_user].fec0 & 0x1f;
+        _q->header[i + 4] = _q->user_props[current_user].fec1 & 0x1f;
         current_user++;
     }
 
@@ -831,7 +1104,6 @@ void ofdmflexframegen_assemble_multi_user(ofdmflexframegen _q,
     // modulate header
     ofdmflexframegen_modulate_header(_q);
 
-    unsigned int bps = modulation_types[_q->props.mod_scheme].bps;
     unsigned int num_written[_q->num_users];
     unsigned int total_num_written = 0;
     unsigned int total_expected = 0;
@@ -849,6 +1121,7 @@ void ofdmflexframegen_assemble_multi_user(ofdmflexframegen _q,
         memset(_q->user_payload_mods[i], 0x00, _q->user_payload_mod_lens[i]);
 
         // repack 8-bit payload bytes into 'bps'-bit payload symbols
+        unsigned int bps = modulation_types[_q->user_props[i].mod_scheme].bps;
         liquid_repack_bytes(_q->user_payload_encs[i],  8,  _q->user_payload_enc_lens[i],
                 _q->user_payload_mods[i], bps, _q->user_payload_mod_lens[i],
                 &num_written[i]);
@@ -928,20 +1201,33 @@ int ofdmflexframegen_writesymbol(ofdmflexframegen       _q,
 // internal
 //
 
+// grow buffer to hold at least _len bytes, keeping its contents
+static unsigned char * ofdmflexframegen_grow(unsigned char * _buf,
+                                             unsigned int *  _cap,
+                                             unsigned int    _len)
+{
+    if (_len <= *_cap)
+        return _buf;
+    *_cap = _len;
+    return (unsigned char*) realloc(_buf, _len*sizeof(unsigned char));
+}
+
 // reconfigure internal buffers, objects, etc.
 void ofdmflexframegen_reconfigure(ofdmflexframegen _q)
 {
     // re-create payload packetizer
-    _q->p_payload = packetizer_recreate(_q->p_payload,
-                                        _q->payload_dec_len,
-                                        _q->props.check,
-                                        _q->props.fec0,
-                                        _q->props.fec1);
+    _q->p_payload = packetizer_recreate_cached(_q->p_payload,
+                                               _q->p_payload_cache,
+                                               _q->payload_dec_len,
+                                               _q->props.check,
+                                               _q->props.fec0,
+                                               _q->props.fec1);
 
     // re-allocate memory for encoded message
     _q->payload_enc_len = packetizer_get_enc_msg_len(_q->p_payload);
-    _q->payload_enc = (unsigned char*) realloc(_q->payload_enc,
-                                               _q->payload_enc_len*sizeof(unsigned char));
+    _q->payload_enc = ofdmflexframegen_grow(_q->payload_enc,
+                                            &_q->payload_enc_cap,
+                                            _q->payload_enc_len);
 #if DEBUG_OFDMFLEXFRAMEGEN
     //printf(">>>> payload : %u (%u encoded)\n", _q->props.payload_len, _q->payload_enc_len);
 #endif
@@ -954,8 +1240,9 @@ void ofdmflexframegen_reconfigure(ofdmflexframegen _q)
     unsigned int bps = modulation_types[_q->props.mod_scheme].bps;
     div_t d = div(8*_q->payload_enc_len, bps);
     _q->payload_mod_len = d.quot + (d.rem ? 1 : 0);
-    _q->payload_mod = (unsigned char*)realloc(_q->payload_mod,
-                                              _q->payload_mod_len*sizeof(unsigned char));
+    _q->payload_mod = ofdmflexframegen_grow(_q->payload_mod,
+                                            &_q->payload_mod_cap,
+                                            _q->payload_mod_len);
 
     // re-compute number of payload OFDM symbols
     d = div(_q->payload_mod_len, _q->M_data);
@@ -965,58 +1252,56 @@ void ofdmflexframegen_reconfigure(ofdmflexframegen _q)
 void ofdmflexframegen_reconfigure_multi_user(ofdmflexframegen _q, unsigned int user)
 {
     div_t d;
-    unsigned int all_payload_mod_len = 0;
-    unsigned int i;
     // re-create payload packetizer
-    _q->user_packetizers[user] = packetizer_recreate(_q->user_packetizers[user],
+    _q->user_packetizers[user] = packetizer_recreate_cached(_q->user_packetizers[user],
+            &_q->user_packetizer_caches[user*PACKETIZER_CACHE_LEN],
             _q->user_payload_dec_lens[user],
             _q->props.check,
-            _q->props.fec0,
-            _q->props.fec1);
+            _q->user_props[user].fec0,
+            _q->user_props[user].fec1);
 
     //re-allocate memory for decoded message
-    _q->user_payloads[user] = (unsigned char*) realloc(_q->user_payloads[user], 
-            _q->user_payload_dec_lens[user]*sizeof(unsigned char));
+    _q->user_payloads[user] = ofdmflexframegen_grow(_q->user_payloads[user],
+            &_q->user_payload_caps[user], _q->user_payload_dec_lens[user]);
 
 
     // re-allocate memory for encoded message
     _q->user_payload_enc_lens[user] = packetizer_get_enc_msg_len(_q->user_packetizers[user]);
-    _q->user_payload_encs[user] = (unsigned char*) realloc(_q->user_payload_encs[user], 
-            _q->user_payload_enc_lens[user]*sizeof(unsigned char));
+    _q->user_payload_encs[user] = ofdmflexframegen_grow(_q->user_payload_encs[user],
+            &_q->user_payload_enc_caps[user], _q->user_payload_enc_lens[user]);
 
 
     // re-create modem
-    _q->user_payload_modems[user] = modem_recreate(_q->user_payload_modems[user], _q->props.mod_scheme);
+    _q->user_payload_modems[user] = modem_recreate(_q->user_payload_modems[user], _q->user_props[user].mod_scheme);
+
+    // re-allocate memory for payload modem symbols
+    unsigned int bps = modulation_types[_q->user_props[user].mod_scheme].bps;
+    d = div(8*_q->user_payload_enc_lens[user], bps);
+    _q->user_payload_mod_lens[user] = d.quot + (d.rem ? 1 : 0);
+    _q->user_payload_mods[user] = ofdmflexframegen_grow(_q->user_payload_mods[user],
+            &_q->user_payload_mod_caps[user], _q->user_payload_mod_lens[user]);
+
+    ofdmflexframegen_update_num_symbols_payload(_q);
+}
 
+// re-compute number of payload OFDM symbols: enough for the user needing
+// the most, as users differ in modulation depth as well as in payload
+// length and number of subcarriers
+void ofdmflexframegen_update_num_symbols_payload(ofdmflexframegen _q)
+{
+    div_t d;
+    unsigned int i;
+    unsigned int num_symbols;
+    _q->num_symbols_payload = 0;
     for(i = 0; i < _q->num_users; i++)
     {
-        // re-allocate memory for payload modem symbols
-        unsigned int bps = modulation_types[_q->props.mod_scheme].bps;
-        d = div(8*_q->user_payload_enc_lens[i], bps);
-        _q->user_payload_mod_lens[i] = d.quot + (d.rem ? 1 : 0);
-        _q->user_payload_mods[i] = (unsigned char*)realloc(_q->user_payload_mods[i],
-                _q->user_payload_mod_lens[i]*sizeof(unsigned char));
-
-        all_payload_mod_len += _q->user_payload_mod_lens[i];
+        if(_q->num_subcarriers[i] == 0)
+            continue;
+        d = div(_q->user_payload_mod_lens[i], _q->num_subcarriers[i]);
+        num_symbols = d.quot + (d.rem ? 1 : 0);
+        if(num_symbols > _q->num_symbols_payload)
+            _q->num_symbols_payload = num_symbols;
     }
-    // re-compute number of payload OFDM symbols
-    // old way, divide total number of symbols by number of data subcarriers
-    //d = div(all_payload_mod_len, _q->M_data);
-    //_q->num_symbols_payload = d.quot + (d.rem ? 1 : 0);
-    // new way, divide number of symbols of user with largest payload by
-    // smallest number of subcarriers used by any user
-    // long explanation:
-    //         The number of subcarriers availabe for each user can be different
-    //         if the number of users doesn't divide evenly into the number of subcarriers.
-    //         ex. 120 subcarriers, 82 data, 12 pilot, 26 NULL
-    //         3 of the users will get 16 subcarriers will the other 2 will get 17 each
-    //         To make sure we generate enough ofdm symbols to transmit all the data
-    //         assume the user with the largest payload also has the least number of subcarriers.
-    //         Do the div with those 2 numbers (largest user_payload_mod and smallest number of subcarriers)
-    //         to determine the number of necessary ofdm symbols
-    d = div(_q->user_payload_mod_lens[_q->index_of_user_with_largest_payload],
-            _q->num_subcarriers[_q->index_of_user_with_least_subcarriers]);
-    _q->num_symbols_payload = d.quot + (d.rem ? 1 : 0);
 }
 
 
@@ -35,6 +35,10 @@
 
 #define OFDMFLEXFRAME_H_SOFT (0)
 
+// largest weight given to the soft bits of a subcarrier cleaner than
+// the frame average
+#define OFDMFLEXFRAMESYNC_SOFT_MAX_WEIGHT   (4.0f)
+
 suseconds_t current_time()
 {
     struct timeval tv;
@@ -83,6 +87,14 @@ struct ofdmflexframesync_s {
     unsigned int ofdmflexframe_h_sym_dynamic;
 
     unsigned char * subcarrier_map;
+    unsigned char * p_pending;          // allocation to switch to at the next frame boundary
+    int allocation_pending;             // is p_pending waiting to be applied?
+    unsigned int * payload_sc;          // this user's data subcarriers, in order
+    unsigned int payload_sc_len;        // number of entries in payload_sc
+    float complex * payload_syms;       // payload symbols gathered from them
+    unsigned int * payload_demod;       // demodulated payload symbols
+    float * payload_demod_evm;          // error vector magnitude of each
+    unsigned char * payload_demod_soft; // soft bits of each [size: M x MAX_MOD_BITS_PER_SYMBOL]
     float * payload_evm_averages;
     float * header_evm_averages;
     float * evm_db;
@@ -106,6 +118,18 @@ struct ofdmflexframesync_s {
     unsigned int payload_enc_len;       // length of encoded payload
     unsigned int payload_mod_len;       // number of payload modem symbols
     int payload_valid;                  // valid payload flag
+    packetizer p_payload_cache[PACKETIZER_CACHE_LEN]; // previously used payload packetizers
+    unsigned int payload_enc_cap;       // allocated size of payload_enc
+    unsigned int payload_dec_cap;       // allocated size of payload_dec
+    int payload_soft;                   // soft-decision payload decoding?
+    unsigned char * payload_enc_soft;   // payload data (encoded soft bits)
+    unsigned int payload_soft_cap;      // allocated size of payload_enc_soft
+
+    // per-subcarrier error vector magnitude over the current frame, for
+    // weighting the payload soft bits
+    float * sc_evm;                     // sum of squared EVM
+    unsigned int * sc_evm_count;        // number of symbols
+    float evm_ref;                      // mean squared EVM over the header
 
     // callback
     framesync_callback callback;        // user-defined callback function
@@ -146,9 +170,46 @@ modulation_scheme ofdmflexframesync_get_payload_mod_scheme(ofdmflexframesync _q)
     return _q->ms_payload;
 }
 
+// change the subcarrier allocation without re-creating the synchronizer.
+// If a frame is being received the change is held until it ends, so the
+// frame is not lost; otherwise it takes effect immediately.
 void ofdmflexframesync_update_subcarrier_allocation(ofdmflexframesync _q, unsigned char* new_allocation)
 {
-    memmove(_q->p, new_allocation, _q->M*sizeof(unsigned char));
+    memmove(_q->p_pending, new_allocation, _q->M*sizeof(unsigned char));
+    _q->allocation_pending = 1;
+
+    if (!ofdmframesync_is_frame_open(_q->fs))
+        ofdmflexframesync_apply_subcarrier_allocation(_q);
+}
+
+// switch to the pending subcarrier allocation; only the PLCP sequences,
+// gains and payload subcarrier list depend on it
+void ofdmflexframesync_apply_subcarrier_allocation(ofdmflexframesync _q)
+{
+    _q->allocation_pending = 0;
+    if (memcmp(_q->p, _q->p_pending, _q->M*sizeof(unsigned char)) == 0)
+        return;
+
+    memmove(_q->p, _q->p_pending, _q->M*sizeof(unsigned char));
+    ofdmframe_validate_sctype(_q->p, _q->M, &_q->M_null, &_q->M_pilot, &_q->M_data);
+    ofdmframesync_set_allocation(_q->fs, _q->p);
+    ofdmflexframesync_update_payload_subcarriers(_q);
+}
+
+// rebuild the list of subcarriers carrying this receiver's payload: the
+// data subcarriers, and in multi-user mode only those the subcarrier map
+// gives to this user
+void ofdmflexframesync_update_payload_subcarriers(ofdmflexframesync _q)
+{
+    unsigned int i;
+    _q->payload_sc_len = 0;
+    for (i=0; i<_q->M; i++) {
+        if (_q->p[i] != OFDMFRAME_SCTYPE_DATA)
+            continue;
+        if (_q->ofdma && _q->subcarrier_map[i] != _q->user_id)
+            continue;
+        _q->payload_sc[_q->payload_sc_len++] = i;
+    }
 }
 
 
@@ -201,6 +262,14 @@ ofdmflexframesync ofdmflexframesync_create(unsigned int       _M,
 
     q->ofdma = 0;
     q->subcarrier_map = (unsigned char*) malloc((1)*sizeof(unsigned char));
+    q->p_pending = (unsigned char*) malloc((q->M)*sizeof(unsigned char));
+    q->allocation_pending = 0;
+    q->payload_sc = (unsigned int*) malloc((q->M)*sizeof(unsigned int));
+    q->payload_syms = (float complex*) malloc((q->M)*sizeof(float complex));
+    q->payload_demod = (unsigned int*) malloc((q->M)*sizeof(unsigned int));
+    q->payload_demod_evm = (float*) malloc((q->M)*sizeof(float));
+    q->payload_demod_soft = (unsigned char*) malloc((q->M)*MAX_MOD_BITS_PER_SYMBOL*sizeof(unsigned char));
+    ofdmflexframesync_update_payload_subcarriers(q);
     q->payload_evm_averages = (float*) malloc((1)*sizeof(float));
     q->header_evm_averages = (float*) malloc((1)*sizeof(float));
     q->payload_symbols_received = (int*) malloc((1)*sizeof(int));
@@ -239,6 +308,14 @@ ofdmflexframesync ofdmflexframesync_create(unsigned int       _M,
     q->payload_enc = (unsigned char*) malloc(q->payload_enc_len*sizeof(unsigned char));
     q->payload_dec = (unsigned char*) malloc(q->payload_len*sizeof(unsigned char));
     q->payload_mod_len = 0;
+    memset(q->p_payload_cache, 0, sizeof(q->p_payload_cache));
+    q->payload_enc_cap = q->payload_enc_len;
+    q->payload_dec_cap = q->payload_len;
+    q->payload_soft = 0;
+    q->payload_enc_soft = NULL;
+    q->payload_soft_cap = 0;
+    q->sc_evm = (float*) malloc((q->M)*sizeof(float));
+    q->sc_evm_count = (unsigned int*) malloc((q->M)*sizeof(unsigned int));
 
     // reset state
     ofdmflexframesync_reset(q);
@@ -298,7 +375,7 @@ ofdmflexframesync ofdmflexframesync_create_multi_user(unsigned int       _M,
     q->ofdma = 1;
     q->user_id = user_id;
     q->num_users = num_users;
-    q->ofdmflexframe_h_user_dynamic = 8 + q->M + 2*num_users;
+    q->ofdmflexframe_h_user_dynamic = 8 + q->M + OFDMFLEXFRAME_H_USER_PROPS*num_users;
     q->ofdmflexframe_h_dec_dynamic = q->ofdmflexframe_h_user_dynamic + 6;
 
     // create internal framing object
@@ -324,6 +401,13 @@ ofdmflexframesync ofdmflexframesync_create_multi_user(unsigned int       _M,
     assert(packetizer_get_enc_msg_len(q->p_header)==q->ofdmflexframe_h_enc_dynamic);
 
     q->subcarrier_map = (unsigned char*) malloc((q->M)*sizeof(unsigned char));
+    q->p_pending = (unsigned char*) malloc((q->M)*sizeof(unsigned char));
+    q->allocation_pending = 0;
+    q->payload_sc = (unsigned int*) malloc((q->M)*sizeof(unsigned int));
+    q->payload_syms = (float complex*) malloc((q->M)*sizeof(float complex));
+    q->payload_demod = (unsigned int*) malloc((q->M)*sizeof(unsigned int));
+    q->payload_demod_evm = (float*) malloc((q->M)*sizeof(float));
+    q->payload_demod_soft = (unsigned char*) malloc((q->M)*MAX_MOD_BITS_PER_SYMBOL*sizeof(unsigned char));
     q->payload_evm_averages = (float*) malloc((q->M)*sizeof(float));
     q->header_evm_averages = (float*) malloc((q->M)*sizeof(float));
     q->evm_db = (float*) malloc((q->M)*sizeof(float));
@@ -331,6 +415,10 @@ ofdmflexframesync ofdmflexframesync_create_multi_user(unsigned int       _M,
     q->header_symbols_received = (int*) malloc((q->M)*sizeof(int));
 
     unsigned int i;
+    // no subcarriers are this user's until a header carries the map
+    memset(q->subcarrier_map, 0xff, q->M*sizeof(unsigned char));
+    q->payload_sc_len = 0;
+
     for(i = 0; i < q->M; i++)
     {
         q->payload_symbols_received[i] = 0;
@@ -356,6 +444,14 @@ ofdmflexframesync ofdmflexframesync_create_multi_user(unsigned int       _M,
     q->payload_enc = (unsigned char*) malloc(q->payload_enc_len*sizeof(unsigned char));
     q->payload_dec = (unsigned char*) malloc(q->payload_len*sizeof(unsigned char));
     q->payload_mod_len = 0;
+    memset(q->p_payload_cache, 0, sizeof(q->p_payload_cache));
+    q->payload_enc_cap = q->payload_enc_len;
+    q->payload_dec_cap = q->payload_len;
+    q->payload_soft = 0;
+    q->payload_enc_soft = NULL;
+    q->payload_soft_cap = 0;
+    q->sc_evm = (float*) malloc((q->M)*sizeof(float));
+    q->sc_evm_count = (unsigned int*) malloc((q->M)*sizeof(unsigned int));
 
 
 
@@ -375,17 +471,27 @@ void ofdmflexframesync_destroy(ofdmflexframesync _q)
     packetizer_destroy(_q->p_header);
     modem_destroy(_q->mod_header);
     packetizer_destroy(_q->p_payload);
+    packetizer_cache_destroy(_q->p_payload_cache);
     modem_destroy(_q->mod_payload);
 
     // free internal buffers/arrays
     free(_q->p);
     free(_q->payload_enc);
     free(_q->payload_dec);
+    free(_q->payload_enc_soft);
+    free(_q->sc_evm);
+    free(_q->sc_evm_count);
 
     free(_q->header);
     free(_q->header_enc);
     free(_q->header_mod);
     free(_q->subcarrier_map);
+    free(_q->p_pending);
+    free(_q->payload_sc);
+    free(_q->payload_syms);
+    free(_q->payload_demod);
+    free(_q->payload_demod_evm);
+    free(_q->payload_demod_soft);
     free(_q->payload_symbols_received);
     free(_q->header_symbols_received);
     free(_q->payload_evm_averages);
@@ -433,19 +539,42 @@ void ofdmflexframesync_reset(ofdmflexframesync _q)
 
     // reset error vector magnitude estimate
     _q->evm_hat = 1e-12f;   // slight offset to ensure no log(0)
+    memset(_q->sc_evm,       0, _q->M*sizeof(float));
+    memset(_q->sc_evm_count, 0, _q->M*sizeof(unsigned int));
 
     // reset framestats object
     framesyncstats_init_default(&_q->framestats);
 
-    // reset internal OFDM frame synchronizer object
+    // reset internal OFDM frame synchronizer object, switching to a
+    // subcarrier allocation held back while the last frame was received
+    if (_q->allocation_pending)
+        ofdmflexframesync_apply_subcarrier_allocation(_q);
     ofdmframesync_reset(_q->fs);
 }
 
+// enable/disable soft-decision payload decoding
+void ofdmflexframesync_set_payload_soft(ofdmflexframesync _q,
+                                        int               _soft)
+{
+    _q->payload_soft = _soft;
+
+    // one soft bit per encoded bit
+    if (_q->payload_soft && _q->payload_soft_cap < 8*_q->payload_enc_cap) {
+        _q->payload_soft_cap = 8*_q->payload_enc_cap;
+        _q->payload_enc_soft = (unsigned char*) realloc(_q->payload_enc_soft, _q->payload_soft_cap*sizeof(unsigned char));
+    }
+}
+
 // execute synchronizer object on buffer of samples
 void ofdmflexframesync_execute(ofdmflexframesync _q,
                                float complex * _x,
                                unsigned int _n)
 {
+    // the synchronizer may have dropped a partial frame on its own since
+    // an allocation change was held back
+    if (_q->allocation_pending && !ofdmframesync_is_frame_open(_q->fs))
+        ofdmflexframesync_apply_subcarrier_allocation(_q);
+
     // push samples through ofdmframesync object
     ofdmframesync_execute(_q->fs, _x, _n);
 }
@@ -569,6 +698,8 @@ void ofdmflexframesync_rxheader(ofdmflexframesync _q,
             //printf("evm for subcarrier %u: %f\n", i, evm);
 
             _q->evm_hat += evm*evm;
+            _q->sc_evm[i] += evm*evm;
+            _q->sc_evm_count[i]++;
             if(_q->ofdma)
             {
                 _q->header_evm_averages[i] = evm * evm;
@@ -583,6 +714,7 @@ void ofdmflexframesync_rxheader(ofdmflexframesync _q,
 
                 // decode header
                 ofdmflexframesync_decode_header(_q);
+                _q->evm_ref = _q->evm_hat / num_header_symbols;
             
                 // compute error vector magnitude estimate
 		if(_q->ofdma)
@@ -591,7 +723,32 @@ void ofdmflexframesync_rxheader(ofdmflexframesync _q,
 			_q->framestats.evm = 10*log10f( _q->evm_hat/OFDMFLEXFRAME_H_SYM );
 
                 // invoke callback if header is invalid
-                if (_q->header_valid)
+                if (_q->header_valid && _q->ofdma && _q->payload_sc_len == 0)
+                {
+                    // the frame gives this user no subcarriers, so there
+                    // is no payload to wait for
+                    _q->framestats.rssi             = ofdmframesync_get_rssi(_q->fs);
+                    _q->framestats.cfo              = ofdmframesync_get_cfo(_q->fs);
+                    _q->framestats.framesyms        = NULL;
+                    _q->framestats.num_framesyms    = 0;
+                    _q->framestats.mod_scheme       = _q->ms_payload;
+                    _q->framestats.mod_bps          = _q->bps_payload;
+                    _q->framestats.check            = _q->check;
+                    _q->framestats.fec0             = _q->fec0;
+                    _q->framestats.fec1             = _q->fec1;
+
+                    if (_q->callback != NULL)
+                        _q->callback(_q->header,
+                                     _q->header_valid,
+                                     NULL,
+                                     0,
+                                     0,
+                                     _q->framestats,
+                                     _q->userdata);
+
+                    ofdmflexframesync_reset(_q);
+                }
+                else if (_q->header_valid)
                 {
                     _q->state = OFDMFLEXFRAMESYNC_STATE_PAYLOAD;
                 }
@@ -717,20 +874,22 @@ void ofdmflexframesync_decode_header(ofdmflexframesync _q)
     // strip off payload length
     unsigned int payload_len;
     //when using normal ofdm, the payload length is stored in q->header[n+1] and [n+2]
-    //when using in ofdma, the payload lengths for the user get stored in the header
-    //after both the user defined portion of the header and the subcarrier map
+    //when using in ofdma, the payload length, modulation and fec schemes for
+    //the user get stored in the header after both the user defined portion
+    //of the header and the subcarrier map
+    unsigned char * user_props = NULL;
     if(!_q->ofdma)
         payload_len = (_q->header[n+1] << 8) | (_q->header[n+2]);
     else
     {
-        //index marks the start of the payload length data in the header
+        //index marks the start of the per-user data in the header
         unsigned int index = OFDMFLEXFRAME_H_USER + _q->M;
-        //then add 2*user_id and 2*user_id + 1 to get the length for the specific user
-        payload_len = (_q->header[index + (2*_q->user_id)] << 8) | (_q->header[index + (2*_q->user_id) +1]);
+        user_props = &_q->header[index + OFDMFLEXFRAME_H_USER_PROPS*_q->user_id];
+        payload_len = (user_props[0] << 8) | (user_props[1]);
     }
 
     // strip off modulation scheme/depth
-    unsigned int mod_scheme = _q->header[n+3];
+    unsigned int mod_scheme = _q->ofdma ? user_props[2] : _q->header[n+3];
     if (mod_scheme == 0 || mod_scheme >= LIQUID_MODEM_NUM_SCHEMES) {
         fprintf(stderr,"warning: ofdmflexframesync_decode_header(), invalid modulation scheme\n");
         _q->header_valid = 0;
@@ -744,6 +903,11 @@ void ofdmflexframesync_decode_header(ofdmflexframesync _q)
     unsigned int check = (_q->header[n+4] >> 5 ) & 0x07;
     unsigned int fec0  = (_q->header[n+4]      ) & 0x1f;
     unsigned int fec1  = (_q->header[n+5]      ) & 0x1f;
+    if(_q->ofdma)
+    {
+        fec0 = user_props[3] & 0x1f;
+        fec1 = user_props[4] & 0x1f;
+    }
 
     // validate properties
     if (check >= LIQUID_CRC_NUM_SCHEMES) {
@@ -766,7 +930,10 @@ void ofdmflexframesync_decode_header(ofdmflexframesync _q)
     {
 
         n = OFDMFLEXFRAME_H_USER;
-        memmove(_q->subcarrier_map, _q->header + n, _q->M*sizeof(unsigned char));
+        if (memcmp(_q->subcarrier_map, _q->header + n, _q->M*sizeof(unsigned char)) != 0) {
+            memmove(_q->subcarrier_map, _q->header + n, _q->M*sizeof(unsigned char));
+            ofdmflexframesync_update_payload_subcarriers(_q);
+        }
     }
 
 
@@ -798,12 +965,14 @@ void ofdmflexframesync_decode_header(ofdmflexframesync _q)
         _q->fec0        = fec0;
         _q->fec1        = fec1;
         
-        // recreate packetizer object
-        _q->p_payload = packetizer_recreate(_q->p_payload,
-                                            _q->payload_len,
-                                            _q->check,
-                                            _q->fec0,
-                                            _q->fec1);
+        // recreate packetizer object, re-using one from a recent frame if
+        // the payload length has been seen before
+        _q->p_payload = packetizer_recreate_cached(_q->p_payload,
+                                                   _q->p_payload_cache,
+                                                   _q->payload_len,
+                                                   _q->check,
+                                                   _q->fec0,
+                                                   _q->fec1);
 
         // re-compute payload encoded message length
         _q->payload_enc_len = packetizer_get_enc_msg_len(_q->p_payload);
@@ -811,9 +980,19 @@ void ofdmflexframesync_decode_header(ofdmflexframesync _q)
         printf("      * payload encoded :   %u bytes\n", _q->payload_enc_len);
 #endif
 
-        // re-allocate buffers accordingly
-        _q->payload_enc = (unsigned char*) realloc(_q->payload_enc, _q->payload_enc_len*sizeof(unsigned char));
-        _q->payload_dec = (unsigned char*) realloc(_q->payload_dec, _q->payload_len*sizeof(unsigned char));
+        // re-allocate buffers accordingly; they only ever grow
+        if (_q->payload_enc_len > _q->payload_enc_cap) {
+            _q->payload_enc_cap = _q->payload_enc_len;
+            _q->payload_enc = (unsigned char*) realloc(_q->payload_enc, _q->payload_enc_cap*sizeof(unsigned char));
+        }
+        if (_q->payload_len > _q->payload_dec_cap) {
+            _q->payload_dec_cap = _q->payload_len;
+            _q->payload_dec = (unsigned char*) realloc(_q->payload_dec, _q->payload_dec_cap*sizeof(unsigned char));
+        }
+        if (_q->payload_soft && 8*_q->payload_enc_len > _q->payload_soft_cap) {
+            _q->payload_soft_cap = 8*_q->payload_enc_len;
+            _q->payload_enc_soft = (unsigned char*) realloc(_q->payload_enc_soft, _q->payload_soft_cap*sizeof(unsigned char));
+        }
 
         // re-compute number of modulated payload symbols
         div_t d = div(8*_q->payload_enc_len, _q->bps_payload);
@@ -824,118 +1003,147 @@ void ofdmflexframesync_decode_header(ofdmflexframesync _q)
     }
 }
 
+// store the soft bits of one payload symbol, weighted by the reliability
+// of its subcarrier: the header's mean squared EVM over the subcarrier's
+// so far this frame.  The log-likelihood ratio scales with the inverse
+// noise variance, so bits from faded or jammed subcarriers move toward an
+// erasure and the Viterbi decoder leans on the clean ones.
+//  _q          :   synchronizer object
+//  _i          :   subcarrier index
+//  _soft_bits  :   soft bits from modem_demodulate_soft() [size: bps x 1]
+void ofdmflexframesync_store_soft_bits(ofdmflexframesync _q,
+                                       unsigned int      _i,
+                                       unsigned char *   _soft_bits)
+{
+    float sc_evm = _q->sc_evm[_i] / _q->sc_evm_count[_i];
+    float w = _q->evm_ref / (sc_evm + 1e-12f);
+    if (w > OFDMFLEXFRAMESYNC_SOFT_MAX_WEIGHT)
+        w = OFDMFLEXFRAMESYNC_SOFT_MAX_WEIGHT;
+
+    unsigned int num_bits = 8*_q->payload_enc_len;
+    unsigned int k;
+    for (k=0; k<_q->bps_payload; k++) {
+        // the last symbol may carry padding bits
+        unsigned int b = _q->payload_buffer_index + k;
+        if (b >= num_bits)
+            break;
+
+        int soft_bit = LIQUID_SOFTBIT_ERASURE +
+                       (int)roundf(w*((int)_soft_bits[k] - LIQUID_SOFTBIT_ERASURE));
+        if (soft_bit > LIQUID_SOFTBIT_1) soft_bit = LIQUID_SOFTBIT_1;
+        if (soft_bit < LIQUID_SOFTBIT_0) soft_bit = LIQUID_SOFTBIT_0;
+        _q->payload_enc_soft[b] = (unsigned char)soft_bit;
+    }
+}
+
 // receive payload data
 void ofdmflexframesync_rxpayload(ofdmflexframesync _q,
                                  float complex * _X)
 {
-    // demodulate paylod symbols
-    unsigned int i;
-    unsigned int j;
-    int sctype;
-    for (i=0; i<_q->M; i++) {
-        // subcarrier type (PILOT/NULL/DATA)
-        sctype = _q->p[i];
+    // gather this receiver's payload symbols, up to the end of the payload
+    unsigned int num_symbols = _q->payload_sc_len;
+    if (num_symbols > _q->payload_mod_len - _q->payload_symbol_index)
+        num_symbols = _q->payload_mod_len - _q->payload_symbol_index;
 
-        int data_for_user = 1;
-        if(_q->ofdma && _q->subcarrier_map[i] != _q->user_id)
-            data_for_user = 0;
+    unsigned int i;
+    unsigned int k;
+    for (k=0; k<num_symbols; k++)
+        _q->payload_syms[k] = _X[_q->payload_sc[k]];
+
+    // demodulate payload symbols as a block
+    if (_q->payload_soft)
+        modem_demodulate_soft_block(_q->mod_payload, _q->payload_syms, num_symbols,
+                                    _q->payload_demod, _q->payload_demod_soft,
+                                    _q->payload_demod_evm);
+    else
+        modem_demodulate_block(_q->mod_payload, _q->payload_syms, num_symbols,
+                               _q->payload_demod, _q->payload_demod_evm);
 
+    for (k=0; k<num_symbols; k++) {
+        i = _q->payload_sc[k];
 
-        // ignore pilot and null subcarriers
-        if (sctype == OFDMFRAME_SCTYPE_DATA && data_for_user) {
-            // unload payload symbols
-            unsigned int sym;
-            modem_demodulate(_q->mod_payload, _X[i], &sym);
-            if(_q->ofdma)
-            {
-                float evm = modem_get_demodulator_evm(_q->mod_payload);
-                _q->payload_evm_averages[i] += evm * evm;
-                _q->payload_symbols_received[i]++;
-            }
+        float evm = _q->payload_demod_evm[k];
+        _q->sc_evm[i] += evm*evm;
+        _q->sc_evm_count[i]++;
+        if(_q->ofdma)
+        {
+            _q->payload_evm_averages[i] += evm * evm;
+            _q->payload_symbols_received[i]++;
+        }
 
+        if (_q->payload_soft) {
+            // store weighted soft bits
+            ofdmflexframesync_store_soft_bits(_q, i,
+                    &_q->payload_demod_soft[k*_q->bps_payload]);
+        } else {
             // pack decoded symbol into array
             liquid_pack_array(_q->payload_enc,
                               _q->payload_enc_len,
                               _q->payload_buffer_index,
                               _q->bps_payload,
-                              sym);
+                              _q->payload_demod[k]);
+        }
+
+        // increment...
+        _q->payload_buffer_index += _q->bps_payload;
+    }
 
-            // increment...
-            _q->payload_buffer_index += _q->bps_payload;
+    // increment symbol counter
+    _q->payload_symbol_index += num_symbols;
 
-            // increment symbol counter
-            _q->payload_symbol_index++;
+    if (_q->payload_symbol_index < _q->payload_mod_len)
+        return;
 
-            if (_q->payload_symbol_index == _q->payload_mod_len) {
-                // payload extracted
+    // payload extracted
 
-                // decode payload
-                _q->payload_valid = packetizer_decode(_q->p_payload, _q->payload_enc, _q->payload_dec);
+    // decode payload
+    if (_q->payload_soft)
+        _q->payload_valid = packetizer_decode_soft(_q->p_payload, _q->payload_enc_soft, _q->payload_dec);
+    else
+        _q->payload_valid = packetizer_decode(_q->p_payload, _q->payload_enc, _q->payload_dec);
 #if DEBUG_OFDMFLEXFRAMESYNC
-                printf("****** payload extracted [%s]\n", _q->payload_valid ? "valid" : "INVALID!");
+    printf("****** payload extracted [%s]\n", _q->payload_valid ? "valid" : "INVALID!");
 #endif
 
-                if(_q->ofdma)
-                {
-                    for(j = 0; j < _q->M; j++)
-                    {
-                        if(_q->payload_symbols_received[j] > 0)
-                        {
-                            _q->evm_db[j] = (_q->payload_evm_averages[j]/_q->payload_symbols_received[j]);
-                            // if(!_q->payload_valid)
-                            //  printf("%u: average: %f, 10log10f: %f, #symbols: %u\n", j, _q->payload_evm_averages[j]/_q->payload_symbols_received[j], _q->evm_db[j], _q->payload_symbols_received[j]);
-                        }
-                    }
-                }
-
-
-                // ignore callback if set to NULL
-                if (_q->callback == NULL) {
-                    ofdmflexframesync_reset(_q);
-                    break;
-                }
-
-                // set framestats internals
-                _q->framestats.rssi             = ofdmframesync_get_rssi(_q->fs);
-                _q->framestats.cfo              = ofdmframesync_get_cfo(_q->fs);
-                _q->framestats.framesyms        = NULL;
-                _q->framestats.num_framesyms    = 0;
-                _q->framestats.mod_scheme       = _q->ms_payload;
-                _q->framestats.mod_bps          = _q->bps_payload;
-                _q->framestats.check            = _q->check;
-                _q->framestats.fec0             = _q->fec0;
-                _q->framestats.fec1             = _q->fec1;
-
-                // invoke callback method
-                if(!_q->ofdma)
-                {
-                    _q->callback(_q->header,
-                             _q->header_valid,
-                             _q->payload_dec,
-                             _q->payload_len,
-                             _q->payload_valid,
-                             _q->framestats,
-                             _q->userdata);
-                }
-                else
-                {
-                    _q->callback(_q->header,
-                            _q->header_valid,
-                            _q->payload_dec,
-                            _q->payload_len,
-                            _q->payload_valid,
-                            _q->framestats,
-                            _q->userdata);
-                }
-
-
-
-                // reset object
-                ofdmflexframesync_reset(_q);
-                break;
-            }
+    if(_q->ofdma)
+    {
+        // only this user's subcarriers have received symbols
+        for(k = 0; k < _q->payload_sc_len; k++)
+        {
+            i = _q->payload_sc[k];
+            if(_q->payload_symbols_received[i] > 0)
+                _q->evm_db[i] = (_q->payload_evm_averages[i]/_q->payload_symbols_received[i]);
         }
     }
+
+    // ignore callback if set to NULL
+    if (_q->callback == NULL) {
+        ofdmflexframesync_reset(_q);
+        return;
+    }
+
+    // set framestats internals
+    _q->framestats.rssi             = ofdmframesync_get_rssi(_q->fs);
+    _q->framestats.cfo              = ofdmframesync_get_cfo(_q->fs);
+    _q->framestats.framesyms        = NULL;
+    _q->framestats.num_framesyms    = 0;
+    _q->framestats.mod_scheme       = _q->ms_payload;
+    _q->framestats.mod_bps          = _q->bps_payload;
+    _q->framestats.check            = _q->check;
+    _q->framestats.fec0             = _q->fec0;
+    _q->framestats.fec1             = _q->fec1;
+
+    // invoke callback method
+    _q->callback(_q->header,
+                 _q->header_valid,
+                 _q->payload_dec,
+                 _q->payload_len,
+                 _q->payload_valid,
+                 _q->framestats,
+                 _q->userdata);
+
+    // reset object
+    ofdmflexframesync_reset(_q);
 }
 
 void ofdmflexframesync_print_sctype(ofdmflexframesync _q)
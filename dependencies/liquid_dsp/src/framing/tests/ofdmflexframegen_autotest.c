@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "autotest/autotest.h"
+#include "liquid.h"
+
+// write one multi-user frame with user 0 carrying _len bytes of _payload;
+// returns number of samples written to _buffer
+unsigned int ofdmflexframegen_autotest_frame(ofdmflexframegen _q,
+                                             unsigned int     _num_users,
+                                             unsigned char *  _payload,
+                                             unsigned int     _len,
+                                             float complex *  _buffer,
+                                             unsigned int     _symbol_len)
+{
+    unsigned char header[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    unsigned int i;
+    ofdmflexframegen_reset_multi_user(_q);
+    // symbols padding out the shorter payloads are random
+    srand(1);
+    for (i=0; i<_num_users; i++)
+        ofdmflexframegen_multi_user_update_data(_q, _payload, i==0 ? _len : 40, i);
+    ofdmflexframegen_assemble_multi_user(_q, header);
+
+    unsigned int n = 0;
+    int last_symbol = 0;
+    while (!last_symbol) {
+        last_symbol = ofdmflexframegen_writesymbol(_q, &_buffer[n]);
+        n += _symbol_len;
+    }
+    return n;
+}
+
+// 
+// AUTOTEST: the multi-user generator re-uses its buffers and packetizers
+// when a user's payload length moves between a few values; the frame it
+// writes must match that of a generator which only ever saw the one length
+//
+void autotest_ofdmflexframegen_multi_user_alternating_length()
+{
+    unsigned int M         = 64;
+    unsigned int cp_len    = 8;
+    unsigned int taper_len = 4;
+    unsigned int num_users = 4;
+    unsigned int symbol_len = M + cp_len;
+    unsigned int len_a = 60;
+    unsigned int len_b = 24;
+
+    ofdmflexframegenprops_s fgprops;
+    ofdmflexframegenprops_init_default(&fgprops);
+    fgprops.check = LIQUID_CRC_32;
+    fgprops.fec0  = LIQUID_FEC_HAMMING128;
+    fgprops.fec1  = LIQUID_FEC_NONE;
+
+    ofdmflexframegen q0 = ofdmflexframegen_create_multi_user(M, cp_len, taper_len, NULL, &fgprops, num_users);
+    ofdmflexframegen q1 = ofdmflexframegen_create_multi_user(M, cp_len, taper_len, NULL, &fgprops, num_users);
+
+    unsigned char payload[60];
+    unsigned int i;
+    for (i=0; i<len_a; i++)
+        payload[i] = rand() & 0xff;
+
+    unsigned int buffer_len = 1000*symbol_len;
+    float complex * buf0 = (float complex*) malloc(buffer_len*sizeof(float complex));
+    float complex * buf1 = (float complex*) malloc(buffer_len*sizeof(float complex));
+
+    // q0 always sends len_a; q1 goes through len_b and an empty payload
+    // (as for a control frame) and back
+    unsigned int lengths[4] = {len_a, len_b, 0, len_b};
+    for (i=0; i<8; i++) {
+        ofdmflexframegen_autotest_frame(q0, num_users, payload, len_a, buf0, symbol_len);
+        ofdmflexframegen_autotest_frame(q1, num_users, payload, lengths[i%4], buf1, symbol_len);
+    }
+    unsigned int n0 = ofdmflexframegen_autotest_frame(q0, num_users, payload, len_a, buf0, symbol_len);
+    unsigned int n1 = ofdmflexframegen_autotest_frame(q1, num_users, payload, len_a, buf1, symbol_len);
+
+    CONTEND_EQUALITY( n0, n1 );
+    for (i=0; i<n0 && i<n1; i++) {
+        CONTEND_DELTA( crealf(buf0[i]), crealf(buf1[i]), 1e-6f );
+        CONTEND_DELTA( cimagf(buf0[i]), cimagf(buf1[i]), 1e-6f );
+    }
+
+    ofdmflexframegen_destroy_multi_user(q0);
+    ofdmflexframegen_destroy_multi_user(q1);
+    free(buf0);
+    free(buf1);
+}
+
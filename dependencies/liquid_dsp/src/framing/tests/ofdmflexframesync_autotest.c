@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "autotest/autotest.h"
+#include "liquid.h"
+
+struct ofdmflexframesync_autotest_s {
+    unsigned char * payload;        // expected payload
+    unsigned int    payload_len;    // expected payload length
+    unsigned int    num_valid;      // number of payloads received intact
+    unsigned int    num_empty;      // valid headers without a payload
+};
+
+static int ofdmflexframesync_autotest_callback(unsigned char *  _header,
+                                               int              _header_valid,
+                                               unsigned char *  _payload,
+                                               unsigned int     _payload_len,
+                                               int              _payload_valid,
+                                               framesyncstats_s _stats,
+                                               void *           _userdata)
+{
+    struct ofdmflexframesync_autotest_s * r = (struct ofdmflexframesync_autotest_s*) _userdata;
+    if (_header_valid && _payload_valid && _payload_len == r->payload_len &&
+        memcmp(_payload, r->payload, r->payload_len) == 0)
+    {
+        r->num_valid++;
+    }
+    if (_header_valid && _payload == NULL)
+        r->num_empty++;
+    return 0;
+}
+
+//
+// AUTOTEST: frames with noise on every subcarrier and tones jamming two of
+// them, received by a hard- and a soft-decision synchronizer; the soft one
+// weights down the jammed subcarriers and must recover every payload, where
+// the hard one loses most of them
+//
+void autotest_ofdmflexframesync_payload_soft_jammed()
+{
+    unsigned int M           = 64;
+    unsigned int cp_len      = 16;
+    unsigned int taper_len   = 4;
+    unsigned int payload_len = 120;
+    unsigned int num_frames  = 8;
+    float        nstd        = 0.3f;    // noise standard deviation
+    float        jammer_amp  = 0.5f;    // amplitude of each jamming tone
+    unsigned int jammed[2]   = {5, 6};  // jammed subcarriers
+    unsigned int symbol_len  = M + cp_len;
+
+    srand(0);
+
+    ofdmflexframegenprops_s fgprops;
+    ofdmflexframegenprops_init_default(&fgprops);
+    fgprops.check        = LIQUID_CRC_32;
+    fgprops.fec0         = LIQUID_FEC_CONV_V27;
+    fgprops.fec1         = LIQUID_FEC_NONE;
+    fgprops.mod_scheme   = LIQUID_MODEM_QAM16;
+    ofdmflexframegen fg = ofdmflexframegen_create(M, cp_len, taper_len, NULL, &fgprops);
+
+    unsigned char header[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    unsigned char payload[120];
+    unsigned int i;
+    for (i=0; i<payload_len; i++)
+        payload[i] = rand() & 0xff;
+
+    struct ofdmflexframesync_autotest_s r_hard = {payload, payload_len, 0};
+    struct ofdmflexframesync_autotest_s r_soft = {payload, payload_len, 0};
+    ofdmflexframesync fs_hard = ofdmflexframesync_create(M, cp_len, taper_len, NULL,
+                                    ofdmflexframesync_autotest_callback, &r_hard);
+    ofdmflexframesync fs_soft = ofdmflexframesync_create(M, cp_len, taper_len, NULL,
+                                    ofdmflexframesync_autotest_callback, &r_soft);
+    ofdmflexframesync_set_payload_soft(fs_soft, 1);
+
+    float complex buffer[80];
+    unsigned int n = 0;     // sample counter, keeps the jammer continuous
+    unsigned int f;
+    for (f=0; f<num_frames; f++) {
+        ofdmflexframegen_assemble(fg, header, payload, payload_len);
+
+        // lead each frame with a few symbols of silence
+        int last_symbol = 0;
+        unsigned int k = 0;
+        while (!last_symbol || k < 4) {
+            if (k < 4)
+                memset(buffer, 0, symbol_len*sizeof(float complex));
+            else
+                last_symbol = ofdmflexframegen_writesymbol(fg, buffer);
+            k++;
+
+            for (i=0; i<symbol_len; i++) {
+                unsigned int j;
+                for (j=0; j<2; j++)
+                    buffer[i] += jammer_amp * cexpf(_Complex_I*2*M_PI*jammed[j]*(n % M)/M);
+                buffer[i] += nstd * (randnf() + _Complex_I*randnf()) * M_SQRT1_2;
+                n++;
+            }
+            ofdmflexframesync_execute(fs_hard, buffer, symbol_len);
+            ofdmflexframesync_execute(fs_soft, buffer, symbol_len);
+        }
+    }
+
+    if (liquid_autotest_verbose) {
+        printf("  hard : %u / %u payloads\n", r_hard.num_valid, num_frames);
+        printf("  soft : %u / %u payloads\n", r_soft.num_valid, num_frames);
+    }
+    CONTEND_EQUALITY( r_soft.num_valid, num_frames );
+    CONTEND_GREATER_THAN( r_soft.num_valid, r_hard.num_valid );
+
+    ofdmflexframegen_destroy(fg);
+    ofdmflexframesync_destroy(fs_hard);
+    ofdmflexframesync_destroy(fs_soft);
+}
+
+
+//
+// AUTOTEST: the generator and synchronizer change subcarrier allocation in
+// place part-way through a frame; that frame finishes with the old
+// allocation and every later one uses the new allocation
+//
+void autotest_ofdmflexframesync_update_allocation()
+{
+    unsigned int M           = 64;
+    unsigned int cp_len      = 16;
+    unsigned int taper_len   = 4;
+    unsigned int payload_len = 120;
+    unsigned int num_frames  = 6;
+    unsigned int f_update    = 2;   // frame during which allocation changes
+    unsigned int symbol_len  = M + cp_len;
+
+    srand(0);
+
+    // default allocation, and one with every third data subcarrier nulled
+    unsigned char p0[M];
+    unsigned char p1[M];
+    ofdmframe_init_default_sctype(M, p0);
+    memmove(p1, p0, M*sizeof(unsigned char));
+    unsigned int i;
+    unsigned int n = 0;
+    for (i=0; i<M; i++) {
+        if (p1[i] == OFDMFRAME_SCTYPE_DATA && (n++ % 3) == 0)
+            p1[i] = OFDMFRAME_SCTYPE_NULL;
+    }
+
+    ofdmflexframegenprops_s fgprops;
+    ofdmflexframegenprops_init_default(&fgprops);
+    fgprops.check        = LIQUID_CRC_32;
+    fgprops.fec0         = LIQUID_FEC_NONE;
+    fgprops.fec1         = LIQUID_FEC_NONE;
+    fgprops.mod_scheme   = LIQUID_MODEM_QPSK;
+    ofdmflexframegen fg = ofdmflexframegen_create(M, cp_len, taper_len, p0, &fgprops);
+
+    unsigned char header[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    unsigned char payload[120];
+    for (i=0; i<payload_len; i++)
+        payload[i] = rand() & 0xff;
+
+    struct ofdmflexframesync_autotest_s r = {payload, payload_len, 0};
+    ofdmflexframesync fs = ofdmflexframesync_create(M, cp_len, taper_len, p0,
+                               ofdmflexframesync_autotest_callback, &r);
+
+    float complex buffer[80];
+    unsigned int f;
+    for (f=0; f<num_frames; f++) {
+        ofdmflexframegen_assemble(fg, header, payload, payload_len);
+
+        // lead each frame with a few symbols of silence
+        int last_symbol = 0;
+        unsigned int k = 0;
+        while (!last_symbol || k < 4) {
+            if (k < 4)
+                memset(buffer, 0, symbol_len*sizeof(float complex));
+            else
+                last_symbol = ofdmflexframegen_writesymbol(fg, buffer);
+
+            // change allocation once both ends are inside the frame
+            if (f == f_update && k == 8) {
+                ofdmflexframegen_update_subcarrier_allocation(fg, p1);
+                ofdmflexframesync_update_subcarrier_allocation(fs, p1);
+                CONTEND_SAME_DATA( ofdmflexframegen_get_subcarrier_allocation(fg), p0, M );
+                CONTEND_SAME_DATA( ofdmflexframesync_get_subcarrier_allocation(fs), p0, M );
+            }
+            k++;
+
+            for (i=0; i<symbol_len; i++)
+                buffer[i] += 0.01f * (randnf() + _Complex_I*randnf()) * M_SQRT1_2;
+            ofdmflexframesync_execute(fs, buffer, symbol_len);
+        }
+    }
+
+    if (liquid_autotest_verbose)
+        printf("  %u / %u payloads\n", r.num_valid, num_frames);
+    CONTEND_EQUALITY( r.num_valid, num_frames );
+    CONTEND_SAME_DATA( ofdmflexframegen_get_subcarrier_allocation(fg), p1, M );
+    CONTEND_SAME_DATA( ofdmflexframesync_get_subcarrier_allocation(fs), p1, M );
+
+    ofdmflexframegen_destroy(fg);
+    ofdmflexframesync_destroy(fs);
+}
+
+//
+// AUTOTEST: a multi-user generator sends each user its own modulation and
+// FEC schemes, changing them between frames; every user's synchronizer
+// picks them up from the header and recovers its payload, and deeper
+// modulation shortens the frame
+//
+void autotest_ofdmflexframesync_multi_user_props()
+{
+    unsigned int M           = 64;
+    unsigned int cp_len      = 16;
+    unsigned int taper_len   = 4;
+    unsigned int num_users   = 3;
+    unsigned int payload_len = 200;
+    unsigned int num_frames  = 4;
+    unsigned int symbol_len  = M + cp_len;
+
+    srand(0);
+
+    ofdmflexframegenprops_s fgprops;
+    ofdmflexframegenprops_init_default(&fgprops);
+    fgprops.check        = LIQUID_CRC_32;
+    fgprops.fec0         = LIQUID_FEC_NONE;
+    fgprops.fec1         = LIQUID_FEC_NONE;
+    fgprops.mod_scheme   = LIQUID_MODEM_QPSK;
+    ofdmflexframegen fg = ofdmflexframegen_create_multi_user(M, cp_len, taper_len,
+                              NULL, &fgprops, num_users);
+
+    // per-user schemes for the first and for the later frames
+    modulation_scheme ms[2][3] = {
+        {LIQUID_MODEM_QPSK,  LIQUID_MODEM_QAM16, LIQUID_MODEM_QAM64},
+        {LIQUID_MODEM_QAM64, LIQUID_MODEM_QPSK,  LIQUID_MODEM_QAM16}};
+    fec_scheme fec0[2][3] = {
+        {LIQUID_FEC_CONV_V27, LIQUID_FEC_NONE,     LIQUID_FEC_HAMMING128},
+        {LIQUID_FEC_NONE,     LIQUID_FEC_CONV_V27, LIQUID_FEC_NONE}};
+
+    unsigned char payload[3][200];
+    struct ofdmflexframesync_autotest_s r[3];
+    ofdmflexframesync fs[3];
+    unsigned int i, u;
+    for (u=0; u<num_users; u++) {
+        for (i=0; i<payload_len; i++)
+            payload[u][i] = rand() & 0xff;
+        r[u].payload     = payload[u];
+        r[u].payload_len = payload_len;
+        r[u].num_valid   = 0;
+        fs[u] = ofdmflexframesync_create_multi_user(M, cp_len, taper_len, NULL,
+                    ofdmflexframesync_autotest_callback, &r[u], u, num_users);
+    }
+
+    // every user on 64-QAM needs a third of the payload symbols of QPSK
+    for (u=0; u<num_users; u++)
+        ofdmflexframegen_multi_user_update_data(fg, payload[u], payload_len, u);
+    unsigned int framelen_qpsk = ofdmflexframegen_getframelen(fg);
+    ofdmflexframegenprops_s props = fgprops;
+    props.mod_scheme = LIQUID_MODEM_QAM64;
+    for (u=0; u<num_users; u++)
+        ofdmflexframegen_set_user_props(fg, u, &props);
+    CONTEND_LESS_THAN( ofdmflexframegen_getframelen(fg), framelen_qpsk );
+
+    unsigned char header[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    float complex buffer[80];
+    unsigned int f;
+    for (f=0; f<num_frames; f++) {
+        for (u=0; u<num_users; u++) {
+            props = fgprops;
+            props.mod_scheme = ms[f > 0][u];
+            props.fec0       = fec0[f > 0][u];
+            ofdmflexframegen_set_user_props(fg, u, &props);
+            ofdmflexframegen_multi_user_update_data(fg, payload[u], payload_len, u);
+        }
+        ofdmflexframegenprops_s check;
+        ofdmflexframegen_get_user_props(fg, 2, &check);
+        CONTEND_EQUALITY( check.mod_scheme, ms[f > 0][2] );
+        ofdmflexframegen_assemble_multi_user(fg, header);
+
+        // lead each frame with a few symbols of silence
+        int last_symbol = 0;
+        unsigned int k = 0;
+        while (!last_symbol || k < 4) {
+            if (k < 4)
+                memset(buffer, 0, symbol_len*sizeof(float complex));
+            else
+                last_symbol = ofdmflexframegen_writesymbol(fg, buffer);
+            k++;
+
+            for (i=0; i<symbol_len; i++)
+                buffer[i] += 0.001f * (randnf() + _Complex_I*randnf()) * M_SQRT1_2;
+            for (u=0; u<num_users; u++)
+                ofdmflexframesync_execute(fs[u], buffer, symbol_len);
+        }
+    }
+
+    for (u=0; u<num_users; u++) {
+        if (liquid_autotest_verbose)
+            printf("  user %u: %u / %u payloads\n", u, r[u].num_valid, num_frames);
+        CONTEND_EQUALITY( r[u].num_valid, num_frames );
+        CONTEND_EQUALITY( ofdmflexframesync_get_payload_mod_scheme(fs[u]), ms[1][u] );
+        ofdmflexframesync_destroy(fs[u]);
+    }
+    ofdmflexframegen_destroy_multi_user(fg);
+}
+
+//
+// AUTOTEST: a multi-user generator divides the subcarriers by share; the
+// split is exact and interleaved, a user without a share gets a header
+// but no payload, giving the idle user's subcarriers to the others
+// shortens the frame, and all-zero shares restore the even split
+//
+void autotest_ofdmflexframesync_multi_user_shares()
+{
+    unsigned int M           = 64;
+    unsigned int cp_len      = 16;
+    unsigned int taper_len   = 4;
+    unsigned int num_users   = 3;
+    unsigned int payload_len = 200;
+    unsigned int num_frames  = 3;
+    unsigned int symbol_len  = M + cp_len;
+
+    srand(0);
+
+    ofdmflexframegenprops_s fgprops;
+    ofdmflexframegenprops_init_default(&fgprops);
+    fgprops.check        = LIQUID_CRC_32;
+    fgprops.fec0         = LIQUID_FEC_NONE;
+    fgprops.fec1         = LIQUID_FEC_NONE;
+    fgprops.mod_scheme   = LIQUID_MODEM_QPSK;
+    ofdmflexframegen fg = ofdmflexframegen_create_multi_user(M, cp_len, taper_len,
+                              NULL, &fgprops, num_users);
+
+    unsigned char map_even[64];
+    memmove(map_even, ofdmflexframegen_get_subcarrier_map(fg), M);
+
+    unsigned char payload[3][200];
+    unsigned int payload_lens[3] = {payload_len, payload_len, 0};
+    struct ofdmflexframesync_autotest_s r[3];
+    ofdmflexframesync fs[3];
+    unsigned int i, u;
+    for (u=0; u<num_users; u++) {
+        for (i=0; i<payload_len; i++)
+            payload[u][i] = rand() & 0xff;
+        r[u].payload     = payload[u];
+        r[u].payload_len = payload_lens[u];
+        r[u].num_valid   = 0;
+        r[u].num_empty   = 0;
+        fs[u] = ofdmflexframesync_create_multi_user(M, cp_len, taper_len, NULL,
+                    ofdmflexframesync_autotest_callback, &r[u], u, num_users);
+        ofdmflexframegen_multi_user_update_data(fg, payload[u], payload_lens[u], u);
+    }
+    unsigned int framelen_even = ofdmflexframegen_getframelen(fg);
+
+    // 3:1:0 split of every data subcarrier, with user 0's subcarriers
+    // spread out: never more than three of them in a row
+    unsigned int shares[3] = {3, 1, 0};
+    ofdmflexframegen_set_user_shares(fg, shares);
+    unsigned int n0 = ofdmflexframegen_get_user_num_subcarriers(fg, 0);
+    unsigned int n1 = ofdmflexframegen_get_user_num_subcarriers(fg, 1);
+    unsigned int n2 = ofdmflexframegen_get_user_num_subcarriers(fg, 2);
+    unsigned int num_data = 0;
+    for (i=0; i<M; i++)
+        num_data += map_even[i] < num_users ? 1 : 0;
+    CONTEND_EQUALITY( n0 + n1 + n2, num_data );
+    CONTEND_EQUALITY( n2, 0 );
+    CONTEND_DELTA( (float)n0, 3.0f*n1, 3.0f );
+    unsigned char * map = ofdmflexframegen_get_subcarrier_map(fg);
+    unsigned int run = 0, max_run = 0;
+    for (i=0; i<M; i++) {
+        if (map[i] >= num_users)
+            continue;
+        run = map[i] == 0 ? run + 1 : 0;
+        max_run = run > max_run ? run : max_run;
+    }
+    CONTEND_LESS_THAN( max_run, 4 );
+
+    // equal shares between the two busy users beat the even split
+    shares[0] = 1;
+    ofdmflexframegen_set_user_shares(fg, shares);
+    CONTEND_LESS_THAN( ofdmflexframegen_getframelen(fg), framelen_even );
+
+    unsigned char header[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    float complex buffer[80];
+    unsigned int f;
+    for (f=0; f<num_frames; f++) {
+        for (u=0; u<num_users; u++)
+            ofdmflexframegen_multi_user_update_data(fg, payload[u], payload_lens[u], u);
+        ofdmflexframegen_assemble_multi_user(fg, header);
+
+        // lead each frame with a few symbols of silence
+        int last_symbol = 0;
+        unsigned int k = 0;
+        while (!last_symbol || k < 4) {
+            if (k < 4)
+                memset(buffer, 0, symbol_len*sizeof(float complex));
+            else
+                last_symbol = ofdmflexframegen_writesymbol(fg, buffer);
+            k++;
+
+            for (i=0; i<symbol_len; i++)
+                buffer[i] += 0.001f * (randnf() + _Complex_I*randnf()) * M_SQRT1_2;
+            for (u=0; u<num_users; u++)
+                ofdmflexframesync_execute(fs[u], buffer, symbol_len);
+        }
+    }
+
+    if (liquid_autotest_verbose) {
+        printf("  3:1:0 split : %u, %u, %u of %u subcarriers\n", n0, n1, n2, num_data);
+        for (u=0; u<num_users; u++)
+            printf("  user %u: %u / %u payloads, %u empty\n", u, r[u].num_valid, num_frames, r[u].num_empty);
+    }
+    CONTEND_EQUALITY( r[0].num_valid, num_frames );
+    CONTEND_EQUALITY( r[1].num_valid, num_frames );
+    CONTEND_EQUALITY( r[2].num_empty, num_frames );
+
+    // all-zero shares restore the even split
+    shares[0] = shares[1] = shares[2] = 0;
+    ofdmflexframegen_set_user_shares(fg, shares);
+    CONTEND_SAME_DATA( ofdmflexframegen_get_subcarrier_map(fg), map_even, M );
+
+    for (u=0; u<num_users; u++)
+        ofdmflexframesync_destroy(fs[u]);
+    ofdmflexframegen_destroy_multi_user(fg);
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Demodulation of 64-sample blocks (one user's subcarriers of an OFDM
+// symbol), with error vector magnitudes: the block API against one
+// modem_demodulate[_soft]() and modem_get_demodulator_evm() per sample
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/resource.h>
+#include "liquid.h"
+
+#define MODEM_DEMODULATE_BLOCK_BENCH_API(MS,SOFT,BLOCK) \
+(   struct rusage *_start,                              \
+    struct rusage *_finish,                             \
+    unsigned long int *_num_iterations)                 \
+{ modem_demodulate_block_bench(_start, _finish, _num_iterations, MS, SOFT, BLOCK); }
+
+// Helper function to keep code base small
+void modem_demodulate_block_bench(struct rusage *     _start,
+                                  struct rusage *     _finish,
+                                  unsigned long int * _num_iterations,
+                                  modulation_scheme   _ms,
+                                  int                 _soft,
+                                  int                 _block)
+{
+    unsigned int n = 64;
+    *_num_iterations /= n;
+    if (*_num_iterations < 1) *_num_iterations = 1;
+
+    modem demod = modem_create(_ms);
+    unsigned int bps = modem_get_bps(demod);
+
+    // generate input vector to demodulate (spiral)
+    float complex x[n];
+    unsigned long int i;
+    for (i=0; i<n; i++)
+        x[i] = 0.07 * (i % 20) * cexpf(_Complex_I*2*M_PI*0.1*i);
+
+    unsigned int  s[n];
+    unsigned char soft_bits[n*bps];
+    float         evm[n];
+    unsigned int  k;
+
+    // start trials
+    getrusage(RUSAGE_SELF, _start);
+    for (i=0; i<(*_num_iterations); i++) {
+        if (_block && _soft) {
+            modem_demodulate_soft_block(demod, x, n, s, soft_bits, evm);
+        } else if (_block) {
+            modem_demodulate_block(demod, x, n, s, evm);
+        } else if (_soft) {
+            for (k=0; k<n; k++) {
+                modem_demodulate_soft(demod, x[k], &s[k], &soft_bits[k*bps]);
+                evm[k] = modem_get_demodulator_evm(demod);
+            }
+        } else {
+            for (k=0; k<n; k++) {
+                modem_demodulate(demod, x[k], &s[k]);
+                evm[k] = modem_get_demodulator_evm(demod);
+            }
+        }
+    }
+    getrusage(RUSAGE_SELF, _finish);
+    *_num_iterations *= n;
+
+    modem_destroy(demod);
+}
+
+// hard decision
+void benchmark_demodulate_block_qpsk         MODEM_DEMODULATE_BLOCK_BENCH_API(LIQUID_MODEM_QPSK,  0, 1)
+void benchmark_demodulate_block_qpsk_ref     MODEM_DEMODULATE_BLOCK_BENCH_API(LIQUID_MODEM_QPSK,  0, 0)
+void benchmark_demodulate_block_qam16        MODEM_DEMODULATE_BLOCK_BENCH_API(LIQUID_MODEM_QAM16, 0, 1)
+void benchmark_demodulate_block_qam16_ref    MODEM_DEMODULATE_BLOCK_BENCH_API(LIQUID_MODEM_QAM16, 0, 0)
+void benchmark_demodulate_block_qam64        MODEM_DEMODULATE_BLOCK_BENCH_API(LIQUID_MODEM_QAM64, 0, 1)
+void benchmark_demodulate_block_qam64_ref    MODEM_DEMODULATE_BLOCK_BENCH_API(LIQUID_MODEM_QAM64, 0, 0)
+
+// soft decision
+void benchmark_demodulate_soft_block_qpsk     MODEM_DEMODULATE_BLOCK_BENCH_API(LIQUID_MODEM_QPSK, 1, 1)
+void benchmark_demodulate_soft_block_qpsk_ref MODEM_DEMODULATE_BLOCK_BENCH_API(LIQUID_MODEM_QPSK, 1, 0)
+
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// modem_block.c : demodulate blocks of samples
+//
+// QPSK and square QAM (hard decision) and QPSK (soft decision) blocks run
+// eight samples at a time with AVX2; the kernels are built without FMA so
+// that they round exactly as the per-sample demodulators do, and give the
+// same symbols and soft bits.  Every other scheme, and the last samples of
+// each block, go through the per-sample demodulators.
+//
+
+#if LIQUID_AVX2
+#include <immintrin.h>
+
+#define MODEM_AVX2_TARGET   __attribute__((target("avx2")))
+
+// load eight samples, returning their in-phase and quadrature components
+static inline MODEM_AVX2_TARGET void MODEM(_avx2_load8)(TC *     _x,
+                                                        __m256 * _re,
+                                                        __m256 * _im)
+{
+    __m256 a = _mm256_loadu_ps((float*)(_x  ));     // r0 i0 r1 i1 | r2 i2 r3 i3
+    __m256 b = _mm256_loadu_ps((float*)(_x+4));     // r4 i4 r5 i5 | r6 i6 r7 i7
+
+    // r0 r1 r4 r5 | r2 r3 r6 r7, then swap the middle pairs
+    __m256 re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0));
+    __m256 im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1));
+    *_re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(re), _MM_SHUFFLE(3,1,2,0)));
+    *_im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(im), _MM_SHUFFLE(3,1,2,0)));
+}
+
+// QPSK symbols and error vector magnitudes of eight samples
+static inline MODEM_AVX2_TARGET void MODEM(_avx2_slice8_qpsk)(__m256    _re,
+                                                              __m256    _im,
+                                                              __m256i * _s,
+                                                              __m256 *  _evm)
+{
+    __m256 zero = _mm256_setzero_ps();
+    __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 a    = _mm256_set1_ps((float)M_SQRT1_2);
+
+    // symbol: bit 0 set if in-phase component not positive, bit 1 for
+    // quadrature (as MODEM(_demodulate_qpsk))
+    __m256 gt_i = _mm256_cmp_ps(_re, zero, _CMP_GT_OQ);
+    __m256 gt_q = _mm256_cmp_ps(_im, zero, _CMP_GT_OQ);
+    *_s = _mm256_or_si256(_mm256_andnot_si256(_mm256_castps_si256(gt_i), _mm256_set1_epi32(1)),
+                          _mm256_andnot_si256(_mm256_castps_si256(gt_q), _mm256_set1_epi32(2)));
+
+    // error to re-modulated symbol
+    __m256 e_i = _mm256_sub_ps(_re, _mm256_xor_ps(a, _mm256_andnot_ps(gt_i, sign)));
+    __m256 e_q = _mm256_sub_ps(_im, _mm256_xor_ps(a, _mm256_andnot_ps(gt_q, sign)));
+    *_evm = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(e_i,e_i), _mm256_mul_ps(e_q,e_q)));
+}
+
+// hard-decision QPSK; returns number of samples demodulated
+static MODEM_AVX2_TARGET unsigned int MODEM(_demodulate_block_qpsk_avx2)(MODEM()        _q,
+                                                                         TC *           _x,
+                                                                         unsigned int   _n,
+                                                                         unsigned int * _s,
+                                                                         T *            _evm)
+{
+    unsigned int i;
+    for (i=0; i+8<_n; i+=8) {
+        __m256 re, im, evm;
+        __m256i s;
+        MODEM(_avx2_load8)(&_x[i], &re, &im);
+        MODEM(_avx2_slice8_qpsk)(re, im, &s, &evm);
+        _mm256_storeu_si256((__m256i*)&_s[i], s);
+        if (_evm != NULL)
+            _mm256_storeu_ps(&_evm[i], evm);
+    }
+    return i;
+}
+
+// soft-decision QPSK; returns number of samples demodulated
+static MODEM_AVX2_TARGET unsigned int MODEM(_demodulate_soft_block_qpsk_avx2)(MODEM()         _q,
+                                                                              TC *            _x,
+                                                                              unsigned int    _n,
+                                                                              unsigned int *  _s,
+                                                                              unsigned char * _soft_bits,
+                                                                              T *             _evm)
+{
+    // as MODEM(_demodulate_soft_qpsk): soft bit = -2*x*gamma*16 + 127
+    __m256 m2    = _mm256_set1_ps(-2.0f);
+    __m256 gamma = _mm256_set1_ps(5.8f);
+    __m256 g16   = _mm256_set1_ps(16.0f);
+    __m256 c127  = _mm256_set1_ps(127.0f);
+    __m256i zero = _mm256_setzero_si256();
+    __m256i c255 = _mm256_set1_epi32(255);
+
+    unsigned int i;
+    for (i=0; i+8<_n; i+=8) {
+        __m256 re, im, evm;
+        __m256i s;
+        MODEM(_avx2_load8)(&_x[i], &re, &im);
+        MODEM(_avx2_slice8_qpsk)(re, im, &s, &evm);
+        _mm256_storeu_si256((__m256i*)&_s[i], s);
+        if (_evm != NULL)
+            _mm256_storeu_ps(&_evm[i], evm);
+
+        // first bit from quadrature component, second from in-phase
+        __m256 llr_q = _mm256_mul_ps(_mm256_mul_ps(m2, im), gamma);
+        __m256 llr_i = _mm256_mul_ps(_mm256_mul_ps(m2, re), gamma);
+        __m256i b0 = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(llr_q, g16), c127));
+        __m256i b1 = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(llr_i, g16), c127));
+        b0 = _mm256_min_epi32(_mm256_max_epi32(b0, zero), c255);
+        b1 = _mm256_min_epi32(_mm256_max_epi32(b1, zero), c255);
+
+        // interleave to b0[0] b1[0] b0[1] b1[1] ... and narrow to bytes
+        __m256i lo = _mm256_unpacklo_epi32(b0, b1);
+        __m256i hi = _mm256_unpackhi_epi32(b0, b1);
+        __m256i w  = _mm256_packus_epi16(_mm256_packus_epi32(lo, hi), zero);
+        w = _mm256_permute4x64_epi64(w, _MM_SHUFFLE(3,1,2,0));
+        _mm_storeu_si128((__m128i*)&_soft_bits[2*i], _mm256_castsi256_si128(w));
+    }
+    return i;
+}
+
+// hard-decision square QAM; returns number of samples demodulated
+static MODEM_AVX2_TARGET unsigned int MODEM(_demodulate_block_qam_avx2)(MODEM()        _q,
+                                                                        TC *           _x,
+                                                                        unsigned int   _n,
+                                                                        unsigned int * _s,
+                                                                        T *            _evm)
+{
+    unsigned int m = _q->data.qam.m_i;  // bits per dimension
+    __m256 zero = _mm256_setzero_ps();
+    __m256 sign = _mm256_set1_ps(-0.0f);
+    __m128i shift = _mm_cvtsi32_si128(m);
+
+    unsigned int i;
+    unsigned int j;
+    for (i=0; i+8<_n; i+=8) {
+        __m256 v_i, v_q;
+        MODEM(_avx2_load8)(&_x[i], &v_i, &v_q);
+
+        // slice each component on the linear array, most-significant bit
+        // first (as MODEM(_demodulate_linear_array_ref))
+        __m256i s_i = _mm256_setzero_si256();
+        __m256i s_q = _mm256_setzero_si256();
+        for (j=0; j<m; j++) {
+            __m256 ref  = _mm256_set1_ps(_q->ref[m-j-1]);
+            __m256 gt_i = _mm256_cmp_ps(v_i, zero, _CMP_GT_OQ);
+            __m256 gt_q = _mm256_cmp_ps(v_q, zero, _CMP_GT_OQ);
+
+            // shift in the bit (the mask is -1 where set)
+            s_i = _mm256_sub_epi32(_mm256_slli_epi32(s_i, 1), _mm256_castps_si256(gt_i));
+            s_q = _mm256_sub_epi32(_mm256_slli_epi32(s_q, 1), _mm256_castps_si256(gt_q));
+
+            // subtract the reference where the bit is set, add it elsewhere
+            v_i = _mm256_sub_ps(v_i, _mm256_xor_ps(ref, _mm256_andnot_ps(gt_i, sign)));
+            v_q = _mm256_sub_ps(v_q, _mm256_xor_ps(ref, _mm256_andnot_ps(gt_q, sign)));
+        }
+
+        // gray encoding, combine components
+        s_i = _mm256_xor_si256(s_i, _mm256_srli_epi32(s_i, 1));
+        s_q = _mm256_xor_si256(s_q, _mm256_srli_epi32(s_q, 1));
+        _mm256_storeu_si256((__m256i*)&_s[i], _mm256_or_si256(_mm256_sll_epi32(s_i, shift), s_q));
+
+        // residuals are the error to the re-modulated symbol
+        if (_evm != NULL)
+            _mm256_storeu_ps(&_evm[i], _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(v_i,v_i),
+                                                                    _mm256_mul_ps(v_q,v_q))));
+    }
+    return i;
+}
+#endif
+
+// demodulate a block of samples (hard decision)
+//  _q      :   modem object
+//  _x      :   input samples [size: _n x 1]
+//  _n      :   number of input samples
+//  _s      :   output symbols [size: _n x 1]
+//  _evm    :   output error vector magnitudes [size: _n x 1], ignored if NULL
+void MODEM(_demodulate_block)(MODEM()        _q,
+                              TC *           _x,
+                              unsigned int   _n,
+                              unsigned int * _s,
+                              T *            _evm)
+{
+    // the vector kernels always leave at least the last sample to the
+    // loop below, so the object's state is that of MODEM(_demodulate)
+    unsigned int i = 0;
+#if LIQUID_AVX2
+    if (_q->avx2) {
+        switch (_q->scheme) {
+        case LIQUID_MODEM_QPSK:
+            i = MODEM(_demodulate_block_qpsk_avx2)(_q, _x, _n, _s, _evm);
+            break;
+        case LIQUID_MODEM_QAM4:
+        case LIQUID_MODEM_QAM16:
+        case LIQUID_MODEM_QAM64:
+        case LIQUID_MODEM_QAM256:
+            i = MODEM(_demodulate_block_qam_avx2)(_q, _x, _n, _s, _evm);
+            break;
+        default:;
+        }
+    }
+#endif
+
+    for ( ; i<_n; i++) {
+        _q->demodulate_func(_q, _x[i], &_s[i]);
+        if (_evm != NULL)
+            _evm[i] = cabsf(_q->x_hat - _q->r);
+    }
+}
+
+// demodulate a block of samples (soft decision)
+//  _q          :   modem object
+//  _x          :   input samples [size: _n x 1]
+//  _n          :   number of input samples
+//  _s          :   output hard symbols [size: _n x 1]
+//  _soft_bits  :   output soft bits [size: _n*bps x 1]
+//  _evm        :   output error vector magnitudes [size: _n x 1], ignored if NULL
+void MODEM(_demodulate_soft_block)(MODEM()         _q,
+                                   TC *            _x,
+                                   unsigned int    _n,
+                                   unsigned int *  _s,
+                                   unsigned char * _soft_bits,
+                                   T *             _evm)
+{
+    unsigned int i = 0;
+#if LIQUID_AVX2
+    if (_q->avx2 && _q->scheme == LIQUID_MODEM_QPSK)
+        i = MODEM(_demodulate_soft_block_qpsk_avx2)(_q, _x, _n, _s, _soft_bits, _evm);
+#endif
+
+    for ( ; i<_n; i++) {
+        MODEM(_demodulate_soft)(_q, _x[i], &_s[i], &_soft_bits[i*_q->m]);
+        if (_evm != NULL)
+            _evm[i] = cabsf(_q->x_hat - _q->r);
+    }
+}
+
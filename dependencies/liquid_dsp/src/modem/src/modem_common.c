@@ -127,6 +127,9 @@ struct MODEM(_s)
     // neighbors array
     unsigned char * demod_soft_neighbors;   // array of nearest neighbors
     unsigned int demod_soft_p;              // number of neighbors in array
+
+    // block demodulation
+    int avx2;                               // use AVX2 kernels?
 };
 
 // create digital modem of a specific scheme and bits/symbol
@@ -296,6 +299,9 @@ void MODEM(_init)(MODEM() _q,
     // soft demodulation
     _q->demod_soft_neighbors = NULL;
     _q->demod_soft_p = 0;
+
+    // block demodulation
+    _q->avx2 = liquid_avx2_enabled();
 }
 
 // initialize symbol map for fast modulation
@@ -55,6 +55,9 @@
 // arbitary modems
 #include "modem_arb.c"
 
+// block demodulation
+#include "modem_block.c"
+
 // analog modems
 #include "freqmod.c"
 #include "freqdem.c"
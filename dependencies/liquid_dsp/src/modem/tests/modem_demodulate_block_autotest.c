@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2007 - 2014 Joseph Gaeddert
+ *
+ * This file is part of liquid.
+ *
+ * liquid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * liquid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with liquid.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// block demodulation tests
+//
+
+#include <stdlib.h>
+
+#include "autotest/autotest.h"
+#include "liquid.h"
+
+// block and per-sample demodulation of the same noisy samples must agree;
+// run with the vector kernels (where available) and without
+void modem_test_demodulate_block(modulation_scheme _ms,
+                                 int               _soft,
+                                 int               _no_avx2)
+{
+    if (_no_avx2)
+        setenv("LIQUID_NO_AVX2", "1", 1);
+
+    modem mod     = modem_create(_ms);
+    modem demod_0 = modem_create(_ms);  // per sample
+    modem demod_1 = modem_create(_ms);  // block
+
+    // enough samples for several vectors plus a tail
+    unsigned int n   = 61;
+    unsigned int bps = modem_get_bps(mod);
+    float complex x[n];
+    unsigned int i, k;
+    for (i=0; i<n; i++) {
+        modem_modulate(mod, rand() % (1<<bps), &x[i]);
+        x[i] += 0.15f*(randnf() + _Complex_I*randnf());
+    }
+
+    // samples on the decision boundaries
+    x[3] = 0.0f;
+    x[9] = 0.5f*_Complex_I;
+    x[17] = -0.3f;
+
+    unsigned int  s_0[n], s_1[n];
+    unsigned char soft_0[n*bps], soft_1[n*bps];
+    float         evm_0[n], evm_1[n];
+    for (i=0; i<n; i++) {
+        if (_soft)
+            modem_demodulate_soft(demod_0, x[i], &s_0[i], &soft_0[i*bps]);
+        else
+            modem_demodulate(demod_0, x[i], &s_0[i]);
+        evm_0[i] = modem_get_demodulator_evm(demod_0);
+    }
+    if (_soft)
+        modem_demodulate_soft_block(demod_1, x, n, s_1, soft_1, evm_1);
+    else
+        modem_demodulate_block(demod_1, x, n, s_1, evm_1);
+
+    for (i=0; i<n; i++) {
+        CONTEND_EQUALITY( s_0[i], s_1[i] );
+        CONTEND_DELTA( evm_0[i], evm_1[i], 1e-5f );
+        if (_soft) {
+            for (k=0; k<bps; k++)
+                CONTEND_EQUALITY( soft_0[i*bps+k], soft_1[i*bps+k] );
+        }
+    }
+
+    // object state is that of the last sample
+    CONTEND_DELTA( modem_get_demodulator_evm(demod_1), evm_0[n-1], 1e-5f );
+
+    modem_destroy(mod);
+    modem_destroy(demod_0);
+    modem_destroy(demod_1);
+
+    if (_no_avx2)
+        unsetenv("LIQUID_NO_AVX2");
+}
+
+// AUTOTESTS: hard decision
+void autotest_demodulate_block_qpsk()      { modem_test_demodulate_block(LIQUID_MODEM_QPSK,     0, 0); }
+void autotest_demodulate_block_qam4()      { modem_test_demodulate_block(LIQUID_MODEM_QAM4,     0, 0); }
+void autotest_demodulate_block_qam16()     { modem_test_demodulate_block(LIQUID_MODEM_QAM16,    0, 0); }
+void autotest_demodulate_block_qam64()     { modem_test_demodulate_block(LIQUID_MODEM_QAM64,    0, 0); }
+void autotest_demodulate_block_qam256()    { modem_test_demodulate_block(LIQUID_MODEM_QAM256,   0, 0); }
+void autotest_demodulate_block_qam32()     { modem_test_demodulate_block(LIQUID_MODEM_QAM32,    0, 0); }
+void autotest_demodulate_block_psk8()      { modem_test_demodulate_block(LIQUID_MODEM_PSK8,     0, 0); }
+void autotest_demodulate_block_arb16opt()  { modem_test_demodulate_block(LIQUID_MODEM_ARB16OPT, 0, 0); }
+void autotest_demodulate_block_qpsk_no_avx2()  { modem_test_demodulate_block(LIQUID_MODEM_QPSK,  0, 1); }
+void autotest_demodulate_block_qam16_no_avx2() { modem_test_demodulate_block(LIQUID_MODEM_QAM16, 0, 1); }
+
+// AUTOTESTS: soft decision
+void autotest_demodulate_soft_block_qpsk()     { modem_test_demodulate_block(LIQUID_MODEM_QPSK,  1, 0); }
+void autotest_demodulate_soft_block_qam16()    { modem_test_demodulate_block(LIQUID_MODEM_QAM16, 1, 0); }
+void autotest_demodulate_soft_block_bpsk()     { modem_test_demodulate_block(LIQUID_MODEM_BPSK,  1, 0); }
+void autotest_demodulate_soft_block_qpsk_no_avx2() { modem_test_demodulate_block(LIQUID_MODEM_QPSK, 1, 1); }
+
@@ -100,3 +100,45 @@ void benchmark_ofdmframesync_acquire_n128   OFDMFRAMESYNC_ACQUIRE_BENCH_API(128,
 void benchmark_ofdmframesync_acquire_n256   OFDMFRAMESYNC_ACQUIRE_BENCH_API(256,32)
 void benchmark_ofdmframesync_acquire_n512   OFDMFRAMESYNC_ACQUIRE_BENCH_API(512,64)
 
+
+#define OFDMFRAMESYNC_IDLE_BENCH_API(M,CP_LEN)      \
+(   struct rusage *_start,                          \
+    struct rusage *_finish,                         \
+    unsigned long int *_num_iterations)             \
+{ ofdmframesync_idle_bench(_start, _finish, _num_iterations, M, CP_LEN); }
+
+// Helper function: seeking the PLCP in noise alone, as a receiver that runs
+// continuously does between frames
+void ofdmframesync_idle_bench(struct rusage *_start,
+                              struct rusage *_finish,
+                              unsigned long int *_num_iterations,
+                              unsigned int _num_subcarriers,
+                              unsigned int _cp_len)
+{
+    // options
+    unsigned int M           = _num_subcarriers;
+    unsigned int cp_len      = _cp_len;
+    unsigned int num_samples = 1024;
+
+    ofdmframesync fs = ofdmframesync_create(M,cp_len,0,NULL,NULL,NULL);
+
+    unsigned int i;
+    float complex y[num_samples];
+    for (i=0; i<num_samples; i++)
+        y[i] = 0.02f*randnf()*cexpf(_Complex_I*2*M_PI*randf());
+
+    // start trials
+    *_num_iterations /= 40;
+    getrusage(RUSAGE_SELF, _start);
+    for (i=0; i<(*_num_iterations); i++)
+        ofdmframesync_execute(fs,y,num_samples);
+    getrusage(RUSAGE_SELF, _finish);
+    *_num_iterations *= num_samples;
+
+    ofdmframesync_destroy(fs);
+}
+
+//
+void benchmark_ofdmframesync_idle_n64       OFDMFRAMESYNC_IDLE_BENCH_API(64, 8)
+void benchmark_ofdmframesync_idle_n128      OFDMFRAMESYNC_IDLE_BENCH_API(128,16)
+void benchmark_ofdmframesync_idle_n256      OFDMFRAMESYNC_IDLE_BENCH_API(256,32)
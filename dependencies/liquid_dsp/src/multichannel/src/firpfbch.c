@@ -121,15 +121,14 @@ FIRPFBCH() FIRPFBCH(_create)(int          _type,
     }
 
     // allocate memory for buffers
-    // TODO : use fftw_malloc if HAVE_FFTW3_H
-    q->x = (T*) malloc((q->num_channels)*sizeof(T));
-    q->X = (T*) malloc((q->num_channels)*sizeof(T));
+    q->x = (T*) FFT_MALLOC((q->num_channels)*sizeof(T));
+    q->X = (T*) FFT_MALLOC((q->num_channels)*sizeof(T));
 
     // create fft plan
     if (q->type == LIQUID_ANALYZER)
-        q->fft = FFT_CREATE_PLAN(q->num_channels, q->X, q->x, FFT_DIR_FORWARD, FFT_METHOD);
+        q->fft = FFT_CREATE_PLAN_SHARED(q->num_channels, q->X, q->x, FFT_DIR_FORWARD);
     else
-        q->fft = FFT_CREATE_PLAN(q->num_channels, q->X, q->x, FFT_DIR_BACKWARD, FFT_METHOD);
+        q->fft = FFT_CREATE_PLAN_SHARED(q->num_channels, q->X, q->x, FFT_DIR_BACKWARD);
 
     // reset filterbank object
     FIRPFBCH(_reset)(q);
@@ -266,12 +265,12 @@ void FIRPFBCH(_destroy)(FIRPFBCH() _q)
     free(_q->w);
 
     // free transform object
-    FFT_DESTROY_PLAN(_q->fft);
+    FFT_DESTROY_PLAN_SHARED(_q->fft);
 
     // free additional arrays
     free(_q->h);
-    free(_q->x);
-    free(_q->X);
+    FFT_FREE(_q->x);
+    FFT_FREE(_q->X);
 
     // free main object memory
     free(_q);
@@ -318,7 +317,7 @@ void FIRPFBCH(_synthesizer_execute)(FIRPFBCH() _q,
     memmove(_q->X, _x, _q->num_channels*sizeof(TI));
 
     // execute inverse DFT, store result in buffer 'x'
-    FFT_EXECUTE(_q->fft);
+    FFT_EXECUTE_SHARED(_q->fft, _q->X, _q->x);
 
     // push samples into filter bank and execute
     T * r;      // read pointer
@@ -399,7 +398,7 @@ void FIRPFBCH(_analyzer_run)(FIRPFBCH() _q,
     }
 
     // execute DFT, store result in buffer 'x'
-    FFT_EXECUTE(_q->fft);
+    FFT_EXECUTE_SHARED(_q->fft, _q->X, _q->x);
 
     // move to output array
     memmove(_y, _q->x, _q->num_channels*sizeof(TO));
@@ -106,10 +106,9 @@ FIRPFBCH2() FIRPFBCH2(_create)(int          _type,
     }
 
     // create FFT plan (inverse transform)
-    // TODO : use fftw_malloc if HAVE_FFTW3_H
-    q->X = (T*) malloc((q->M)*sizeof(T));   // IFFT input
-    q->x = (T*) malloc((q->M)*sizeof(T));   // IFFT output
-    q->ifft = FFT_CREATE_PLAN(q->M, q->X, q->x, FFT_DIR_BACKWARD, FFT_METHOD);
+    q->X = (T*) FFT_MALLOC((q->M)*sizeof(T));   // IFFT input
+    q->x = (T*) FFT_MALLOC((q->M)*sizeof(T));   // IFFT output
+    q->ifft = FFT_CREATE_PLAN_SHARED(q->M, q->X, q->x, FFT_DIR_BACKWARD);
 
     // create buffer objects
     q->w0 = (WINDOW()*) malloc((q->M)*sizeof(WINDOW()));
@@ -190,9 +189,9 @@ void FIRPFBCH2(_destroy)(FIRPFBCH2() _q)
     free(_q->dp);
 
     // free transform object and arrays
-    FFT_DESTROY_PLAN(_q->ifft);
-    free(_q->X);
-    free(_q->x);
+    FFT_DESTROY_PLAN_SHARED(_q->ifft);
+    FFT_FREE(_q->X);
+    FFT_FREE(_q->x);
     
     // free window objects (buffers)
     for (i=0; i<_q->M; i++) {
@@ -268,7 +267,7 @@ void FIRPFBCH2(_execute_analyzer)(FIRPFBCH2() _q,
     }
 
     // execute IFFT, store result in buffer 'x'
-    FFT_EXECUTE(_q->ifft);
+    FFT_EXECUTE_SHARED(_q->ifft, _q->X, _q->x);
 
     // scale result by 1/num_channels (C transform)
     for (i=0; i<_q->M; i++)
@@ -291,7 +290,7 @@ void FIRPFBCH2(_execute_synthesizer)(FIRPFBCH2() _q,
     memmove(_q->X, _x, _q->M * sizeof(TI));
 
     // execute IFFT, store result in buffer 'x'
-    FFT_EXECUTE(_q->ifft);
+    FFT_EXECUTE_SHARED(_q->ifft, _q->X, _q->x);
 
     // TODO: ignore this scaling
     // scale result by 1/num_channels (C transform)
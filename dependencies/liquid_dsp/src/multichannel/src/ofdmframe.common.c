@@ -33,7 +33,7 @@
 //  _p      :   subcarrier allocation array
 //  _M      :   total number of subcarriers
 //  _S0     :   output symbol (freq)
-//  _s0     :   output symbol (time)
+//  _s0     :   output symbol (time), NULL to skip the transform
 //  _M_S0   :   total number of enabled subcarriers in S0
 void ofdmframe_init_S0(unsigned char * _p,
                        unsigned int    _M,
@@ -87,6 +87,10 @@ void ofdmframe_init_S0(unsigned char * _p,
     // set return value(s)
     *_M_S0 = M_S0;
 
+    // caller computes the time-domain sequence itself
+    if (_s0 == NULL)
+        return;
+
     // run inverse fft to get time-domain sequence
     fft_run(_M, _S0, _s0, LIQUID_FFT_BACKWARD, 0);
 
@@ -101,7 +105,7 @@ void ofdmframe_init_S0(unsigned char * _p,
 //  _p      :   subcarrier allocation array
 //  _M      :   total number of subcarriers
 //  _S1     :   output symbol (freq)
-//  _s1     :   output symbol (time)
+//  _s1     :   output symbol (time), NULL to skip the transform
 //  _M_S1   :   total number of enabled subcarriers in S1
 void ofdmframe_init_S1(unsigned char * _p,
                        unsigned int    _M,
@@ -154,6 +158,10 @@ void ofdmframe_init_S1(unsigned char * _p,
     // set return value(s)
     *_M_S1 = M_S1;
 
+    // caller computes the time-domain sequence itself
+    if (_s1 == NULL)
+        return;
+
     // run inverse fft to get time-domain sequence
     fft_run(_M, _S1, _s1, LIQUID_FFT_BACKWARD, 0);
 
@@ -130,9 +130,9 @@ ofdmframegen ofdmframegen_create(unsigned int    _M,
     unsigned int i;
 
     // allocate memory for transform objects
-    q->X = (float complex*) malloc((q->M)*sizeof(float complex));
-    q->x = (float complex*) malloc((q->M)*sizeof(float complex));
-    q->ifft = FFT_CREATE_PLAN(q->M, q->X, q->x, FFT_DIR_BACKWARD, FFT_METHOD);
+    q->X = (float complex*) FFT_MALLOC((q->M)*sizeof(float complex));
+    q->x = (float complex*) FFT_MALLOC((q->M)*sizeof(float complex));
+    q->ifft = FFT_CREATE_PLAN_SHARED(q->M, q->X, q->x, FFT_DIR_BACKWARD);
 
     // allocate memory for PLCP arrays
     q->S0 = (float complex*) malloc((q->M)*sizeof(float complex));
@@ -174,9 +174,9 @@ void ofdmframegen_destroy(ofdmframegen _q)
     free(_q->p);
 
     // free transform array memory
-    free(_q->X);
-    free(_q->x);
-    FFT_DESTROY_PLAN(_q->ifft);
+    FFT_FREE(_q->X);
+    FFT_FREE(_q->x);
+    FFT_DESTROY_PLAN_SHARED(_q->ifft);
 
     // free tapering window and transition buffer
     free(_q->taper);
@@ -218,6 +218,55 @@ void ofdmframegen_reset(ofdmframegen _q)
         _q->postfix[i] = 0.0f;
 }
 
+// change the subcarrier allocation in place, re-computing only what
+// depends on it: subcarrier counts, PLCP sequences and data gain. The
+// transform plan and buffers are kept; call between frames.
+//  _q      :   OFDM frame generator object
+//  _p      :   subcarrier allocation (null, pilot, data), [size: _M x 1]
+void ofdmframegen_set_allocation(ofdmframegen    _q,
+                                 unsigned char * _p)
+{
+    // validate and count subcarrier allocation
+    unsigned int M_null, M_pilot, M_data;
+    ofdmframe_validate_sctype(_p, _q->M, &M_null, &M_pilot, &M_data);
+    if ( (M_pilot + M_data) == 0) {
+        fprintf(stderr,"error: ofdmframegen_set_allocation(), must have at least one enabled subcarrier\n");
+        exit(1);
+    } else if (M_data == 0) {
+        fprintf(stderr,"error: ofdmframegen_set_allocation(), must have at least one data subcarriers\n");
+        exit(1);
+    } else if (M_pilot < 2) {
+        fprintf(stderr,"error: ofdmframegen_set_allocation(), must have at least two pilot subcarriers\n");
+        exit(1);
+    }
+
+    memmove(_q->p, _p, _q->M*sizeof(unsigned char));
+    _q->M_null  = M_null;
+    _q->M_pilot = M_pilot;
+    _q->M_data  = M_data;
+
+    // PLCP sequences, transformed with this object's inverse transform
+    // rather than a newly planned one
+    unsigned int i;
+    float g;
+    ofdmframe_init_S0(_q->p, _q->M, _q->S0, NULL, &_q->M_S0);
+    memmove(_q->X, _q->S0, _q->M*sizeof(float complex));
+    FFT_EXECUTE_SHARED(_q->ifft, _q->X, _q->x);
+    g = 1.0f / sqrtf(_q->M_S0);
+    for (i=0; i<_q->M; i++)
+        _q->s0[i] = _q->x[i] * g;
+
+    ofdmframe_init_S1(_q->p, _q->M, _q->S1, NULL, &_q->M_S1);
+    memmove(_q->X, _q->S1, _q->M*sizeof(float complex));
+    FFT_EXECUTE_SHARED(_q->ifft, _q->X, _q->x);
+    g = 1.0f / sqrtf(_q->M_S1);
+    for (i=0; i<_q->M; i++)
+        _q->s1[i] = _q->x[i] * g;
+
+    // compute scaling factor
+    _q->g_data = 1.0f / sqrtf(_q->M_pilot + _q->M_data);
+}
+
 // write first PLCP short sequence 'symbol' to buffer
 //
 //  |<- 2*cp->|<-       M       ->|<-       M       ->|
@@ -301,7 +350,7 @@ void ofdmframegen_writesymbol(ofdmframegen    _q,
     }
 
     // execute transform
-    FFT_EXECUTE(_q->ifft);
+    FFT_EXECUTE_SHARED(_q->ifft, _q->X, _q->x);
 
     // copy result to output, adding cyclic prefix and tapering window
     ofdmframegen_gensymbol(_q, _y);
@@ -31,6 +31,10 @@
 
 #include "liquid.internal.h"
 
+#if LIQUID_AVX2
+#include <immintrin.h>
+#endif
+
 #define DEBUG_OFDMFRAMESYNC             1
 #define DEBUG_OFDMFRAMESYNC_PRINT       0
 #define DEBUG_OFDMFRAMESYNC_FILENAME    "ofdmframesync_internal_debug.m"
@@ -38,6 +42,12 @@
 
 #define OFDMFRAMESYNC_ENABLE_SQUELCH    0
 
+// While seeking the PLCP, the transform-based short-sequence metric only
+// runs on windows whose delay-and-correlate metric (normalized to [0,1])
+// exceeds this; noise alone rarely does, so an idle receiver skips nearly
+// every transform
+#define OFDMFRAMESYNC_PLCP_GATE_THRESH  (0.20f)
+
 struct ofdmframesync_s {
     unsigned int M;         // number of subcarriers
     unsigned int M2;        // number of subcarriers (divided by 2)
@@ -107,6 +117,8 @@ struct ofdmframesync_s {
     // detection thresholds
     float plcp_detect_thresh;   // plcp detection threshold, nominally 0.35
     float plcp_sync_thresh;     // long symbol threshold, nominally 0.30
+    float plcp_gate_thresh;     // delay-and-correlate gate on plcp detection
+    int   avx2;                 // use AVX2 kernels?
 
     // callback
     ofdmframesync_callback callback;
@@ -181,9 +193,9 @@ ofdmframesync ofdmframesync_create(unsigned int           _M,
     }
 
     // create transform object
-    q->X = (float complex*) malloc((q->M)*sizeof(float complex));
-    q->x = (float complex*) malloc((q->M)*sizeof(float complex));
-    q->fft = FFT_CREATE_PLAN(q->M, q->x, q->X, FFT_DIR_FORWARD, FFT_METHOD);
+    q->X = (float complex*) FFT_MALLOC((q->M)*sizeof(float complex));
+    q->x = (float complex*) FFT_MALLOC((q->M)*sizeof(float complex));
+    q->fft = FFT_CREATE_PLAN_SHARED(q->M, q->x, q->X, FFT_DIR_FORWARD);
  
     // create input buffer the length of the transform
     q->input_buffer = windowcf_create(q->M + q->cp_len);
@@ -243,6 +255,9 @@ ofdmframesync ofdmframesync_create(unsigned int           _M,
     q->squelch_enabled = 0;
 #endif
 
+    // select the S0 autocorrelation kernel once
+    q->avx2 = liquid_avx2_enabled();
+
     // reset object
     ofdmframesync_reset(q);
 
@@ -285,9 +300,9 @@ void ofdmframesync_destroy(ofdmframesync _q)
 
     // free transform object
     windowcf_destroy(_q->input_buffer);
-    free(_q->X);
-    free(_q->x);
-    FFT_DESTROY_PLAN(_q->fft);
+    FFT_FREE(_q->X);
+    FFT_FREE(_q->x);
+    FFT_DESTROY_PLAN_SHARED(_q->fft);
 
     // clean up PLCP arrays
     free(_q->S0);
@@ -342,25 +357,117 @@ void ofdmframesync_reset(ofdmframesync _q)
     // set thresholds (increase for small number of subcarriers)
     _q->plcp_detect_thresh = (_q->M > 44) ? 0.35f : 0.35f + 0.01f*(44 - _q->M);
     _q->plcp_sync_thresh   = (_q->M > 44) ? 0.30f : 0.30f + 0.01f*(44 - _q->M);
+    _q->plcp_gate_thresh   = OFDMFRAMESYNC_PLCP_GATE_THRESH;
 
     // reset state
     _q->state = OFDMFRAMESYNC_STATE_SEEKPLCP;
 }
 
+// change the subcarrier allocation in place, re-computing only what
+// depends on it: subcarrier counts, PLCP sequences and gains. The
+// transform plan, buffers and synchronizer objects are kept. Any frame
+// being received is dropped; call between frames.
+//  _q      :   OFDM frame synchronizer object
+//  _p      :   subcarrier allocation (null, pilot, data), [size: _M x 1]
+void ofdmframesync_set_allocation(ofdmframesync   _q,
+                                  unsigned char * _p)
+{
+    // validate and count subcarrier allocation
+    unsigned int M_null, M_pilot, M_data;
+    ofdmframe_validate_sctype(_p, _q->M, &M_null, &M_pilot, &M_data);
+    if ( (M_pilot + M_data) == 0) {
+        fprintf(stderr,"error: ofdmframesync_set_allocation(), must have at least one enabled subcarrier\n");
+        exit(1);
+    } else if (M_data == 0) {
+        fprintf(stderr,"error: ofdmframesync_set_allocation(), must have at least one data subcarriers\n");
+        exit(1);
+    } else if (M_pilot < 2) {
+        fprintf(stderr,"error: ofdmframesync_set_allocation(), must have at least two pilot subcarriers\n");
+        exit(1);
+    }
+
+    memmove(_q->p, _p, _q->M*sizeof(unsigned char));
+    _q->M_null  = M_null;
+    _q->M_pilot = M_pilot;
+    _q->M_data  = M_data;
+
+    // PLCP sequences; the time-domain sequences come from this object's
+    // forward transform, ifft(S) = conj(fft(conj(S)))
+    unsigned int i;
+    float g;
+    ofdmframe_init_S0(_q->p, _q->M, _q->S0, NULL, &_q->M_S0);
+    for (i=0; i<_q->M; i++)
+        _q->x[i] = conjf(_q->S0[i]);
+    FFT_EXECUTE_SHARED(_q->fft, _q->x, _q->X);
+    g = 1.0f / sqrtf(_q->M_S0);
+    for (i=0; i<_q->M; i++)
+        _q->s0[i] = conjf(_q->X[i]) * g;
+
+    ofdmframe_init_S1(_q->p, _q->M, _q->S1, NULL, &_q->M_S1);
+    for (i=0; i<_q->M; i++)
+        _q->x[i] = conjf(_q->S1[i]);
+    FFT_EXECUTE_SHARED(_q->fft, _q->x, _q->X);
+    g = 1.0f / sqrtf(_q->M_S1);
+    for (i=0; i<_q->M; i++)
+        _q->s1[i] = conjf(_q->X[i]) * g;
+
+    // compute scaling factor
+    _q->g_data = sqrtf(_q->M) / sqrtf(_q->M_pilot + _q->M_data);
+    _q->g_S0   = sqrtf(_q->M) / sqrtf(_q->M_S0);
+    _q->g_S1   = sqrtf(_q->M) / sqrtf(_q->M_S1);
+
+#if DEBUG_OFDMFRAMESYNC
+    // pilot polyfit buffers are sized by the number of pilots
+    if (_q->debug_objects_created) {
+        _q->px = (float*) realloc(_q->px, (_q->M_pilot)*sizeof(float));
+        _q->py = (float*) realloc(_q->py, (_q->M_pilot)*sizeof(float));
+    }
+#endif
+
+    ofdmframesync_reset(_q);
+}
+
+// is a frame being received (PLCP detected, not yet reset)?
+int ofdmframesync_is_frame_open(ofdmframesync _q)
+{
+    return _q->state != OFDMFRAMESYNC_STATE_SEEKPLCP;
+}
+
 void ofdmframesync_execute(ofdmframesync _q,
                            float complex * _x,
                            unsigned int _n)
 {
-    unsigned int i;
+    unsigned int i = 0;
     float complex x;
-    for (i=0; i<_n; i++) {
-        x = _x[i];
+    while (i < _n) {
+        // while seeking the PLCP the window is only examined every M
+        // samples, so push everything up to the next examination at once
+        if (_q->state == OFDMFRAMESYNC_STATE_SEEKPLCP) {
+            unsigned int k = (_q->timer < _q->M) ? _q->M - _q->timer : 1;
+            if (k > _n - i)
+                k = _n - i;
+            windowcf_write(_q->input_buffer, &_x[i], k);
+#if DEBUG_OFDMFRAMESYNC
+            if (_q->debug_enabled) {
+                unsigned int j;
+                for (j=i; j<i+k; j++) {
+                    windowcf_push(_q->debug_x, _x[j]);
+                    windowf_push(_q->debug_rssi, crealf(_x[j])*crealf(_x[j]) + cimagf(_x[j])*cimagf(_x[j]));
+                }
+            }
+#endif
+            // execute_seekplcp() counts the last sample
+            _q->timer += k - 1;
+            i += k;
+            ofdmframesync_execute_seekplcp(_q);
+            continue;
+        }
+
+        x = _x[i++];
 
         // correct for carrier frequency offset
-        if (_q->state != OFDMFRAMESYNC_STATE_SEEKPLCP) {
-            nco_crcf_mix_down(_q->nco_rx, x, &x);
-            nco_crcf_step(_q->nco_rx);
-        }
+        nco_crcf_mix_down(_q->nco_rx, x, &x);
+        nco_crcf_step(_q->nco_rx);
 
         // save input sample to buffer
         windowcf_push(_q->input_buffer,x);
@@ -373,9 +480,6 @@ void ofdmframesync_execute(ofdmframesync _q,
 #endif
 
         switch (_q->state) {
-        case OFDMFRAMESYNC_STATE_SEEKPLCP:
-            ofdmframesync_execute_seekplcp(_q);
-            break;
         case OFDMFRAMESYNC_STATE_PLCPSHORT0:
             ofdmframesync_execute_S0a(_q);
             break;
@@ -391,7 +495,7 @@ void ofdmframesync_execute(ofdmframesync _q,
         default:;
         }
 
-    } // for (i=0; i<_n; i++)
+    } // while (i < _n)
 } // ofdmframesync_execute()
 
 // get receiver RSSI
@@ -426,14 +530,16 @@ void ofdmframesync_execute_seekplcp(ofdmframesync _q)
     float complex * rc;
     windowcf_read(_q->input_buffer, &rc);
 
-    // estimate gain
-    unsigned int i;
-    float g = 0.0f;
-    for (i=_q->cp_len; i<_q->M + _q->cp_len; i++) {
-        // compute |rc[i]|^2 efficiently
-        g += crealf(rc[i])*crealf(rc[i]) + cimagf(rc[i])*cimagf(rc[i]);
-    }
-    g = (float)(_q->M) / g;
+    // delay-and-correlate metric and gain over the window
+    float complex r;
+    float e;
+#if LIQUID_AVX2
+    if (_q->avx2)
+        ofdmframesync_S0_autocorr_avx2(&rc[_q->cp_len], _q->M2, &r, &e);
+    else
+#endif
+        ofdmframesync_S0_autocorr(&rc[_q->cp_len], _q->M2, &r, &e);
+    float g = (float)(_q->M) / e;
 
 #if OFDMFRAMESYNC_ENABLE_SQUELCH
     // TODO : squelch here
@@ -445,6 +551,13 @@ void ofdmframesync_execute_seekplcp(ofdmframesync _q)
     }
 #endif
 
+    // save gain (permits dynamic invocation of get_rssi() method)
+    _q->g0 = g;
+
+    // the window holds no short sequence if its halves barely correlate
+    if (2.0f*cabsf(r) < _q->plcp_gate_thresh * e)
+        return;
+
     // estimate S0 gain
     ofdmframesync_estimate_gain_S0(_q, &rc[_q->cp_len], _q->G0);
 
@@ -461,9 +574,6 @@ void ofdmframesync_execute_seekplcp(ofdmframesync _q)
             tau_hat);
 #endif
 
-    // save gain (permits dynamic invocation of get_rssi() method)
-    _q->g0 = g;
-
     // 
     if (cabsf(s_hat) > _q->plcp_detect_thresh) {
 
@@ -719,7 +829,7 @@ void ofdmframesync_execute_rxsymbols(ofdmframesync _q)
         float complex * rc;
         windowcf_read(_q->input_buffer, &rc);
         memmove(_q->x, &rc[_q->cp_len-_q->backoff], (_q->M)*sizeof(float complex));
-        FFT_EXECUTE(_q->fft);
+        FFT_EXECUTE_SHARED(_q->fft, _q->x, _q->X);
 
         // recover symbol in internal _q->X buffer
         ofdmframesync_rxsymbol(_q);
@@ -768,6 +878,80 @@ void ofdmframesync_S0_metrics(ofdmframesync _q,
     *_s_hat = s_hat;
 }
 
+// delay-and-correlate metric of the short sequence
+//  _x      :   input array (time), [size: 2*_n x 1]
+//  _n      :   correlation lag (half the window)
+//  _r      :   output correlation of first half with second
+//  _e      :   output energy of both halves
+void ofdmframesync_S0_autocorr(float complex * _x,
+                               unsigned int    _n,
+                               float complex * _r,
+                               float *         _e)
+{
+    unsigned int i;
+    float complex r = 0.0f;
+    float e = 0.0f;
+    for (i=0; i<_n; i++) {
+        float complex a = _x[i];
+        float complex b = _x[i+_n];
+        r += a * conjf(b);
+        // compute |a|^2 + |b|^2 efficiently
+        e += crealf(a)*crealf(a) + cimagf(a)*cimagf(a) +
+             crealf(b)*crealf(b) + cimagf(b)*cimagf(b);
+    }
+    *_r = r;
+    *_e = e;
+}
+
+#if LIQUID_AVX2
+// delay-and-correlate metric, four samples of each half at a time
+LIQUID_AVX2_TARGET
+void ofdmframesync_S0_autocorr_avx2(float complex * _x,
+                                    unsigned int    _n,
+                                    float complex * _r,
+                                    float *         _e)
+{
+    __m256 acc_re = _mm256_setzero_ps();    // ar*br, ai*bi
+    __m256 acc_im = _mm256_setzero_ps();    // ar*bi, ai*br
+    __m256 acc_e  = _mm256_setzero_ps();
+    unsigned int i;
+    for (i=0; i+4<=_n; i+=4) {
+        __m256 a = _mm256_loadu_ps((float*)&_x[i]);
+        __m256 b = _mm256_loadu_ps((float*)&_x[i+_n]);
+        __m256 b_swap = _mm256_permute_ps(b, _MM_SHUFFLE(2,3,0,1));
+        acc_re = _mm256_fmadd_ps(a, b,      acc_re);
+        acc_im = _mm256_fmadd_ps(a, b_swap, acc_im);
+        acc_e  = _mm256_fmadd_ps(a, a,      acc_e);
+        acc_e  = _mm256_fmadd_ps(b, b,      acc_e);
+    }
+
+    // a*conj(b) : real = ar*br + ai*bi, imag = ai*br - ar*bi
+    float v_re[8], v_im[8], v_e[8];
+    _mm256_storeu_ps(v_re, acc_re);
+    _mm256_storeu_ps(v_im, acc_im);
+    _mm256_storeu_ps(v_e,  acc_e);
+    float r_re = 0.0f, r_im = 0.0f, e = 0.0f;
+    unsigned int j;
+    for (j=0; j<8; j+=2) {
+        r_re += v_re[j] + v_re[j+1];
+        r_im += v_im[j+1] - v_im[j];
+        e    += v_e[j]  + v_e[j+1];
+    }
+
+    // remaining samples
+    float complex r = r_re + _Complex_I*r_im;
+    for (; i<_n; i++) {
+        float complex a = _x[i];
+        float complex b = _x[i+_n];
+        r += a * conjf(b);
+        e += crealf(a)*crealf(a) + cimagf(a)*cimagf(a) +
+             crealf(b)*crealf(b) + cimagf(b)*cimagf(b);
+    }
+    *_r = r;
+    *_e = e;
+}
+#endif
+
 // estimate short sequence gain
 //  _q      :   ofdmframesync object
 //  _x      :   input array (time), [size: M x 1]
@@ -780,7 +964,7 @@ void ofdmframesync_estimate_gain_S0(ofdmframesync   _q,
     memmove(_q->x, _x, (_q->M)*sizeof(float complex));
 
     // compute fft, storing result into _q->X
-    FFT_EXECUTE(_q->fft);
+    FFT_EXECUTE_SHARED(_q->fft, _q->x, _q->X);
     
     // compute gain, ignoring NULL subcarriers
     unsigned int i;
@@ -813,7 +997,7 @@ void ofdmframesync_estimate_gain_S1(ofdmframesync _q,
     memmove(_q->x, _x, (_q->M)*sizeof(float complex));
 
     // compute fft, storing result into _q->X
-    FFT_EXECUTE(_q->fft);
+    FFT_EXECUTE_SHARED(_q->fft, _q->x, _q->X);
     
     // compute gain, ignoring NULL subcarriers
     unsigned int i;
@@ -857,7 +1041,7 @@ void ofdmframesync_estimate_eqgain(ofdmframesync _q,
     // generate smoothing window (fft of temporal window)
     for (i=0; i<_q->M; i++)
         _q->x[i] = (i < _ntaps) ? 1.0f : 0.0f;
-    FFT_EXECUTE(_q->fft);
+    FFT_EXECUTE_SHARED(_q->fft, _q->x, _q->X);
 
     memmove(_q->G0, _q->G, _q->M*sizeof(float complex));
 
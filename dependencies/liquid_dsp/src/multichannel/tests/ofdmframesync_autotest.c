@@ -140,3 +140,84 @@ void autotest_ofdmframesync_acquire_n128()  { ofdmframesync_acquire_test(128, 16
 void autotest_ofdmframesync_acquire_n256()  { ofdmframesync_acquire_test(256, 32, 0); }
 void autotest_ofdmframesync_acquire_n512()  { ofdmframesync_acquire_test(512, 64, 0); }
 
+
+// count acquired frames; resetting the synchronizer after the first
+// symbol of each
+static int ofdmframesync_autotest_count_callback(float complex * _X,
+                                                 unsigned char * _p,
+                                                 unsigned int    _M,
+                                                 void *          _userdata)
+{
+    unsigned int * num_acquired = (unsigned int *)_userdata;
+    (*num_acquired)++;
+    return 1;
+}
+
+// Helper function: frames in noise behind random lengths of noise alone,
+// fed to the synchronizer in uneven blocks; each frame must be acquired
+// and nothing else
+//  _num_subcarriers    :   number of subcarriers
+//  _no_avx2            :   force the portable kernels?
+void ofdmframesync_acquire_noise_test(unsigned int _num_subcarriers,
+                                      int          _no_avx2)
+{
+    unsigned int M          = _num_subcarriers;
+    unsigned int cp_len     = M / 8;
+    unsigned int num_frames = 20;
+    float        SNRdB      = 6.0f;
+    unsigned int symbol_len = M + cp_len;
+
+    if (_no_avx2)
+        setenv("LIQUID_NO_AVX2", "1", 1);
+
+    float nstd = powf(10.0f, -SNRdB/20.0f);
+    unsigned int num_acquired = 0;
+    ofdmframegen  fg = ofdmframegen_create(M, cp_len, 0, NULL);
+    ofdmframesync fs = ofdmframesync_create(M, cp_len, 0, NULL,
+                           ofdmframesync_autotest_count_callback, (void*)&num_acquired);
+
+    // noise, then S0 (twice), S1 and a data symbol, then more noise
+    unsigned int num_symbols = 10;
+    unsigned int num_samples = num_symbols*symbol_len;
+    float complex y[num_samples];
+    float complex X[M];
+    unsigned int i, f;
+    for (f=0; f<num_frames; f++) {
+        unsigned int n = (3 + (f % 3))*symbol_len + (7*f) % symbol_len;
+        memset(y, 0, num_samples*sizeof(float complex));
+        ofdmframegen_reset(fg);
+        ofdmframegen_write_S0a(fg, &y[n]);  n += symbol_len;
+        ofdmframegen_write_S0b(fg, &y[n]);  n += symbol_len;
+        ofdmframegen_write_S1( fg, &y[n]);  n += symbol_len;
+        for (i=0; i<M; i++)
+            X[i] = (rand() % 2) ? 1.0f : -1.0f;
+        ofdmframegen_writesymbol(fg, X, &y[n]);
+
+        for (i=0; i<num_samples; i++)
+            y[i] += nstd*(randnf() + _Complex_I*randnf())*M_SQRT1_2;
+
+        // push through in uneven blocks
+        for (i=0; i<num_samples; ) {
+            unsigned int k = 1 + rand() % (2*M);
+            if (k > num_samples - i)
+                k = num_samples - i;
+            ofdmframesync_execute(fs, &y[i], k);
+            i += k;
+        }
+    }
+
+    if (liquid_autotest_verbose)
+        printf("  acquired %u / %u frames\n", num_acquired, num_frames);
+    CONTEND_EQUALITY( num_acquired, num_frames );
+
+    if (_no_avx2)
+        unsetenv("LIQUID_NO_AVX2");
+
+    ofdmframegen_destroy(fg);
+    ofdmframesync_destroy(fs);
+}
+
+void autotest_ofdmframesync_acquire_noise_n64()         { ofdmframesync_acquire_noise_test(64,  0); }
+void autotest_ofdmframesync_acquire_noise_n256()        { ofdmframesync_acquire_noise_test(256, 0); }
+void autotest_ofdmframesync_acquire_noise_n64_noavx2()  { ofdmframesync_acquire_noise_test(64,  1); }
+void autotest_ofdmframesync_acquire_noise_n256_noavx2() { ofdmframesync_acquire_noise_test(256, 1); }
@@ -53,6 +53,9 @@ public:
     // accessor methods
     unsigned int GetNumChannels() { return num_channels; }
 
+    // enable/disable soft-decision payload decoding on all channels
+    void SetPayloadSoft(int _soft);
+
     // push samples into base station receiver
     void Execute(std::complex<float> * _x,
                  unsigned int          _num_samples);
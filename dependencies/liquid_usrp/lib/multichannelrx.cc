@@ -152,6 +152,14 @@ void multichannelrx::Reset()
     buffer_index = 0;
 }
 
+// enable/disable soft-decision payload decoding
+void multichannelrx::SetPayloadSoft(int _soft)
+{
+    unsigned int i;
+    for (i=0; i<num_channels; i++)
+        ofdmflexframesync_set_payload_soft(framesync[i], _soft);
+}
+
 void multichannelrx::Execute(std::complex<float> * _x,
                                   unsigned int          _num_samples)
 {
@@ -0,0 +1,220 @@
+/* AllocTracker.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <execinfo.h>
+
+#include "AllocTracker.h"
+
+using namespace std;
+
+#define ALLOC_REGION_NONE                           -1
+
+static const char* alloc_region_names[ALLOC_REGION_NUM] = {
+    "rx loop",
+    "tx burst",
+    "callback",
+    "reconfigure"
+};
+
+// Zero-initialized before any constructor runs, so allocations made during
+// static initialization are safe to count
+static std::atomic<unsigned long> region_passes[ALLOC_REGION_NUM];
+static std::atomic<unsigned long> region_allocs[ALLOC_REGION_NUM];
+static std::atomic<unsigned long> region_bytes[ALLOC_REGION_NUM];
+static std::atomic<unsigned long> region_steady_allocs[ALLOC_REGION_NUM];
+static size_t first_steady_size[ALLOC_REGION_NUM];
+static void* first_steady_frames[ALLOC_REGION_NUM][ALLOC_TRACKER_BACKTRACE_DEPTH];
+static int first_steady_depth[ALLOC_REGION_NUM];
+
+static __thread int current_region = ALLOC_REGION_NONE;
+// Set while an allocation is being recorded; backtrace() allocates the
+// first time it is called
+static __thread bool recording = false;
+
+AllocRegion::AllocRegion(
+        AllocRegionType type
+        )
+{
+    previous_region = current_region;
+    current_region = type;
+    region_passes[type]++;
+}
+//////////////////////////////////////////////////////////////////////////
+
+AllocRegion::~AllocRegion()
+{
+    current_region = previous_region;
+}
+//////////////////////////////////////////////////////////////////////////
+
+static inline void recordAllocation(size_t size)
+{
+    int region = current_region;
+    if ((region == ALLOC_REGION_NONE) || recording)
+        return;
+
+    recording = true;
+    region_allocs[region]++;
+    region_bytes[region] += size;
+    if ((region != ALLOC_REGION_RECONFIGURE) &&
+            (region_passes[region] > ALLOC_TRACKER_WARMUP_PASSES)) {
+        if (region_steady_allocs[region]++ == 0) {
+            first_steady_size[region] = size;
+            first_steady_depth[region] = backtrace(first_steady_frames[region],
+                    ALLOC_TRACKER_BACKTRACE_DEPTH);
+        }
+    }
+    recording = false;
+}
+//////////////////////////////////////////////////////////////////////////
+
+unsigned long AllocTracker::getSteadyStateAllocations()
+{
+    unsigned long total = 0;
+    for (int i = 0; i < ALLOC_REGION_NUM; i++)
+        total += region_steady_allocs[i];
+    return(total);
+}
+//////////////////////////////////////////////////////////////////////////
+
+unsigned long AllocTracker::report(
+        std::ostream& os
+        )
+{
+    os << "Heap allocations by region (the first " << ALLOC_TRACKER_WARMUP_PASSES;
+    os << " passes of each are warm-up):" << endl;
+    os << "  " << setw(12) << left << "region" << right;
+    os << setw(12) << "passes" << setw(12) << "allocs";
+    os << setw(14) << "bytes" << setw(14) << "steady state" << endl;
+    for (int i = 0; i < ALLOC_REGION_NUM; i++) {
+        os << "  " << setw(12) << left << alloc_region_names[i] << right;
+        os << setw(12) << region_passes[i] << setw(12) << region_allocs[i];
+        os << setw(14) << region_bytes[i] << setw(14) << region_steady_allocs[i] << endl;
+    }
+
+    for (int i = 0; i < ALLOC_REGION_NUM; i++) {
+        if (region_steady_allocs[i] == 0)
+            continue;
+        os << endl << "First steady-state allocation in " << alloc_region_names[i];
+        os << " (" << first_steady_size[i] << " bytes):" << endl;
+        char** symbols = backtrace_symbols(first_steady_frames[i], first_steady_depth[i]);
+        for (int j = 0; j < first_steady_depth[i]; j++)
+            os << "  " << ((symbols != NULL) ? symbols[j] : "?") << endl;
+        free(symbols);
+    }
+
+    return(getSteadyStateAllocations());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+#if RHC_ALLOC_TRACKING
+// glibc's own entry points, which the replacements below forward to
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t num, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+extern "C" void* malloc(size_t size) throw()
+{
+    recordAllocation(size);
+    return(__libc_malloc(size));
+}
+
+extern "C" void* calloc(size_t num, size_t size) throw()
+{
+    recordAllocation(num * size);
+    return(__libc_calloc(num, size));
+}
+
+extern "C" void* realloc(void* ptr, size_t size) throw()
+{
+    recordAllocation(size);
+    return(__libc_realloc(ptr, size));
+}
+
+extern "C" void* memalign(size_t alignment, size_t size) throw()
+{
+    recordAllocation(size);
+    return(__libc_memalign(alignment, size));
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) throw()
+{
+    recordAllocation(size);
+    return(__libc_memalign(alignment, size));
+}
+
+extern "C" int posix_memalign(void** ptr, size_t alignment, size_t size) throw()
+{
+    if ((alignment % sizeof(void*) != 0) || ((alignment & (alignment - 1)) != 0))
+        return(EINVAL);
+    recordAllocation(size);
+    void* p = __libc_memalign(alignment, size);
+    if (p == NULL)
+        return(ENOMEM);
+    *ptr = p;
+    return(0);
+}
+
+static inline void* trackedNew(size_t size)
+{
+    recordAllocation(size);
+    void* p = __libc_malloc((size > 0) ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return(p);
+}
+
+void* operator new(size_t size)
+{
+    return(trackedNew(size));
+}
+
+void* operator new[](size_t size)
+{
+    return(trackedNew(size));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw()
+{
+    recordAllocation(size);
+    return(__libc_malloc((size > 0) ? size : 1));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) throw()
+{
+    recordAllocation(size);
+    return(__libc_malloc((size > 0) ? size : 1));
+}
+
+void operator delete(void* ptr) throw()
+{
+    __libc_free(ptr);
+}
+
+void operator delete[](void* ptr) throw()
+{
+    __libc_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) throw()
+{
+    __libc_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) throw()
+{
+    __libc_free(ptr);
+}
+#endif
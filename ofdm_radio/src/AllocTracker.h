@@ -0,0 +1,68 @@
+/* AllocTracker.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef ALLOCTRACKER_H_
+#define ALLOCTRACKER_H_
+
+#include <ostream>
+
+// Test builds only (make ALLOC_DEFS=-DRHC_ALLOC_TRACKING=1, see the
+// Makefile): replaces malloc, calloc, realloc, the aligned allocators and
+// operator new so that every heap allocation made while a thread is inside
+// a marked region is counted against that region.  The first
+// ALLOC_TRACKER_WARMUP_PASSES passes of each region may allocate while the
+// buffers in the chain grow to their steady-state sizes; any allocation
+// after that is a steady-state allocation, and the binaries that run the
+// chain (U4, U4_sim, U4_replay) print the report and exit non-zero.
+//
+// The per-frame logging allocates by design, so tracking runs should also
+// use the production LOG_DEFS.  In normal builds the region markers are
+// empty statements and nothing is replaced.
+#ifndef RHC_ALLOC_TRACKING
+#define RHC_ALLOC_TRACKING                          0
+#endif
+
+#define ALLOC_TRACKER_WARMUP_PASSES                 50
+// Stack frames kept for the first steady-state allocation of each region
+#define ALLOC_TRACKER_BACKTRACE_DEPTH               24
+
+typedef enum {
+    ALLOC_REGION_RX_LOOP = 0,   // one pass of run_ofdma_rx/run_mc_rx
+    ALLOC_REGION_TX_BURST,      // one data/control frame burst
+    ALLOC_REGION_CALLBACK,      // one frame synchronizer callback
+    ALLOC_REGION_RECONFIGURE,   // modem re-creation; counted, never an error
+    ALLOC_REGION_NUM
+} AllocRegionType;
+
+// Marks the rest of the enclosing scope as a region; regions nest and
+// allocations are charged to the innermost one
+#if RHC_ALLOC_TRACKING
+#define RHC_ALLOC_REGION(_type)     AllocRegion alloc_region_guard(_type)
+#else
+#define RHC_ALLOC_REGION(_type)     do {} while (0)
+#endif
+
+class AllocRegion
+{
+public:
+    AllocRegion(AllocRegionType type);
+    ~AllocRegion();
+
+private:
+    int previous_region;
+};
+
+class AllocTracker
+{
+public:
+    // Per-region passes, allocations and bytes, then a backtrace of the
+    // first steady-state allocation of each region that had one.  Returns
+    // the number of steady-state allocations.
+    static unsigned long report(std::ostream& os);
+    static unsigned long getSteadyStateAllocations();
+};
+
+
+#endif // ALLOCTRACKER_H_
@@ -0,0 +1,299 @@
+/* AntiJamController.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <unistd.h>
+
+#include "AntiJamController.h"
+
+using namespace std;
+void openNullHole(unsigned char*, int, int);
+
+AntiJamController::AntiJamController(
+        RadioConfig* rc,
+        RadioHardwareConfig* rhc,
+        RadioScheduler* rs,
+        AppManager* app,
+        Logger* app_log,
+        double time_scale
+        )
+{
+    this->rc = rc;
+    this->rhc = rhc;
+    this->rs = rs;
+    this->app = app;
+    this->app_log = app_log;
+    this->time_scale = time_scale;
+
+    last_bytes_received = 0;
+    last_idle_frames_received = 0;
+    link_idle = false;
+
+    throughput_timer = timer_create();
+    good_throughput_timer = timer_create();
+    mitigation_timer = timer_create();
+    enable_mitigation_timer = timer_create();
+    resend_alloc_timer = timer_create();
+    timer_tic(resend_alloc_timer);
+
+    sweeping = true;
+    left_edge = 0;
+    direction = 1;
+    jam_mitigation_running = false;
+    mitigation_enabled = true;
+    resuming = false;
+    check_full_band = true;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+AntiJamController::~AntiJamController()
+{
+    timer_destroy(throughput_timer);
+    timer_destroy(good_throughput_timer);
+    timer_destroy(mitigation_timer);
+    timer_destroy(enable_mitigation_timer);
+    timer_destroy(resend_alloc_timer);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double AntiJamController::elapsed(timer t)
+{
+    return(time_scale * timer_toc(t));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void AntiJamController::logReport(std::string msg)
+{
+    std::stringstream report;
+    report << scientific << app->getElapsedTime();
+    report << "    Main: ";
+    report << msg;
+    app_log->log(report.str());
+    app_log->write_log();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void AntiJamController::start()
+{
+    timer_tic(throughput_timer);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double AntiJamController::evaluateThroughput()
+{
+    long int total_bytes_received = rhc->valid_bytes_received;
+    long int difference = total_bytes_received - last_bytes_received;
+    double throughput = (difference * 8 / 1024) / elapsed(throughput_timer);
+    last_bytes_received = total_bytes_received;
+    link_idle = rc->traffic_aware && (rhc->idle_frames_received != last_idle_frames_received);
+    last_idle_frames_received = rhc->idle_frames_received;
+    timer_tic(throughput_timer);
+    return throughput;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool AntiJamController::isMitigationEnabled()
+{
+    return(mitigation_enabled);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool AntiJamController::isMitigationRunning()
+{
+    return(jam_mitigation_running);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+int AntiJamController::getLeftEdge()
+{
+    return(left_edge);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void AntiJamController::update(
+        double throughput,
+        unsigned int batch_count
+        )
+{
+    if(mitigation_enabled && rhc->valid_payloads_received > 0)
+    {
+        if(rc->anti_jam && !rc->node_is_basestation && batch_count > 3)
+        {
+            //Threshold to start or continue anti-jamming mode
+            if(throughput < rc->jamming_threshold && !link_idle)
+            {
+                if(jam_mitigation_running)
+                {
+                    //If jam mitigation has been on for 10 seconds and the throughput is still below
+                    //the threshold, turn it off since it's not working.
+                    if(elapsed(mitigation_timer) > rc->mitigation_timeout && false)
+                    {
+                        logReport("jam mitigation ineffective, resuming normal mode");
+                        std::cout << "jam mitigation ineffective, resuming normal mode" << std::endl;
+                        ofdmframe_init_sctype(RHC_OFDMA_M, alloc, .05);
+
+                        if(rc->node_id == 1)
+                        {
+                            rhc->txMCAllocBurst(alloc);
+                        }
+                        memcpy(rhc->new_alloc, alloc, RHC_OFDMA_M);
+
+                        rhc->recreate_modem();
+
+                        jam_mitigation_running = false;
+                        //If the jammer has not been turned off, we'll want to reopen the hole
+                        //in the same place. The resuming variablre is used below to keep it from moving when
+                        //the hole initially opens back up
+                        resuming = true;
+                        direction *= -1;
+                        timer_tic(enable_mitigation_timer);
+                        mitigation_enabled = false;
+                        sweeping = false;
+                        rs->setU4ScheduleSize(40);
+                        return;
+                    }
+                }
+                //If not already sweeping, switch to anti-jam mode
+                if(!sweeping)
+                {
+                    logReport("switched to anti-jam mode");
+                    timer_tic(mitigation_timer);
+                    jam_mitigation_running = true;
+                    std::cout << "activating anti-jam mode" << std::endl;
+                }
+
+                sweeping = true;
+                rs->setU4ScheduleSize(5);
+                timer_tic(good_throughput_timer);
+            }
+            //Throughput is above threshold
+            //Jammer might be off or anti-jam mode has found jammer and is successfully mitigating
+            else
+            {
+
+                check_full_band = true;
+                timer_tic(mitigation_timer);
+                //Stop sweeping null nole
+                sweeping = false;
+                rs->setU4ScheduleSize(40);
+                //If a hole is currently open...
+                if(jam_mitigation_running)
+                {
+                    //...periodically try closing hole in case jammer has been turned off
+                    if(elapsed(good_throughput_timer) > rc->close_hole_timeout)
+                    {
+                        logReport("resuming normal mode");
+                        std::cout << "resuming normal mode" << std::endl;
+                        ofdmframe_init_sctype(RHC_OFDMA_M, alloc, .05);
+                        memcpy(rhc->new_alloc, alloc, RHC_OFDMA_M);
+                        rhc->recreate_modem();
+                        if(rc->node_id == 1)
+                        {
+                            rhc->txMCAllocBurst(alloc);
+                            rhc->txMCAllocBurst(alloc);
+                            rhc->txMCAllocBurst(alloc);
+                            rhc->txMCAllocBurst(alloc);
+                            rhc->txMCAllocBurst(alloc);
+                        }
+                        jam_mitigation_running = false;
+                        //If the jammer has not been turned off, we'll want to reopen the hole
+                        //in the same place. The resuming variablre is used below to keep it from moving when
+                        //the hole initially opens back up
+                        resuming = true;
+                        direction *= -1;
+                        rs->setU4ScheduleSize(40);
+                        usleep(.05*1000000/time_scale);
+                    }
+                }
+            }
+            if(sweeping)
+            {
+                if(check_full_band && rc->node_id > 1)
+                {
+                    ofdmframe_init_sctype(RHC_OFDMA_M, alloc, .05);
+                    memcpy(rhc->new_alloc, alloc, RHC_OFDMA_M);
+                    rhc->recreate_modem();
+                    jam_mitigation_running = false;
+                    check_full_band = false;
+                    rs->setU4ScheduleSize(10);
+                }
+                else
+                {
+                    std::stringstream msg;
+                    msg << "Repositioning null hole, left edge: " << left_edge;
+                    logReport(msg.str());
+                    std::cout << msg.str() << std::endl;
+
+                    ofdmframe_init_sctype(RHC_OFDMA_M, alloc, .05);
+                    openNullHole(alloc, left_edge, left_edge + AJC_NULL_HOLE_WIDTH);
+                    if(rc->node_id == 1)
+                    {
+                        rhc->txMCAllocBurst(alloc);
+                        rhc->txMCAllocBurst(alloc);
+                        rhc->txMCAllocBurst(alloc);
+                        rhc->txMCAllocBurst(alloc);
+                        rhc->txMCAllocBurst(alloc);
+                    }
+                    memcpy(rhc->new_alloc, alloc, RHC_OFDMA_M);
+                    rhc->recreate_modem();
+                    jam_mitigation_running = true;
+                    if(left_edge <= 0)
+                    {
+                        left_edge = 0;
+                        direction = 1;
+                        check_full_band = true;
+                    }
+                    else if(left_edge >= AJC_NULL_HOLE_MAX_LEFT_EDGE)
+                    {
+                        direction = -1;
+                        check_full_band = true;
+                    }
+                    //After a hole is opened and a jammer is found, the radio will periodically try to
+                    //fill the whole in case the jammer is gone. If it's not, we want the hole to open
+                    //again where it was before to stay right on the jammer
+                    //The resuming boolean does this
+                    if(!resuming)
+                        left_edge += (direction * AJC_NULL_HOLE_STEP);
+                    else
+                    {
+                        resuming = false;
+                        rs->setU4ScheduleSize(10);
+                    }
+
+                }
+
+            }
+        }
+    }
+    else
+    {
+        if(!rc->node_is_basestation)
+        {
+            if(elapsed(resend_alloc_timer) > 1.0 && rc->node_id == 1)
+            {
+                timer_tic(resend_alloc_timer);
+                ofdmframe_init_sctype(RHC_OFDMA_M, alloc, .05);
+                rhc->txMCAllocBurst(alloc);
+            }
+            if(elapsed(enable_mitigation_timer) > rc->mitigation_reenable_timeout)
+            {
+                std::cout << "re-enabling anti-jam mode" << std::endl;
+                mitigation_enabled = true;
+            }
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////
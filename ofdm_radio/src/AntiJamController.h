@@ -0,0 +1,91 @@
+/* AntiJamController.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef ANTIJAMCONTROLLER_H_
+#define ANTIJAMCONTROLLER_H_
+
+#include "AppManager.h"
+#include "Logger.hh"
+#include "RadioConfig.hh"
+#include "RadioHardwareConfig.h"
+#include "RadioScheduler.h"
+#include "timer.h"
+
+// Width in subcarriers of the null hole and the step it moves per batch
+#define AJC_NULL_HOLE_WIDTH                         150
+#define AJC_NULL_HOLE_STEP                          25
+#define AJC_NULL_HOLE_MAX_LEFT_EDGE                 412
+
+// Anti-jam state machine of a U4 mobile, run once per batch of scheduled
+// tasks.  When the batch throughput drops below jamming_threshold it sweeps
+// a null hole across the OFDMA allocation until throughput recovers, then
+// periodically closes the hole again in case the jammer has gone.  Node 1
+// carries every allocation change to the basestation.
+//
+// Throughput and the timeouts are measured in radio time: wall-clock time
+// multiplied by time_scale, which is 1.0 except on the loopback radio.
+class AntiJamController
+{
+public:
+    AntiJamController(
+        RadioConfig* rc,
+        RadioHardwareConfig* rhc,
+        RadioScheduler* rs,
+        AppManager* app,
+        Logger* app_log,
+        double time_scale
+    );
+    ~AntiJamController();
+
+    // Restarts the throughput measurement; call when the receiver starts
+    void start();
+    // Throughput in kbps since the previous call (or start)
+    double evaluateThroughput();
+    // One step of the state machine for a batch with the given throughput
+    void update(
+        double throughput,
+        unsigned int batch_count
+    );
+
+    bool isMitigationEnabled();
+    bool isMitigationRunning();
+    int getLeftEdge();
+
+private:
+    double elapsed(timer t);
+    void logReport(std::string msg);
+
+    RadioConfig* rc;
+    RadioHardwareConfig* rhc;
+    RadioScheduler* rs;
+    AppManager* app;
+    Logger* app_log;
+    double time_scale;
+
+    long int last_bytes_received;
+    // Traffic-aware mode: idle frames (keep-alives, empty slots) heard since
+    // the previous throughput measurement mean the link is up but has
+    // nothing to carry, so low throughput is not taken for jamming
+    unsigned int last_idle_frames_received;
+    bool link_idle;
+    unsigned char alloc[RHC_OFDMA_M];
+
+    timer throughput_timer;
+    timer good_throughput_timer;
+    timer mitigation_timer;
+    timer enable_mitigation_timer;
+    timer resend_alloc_timer;
+
+    bool sweeping;
+    int left_edge;
+    int direction;
+    bool jam_mitigation_running;
+    bool mitigation_enabled;
+    bool resuming;
+    bool check_full_band;
+};
+
+
+#endif // ANTIJAMCONTROLLER_H_
@@ -0,0 +1,180 @@
+/* ChainBench.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+#include "ChainBench.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define CHAIN_BENCH_HAS_TSC                         1
+#else
+#define CHAIN_BENCH_HAS_TSC                         0
+#endif
+
+using namespace std;
+
+static double elapsedSeconds(const struct timespec& t0, const struct timespec& t1)
+{
+    return((double)(t1.tv_sec - t0.tv_sec) + 1.0E-9 * (double)(t1.tv_nsec - t0.tv_nsec));
+}
+
+static unsigned long long readCycles()
+{
+#if CHAIN_BENCH_HAS_TSC
+    return(__rdtsc());
+#else
+    return(0);
+#endif
+}
+
+ChainBenchTimer::ChainBenchTimer()
+{
+    cycles_start = 0;
+    wall_time = 0.0;
+    cpu_time = 0.0;
+    cycles = 0.0;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ChainBenchTimer::start()
+{
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start);
+    cycles_start = readCycles();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ChainBenchTimer::stop()
+{
+    unsigned long long cycles_stop = readCycles();
+    struct timespec cpu_stop, wall_stop;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_stop);
+    clock_gettime(CLOCK_MONOTONIC, &wall_stop);
+
+    wall_time = elapsedSeconds(wall_start, wall_stop);
+    cpu_time = elapsedSeconds(cpu_start, cpu_stop);
+    cycles = (double)(cycles_stop - cycles_start);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double ChainBenchTimer::getWallTime()
+{
+    return(wall_time);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double ChainBenchTimer::getCpuTime()
+{
+    return(cpu_time);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double ChainBenchTimer::getCycles()
+{
+    return(cycles);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool ChainBenchTimer::hasCycles()
+{
+    return(CHAIN_BENCH_HAS_TSC != 0);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+ChainBenchResult::ChainBenchResult(std::string name)
+{
+    this->name = name;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ChainBenchResult::set(std::string key, double value)
+{
+    stringstream text;
+    // JSON has no representation for inf or nan
+    if (std::isfinite(value))
+        text << setprecision(8) << value;
+    else
+        text << "null";
+    fields.push_back(make_pair(key, text.str()));
+    numbers.push_back(make_pair(key, value));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ChainBenchResult::set(std::string key, std::string value)
+{
+    fields.push_back(make_pair(key, "\"" + value + "\""));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double ChainBenchResult::get(std::string key)
+{
+    for (unsigned int i = 0; i < numbers.size(); i++) {
+        if (numbers[i].first == key)
+            return(numbers[i].second);
+    }
+    return(0.0);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+std::string ChainBenchResult::getText(std::string key)
+{
+    for (unsigned int i = 0; i < fields.size(); i++) {
+        const std::string& text = fields[i].second;
+        if ((fields[i].first == key) && (text.size() >= 2) && (text[0] == '"'))
+            return(text.substr(1, text.size() - 2));
+    }
+    return("");
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+std::string ChainBenchResult::getName()
+{
+    return(name);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ChainBenchResult::writeJson(std::ostream& os)
+{
+    os << "{\"name\": \"" << name << "\"";
+    for (unsigned int i = 0; i < fields.size(); i++)
+        os << ", \"" << fields[i].first << "\": " << fields[i].second;
+    os << "}";
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void writeChainBenchJson(
+        std::ostream& os,
+        ChainBenchResult& settings,
+        std::vector<ChainBenchResult>& results
+        )
+{
+    os << "{" << endl << "  \"benchmark\": ";
+    settings.writeJson(os);
+    os << "," << endl << "  \"results\": [" << endl;
+    for (unsigned int i = 0; i < results.size(); i++) {
+        os << "    ";
+        results[i].writeJson(os);
+        os << ((i + 1 < results.size()) ? "," : "") << endl;
+    }
+    os << "  ]" << endl << "}" << endl;
+}
+//////////////////////////////////////////////////////////////////////////
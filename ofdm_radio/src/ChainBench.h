@@ -0,0 +1,70 @@
+/* ChainBench.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef CHAINBENCH_H_
+#define CHAINBENCH_H_
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <time.h>
+
+// Wall time, CPU time of the calling thread and, on x86, time stamp counter
+// ticks over one measured run.  The benchmarks are single threaded, so
+// rates over the CPU time are rates per core.
+class ChainBenchTimer
+{
+public:
+    ChainBenchTimer();
+
+    void start();
+    void stop();
+    double getWallTime();
+    double getCpuTime();
+    // Zero where the host has no time stamp counter
+    double getCycles();
+    static bool hasCycles();
+
+private:
+    struct timespec wall_start;
+    struct timespec cpu_start;
+    unsigned long long cycles_start;
+    double wall_time;
+    double cpu_time;
+    double cycles;
+};
+
+// One benchmark case: its parameters and measurements in insertion order
+class ChainBenchResult
+{
+public:
+    ChainBenchResult(std::string name);
+
+    void set(std::string key, double value);
+    void set(std::string key, std::string value);
+    double get(std::string key);
+    // Text of a string value, empty if there is none
+    std::string getText(std::string key);
+    std::string getName();
+    void writeJson(std::ostream& os);
+
+private:
+    std::string name;
+    // Values are kept as JSON text; numbers are stored as well for get()
+    std::vector<std::pair<std::string, std::string> > fields;
+    std::vector<std::pair<std::string, double> > numbers;
+};
+
+// Writes {"benchmark": <settings>, "results": [<result>, ...]} for CI, where
+// the settings' name is the benchmark's
+void writeChainBenchJson(
+    std::ostream& os,
+    ChainBenchResult& settings,
+    std::vector<ChainBenchResult>& results
+);
+
+
+#endif // CHAINBENCH_H_
@@ -0,0 +1,148 @@
+/* DownlinkScheduler.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "DownlinkScheduler.h"
+
+using namespace std;
+
+DownlinkScheduler::DownlinkScheduler(
+        unsigned int num_users,
+        unsigned int num_blocks,
+        float fairness
+        )
+{
+    this->num_users = num_users;
+    this->num_blocks = num_blocks;
+    this->fairness = fairness;
+
+    if (num_blocks < num_users) {
+        cerr << "\nERROR in DownlinkScheduler constructor: ";
+        cerr << "scheduler_blocks must be at least the number of mobiles" << endl;
+        exit(EXIT_FAILURE);
+    }
+    if (fairness < 0.0f) {
+        cerr << "\nERROR in DownlinkScheduler constructor: ";
+        cerr << "scheduler_fairness must not be negative" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    average_bytes.assign(num_users, 0.0f);
+    order.assign(num_users, 0);
+    metric.assign(num_users, 0.0f);
+    remainder.assign(num_users, 0);
+    frames_served.assign(num_users, 0);
+    frames_deferred.assign(num_users, 0);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+DownlinkScheduler::~DownlinkScheduler()
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void DownlinkScheduler::schedule(
+        const unsigned int* payload_bytes,
+        const unsigned int* payload_symbols,
+        unsigned int symbol_budget,
+        unsigned int* blocks
+        )
+{
+    // Rank the mobiles with something queued by bits per symbol over
+    // their average service; the +1 keeps a mobile never served finite
+    unsigned int num_queued = 0;
+    for (unsigned int u = 0; u < num_users; u++) {
+        blocks[u] = 0;
+        if ((payload_bytes[u] == 0) || (payload_symbols[u] == 0))
+            continue;
+        float rate = 8.0f * payload_bytes[u] / payload_symbols[u];
+        metric[u] = rate / powf(average_bytes[u] + 1.0f, fairness);
+        order[num_queued++] = u;
+    }
+    std::vector<float>& m = metric;
+    std::sort(order.begin(), order.begin() + num_queued,
+            [&m](unsigned int a, unsigned int b) { return m[a] > m[b]; });
+
+    // Serve in that order while the payloads fit
+    unsigned long symbols_served = 0;
+    unsigned int num_served = 0;
+    for (unsigned int k = 0; k < num_queued; k++) {
+        unsigned int u = order[k];
+        if ((num_served > 0) && (symbols_served + payload_symbols[u] > symbol_budget)) {
+            frames_deferred[u]++;
+            continue;
+        }
+        symbols_served += payload_symbols[u];
+        blocks[u] = 1;
+        num_served++;
+    }
+
+    // One block each, the rest in proportion to the symbols needed, with
+    // leftovers going to the largest remainders
+    if (num_served > 0) {
+        unsigned int blocks_left = num_blocks - num_served;
+        unsigned int blocks_given = num_served;
+        for (unsigned int u = 0; u < num_users; u++) {
+            remainder[u] = 0;
+            if (blocks[u] == 0)
+                continue;
+            unsigned long long t = (unsigned long long)blocks_left * payload_symbols[u];
+            blocks[u] += (unsigned int)(t / symbols_served);
+            remainder[u] = (unsigned long)(t % symbols_served);
+            blocks_given += (unsigned int)(t / symbols_served);
+        }
+        while (blocks_given < num_blocks) {
+            unsigned int best = num_users;
+            for (unsigned int u = 0; u < num_users; u++) {
+                if ((blocks[u] > 0) && ((best == num_users) || (remainder[u] > remainder[best])))
+                    best = u;
+            }
+            blocks[best]++;
+            remainder[best] = 0;
+            blocks_given++;
+        }
+    }
+
+    // Update the averages of every mobile, served or not
+    for (unsigned int u = 0; u < num_users; u++) {
+        float served = (blocks[u] > 0) ? (float)payload_bytes[u] : 0.0f;
+        average_bytes[u] += DS_THROUGHPUT_ALPHA * (served - average_bytes[u]);
+        if (blocks[u] > 0)
+            frames_served[u]++;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned long DownlinkScheduler::getFramesServed(unsigned int user)
+{
+    return (user < num_users) ? frames_served[user] : 0;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned long DownlinkScheduler::getFramesDeferred(unsigned int user)
+{
+    return (user < num_users) ? frames_deferred[user] : 0;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void DownlinkScheduler::printSummary()
+{
+    cout << "Downlink scheduler (frames served/deferred):" << endl;
+    for (unsigned int u = 0; u < num_users; u++) {
+        cout << "  user " << u << ": " << frames_served[u] << "/"
+            << frames_deferred[u] << ", average "
+            << average_bytes[u] << " bytes per frame" << endl;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
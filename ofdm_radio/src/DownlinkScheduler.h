@@ -0,0 +1,68 @@
+/* DownlinkScheduler.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef DOWNLINKSCHEDULER_H_
+#define DOWNLINKSCHEDULER_H_
+
+#include <vector>
+
+// Weight of each frame in the per-mobile average of bytes served
+#define DS_THROUGHPUT_ALPHA                         0.05f
+
+// Proportional-fair scheduler for the OFDMA downlink.
+//
+// Each frame carries at most one payload per mobile, and the frame lasts
+// until the mobile needing the most OFDM symbols is done. The scheduler
+// therefore does two things per frame:
+//  - it picks the mobiles to serve, in order of the proportional-fair
+//    metric rate / average^fairness, while their payloads fit in the
+//    frame's budget of subcarrier-symbols (the first always fits). Mobiles
+//    with nothing queued are never served. A fairness of 0 serves the
+//    fastest channels first, 1 is classic proportional fairness.
+//  - it splits the subcarrier blocks between the served mobiles in
+//    proportion to the symbols their payloads need, so that they all
+//    finish together and the frame is as short as it can be.
+class DownlinkScheduler
+{
+public:
+    DownlinkScheduler(
+        unsigned int num_users,
+        unsigned int num_blocks,
+        float fairness
+    );
+    ~DownlinkScheduler();
+
+    // payload_bytes   : bytes each mobile would be sent, 0 if none queued
+    // payload_symbols : modem symbols those bytes take in the mobile's
+    //                   current modulation and coding
+    // symbol_budget   : subcarrier-symbols the frame may spend on payloads
+    // blocks          : out, subcarrier blocks for each mobile (0 = not
+    //                   served this frame)
+    void schedule(
+        const unsigned int* payload_bytes,
+        const unsigned int* payload_symbols,
+        unsigned int symbol_budget,
+        unsigned int* blocks
+    );
+
+    unsigned long getFramesServed(unsigned int user);
+    unsigned long getFramesDeferred(unsigned int user);
+    void printSummary();
+
+private:
+    unsigned int num_users;
+    unsigned int num_blocks;
+    float fairness;
+
+    std::vector<float> average_bytes;
+    std::vector<unsigned int> order;
+    std::vector<float> metric;
+    std::vector<unsigned long> remainder;
+    std::vector<unsigned long> frames_served;
+    std::vector<unsigned long> frames_deferred;
+};
+
+
+#endif // DOWNLINKSCHEDULER_H_
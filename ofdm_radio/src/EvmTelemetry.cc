@@ -0,0 +1,200 @@
+/* EvmTelemetry.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <unistd.h>
+#include <stdint.h>
+
+#include "EvmTelemetry.h"
+
+using namespace std;
+
+EvmTelemetry::EvmTelemetry(
+        unsigned int num_subcarriers,
+        std::string dump_file,
+        unsigned int decimation,
+        float alpha,
+        float high_evm_threshold_db,
+        unsigned int* high_evm_counts
+        )
+{
+    this->num_subcarriers = num_subcarriers;
+    this->decimation = (decimation > 0) ? decimation : 1;
+    this->alpha = alpha;
+    this->high_evm_counts = high_evm_counts;
+    // Compare against the linear mean-square EVM so the drain loop needs
+    // no log10 per subcarrier
+    high_evm_threshold = powf(10.0f, high_evm_threshold_db / 10.0f);
+
+    if ((alpha <= 0.0f) || (alpha > 1.0f)) {
+        cerr << "\nERROR in EvmTelemetry constructor: ";
+        cerr << "alpha must be in (0, 1]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    ring_evm = new float[EVM_TELEMETRY_RING_SIZE * num_subcarriers];
+    ring_head = 0;
+    ring_tail = 0;
+    frames_dropped = 0;
+
+    evm_average = new float[num_subcarriers];
+    evm_observed = new bool[num_subcarriers];
+    dump_buffer = new float[num_subcarriers];
+    for (unsigned int i = 0; i < num_subcarriers; i++) {
+        evm_average[i] = 0.0f;
+        evm_observed[i] = false;
+        if (high_evm_counts != NULL)
+            high_evm_counts[i] = 0;
+    }
+    frames_processed = 0;
+
+    dump_fp = NULL;
+    if (!dump_file.empty()) {
+        dump_fp = fopen(dump_file.c_str(), "wb");
+        if (dump_fp == NULL) {
+            cerr << "\nERROR in EvmTelemetry constructor: ";
+            cerr << "unable to open " << dump_file << endl;
+            exit(EXIT_FAILURE);
+        }
+        uint32_t header[4] = {EVM_TELEMETRY_DUMP_MAGIC, EVM_TELEMETRY_DUMP_VERSION,
+            num_subcarriers, this->decimation};
+        fwrite(header, sizeof(uint32_t), 4, dump_fp);
+    }
+
+    continue_draining = true;
+    drainThread = std::thread(&EvmTelemetry::drain, this);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+EvmTelemetry::~EvmTelemetry()
+{
+    continue_draining = false;
+    if (drainThread.joinable())
+        drainThread.join();
+    if (dump_fp != NULL)
+        fclose(dump_fp);
+    delete [] ring_evm;
+    delete [] evm_average;
+    delete [] evm_observed;
+    delete [] dump_buffer;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool EvmTelemetry::record(
+        const float* evm,
+        double timestamp
+        )
+{
+    unsigned int head = ring_head.load(std::memory_order_relaxed);
+    unsigned int tail = ring_tail.load(std::memory_order_acquire);
+
+    // Never wait on the drain thread from the receive path
+    if (head - tail >= EVM_TELEMETRY_RING_SIZE) {
+        frames_dropped++;
+        return(false);
+    }
+
+    unsigned int slot = head & (EVM_TELEMETRY_RING_SIZE - 1);
+    memcpy(&ring_evm[slot * num_subcarriers], evm, num_subcarriers * sizeof(float));
+    ring_timestamp[slot] = timestamp;
+    ring_head.store(head + 1, std::memory_order_release);
+
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void EvmTelemetry::drain()
+{
+    while (true) {
+        unsigned int tail = ring_tail.load(std::memory_order_relaxed);
+        unsigned int head = ring_head.load(std::memory_order_acquire);
+
+        if (tail == head) {
+            if (!continue_draining)
+                break;
+            usleep(1000);
+            continue;
+        }
+
+        while (tail != head) {
+            processFrame(tail & (EVM_TELEMETRY_RING_SIZE - 1));
+            tail++;
+            ring_tail.store(tail, std::memory_order_release);
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void EvmTelemetry::processFrame(unsigned int slot)
+{
+    const float* evm = &ring_evm[slot * num_subcarriers];
+
+    averages_mutex.lock();
+    for (unsigned int i = 0; i < num_subcarriers; i++) {
+        if (evm[i] <= EVM_TELEMETRY_UNUSED_LEVEL)
+            continue;
+
+        if (evm_observed[i]) {
+            evm_average[i] += alpha * (evm[i] - evm_average[i]);
+        } else {
+            evm_average[i] = evm[i];
+            evm_observed[i] = true;
+        }
+
+        if ((high_evm_counts != NULL) && (evm[i] > high_evm_threshold))
+            high_evm_counts[i]++;
+    }
+    averages_mutex.unlock();
+
+    frames_processed++;
+    if ((dump_fp != NULL) && (frames_processed % decimation == 0))
+        writeDumpRecord(ring_timestamp[slot]);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+int EvmTelemetry::writeDumpRecord(double timestamp)
+{
+    uint32_t frame_count = (uint32_t)frames_processed;
+
+    getAverages(dump_buffer);
+    fwrite(&timestamp, sizeof(double), 1, dump_fp);
+    fwrite(&frame_count, sizeof(uint32_t), 1, dump_fp);
+    fwrite(dump_buffer, sizeof(float), num_subcarriers, dump_fp);
+
+    return(EXIT_SUCCESS);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void EvmTelemetry::getAverages(float* evm_db)
+{
+    averages_mutex.lock();
+    for (unsigned int i = 0; i < num_subcarriers; i++) {
+        evm_db[i] = evm_observed[i] ? 10.0f * log10f(evm_average[i]) : 0.0f;
+    }
+    averages_mutex.unlock();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned long EvmTelemetry::getFramesRecorded()
+{
+    return(ring_head.load());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned long EvmTelemetry::getFramesDropped()
+{
+    return(frames_dropped.load());
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,87 @@
+/* EvmTelemetry.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef EVMTELEMETRY_H_
+#define EVMTELEMETRY_H_
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// Number of frames the receive thread can get ahead of the drain thread
+// before frames are dropped; must be a power of two
+#define EVM_TELEMETRY_RING_SIZE                     64
+// Values at or below this are subcarriers the synchronizer did not
+// demodulate in the frame (ofdmflexframesync resets them to 1e-12)
+#define EVM_TELEMETRY_UNUSED_LEVEL                  1.0E-11
+#define EVM_TELEMETRY_DUMP_MAGIC                    0x544d5645  // "EVMT"
+#define EVM_TELEMETRY_DUMP_VERSION                  1
+
+// Binary dump layout, all fields native endian:
+//   header : uint32 magic, uint32 version, uint32 num_subcarriers,
+//            uint32 decimation
+//   record : double timestamp, uint32 frame count,
+//            float averaged evm [dB] x num_subcarriers
+// Subcarriers never observed are written as 0.0 dB.
+
+class EvmTelemetry
+{
+public:
+    EvmTelemetry(
+        unsigned int num_subcarriers,
+        std::string dump_file,
+        unsigned int decimation,
+        float alpha,
+        float high_evm_threshold_db,
+        unsigned int* high_evm_counts
+    );
+    ~EvmTelemetry();
+
+    // Called from the receive callback with the synchronizer's per-subcarrier
+    // mean-square EVM; copies the vector and returns without blocking
+    bool record(
+        const float* evm,
+        double timestamp
+    );
+    // Snapshot of the decayed averages in dB
+    void getAverages(float* evm_db);
+    unsigned long getFramesRecorded();
+    unsigned long getFramesDropped();
+
+private:
+    void drain();
+    void processFrame(unsigned int slot);
+    int writeDumpRecord(double timestamp);
+
+    unsigned int num_subcarriers;
+    unsigned int decimation;
+    float alpha;
+    float high_evm_threshold;
+    unsigned int* high_evm_counts;
+
+    // Single-producer/single-consumer ring of per-frame EVM vectors
+    float* ring_evm;
+    double ring_timestamp[EVM_TELEMETRY_RING_SIZE];
+    std::atomic<unsigned int> ring_head;
+    std::atomic<unsigned int> ring_tail;
+    std::atomic<unsigned long> frames_dropped;
+
+    // Owned by the drain thread, averages shared under averages_mutex
+    std::mutex averages_mutex;
+    float* evm_average;
+    bool* evm_observed;
+    float* dump_buffer;
+    unsigned long frames_processed;
+    FILE* dump_fp;
+
+    std::atomic<bool> continue_draining;
+    std::thread drainThread;
+};
+
+
+#endif // EVMTELEMETRY_H_
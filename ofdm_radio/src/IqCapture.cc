@@ -0,0 +1,395 @@
+/* IqCapture.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "IqCapture.h"
+
+using namespace std;
+
+// Fault the pages of a new window in while mapping it rather than from the
+// receive thread
+#ifdef MAP_POPULATE
+#define IQ_CAPTURE_MMAP_FLAGS                       (MAP_SHARED | MAP_POPULATE)
+#else
+#define IQ_CAPTURE_MMAP_FLAGS                       MAP_SHARED
+#endif
+
+IqCaptureWriter::IqCaptureWriter(std::string file_name, IqSampleFormat format)
+{
+    this->file_name = file_name;
+    fd = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        cerr << "\nERROR in IqCaptureWriter constructor: ";
+        cerr << "unable to open " << file_name << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    memset(&header, 0, sizeof(header));
+    strncpy(header.magic, IQ_CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = IQ_CAPTURE_VERSION;
+    header.format = (uint32_t)format;
+
+    window_offset = 0;
+    window_pos = 0;
+    window = mapWindow(window_offset);
+    append(&header, sizeof(header));
+
+    next_window = NULL;
+    next_offset = IQ_CAPTURE_WINDOW_SIZE;
+    retired_window = NULL;
+    running = true;
+    map_thread = std::thread(&IqCaptureWriter::run, this);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+IqCaptureWriter::~IqCaptureWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(window_mutex);
+        running = false;
+    }
+    window_cond.notify_all();
+    map_thread.join();
+
+    if (retired_window != NULL)
+        munmap(retired_window, IQ_CAPTURE_WINDOW_SIZE);
+    if (next_window != NULL)
+        munmap(next_window, IQ_CAPTURE_WINDOW_SIZE);
+    munmap(window, IQ_CAPTURE_WINDOW_SIZE);
+
+    // Drop the unused end of the last window
+    if (ftruncate(fd, window_offset + (off_t)window_pos) != 0) {
+        cerr << "\nWARNING in IqCaptureWriter destructor: ";
+        cerr << "unable to trim " << file_name << endl;
+    }
+    writeHeader();
+    close(fd);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+IqSampleFormat IqCaptureWriter::formatFromString(std::string format)
+{
+    if (format == "fc32")
+        return(IQ_FORMAT_FC32);
+    if (format == "sc16")
+        return(IQ_FORMAT_SC16);
+    cerr << "\nERROR in IqCaptureWriter::formatFromString: ";
+    cerr << "unknown sample format " << format << " (fc32 or sc16)" << endl;
+    exit(EXIT_FAILURE);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+std::string IqCaptureWriter::formatToString(IqSampleFormat format)
+{
+    switch (format) {
+        case IQ_FORMAT_FC32:    return("fc32");
+        case IQ_FORMAT_SC16:    return("sc16");
+        default:                return("unknown");
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t IqCaptureWriter::bytesPerSample(IqSampleFormat format)
+{
+    return((format == IQ_FORMAT_SC16) ? 2 * sizeof(int16_t) : sizeof(std::complex<float>));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned char* IqCaptureWriter::mapWindow(off_t offset)
+{
+    if (ftruncate(fd, offset + IQ_CAPTURE_WINDOW_SIZE) != 0) {
+        cerr << "\nERROR in IqCaptureWriter::mapWindow: ";
+        cerr << "unable to extend " << file_name << endl;
+        exit(EXIT_FAILURE);
+    }
+    void* w = mmap(NULL, IQ_CAPTURE_WINDOW_SIZE, PROT_READ | PROT_WRITE,
+            IQ_CAPTURE_MMAP_FLAGS, fd, offset);
+    if (w == MAP_FAILED) {
+        cerr << "\nERROR in IqCaptureWriter::mapWindow: ";
+        cerr << "unable to map " << file_name << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return((unsigned char*)w);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void IqCaptureWriter::run()
+{
+    std::unique_lock<std::mutex> lock(window_mutex);
+
+    while (running) {
+        // Unmap the window the receiver has left before mapping the next
+        if (retired_window != NULL) {
+            unsigned char* w = retired_window;
+            retired_window = NULL;
+            lock.unlock();
+            munmap(w, IQ_CAPTURE_WINDOW_SIZE);
+            lock.lock();
+            continue;
+        }
+        if (next_window == NULL) {
+            off_t offset = next_offset;
+            lock.unlock();
+            unsigned char* w = mapWindow(offset);
+            lock.lock();
+            next_window = w;
+            window_cond.notify_all();
+            continue;
+        }
+        window_cond.wait(lock);
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void IqCaptureWriter::nextWindow()
+{
+    std::unique_lock<std::mutex> lock(window_mutex);
+
+    // Only waits if the helper has fallen a whole window behind
+    while (next_window == NULL)
+        window_cond.wait(lock);
+
+    retired_window = window;
+    window = next_window;
+    window_offset = next_offset;
+    window_pos = 0;
+    next_window = NULL;
+    next_offset += IQ_CAPTURE_WINDOW_SIZE;
+    window_cond.notify_all();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void IqCaptureWriter::append(const void* data, size_t len)
+{
+    const unsigned char* p = (const unsigned char*)data;
+
+    while (len > 0) {
+        if (window_pos == IQ_CAPTURE_WINDOW_SIZE)
+            nextWindow();
+        size_t n = std::min(len, (size_t)IQ_CAPTURE_WINDOW_SIZE - window_pos);
+        memcpy(window + window_pos, p, n);
+        window_pos += n;
+        p += n;
+        len -= n;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void IqCaptureWriter::writeHeader()
+{
+    if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        cerr << "\nWARNING in IqCaptureWriter::writeHeader: ";
+        cerr << "unable to write the header of " << file_name << endl;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void IqCaptureWriter::setSampleRate(double sample_rate)
+{
+    header.sample_rate = sample_rate;
+    writeHeader();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void IqCaptureWriter::write(
+        const std::complex<float>* x,
+        size_t num_samps,
+        const uhd::rx_metadata_t& md,
+        double center_freq
+        )
+{
+    bool overflow = (md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+    if ((num_samps == 0) && !overflow)
+        return;
+
+    iq_capture_record_t record;
+    record.full_secs = (int64_t)md.time_spec.get_full_secs();
+    record.frac_secs = md.time_spec.get_frac_secs();
+    record.center_freq = center_freq;
+    record.num_samps = (uint32_t)num_samps;
+    record.flags = overflow ? IQ_CAPTURE_RECORD_OVERFLOW : 0;
+    append(&record, sizeof(record));
+
+    if (header.format == IQ_FORMAT_SC16) {
+        if (sc16_buf.size() < 2 * num_samps)
+            sc16_buf.resize(2 * num_samps);
+        const float* xf = (const float*)x;
+        for (size_t i = 0; i < 2 * num_samps; i++) {
+            float v = xf[i] * IQ_CAPTURE_SC16_SCALE;
+            if (v > IQ_CAPTURE_SC16_SCALE)
+                v = IQ_CAPTURE_SC16_SCALE;
+            else if (v < -IQ_CAPTURE_SC16_SCALE)
+                v = -IQ_CAPTURE_SC16_SCALE;
+            sc16_buf[i] = (int16_t)lrintf(v);
+        }
+        append(&sc16_buf[0], num_samps * bytesPerSample(IQ_FORMAT_SC16));
+    } else {
+        append(x, num_samps * bytesPerSample(IQ_FORMAT_FC32));
+    }
+
+    header.num_records++;
+    header.num_samps += num_samps;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+IqCaptureReader::IqCaptureReader(std::string file_name)
+{
+    this->file_name = file_name;
+    fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "\nERROR in IqCaptureReader constructor: ";
+        cerr << "unable to open " << file_name << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(header))) {
+        cerr << "\nERROR in IqCaptureReader constructor: ";
+        cerr << file_name << " is not an IQ capture" << endl;
+        exit(EXIT_FAILURE);
+    }
+    file_size = (size_t)st.st_size;
+
+    void* p = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        cerr << "\nERROR in IqCaptureReader constructor: ";
+        cerr << "unable to map " << file_name << endl;
+        exit(EXIT_FAILURE);
+    }
+    data = (const unsigned char*)p;
+    madvise(p, file_size, MADV_SEQUENTIAL);
+
+    memcpy(&header, data, sizeof(header));
+    if ((strncmp(header.magic, IQ_CAPTURE_MAGIC, sizeof(header.magic)) != 0) ||
+            (header.version != IQ_CAPTURE_VERSION) ||
+            (header.format > IQ_FORMAT_SC16)) {
+        cerr << "\nERROR in IqCaptureReader constructor: ";
+        cerr << file_name << " is not a version " << IQ_CAPTURE_VERSION;
+        cerr << " IQ capture" << endl;
+        exit(EXIT_FAILURE);
+    }
+    bytes_per_sample = IqCaptureWriter::bytesPerSample((IqSampleFormat)header.format);
+
+    rewind();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+IqCaptureReader::~IqCaptureReader()
+{
+    munmap((void*)data, file_size);
+    close(fd);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+const iq_capture_header_t& IqCaptureReader::getHeader()
+{
+    return(header);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void IqCaptureReader::rewind()
+{
+    record_offset = sizeof(header);
+    record_loaded = false;
+    record_pos = 0;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool IqCaptureReader::loadRecord()
+{
+    if (record_offset + sizeof(record) > file_size)
+        return(false);
+    memcpy(&record, data + record_offset, sizeof(record));
+    if ((record.num_samps == 0) && (record.flags == 0))
+        return(false);
+    // A record cut short by the end of the file ends the capture
+    if (record_offset + sizeof(record) + record.num_samps * bytes_per_sample > file_size)
+        return(false);
+
+    record_loaded = true;
+    record_pos = 0;
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool IqCaptureReader::read(
+        std::complex<float>* y,
+        size_t max_samps,
+        size_t* num_samps,
+        uhd::time_spec_t* time,
+        double* center_freq,
+        bool* overflow
+        )
+{
+    *num_samps = 0;
+    *overflow = false;
+
+    while (!record_loaded || (record_pos == record.num_samps)) {
+        if (record_loaded) {
+            record_offset += sizeof(record) + record.num_samps * bytes_per_sample;
+            record_loaded = false;
+        }
+        if (!loadRecord())
+            return(false);
+        // Reported on its own, ahead of any samples the record holds
+        if (record.flags & IQ_CAPTURE_RECORD_OVERFLOW) {
+            record.flags &= ~IQ_CAPTURE_RECORD_OVERFLOW;
+            *time = uhd::time_spec_t((time_t)record.full_secs, record.frac_secs);
+            *center_freq = record.center_freq;
+            *overflow = true;
+            return(true);
+        }
+    }
+
+    size_t n = std::min(max_samps, (size_t)record.num_samps - record_pos);
+    const unsigned char* src = data + record_offset + sizeof(record) +
+        record_pos * bytes_per_sample;
+    if (header.format == IQ_FORMAT_SC16) {
+        float* yf = (float*)y;
+        for (size_t i = 0; i < 2 * n; i++) {
+            int16_t v;
+            memcpy(&v, src + i * sizeof(int16_t), sizeof(int16_t));
+            yf[i] = (float)v / IQ_CAPTURE_SC16_SCALE;
+        }
+    } else {
+        memcpy(y, src, n * bytes_per_sample);
+    }
+
+    *time = uhd::time_spec_t((time_t)record.full_secs, record.frac_secs);
+    if (header.sample_rate > 0.0)
+        *time += uhd::time_spec_t((double)record_pos / header.sample_rate);
+    *center_freq = record.center_freq;
+    *num_samps = n;
+    record_pos += n;
+
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
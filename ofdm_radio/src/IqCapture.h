@@ -0,0 +1,148 @@
+/* IqCapture.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef IQCAPTURE_H_
+#define IQCAPTURE_H_
+
+#include <complex>
+#include <string>
+#include <vector>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <uhd/types/time_spec.hpp>
+#include <uhd/types/metadata.hpp>
+
+// A capture file is an iq_capture_header_t followed by one record per recv
+// call: an iq_capture_record_t and then num_samps samples in the header's
+// format, interleaved I and Q.  Every field is in host byte order.
+#define IQ_CAPTURE_MAGIC                            "U4IQCAP"
+#define IQ_CAPTURE_VERSION                          1
+// The writer maps the file this many bytes at a time; a helper thread maps
+// (and pre-faults) the next window while the receiver fills the current one
+#define IQ_CAPTURE_WINDOW_SIZE                      (16 << 20)
+// Full scale of sc16 samples
+#define IQ_CAPTURE_SC16_SCALE                       32767.0f
+
+// Record flag: the device dropped samples before this record
+#define IQ_CAPTURE_RECORD_OVERFLOW                  0x1
+
+enum IqSampleFormat {
+    IQ_FORMAT_FC32 = 0,         // complex float, 8 bytes per sample
+    IQ_FORMAT_SC16              // complex int16, 4 bytes per sample
+};
+
+typedef struct {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    format;
+    double      sample_rate;
+    // Written when the capture is closed; zero if the writer never closed
+    uint64_t    num_records;
+    uint64_t    num_samps;
+} iq_capture_header_t;
+
+typedef struct {
+    int64_t     full_secs;
+    double      frac_secs;
+    // Receiver center frequency when the samples arrived
+    double      center_freq;
+    uint32_t    num_samps;
+    uint32_t    flags;
+} iq_capture_record_t;
+
+// Appends the samples of each recv call to a memory-mapped capture file.
+// write() costs a copy (and, for sc16, a conversion) into the mapping; the
+// file is extended and mapped a window ahead by a helper thread, so the
+// receive thread makes no system calls while the host keeps up.
+class IqCaptureWriter
+{
+public:
+    IqCaptureWriter(std::string file_name, IqSampleFormat format);
+    ~IqCaptureWriter();
+
+    void setSampleRate(double sample_rate);
+    void write(
+        const std::complex<float>* x,
+        size_t num_samps,
+        const uhd::rx_metadata_t& md,
+        double center_freq
+    );
+
+    static IqSampleFormat formatFromString(std::string format);
+    static std::string formatToString(IqSampleFormat format);
+    static size_t bytesPerSample(IqSampleFormat format);
+
+private:
+    void append(const void* data, size_t len);
+    void nextWindow();
+    unsigned char* mapWindow(off_t offset);
+    void writeHeader();
+    void run();
+
+    std::string file_name;
+    int fd;
+    iq_capture_header_t header;
+    std::vector<int16_t> sc16_buf;
+
+    // Window the receive thread is filling
+    unsigned char* window;
+    off_t window_offset;
+    size_t window_pos;
+
+    // Shared with the helper thread
+    std::mutex window_mutex;
+    std::condition_variable window_cond;
+    unsigned char* next_window;
+    off_t next_offset;
+    unsigned char* retired_window;
+    bool running;
+    std::thread map_thread;
+};
+
+// Reads a capture file back through a read-only mapping of the whole file.
+// A record of zeros ends the capture, which is what a writer that did not
+// close leaves after its last record.
+class IqCaptureReader
+{
+public:
+    IqCaptureReader(std::string file_name);
+    ~IqCaptureReader();
+
+    const iq_capture_header_t& getHeader();
+    // Copies up to max_samps samples from the current record, continuing
+    // where the last read of it stopped.  Returns false at the end of the
+    // capture.  *time is the time of the first sample copied.
+    bool read(
+        std::complex<float>* y,
+        size_t max_samps,
+        size_t* num_samps,
+        uhd::time_spec_t* time,
+        double* center_freq,
+        bool* overflow
+    );
+    void rewind();
+
+private:
+    bool loadRecord();
+
+    std::string file_name;
+    int fd;
+    const unsigned char* data;
+    size_t file_size;
+    iq_capture_header_t header;
+    size_t bytes_per_sample;
+
+    size_t record_offset;
+    iq_capture_record_t record;
+    bool record_loaded;
+    size_t record_pos;
+};
+
+
+#endif // IQCAPTURE_H_
@@ -0,0 +1,229 @@
+/* Jammer.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "Jammer.h"
+
+using namespace std;
+
+Jammer::Jammer(
+        const jammer_params_t& params,
+        LoopbackMedium* medium,
+        double freq,
+        double resampler_ratio
+        ) : noise_rng(JAMMER_NODE_ID), noise_dist(0.0f, 1.0f)
+{
+    if ((params.num_subcarriers == 0) ||
+            (params.first_subcarrier + params.num_subcarriers > JAMMER_NUM_SUBCARRIERS)) {
+        cerr << "\nERROR in Jammer constructor: ";
+        cerr << "band must lie within subcarriers 0 to " << JAMMER_NUM_SUBCARRIERS - 1 << endl;
+        exit(EXIT_FAILURE);
+    }
+    if ((params.profile == JAMMER_PROFILE_SWEEP) && (params.sweep_period <= 0.0)) {
+        cerr << "\nERROR in Jammer constructor: ";
+        cerr << "sweep_period must be positive" << endl;
+        exit(EXIT_FAILURE);
+    }
+    if ((params.profile == JAMMER_PROFILE_PULSED) && ((params.pulse_period <= 0.0) ||
+                (params.duty_cycle <= 0.0) || (params.duty_cycle > 1.0))) {
+        cerr << "\nERROR in Jammer constructor: ";
+        cerr << "pulse_period must be positive and duty_cycle in (0, 1]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    this->params = params;
+    this->medium = medium;
+    this->freq = freq;
+    this->resampler_ratio = resampler_ratio;
+    start_clock = 0.0;
+    running = false;
+    active = false;
+
+    // Lowpass prototype for the noise profiles, normalized so unit power
+    // white noise comes out at unit power
+    band_filter = NULL;
+    filter_gain = 1.0f;
+    if (params.profile != JAMMER_PROFILE_TONE) {
+        float bw = (float)params.num_subcarriers / JAMMER_NUM_SUBCARRIERS /
+            (float)resampler_ratio;
+        unsigned int filter_len = 2 * (unsigned int)ceilf(2.0f / bw) + 1;
+        if (filter_len > JAMMER_MAX_FILTER_LEN)
+            filter_len = JAMMER_MAX_FILTER_LEN;
+        std::vector<float> h(filter_len);
+        liquid_firdes_kaiser(filter_len, 0.5f * bw, 60.0f, 0.0f, &h[0]);
+        float energy = 0.0f;
+        for (unsigned int i = 0; i < filter_len; i++)
+            energy += h[i] * h[i];
+        filter_gain = 1.0f / sqrtf(energy);
+        band_filter = firfilt_crcf_create(&h[0], filter_len);
+    }
+
+    mixer = nco_crcf_create(LIQUID_VCO);
+    double center = (params.profile == JAMMER_PROFILE_TONE) ?
+        (double)params.first_subcarrier :
+        params.first_subcarrier + 0.5 * (params.num_subcarriers - 1);
+    nco_crcf_set_frequency(mixer, (float)(2.0 * M_PI * subcarrier2Freq(center)));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+Jammer::~Jammer()
+{
+    stop();
+    if (band_filter != NULL)
+        firfilt_crcf_destroy(band_filter);
+    nco_crcf_destroy(mixer);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+JammerProfileType Jammer::profileFromString(std::string profile)
+{
+    for (int i = 0; i < JAMMER_NUM_PROFILES; i++) {
+        if (profile == profileToString((JammerProfileType)i))
+            return((JammerProfileType)i);
+    }
+    cerr << "\nERROR in Jammer::profileFromString: ";
+    cerr << "unknown jammer profile " << profile << endl;
+    exit(EXIT_FAILURE);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+std::string Jammer::profileToString(JammerProfileType profile)
+{
+    switch (profile) {
+        case JAMMER_PROFILE_NONE:           return("NONE");
+        case JAMMER_PROFILE_TONE:           return("TONE");
+        case JAMMER_PROFILE_PARTIAL_BAND:   return("PARTIAL_BAND");
+        case JAMMER_PROFILE_SWEEP:          return("SWEEP");
+        case JAMMER_PROFILE_PULSED:         return("PULSED");
+        default:                            return("UNKNOWN");
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double Jammer::subcarrier2Freq(double subcarrier)
+{
+    // Subcarrier 0 is the lowest frequency of the modem's band, which the
+    // resampler narrows at the device rate
+    return((subcarrier - JAMMER_NUM_SUBCARRIERS / 2) / JAMMER_NUM_SUBCARRIERS /
+            resampler_ratio);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void Jammer::start()
+{
+    if (running || (params.profile == JAMMER_PROFILE_NONE))
+        return;
+    start_clock = medium->now();
+    running = true;
+    jam_thread = std::thread(&Jammer::run, this);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void Jammer::stop()
+{
+    if (!running)
+        return;
+    running = false;
+    jam_thread.join();
+    active = false;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool Jammer::isActive()
+{
+    return(active);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double Jammer::getOnsetTime()
+{
+    return(start_clock + params.start_time);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool Jammer::isOnAt(double t)
+{
+    if (t < params.start_time)
+        return(false);
+    if ((params.stop_time >= 0.0) && (t >= params.stop_time))
+        return(false);
+    if (params.profile == JAMMER_PROFILE_PULSED)
+        return(fmod(t - params.start_time, params.pulse_period) <
+                params.duty_cycle * params.pulse_period);
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void Jammer::generateBlock(
+        long long tick,
+        std::complex<float>* y,
+        size_t num_samps
+        )
+{
+    if (params.profile == JAMMER_PROFILE_TONE) {
+        std::fill(y, y + num_samps, std::complex<float>(1.0f, 0.0f));
+    } else {
+        for (size_t i = 0; i < num_samps; i++)
+            y[i] = std::complex<float>(
+                    (float)M_SQRT1_2 * noise_dist(noise_rng),
+                    (float)M_SQRT1_2 * noise_dist(noise_rng));
+        firfilt_crcf_execute_block(band_filter, y, num_samps, y);
+        for (size_t i = 0; i < num_samps; i++)
+            y[i] *= filter_gain;
+    }
+
+    // The sweep moves its band center linearly across the subcarriers,
+    // updated once per block
+    if (params.profile == JAMMER_PROFILE_SWEEP) {
+        double t = (double)tick / medium->getSampleRate() - start_clock;
+        double phase = fmod(t, params.sweep_period) / params.sweep_period;
+        double center = 0.5 * (params.num_subcarriers - 1) +
+            phase * (JAMMER_NUM_SUBCARRIERS - params.num_subcarriers);
+        nco_crcf_set_frequency(mixer, (float)(2.0 * M_PI * subcarrier2Freq(center)));
+    }
+    nco_crcf_mix_block_up(mixer, y, y, num_samps);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void Jammer::run()
+{
+    std::vector<std::complex<float> > block(JAMMER_BLOCK_SAMPS);
+    long long tick = medium->nowTick() + JAMMER_LEAD_SAMPS;
+
+    while (running) {
+        medium->waitForTick(tick - JAMMER_LEAD_SAMPS);
+
+        double t = (double)tick / medium->getSampleRate() - start_clock;
+        float ref_power = medium->getTransmitPower(params.reference_node);
+        active = isOnAt(t);
+        if (active && (ref_power > 0.0f)) {
+            generateBlock(tick, &block[0], block.size());
+            float amplitude = sqrtf(ref_power * powf(10.0f, (float)params.js_db / 10.0f));
+            for (size_t i = 0; i < block.size(); i++)
+                block[i] *= amplitude;
+            // Fell behind the clock; pick up again a lead ahead of it
+            if (!medium->write(JAMMER_NODE_ID, freq, tick, &block[0], block.size())) {
+                tick = medium->nowTick() + JAMMER_LEAD_SAMPS;
+                continue;
+            }
+        }
+        tick += block.size();
+    }
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,112 @@
+/* Jammer.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef JAMMER_H_
+#define JAMMER_H_
+
+#include <complex>
+#include <string>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <liquid/liquid.h>
+
+#include "LoopbackMedium.h"
+
+// Medium node ID of the jammer, outside the range of radio node IDs
+#define JAMMER_NODE_ID                              100
+// Samples generated per write and how far ahead of the virtual clock the
+// jammer keeps its writes
+#define JAMMER_BLOCK_SAMPS                          4096
+#define JAMMER_LEAD_SAMPS                           (8 * JAMMER_BLOCK_SAMPS)
+// Subcarriers of the OFDMA modem that the jammer's band is given in
+#define JAMMER_NUM_SUBCARRIERS                      512
+#define JAMMER_MAX_FILTER_LEN                       301
+
+enum JammerProfileType {
+    JAMMER_PROFILE_NONE = 0,
+    JAMMER_PROFILE_TONE,            // CW tone at first_subcarrier
+    JAMMER_PROFILE_PARTIAL_BAND,    // noise over the band
+    JAMMER_PROFILE_SWEEP,           // band-wide noise sweeping the spectrum
+    JAMMER_PROFILE_PULSED,          // partial band noise keyed on and off
+    JAMMER_NUM_PROFILES
+};
+
+typedef struct {
+    JammerProfileType profile;
+    // Jammer power over the running transmit power of reference_node
+    double js_db;
+    unsigned int reference_node;
+    // Band in OFDMA subcarriers counted from the lowest frequency, the same
+    // numbering as the anti-jam null hole's left edge
+    unsigned int first_subcarrier;
+    unsigned int num_subcarriers;
+    // Virtual seconds after the jammer is started; stop_time < 0 is never
+    double start_time;
+    double stop_time;
+    // Seconds for the sweep to cross all subcarriers
+    double sweep_period;
+    // Seconds per on/off cycle and the fraction of it spent on
+    double pulse_period;
+    double duty_cycle;
+} jammer_params_t;
+
+// Jammer transmitting into a LoopbackMedium on one carrier, for the
+// network simulator.  A thread generates the waveform a few blocks ahead of
+// the medium's virtual clock and writes it under JAMMER_NODE_ID, so the
+// medium's link channels (ideal unless configured) carry it to each
+// receiver.  The waveform has unit power before scaling to js_db over the
+// reference node's transmit power, so nothing is sent until that node has
+// transmitted.
+class Jammer
+{
+public:
+    Jammer(
+        const jammer_params_t& params,
+        LoopbackMedium* medium,
+        double freq,
+        double resampler_ratio
+    );
+    ~Jammer();
+
+    void start();
+    void stop();
+    // True while the jammer is in its on period
+    bool isActive();
+    // First virtual time the jammer is on, in medium seconds
+    double getOnsetTime();
+
+    static JammerProfileType profileFromString(std::string profile);
+    static std::string profileToString(JammerProfileType profile);
+
+private:
+    void run();
+    bool isOnAt(double t);
+    void generateBlock(
+        long long tick,
+        std::complex<float>* y,
+        size_t num_samps
+    );
+    double subcarrier2Freq(double subcarrier);
+
+    jammer_params_t params;
+    LoopbackMedium* medium;
+    double freq;
+    double resampler_ratio;
+    double start_clock;
+
+    firfilt_crcf band_filter;
+    float filter_gain;
+    nco_crcf mixer;
+    std::mt19937 noise_rng;
+    std::normal_distribution<float> noise_dist;
+
+    std::thread jam_thread;
+    std::atomic<bool> running;
+    std::atomic<bool> active;
+};
+
+
+#endif // JAMMER_H_
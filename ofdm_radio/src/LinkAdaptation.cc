@@ -0,0 +1,220 @@
+/* LinkAdaptation.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+
+#include "LinkAdaptation.h"
+
+using namespace std;
+
+LinkAdaptation::LinkAdaptation(
+        const std::list<AmcTableEntry>& table,
+        fec_scheme robust_fec0,
+        fec_scheme robust_fec1,
+        unsigned int num_users,
+        float evm_alpha,
+        float hysteresis,
+        double report_timeout
+        )
+{
+    this->num_users = num_users;
+    this->evm_alpha = evm_alpha;
+    this->hysteresis = hysteresis;
+    this->report_timeout = report_timeout;
+
+    if ((evm_alpha <= 0.0f) || (evm_alpha > 1.0f)) {
+        cerr << "\nERROR in LinkAdaptation constructor: ";
+        cerr << "amc_evm_alpha must be in (0, 1]" << endl;
+        exit(EXIT_FAILURE);
+    }
+    if (hysteresis < 0.0f) {
+        cerr << "\nERROR in LinkAdaptation constructor: ";
+        cerr << "amc_hysteresis must not be negative" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (table.empty()) {
+        // Default table: the hardened payload coding of the radio first,
+        // then V27 with QPSK, 16- and 64-QAM, then uncoded 64-QAM. The EVM
+        // limits leave a few dB of margin over the usual operating points
+        LinkAdaptationMode defaults[] = {
+            { LIQUID_MODEM_QPSK,  robust_fec0,        robust_fec1,     numeric_limits<float>::infinity() },
+            { LIQUID_MODEM_QPSK,  LIQUID_FEC_CONV_V27, LIQUID_FEC_NONE, -8.0f },
+            { LIQUID_MODEM_QAM16, LIQUID_FEC_CONV_V27, LIQUID_FEC_NONE, -14.0f },
+            { LIQUID_MODEM_QAM64, LIQUID_FEC_CONV_V27, LIQUID_FEC_NONE, -20.0f },
+            { LIQUID_MODEM_QAM64, LIQUID_FEC_NONE,     LIQUID_FEC_NONE, -28.0f },
+        };
+        modes.assign(defaults, defaults + sizeof(defaults) / sizeof(defaults[0]));
+    } else {
+        for (list<AmcTableEntry>::const_iterator it = table.begin(); it != table.end(); it++) {
+            LinkAdaptationMode mode;
+            mode.mod_scheme = liquid_getopt_str2mod(it->mod_scheme.c_str());
+            mode.fec0 = liquid_getopt_str2fec(it->fec0.c_str());
+            mode.fec1 = liquid_getopt_str2fec(it->fec1.c_str());
+            mode.max_evm = it->max_evm;
+            if ((mode.mod_scheme == LIQUID_MODEM_UNKNOWN) ||
+                (mode.fec0 == LIQUID_FEC_UNKNOWN) || (mode.fec1 == LIQUID_FEC_UNKNOWN)) {
+                cerr << "\nERROR in LinkAdaptation constructor: ";
+                cerr << "unknown scheme in amc_table row " << modes.size() << endl;
+                exit(EXIT_FAILURE);
+            }
+            modes.push_back(mode);
+        }
+    }
+
+    evm_smoothed = 0.0f;
+    evm_observed = false;
+    evm_timestamp = 0.0;
+
+    user_evm.assign(num_users, 0.0f);
+    user_report_timestamp.assign(num_users, 0.0);
+    user_reported.assign(num_users, false);
+    user_mode.assign(num_users, 0);
+    user_mode_changes.assign(num_users, 0);
+    mode_frames.assign(modes.size(), 0);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+LinkAdaptation::~LinkAdaptation()
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LinkAdaptation::recordFrameEvm(float evm, double timestamp)
+{
+    if (!std::isfinite(evm))
+        return;
+
+    // Average in the linear domain so a few bad frames pull the estimate
+    // up faster than a few good ones pull it down
+    float evm_linear = powf(10.0f, evm / 10.0f);
+    lock_guard<mutex> lock(mtx);
+    if (evm_observed)
+        evm_smoothed += evm_alpha * (evm_linear - evm_smoothed);
+    else
+        evm_smoothed = evm_linear;
+    evm_observed = true;
+    evm_timestamp = timestamp;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned char LinkAdaptation::getEvmReport(double timestamp)
+{
+    lock_guard<mutex> lock(mtx);
+    if (!evm_observed || (timestamp - evm_timestamp > report_timeout))
+        return LA_EVM_REPORT_NONE;
+    return encodeEvm(10.0f * log10f(evm_smoothed));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LinkAdaptation::recordEvmReport(unsigned int user, unsigned char report, double timestamp)
+{
+    if ((user >= num_users) || (report == LA_EVM_REPORT_NONE))
+        return;
+
+    lock_guard<mutex> lock(mtx);
+    user_evm[user] = decodeEvm(report);
+    user_report_timestamp[user] = timestamp;
+    user_reported[user] = true;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool LinkAdaptation::selectMode(unsigned int user, double timestamp, LinkAdaptationMode* mode)
+{
+    if (user >= num_users) {
+        *mode = modes[0];
+        return false;
+    }
+
+    lock_guard<mutex> lock(mtx);
+    unsigned int m = user_mode[user];
+    if (!user_reported[user] || (timestamp - user_report_timestamp[user] > report_timeout)) {
+        m = 0;
+    } else {
+        float evm = user_evm[user];
+        while ((m > 0) && (evm > modes[m].max_evm))
+            m--;
+        while ((m + 1 < modes.size()) && (evm <= modes[m + 1].max_evm - hysteresis))
+            m++;
+    }
+
+    bool changed = (m != user_mode[user]);
+    if (changed) {
+        user_mode[user] = m;
+        user_mode_changes[user]++;
+    }
+    mode_frames[m]++;
+    *mode = modes[m];
+    return changed;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned int LinkAdaptation::getNumModes()
+{
+    return modes.size();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned int LinkAdaptation::getUserMode(unsigned int user)
+{
+    lock_guard<mutex> lock(mtx);
+    return (user < num_users) ? user_mode[user] : 0;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned long LinkAdaptation::getModeChanges(unsigned int user)
+{
+    lock_guard<mutex> lock(mtx);
+    return (user < num_users) ? user_mode_changes[user] : 0;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LinkAdaptation::printSummary()
+{
+    lock_guard<mutex> lock(mtx);
+    cout << "AMC modes (frames sent):" << endl;
+    for (unsigned int m = 0; m < modes.size(); m++) {
+        cout << "  " << m << ": " << modulation_types[modes[m].mod_scheme].name
+            << ", " << fec_scheme_str[modes[m].fec0][0]
+            << ", " << fec_scheme_str[modes[m].fec1][0]
+            << " (" << mode_frames[m] << ")" << endl;
+    }
+    for (unsigned int u = 0; u < num_users; u++) {
+        cout << "  user " << u << ": mode " << user_mode[u]
+            << ", " << user_mode_changes[u] << " changes" << endl;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned char LinkAdaptation::encodeEvm(float evm)
+{
+    float r = roundf(-evm / LA_EVM_REPORT_STEP);
+    if (r < 0.0f)
+        return 0;
+    if (r > LA_EVM_REPORT_MAX)
+        return LA_EVM_REPORT_MAX;
+    return (unsigned char)r;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+float LinkAdaptation::decodeEvm(unsigned char report)
+{
+    return -LA_EVM_REPORT_STEP * report;
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,101 @@
+/* LinkAdaptation.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef LINKADAPTATION_H_
+#define LINKADAPTATION_H_
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <liquid/liquid.h>
+
+#include "RadioConfig.hh"
+
+// Uplink header byte P2M_HEADER_FIELD_EVM_REPORT carries the mobile's
+// smoothed downlink EVM as -evm/LA_EVM_REPORT_STEP, clamped to
+// [0, LA_EVM_REPORT_MAX]; LA_EVM_REPORT_NONE means no recent estimate
+#define LA_EVM_REPORT_STEP                          0.5f
+#define LA_EVM_REPORT_MAX                           254
+#define LA_EVM_REPORT_NONE                          255
+
+// One resolved row of the mode table
+struct LinkAdaptationMode {
+    modulation_scheme mod_scheme;
+    fec_scheme fec0;
+    fec_scheme fec1;
+    float max_evm;
+};
+
+// Closed-loop adaptive modulation and coding for the OFDMA downlink.
+//
+// Mobile side: every received frame's header EVM is smoothed and the
+// estimate is sent back in the header of every uplink frame.
+// Basestation side: the latest report of each mobile selects a row of the
+// mode table, which is ordered from most to least robust. A user moves to
+// a faster row only once its EVM is hysteresis dB below that row's limit
+// and drops back as soon as it exceeds the limit of its current row. A
+// user without a recent report falls back to the first row.
+//
+// The receive thread records, the transmit thread selects; both are
+// serialized on an internal mutex.
+class LinkAdaptation
+{
+public:
+    LinkAdaptation(
+        const std::list<AmcTableEntry>& table,
+        fec_scheme robust_fec0,
+        fec_scheme robust_fec1,
+        unsigned int num_users,
+        float evm_alpha,
+        float hysteresis,
+        double report_timeout
+    );
+    ~LinkAdaptation();
+
+    // Mobile: smooth the EVM [dB] of a received frame
+    void recordFrameEvm(float evm, double timestamp);
+    // Mobile: report byte for the next uplink frame
+    unsigned char getEvmReport(double timestamp);
+
+    // Basestation: store a report received from a user
+    void recordEvmReport(unsigned int user, unsigned char report, double timestamp);
+    // Basestation: choose the mode of the user's next frame; returns true
+    // when it differs from the previous frame's mode
+    bool selectMode(unsigned int user, double timestamp, LinkAdaptationMode* mode);
+
+    unsigned int getNumModes();
+    unsigned int getUserMode(unsigned int user);
+    unsigned long getModeChanges(unsigned int user);
+    void printSummary();
+
+    static unsigned char encodeEvm(float evm);
+    static float decodeEvm(unsigned char report);
+
+private:
+    std::mutex mtx;
+    std::vector<LinkAdaptationMode> modes;
+    unsigned int num_users;
+    float evm_alpha;
+    float hysteresis;
+    double report_timeout;
+
+    // Mobile: smoothed linear mean-square EVM
+    float evm_smoothed;
+    bool evm_observed;
+    double evm_timestamp;
+
+    // Basestation: per-user state
+    std::vector<float> user_evm;
+    std::vector<double> user_report_timestamp;
+    std::vector<bool> user_reported;
+    std::vector<unsigned int> user_mode;
+    std::vector<unsigned long> user_mode_changes;
+    std::vector<unsigned long> mode_frames;
+};
+
+
+#endif // LINKADAPTATION_H_
@@ -0,0 +1,158 @@
+/* LinkChannel.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <cmath>
+
+#include "LinkChannel.h"
+
+using namespace std;
+
+LinkChannel::LinkChannel(
+        const link_channel_params_t& params,
+        double sample_rate,
+        unsigned int seed
+        ) : noise_rng(seed), noise_dist(0.0f, 1.0f)
+{
+    if (params.timing_offset < 0.0) {
+        cerr << "\nERROR in LinkChannel constructor: ";
+        cerr << "timing_offset must not be negative" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<std::complex<float> > taps = params.taps;
+    if (taps.empty())
+        taps.push_back(std::complex<float>(1.0f, 0.0f));
+
+    // Whole samples come from reading the medium earlier; the fractional
+    // part, kept within (-0.5, 0.5], becomes a Kaiser interpolator
+    integer_delay = (long long)floor(params.timing_offset);
+    double frac = params.timing_offset - (double)integer_delay;
+    if (frac > 0.5) {
+        frac -= 1.0;
+        integer_delay++;
+    }
+    std::vector<std::complex<float> > h;
+    if (fabs(frac) > 1.0E-6) {
+        unsigned int frac_len = 2 * LINK_CHANNEL_FRAC_DELAY_M + 1;
+        float frac_h[2 * LINK_CHANNEL_FRAC_DELAY_M + 1];
+        liquid_firdes_kaiser(frac_len, 0.45f, LINK_CHANNEL_FRAC_DELAY_AS,
+                (float)frac, frac_h);
+        float frac_sum = 0.0f;
+        for (unsigned int i = 0; i < frac_len; i++)
+            frac_sum += frac_h[i];
+        h.assign(taps.size() + frac_len - 1, std::complex<float>(0.0f));
+        for (unsigned int i = 0; i < taps.size(); i++)
+            for (unsigned int j = 0; j < frac_len; j++)
+                h[i + j] += taps[i] * (frac_h[j] / frac_sum);
+    } else {
+        h = taps;
+    }
+
+    tap_energy = 0.0f;
+    for (unsigned int i = 0; i < h.size(); i++)
+        tap_energy += std::norm(h[i]);
+
+    // A single tap is a complex gain and needs no filter
+    channel_filter = NULL;
+    if (h.size() > 1)
+        channel_filter = firfilt_cccf_create(&h[0], h.size());
+    single_tap = h[0];
+
+    cfo_rad_per_samp = 2.0 * M_PI * params.cfo / sample_rate;
+    cfo_nco = nco_crcf_create(LIQUID_VCO);
+    nco_crcf_set_frequency(cfo_nco, (float)cfo_rad_per_samp);
+
+    gain = powf(10.0f, -(float)params.attenuation_db / 20.0f);
+    snr_linear = powf(10.0f, (float)params.snr_db / 10.0f);
+    signal_power = 0.0f;
+    next_tick = -1;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+LinkChannel::~LinkChannel()
+{
+    if (channel_filter != NULL)
+        firfilt_cccf_destroy(channel_filter);
+    nco_crcf_destroy(cfo_nco);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+long long LinkChannel::getIntegerDelay()
+{
+    return(integer_delay);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LinkChannel::updateSignalPower(
+        const std::complex<float>* x,
+        size_t num_samps
+        )
+{
+    float energy = 0.0f;
+    size_t active = 0;
+    for (size_t i = 0; i < num_samps; i++) {
+        float e = std::norm(x[i]);
+        if (e > LINK_CHANNEL_SILENCE_THRESHOLD) {
+            energy += e;
+            active++;
+        }
+    }
+    if (active == 0)
+        return;
+
+    float burst_power = gain * gain * tap_energy * energy / (float)active;
+    if (signal_power == 0.0f)
+        signal_power = burst_power;
+    else
+        signal_power += LINK_CHANNEL_POWER_ALPHA * (burst_power - signal_power);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LinkChannel::execute(
+        long long tick,
+        const std::complex<float>* x,
+        std::complex<float>* y,
+        size_t num_samps
+        )
+{
+    // A gap in the receiver's reads restarts the channel at the new tick;
+    // the CFO phase is tied to the tick so it stays coherent across gaps
+    if (tick != next_tick) {
+        if (channel_filter != NULL)
+            firfilt_cccf_reset(channel_filter);
+        nco_crcf_set_phase(cfo_nco,
+                (float)fmod(cfo_rad_per_samp * (double)tick, 2.0 * M_PI));
+    }
+    next_tick = tick + (long long)num_samps;
+
+    updateSignalPower(x, num_samps);
+
+    scratch.resize(num_samps);
+    if (channel_filter != NULL) {
+        firfilt_cccf_execute_block(channel_filter,
+                const_cast<std::complex<float>*>(x), num_samps, &scratch[0]);
+    } else {
+        for (size_t i = 0; i < num_samps; i++)
+            scratch[i] = single_tap * x[i];
+    }
+    if (cfo_rad_per_samp != 0.0)
+        nco_crcf_mix_block_up(cfo_nco, &scratch[0], &scratch[0], num_samps);
+
+    // Complex noise, split between I and Q
+    float noise_std = (signal_power > 0.0f) ?
+        sqrtf(0.5f * signal_power / snr_linear) : 0.0f;
+    for (size_t i = 0; i < num_samps; i++) {
+        y[i] += gain * scratch[i];
+        if (noise_std > 0.0f)
+            y[i] += std::complex<float>(noise_std * noise_dist(noise_rng),
+                    noise_std * noise_dist(noise_rng));
+    }
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,85 @@
+/* LinkChannel.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef LINKCHANNEL_H_
+#define LINKCHANNEL_H_
+
+#include <complex>
+#include <vector>
+#include <random>
+#include <liquid/liquid.h>
+
+// Length of the Kaiser fractional delay filter used for a timing offset with
+// a fractional part; it adds LINK_CHANNEL_FRAC_DELAY_M samples of delay
+#define LINK_CHANNEL_FRAC_DELAY_M                   4
+#define LINK_CHANNEL_FRAC_DELAY_AS                  60.0f
+// Weight of each transmitted burst in the running signal power estimate
+#define LINK_CHANNEL_POWER_ALPHA                    0.1f
+// Samples whose magnitude squared is below this are treated as silence when
+// estimating transmitted signal power
+#define LINK_CHANNEL_SILENCE_THRESHOLD              1.0e-12f
+
+typedef struct {
+    double snr_db;              // received SNR over the average burst power
+    double attenuation_db;      // path loss applied before noise
+    double cfo;                 // carrier frequency offset [Hz]
+    double timing_offset;       // propagation delay [samples], >= 0
+    // Complex baseband multipath taps; empty means a single unit tap
+    std::vector<std::complex<float> > taps;
+} link_channel_params_t;
+
+// One directional link of the simulated network: a transmitter's samples as
+// heard by one receiver.  The signal is delayed (integer part by reading the
+// medium earlier, fractional part folded into the multipath filter),
+// filtered by the multipath taps, attenuated, rotated by the CFO and buried
+// in AWGN whose power follows the link SNR relative to the running average
+// power of the transmitter's bursts.  Noise is added to every sample the
+// receiver reads, so receivers see a noise floor between bursts as well.
+//
+// Each link belongs to a single receiver, so execute is not locked.
+class LinkChannel
+{
+public:
+    LinkChannel(
+        const link_channel_params_t& params,
+        double sample_rate,
+        unsigned int seed
+    );
+    ~LinkChannel();
+
+    // Whole samples to read the transmitter's carrier ahead of the receiver
+    long long getIntegerDelay();
+    // Adds the channel output for x, which starts at receiver tick, into y
+    void execute(
+        long long tick,
+        const std::complex<float>* x,
+        std::complex<float>* y,
+        size_t num_samps
+    );
+
+private:
+    void updateSignalPower(
+        const std::complex<float>* x,
+        size_t num_samps
+    );
+
+    firfilt_cccf channel_filter;
+    std::complex<float> single_tap;
+    nco_crcf cfo_nco;
+    double cfo_rad_per_samp;
+    long long integer_delay;
+    float gain;
+    float snr_linear;
+    // Average transmitted burst power scaled by gain^2 and the tap energy
+    float signal_power;
+    float tap_energy;
+    long long next_tick;
+    std::vector<std::complex<float> > scratch;
+    std::mt19937 noise_rng;
+    std::normal_distribution<float> noise_dist;
+};
+
+
+#endif // LINKCHANNEL_H_
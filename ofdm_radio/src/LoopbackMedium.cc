@@ -0,0 +1,356 @@
+/* LoopbackMedium.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <unistd.h>
+
+#include "LoopbackMedium.h"
+
+using namespace std;
+
+std::mutex LoopbackMedium::registry_mutex;
+std::map<std::string, LoopbackMedium*> LoopbackMedium::registry;
+
+LoopbackMedium* LoopbackMedium::attach(
+        std::string name,
+        double sample_rate,
+        double time_scale
+        )
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+
+    LoopbackMedium* medium;
+    std::map<std::string, LoopbackMedium*>::iterator it = registry.find(name);
+    if (it == registry.end()) {
+        medium = new LoopbackMedium(name, sample_rate, time_scale);
+        registry[name] = medium;
+    } else {
+        medium = it->second;
+        if (medium->sample_rate != sample_rate) {
+            cerr << "\nERROR in LoopbackMedium::attach: ";
+            cerr << "medium " << name << " runs at " << medium->sample_rate;
+            cerr << " S/s, not " << sample_rate << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    medium->num_attached++;
+
+    return(medium);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackMedium::detach(LoopbackMedium* medium)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+
+    medium->num_attached--;
+    if (medium->num_attached == 0) {
+        registry.erase(medium->name);
+        delete medium;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+LoopbackMedium::LoopbackMedium(
+        std::string name,
+        double sample_rate,
+        double time_scale
+        )
+{
+    if ((sample_rate <= 0.0) || (time_scale <= 0.0)) {
+        cerr << "\nERROR in LoopbackMedium constructor: ";
+        cerr << "sample_rate and time_scale must be positive" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    this->name = name;
+    this->sample_rate = sample_rate;
+    this->time_scale = time_scale;
+    num_attached = 0;
+    links_enabled = false;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+LoopbackMedium::~LoopbackMedium()
+{
+    std::map<std::pair<unsigned int, long long>, loopback_carrier_t*>::iterator it;
+    for (it = carriers.begin(); it != carriers.end(); it++) {
+        delete [] it->second->samples;
+        delete it->second;
+    }
+    std::map<std::pair<unsigned int, unsigned int>, loopback_link_t*>::iterator lit;
+    for (lit = links.begin(); lit != links.end(); lit++) {
+        if (lit->second->channel != NULL)
+            delete lit->second->channel;
+        delete lit->second;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double LoopbackMedium::getSampleRate()
+{
+    return(sample_rate);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double LoopbackMedium::getTimeScale()
+{
+    return(time_scale);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double LoopbackMedium::now()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return( time_scale * ((double)(t.tv_sec - t0.tv_sec) +
+                1.0E-9 * (double)(t.tv_nsec - t0.tv_nsec)) );
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+long long LoopbackMedium::nowTick()
+{
+    return((long long)floor(now() * sample_rate));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackMedium::waitForTick(long long tick)
+{
+    long long remaining;
+    while ((remaining = tick - nowTick()) > 0) {
+        // Sleep most of the remaining wall-clock time, then poll
+        double wall_wait = (double)remaining / (sample_rate * time_scale);
+        usleep((useconds_t)(0.9E6 * wall_wait) + 10);
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackMedium::setLinkChannel(
+        unsigned int tx_node_id,
+        unsigned int rx_node_id,
+        const link_channel_params_t& params
+        )
+{
+    std::lock_guard<std::mutex> lock(medium_mutex);
+
+    std::pair<unsigned int, unsigned int> key(tx_node_id, rx_node_id);
+    loopback_link_t* link;
+    std::map<std::pair<unsigned int, unsigned int>, loopback_link_t*>::iterator it =
+        links.find(key);
+    if (it == links.end()) {
+        link = new loopback_link_t;
+        links[key] = link;
+    } else {
+        link = it->second;
+        if (link->channel != NULL)
+            delete link->channel;
+    }
+    // Distinct, repeatable noise per link
+    link->channel = new LinkChannel(params, sample_rate,
+            1000 * tx_node_id + rx_node_id);
+    links_enabled = true;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+loopback_carrier_t* LoopbackMedium::getCarrier(unsigned int node_id, double freq)
+{
+    std::pair<unsigned int, long long> key(links_enabled ? node_id : 0,
+            llround(freq));
+    std::map<std::pair<unsigned int, long long>, loopback_carrier_t*>::iterator it =
+        carriers.find(key);
+    if (it != carriers.end())
+        return(it->second);
+
+    loopback_carrier_t* carrier = new loopback_carrier_t;
+    // std::complex default-constructs to zero
+    carrier->samples = new std::complex<float>[LOOPBACK_MEDIUM_RING_SIZE];
+    carrier->cleared_tick = nowTick();
+    carriers[key] = carrier;
+
+    return(carrier);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackMedium::clearTo(loopback_carrier_t* carrier, long long tick)
+{
+    if (tick <= carrier->cleared_tick)
+        return;
+
+    // Slots being reused still hold samples from a full ring ago
+    if (tick - carrier->cleared_tick >= LOOPBACK_MEDIUM_RING_SIZE) {
+        std::fill(carrier->samples, carrier->samples + LOOPBACK_MEDIUM_RING_SIZE,
+                std::complex<float>(0.0f));
+        carrier->cleared_tick = tick;
+        return;
+    }
+    while (carrier->cleared_tick < tick) {
+        size_t slot = carrier->cleared_tick & (LOOPBACK_MEDIUM_RING_SIZE - 1);
+        size_t n = LOOPBACK_MEDIUM_RING_SIZE - slot;
+        if ((long long)n > tick - carrier->cleared_tick)
+            n = tick - carrier->cleared_tick;
+        std::fill(&carrier->samples[slot], &carrier->samples[slot + n],
+                std::complex<float>(0.0f));
+        carrier->cleared_tick += n;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool LoopbackMedium::write(
+        unsigned int node_id,
+        double freq,
+        long long tick,
+        const std::complex<float>* x,
+        size_t num_samps
+        )
+{
+    std::lock_guard<std::mutex> lock(medium_mutex);
+
+    if (tick < nowTick())
+        return(false);
+
+    loopback_carrier_t* carrier = getCarrier(node_id, freq);
+    clearTo(carrier, tick + num_samps);
+    float energy = 0.0f;
+    size_t active = 0;
+    for (size_t i = 0; i < num_samps; i++) {
+        carrier->samples[(tick + i) & (LOOPBACK_MEDIUM_RING_SIZE - 1)] += x[i];
+        if (std::norm(x[i]) > LINK_CHANNEL_SILENCE_THRESHOLD) {
+            energy += std::norm(x[i]);
+            active++;
+        }
+    }
+    if (active > 0) {
+        float power = energy / (float)active;
+        std::map<unsigned int, float>::iterator it = tx_power.find(node_id);
+        if (it == tx_power.end())
+            tx_power[node_id] = power;
+        else
+            it->second += LOOPBACK_MEDIUM_TX_POWER_ALPHA * (power - it->second);
+    }
+
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+float LoopbackMedium::getTransmitPower(unsigned int node_id)
+{
+    std::lock_guard<std::mutex> lock(medium_mutex);
+
+    std::map<unsigned int, float>::iterator it = tx_power.find(node_id);
+    if (it == tx_power.end())
+        return(0.0f);
+    return(it->second);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool LoopbackMedium::read(
+        unsigned int node_id,
+        double freq,
+        long long tick,
+        std::complex<float>* y,
+        size_t num_samps
+        )
+{
+    if (links_enabled)
+        return(readLinks(node_id, freq, tick, y, num_samps));
+
+    std::lock_guard<std::mutex> lock(medium_mutex);
+
+    if (tick < nowTick() - LOOPBACK_MEDIUM_MAX_RX_LAG)
+        return(false);
+
+    loopback_carrier_t* carrier = getCarrier(node_id, freq);
+    clearTo(carrier, tick + num_samps);
+    for (size_t i = 0; i < num_samps; i++)
+        y[i] = carrier->samples[(tick + i) & (LOOPBACK_MEDIUM_RING_SIZE - 1)];
+
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool LoopbackMedium::readLinks(
+        unsigned int node_id,
+        double freq,
+        long long tick,
+        std::complex<float>* y,
+        size_t num_samps
+        )
+{
+    long long freq_key = llround(freq);
+    std::vector<loopback_link_t*>* heard;
+    {
+        std::lock_guard<std::mutex> lock(medium_mutex);
+        // Only this receiver's thread uses its entry once it exists
+        heard = &heard_links[node_id];
+        heard->clear();
+
+        std::map<std::pair<unsigned int, long long>, loopback_carrier_t*>::iterator it;
+        for (it = carriers.begin(); it != carriers.end(); it++) {
+            unsigned int tx_node_id = it->first.first;
+            if ((it->first.second != freq_key) || (tx_node_id == node_id))
+                continue;
+
+            std::pair<unsigned int, unsigned int> key(tx_node_id, node_id);
+            loopback_link_t* link;
+            std::map<std::pair<unsigned int, unsigned int>, loopback_link_t*>::iterator lit =
+                links.find(key);
+            if (lit == links.end()) {
+                link = new loopback_link_t;
+                link->channel = NULL;
+                links[key] = link;
+            } else {
+                link = lit->second;
+            }
+
+            long long src_tick = tick;
+            if (link->channel != NULL)
+                src_tick -= link->channel->getIntegerDelay();
+            if (src_tick < nowTick() - LOOPBACK_MEDIUM_MAX_RX_LAG)
+                return(false);
+
+            loopback_carrier_t* carrier = it->second;
+            clearTo(carrier, src_tick + num_samps);
+            link->raw.resize(num_samps);
+            for (size_t i = 0; i < num_samps; i++)
+                link->raw[i] =
+                    carrier->samples[(src_tick + i) & (LOOPBACK_MEDIUM_RING_SIZE - 1)];
+            heard->push_back(link);
+        }
+    }
+
+    // Links into this receiver are only touched by its own reads, so the
+    // channel models run without holding up other radios
+    std::fill(y, y + num_samps, std::complex<float>(0.0f));
+    for (size_t k = 0; k < heard->size(); k++) {
+        loopback_link_t* link = (*heard)[k];
+        if (link->channel != NULL) {
+            link->channel->execute(tick, &link->raw[0], y, num_samps);
+        } else {
+            for (size_t i = 0; i < num_samps; i++)
+                y[i] += link->raw[i];
+        }
+    }
+
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,138 @@
+/* LoopbackMedium.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef LOOPBACKMEDIUM_H_
+#define LOOPBACKMEDIUM_H_
+
+#include <complex>
+#include <cstdlib>
+#include <string>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <utility>
+#include <time.h>
+
+#include "LinkChannel.h"
+
+// Samples kept per carrier; must be a power of two.  At the nominal 2x
+// resampled device rate of 10 MS/s this covers about 0.4 s.
+#define LOOPBACK_MEDIUM_RING_SIZE                   (1 << 22)
+// Furthest ahead of the virtual clock a timed burst may be written; a
+// sender further ahead waits, as a USRP with full transmit buffers would
+#define LOOPBACK_MEDIUM_MAX_TX_LEAD                 (LOOPBACK_MEDIUM_RING_SIZE / 4)
+// Furthest behind the virtual clock a receiver may read before it overflows
+#define LOOPBACK_MEDIUM_MAX_RX_LAG                  (LOOPBACK_MEDIUM_RING_SIZE / 2)
+// Weight of each write in a node's running transmit power
+#define LOOPBACK_MEDIUM_TX_POWER_ALPHA              0.1f
+
+typedef struct {
+    std::complex<float>* samples;
+    long long cleared_tick;     // ring is zero from here on
+} loopback_carrier_t;
+
+typedef struct {
+    LinkChannel* channel;       // NULL for an ideal link
+    std::vector<std::complex<float> > raw;
+} loopback_link_t;
+
+// Shared over-the-air sample timeline for LoopbackRadioDevice objects in one
+// process.  Time is a virtual clock running at time_scale times wall-clock
+// speed, so a heavily loaded host can run the waveform slower than real time
+// without the radios seeing late bursts or overflows.  Each tuned frequency
+// is its own carrier; transmitters add into the carrier at a sample tick and
+// every receiver tuned to that frequency reads the sum.
+//
+// Once any link channel is set the medium keeps a carrier per transmitting
+// node instead, and a receiver hears the sum of every other node's carrier
+// on its frequency, each passed through the LinkChannel for that pair (or
+// unchanged if that pair has none).  Links must be set before the radios
+// attached to the medium start streaming.
+class LoopbackMedium
+{
+public:
+    // Media are shared by name; the first attach fixes the sample rate and
+    // time scale and later attaches must agree on the sample rate
+    static LoopbackMedium* attach(
+        std::string name,
+        double sample_rate,
+        double time_scale
+    );
+    static void detach(LoopbackMedium* medium);
+
+    double getSampleRate();
+    double getTimeScale();
+    // Virtual clock in seconds and in sample ticks
+    double now();
+    long long nowTick();
+    // Blocks until the virtual clock reaches tick
+    void waitForTick(long long tick);
+
+    void setLinkChannel(
+        unsigned int tx_node_id,
+        unsigned int rx_node_id,
+        const link_channel_params_t& params
+    );
+
+    // Returns false (and writes nothing) if the burst starts in the past
+    bool write(
+        unsigned int node_id,
+        double freq,
+        long long tick,
+        const std::complex<float>* x,
+        size_t num_samps
+    );
+    // Running average power of the non-silent samples node_id has written,
+    // 0 before its first transmission
+    float getTransmitPower(unsigned int node_id);
+    // Returns false (and reads nothing) if the samples have been overwritten
+    bool read(
+        unsigned int node_id,
+        double freq,
+        long long tick,
+        std::complex<float>* y,
+        size_t num_samps
+    );
+
+private:
+    LoopbackMedium(
+        std::string name,
+        double sample_rate,
+        double time_scale
+    );
+    ~LoopbackMedium();
+
+    loopback_carrier_t* getCarrier(unsigned int node_id, double freq);
+    bool readLinks(
+        unsigned int node_id,
+        double freq,
+        long long tick,
+        std::complex<float>* y,
+        size_t num_samps
+    );
+    void clearTo(loopback_carrier_t* carrier, long long tick);
+
+    static std::mutex registry_mutex;
+    static std::map<std::string, LoopbackMedium*> registry;
+
+    std::string name;
+    unsigned int num_attached;
+    double sample_rate;
+    double time_scale;
+    struct timespec t0;
+
+    std::mutex medium_mutex;
+    // Keyed by transmitting node (always 0 without links) and frequency
+    std::map<std::pair<unsigned int, long long>, loopback_carrier_t*> carriers;
+    bool links_enabled;
+    std::map<unsigned int, float> tx_power;
+    // Keyed by transmitting then receiving node
+    std::map<std::pair<unsigned int, unsigned int>, loopback_link_t*> links;
+    // Links each receiver heard on its last read, kept so reads do not allocate
+    std::map<unsigned int, std::vector<loopback_link_t*> > heard_links;
+};
+
+
+#endif // LOOPBACKMEDIUM_H_
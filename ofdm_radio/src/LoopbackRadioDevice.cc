@@ -0,0 +1,469 @@
+/* LoopbackRadioDevice.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <cmath>
+#include <unistd.h>
+
+#include "LoopbackRadioDevice.h"
+
+using namespace std;
+
+LoopbackRadioDevice::LoopbackRadioDevice(
+        std::string medium_name,
+        unsigned int node_id,
+        double sample_rate,
+        double time_scale,
+        double noise_floor_db,
+        std::string rx_file,
+        std::string tx_file
+        )
+{
+    this->node_id = node_id;
+    this->sample_rate = sample_rate;
+    medium = LoopbackMedium::attach(medium_name, sample_rate, time_scale);
+    time_offset = 0.0;
+
+    rx_freq = 0.0;
+    rx_gain = 0.0;
+    rx_continuous = false;
+    rx_burst_remaining = 0;
+    rx_tick = 0;
+    // Complex noise of the given power, split between I and Q
+    noise_std = sqrtf(0.5f * powf(10.0f, (float)noise_floor_db / 10.0f));
+
+    rx_fp = NULL;
+    if (!rx_file.empty()) {
+        rx_fp = fopen(rx_file.c_str(), "rb");
+        if (rx_fp == NULL) {
+            cerr << "\nERROR in LoopbackRadioDevice constructor: ";
+            cerr << "unable to open " << rx_file << endl;
+            exit(EXIT_FAILURE);
+        }
+        std::complex<float> first_sample;
+        if (fread(&first_sample, sizeof(std::complex<float>), 1, rx_fp) != 1) {
+            cerr << "\nERROR in LoopbackRadioDevice constructor: ";
+            cerr << rx_file << " holds no fc32 samples" << endl;
+            exit(EXIT_FAILURE);
+        }
+        rewind(rx_fp);
+    }
+
+    tx_freq = 0.0;
+    tx_gain = 0.0;
+    tx_in_burst = false;
+    tx_burst_dropped = false;
+    tx_tick = 0;
+
+    tx_fp = NULL;
+    if (!tx_file.empty()) {
+        tx_fp = fopen(tx_file.c_str(), "wb");
+        if (tx_fp == NULL) {
+            cerr << "\nERROR in LoopbackRadioDevice constructor: ";
+            cerr << "unable to open " << tx_file << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+LoopbackRadioDevice::~LoopbackRadioDevice()
+{
+    if (rx_fp != NULL)
+        fclose(rx_fp);
+    if (tx_fp != NULL)
+        fclose(tx_fp);
+    LoopbackMedium::detach(medium);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+long long LoopbackRadioDevice::deviceTime2Tick(const uhd::time_spec_t& time)
+{
+    return(llround((time.get_real_secs() + time_offset) * sample_rate));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+uhd::time_spec_t LoopbackRadioDevice::tick2DeviceTime(long long tick)
+{
+    return(uhd::time_spec_t((double)tick / sample_rate - time_offset));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setRxAntenna(const std::string& antenna)
+{
+    // Single virtual antenna
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setRxGain(double gain)
+{
+    rx_gain = gain;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setRxRate(double rate)
+{
+    if (rate != sample_rate) {
+        cerr << "\nERROR in LoopbackRadioDevice::setRxRate: ";
+        cerr << "the loopback medium runs at " << sample_rate << " S/s" << endl;
+        exit(EXIT_FAILURE);
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double LoopbackRadioDevice::getRxRate()
+{
+    return(sample_rate);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setRxFreq(const uhd::tune_request_t& tune_req)
+{
+    if (tune_req.rf_freq_policy == uhd::tune_request_t::POLICY_MANUAL) {
+        rx_freq = tune_req.rf_freq + tune_req.dsp_freq;
+    } else {
+        rx_freq = tune_req.target_freq;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double LoopbackRadioDevice::getRxFreq()
+{
+    return(rx_freq);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool LoopbackRadioDevice::isRxLoLocked()
+{
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::initRxStream()
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t LoopbackRadioDevice::getMaxRecvSamps()
+{
+    return(LOOPBACK_MAX_PACKET_SAMPS);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::issueStreamCmd(const uhd::stream_cmd_t& stream_cmd)
+{
+    std::lock_guard<std::mutex> lock(rx_mutex);
+
+    switch (stream_cmd.stream_mode) {
+        case uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS :
+            rx_continuous = true;
+            rx_burst_remaining = 0;
+            break;
+        case uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS :
+            rx_continuous = false;
+            rx_burst_remaining = 0;
+            return;
+        case uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE :
+        case uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_MORE :
+            rx_continuous = false;
+            rx_burst_remaining = stream_cmd.num_samps;
+            break;
+    }
+
+    if (stream_cmd.stream_now) {
+        rx_tick = medium->nowTick();
+    } else {
+        rx_tick = deviceTime2Tick(stream_cmd.time_spec);
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::readRxFile(
+        std::complex<float>* y,
+        size_t num_samps
+        )
+{
+    size_t n = 0;
+    while (n < num_samps) {
+        size_t nr = fread(&y[n], sizeof(std::complex<float>), num_samps - n, rx_fp);
+        n += nr;
+        if (n < num_samps)
+            rewind(rx_fp);
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t LoopbackRadioDevice::recv(
+        std::complex<float>* buffer,
+        size_t num_samps,
+        uhd::rx_metadata_t& md,
+        double timeout,
+        bool one_packet
+        )
+{
+    std::lock_guard<std::mutex> lock(rx_mutex);
+
+    md.has_time_spec = false;
+    md.more_fragments = false;
+    md.fragment_offset = 0;
+    md.start_of_burst = false;
+    md.end_of_burst = false;
+
+    if (!rx_continuous && (rx_burst_remaining == 0)) {
+        usleep((useconds_t)(1.0E6 * timeout));
+        md.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+        return(0);
+    }
+
+    size_t n = num_samps;
+    if (one_packet && (n > LOOPBACK_MAX_PACKET_SAMPS))
+        n = LOOPBACK_MAX_PACKET_SAMPS;
+    if (!rx_continuous && (n > rx_burst_remaining))
+        n = rx_burst_remaining;
+
+    // Samples are not available until the virtual clock has passed them
+    double wall_wait = (double)(rx_tick + (long long)n - medium->nowTick()) /
+        (sample_rate * medium->getTimeScale());
+    if (wall_wait > timeout) {
+        usleep((useconds_t)(1.0E6 * timeout));
+        md.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+        return(0);
+    }
+    medium->waitForTick(rx_tick + (long long)n);
+
+    if (rx_fp != NULL) {
+        readRxFile(buffer, n);
+    } else if (!medium->read(node_id, rx_freq, rx_tick, buffer, n)) {
+        // Fell too far behind the medium; resume at the present, as a USRP
+        // reports an overflow and drops the samples it could not deliver
+        rx_tick = medium->nowTick();
+        md.error_code = uhd::rx_metadata_t::ERROR_CODE_OVERFLOW;
+        return(0);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        float noise_i = noise_std * noise_dist(noise_rng);
+        float noise_q = noise_std * noise_dist(noise_rng);
+        buffer[i] += std::complex<float>(noise_i, noise_q);
+    }
+
+    md.has_time_spec = true;
+    md.time_spec = tick2DeviceTime(rx_tick);
+    md.error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+    rx_tick += n;
+    if (!rx_continuous) {
+        rx_burst_remaining -= n;
+        md.end_of_burst = (rx_burst_remaining == 0);
+    }
+
+    return(n);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setTxAntenna(const std::string& antenna)
+{
+    // Single virtual antenna
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setTxGain(double gain)
+{
+    tx_gain = gain;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setTxRate(double rate)
+{
+    if (rate != sample_rate) {
+        cerr << "\nERROR in LoopbackRadioDevice::setTxRate: ";
+        cerr << "the loopback medium runs at " << sample_rate << " S/s" << endl;
+        exit(EXIT_FAILURE);
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double LoopbackRadioDevice::getTxRate()
+{
+    return(sample_rate);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setTxFreq(const uhd::tune_request_t& tune_req)
+{
+    if (tune_req.rf_freq_policy == uhd::tune_request_t::POLICY_MANUAL) {
+        tx_freq = tune_req.rf_freq + tune_req.dsp_freq;
+    } else {
+        tx_freq = tune_req.target_freq;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool LoopbackRadioDevice::isTxLoLocked()
+{
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::initTxStream()
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t LoopbackRadioDevice::getMaxSendSamps()
+{
+    return(LOOPBACK_MAX_PACKET_SAMPS);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::pushAsyncMsg(
+        uhd::async_metadata_t::event_code_t event_code,
+        long long tick
+        )
+{
+    uhd::async_metadata_t async_md;
+    async_md.channel = 0;
+    async_md.has_time_spec = true;
+    async_md.time_spec = tick2DeviceTime(tick);
+    async_md.event_code = event_code;
+
+    std::lock_guard<std::mutex> lock(async_mutex);
+    // Callers are not required to drain messages, so keep only the newest
+    if (async_queue.size() == LOOPBACK_ASYNC_QUEUE_SIZE)
+        async_queue.pop_front();
+    async_queue.push_back(async_md);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t LoopbackRadioDevice::send(
+        const std::complex<float>* buffer,
+        size_t num_samps,
+        const uhd::tx_metadata_t& md,
+        double timeout
+        )
+{
+    std::lock_guard<std::mutex> lock(tx_mutex);
+
+    bool burst_start = md.start_of_burst || !tx_in_burst;
+    if (burst_start) {
+        tx_in_burst = true;
+        tx_burst_dropped = false;
+        // Untimed bursts go out after one packet of device latency
+        tx_tick = md.has_time_spec ? deviceTime2Tick(md.time_spec) :
+            medium->nowTick() + LOOPBACK_MAX_PACKET_SAMPS;
+    } else if (md.has_time_spec) {
+        tx_tick = deviceTime2Tick(md.time_spec);
+    }
+
+    if ((num_samps > 0) && !tx_burst_dropped) {
+        medium->waitForTick(tx_tick + (long long)num_samps - LOOPBACK_MEDIUM_MAX_TX_LEAD);
+        if (medium->write(node_id, tx_freq, tx_tick, buffer, num_samps)) {
+            if (tx_fp != NULL)
+                fwrite(buffer, sizeof(std::complex<float>), num_samps, tx_fp);
+        } else {
+            // A late start is a time error; falling behind mid-burst is an
+            // underflow.  Either way the rest of the burst is discarded.
+            tx_burst_dropped = true;
+            pushAsyncMsg(burst_start ? uhd::async_metadata_t::EVENT_CODE_TIME_ERROR :
+                    uhd::async_metadata_t::EVENT_CODE_UNDERFLOW, tx_tick);
+        }
+    }
+    tx_tick += num_samps;
+
+    if (md.end_of_burst) {
+        tx_in_burst = false;
+        if (!tx_burst_dropped)
+            pushAsyncMsg(uhd::async_metadata_t::EVENT_CODE_BURST_ACK, tx_tick);
+    }
+
+    return(num_samps);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool LoopbackRadioDevice::recvAsyncMsg(
+        uhd::async_metadata_t& md,
+        double timeout
+        )
+{
+    {
+        std::lock_guard<std::mutex> lock(async_mutex);
+        if (!async_queue.empty()) {
+            md = async_queue.front();
+            async_queue.pop_front();
+            return(true);
+        }
+    }
+    usleep((useconds_t)(1.0E6 * timeout));
+
+    std::lock_guard<std::mutex> lock(async_mutex);
+    if (async_queue.empty())
+        return(false);
+    md = async_queue.front();
+    async_queue.pop_front();
+
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setTimeSource(const std::string& source)
+{
+    // Every device on a medium shares its clock, so any source is "locked"
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setTimeUnknownPps(const uhd::time_spec_t& time)
+{
+    // The shared PPS edge is the next whole second of medium time
+    time_offset = ceil(medium->now()) - time.get_real_secs();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void LoopbackRadioDevice::setTimeNow(const uhd::time_spec_t& time)
+{
+    time_offset = medium->now() - time.get_real_secs();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+uhd::time_spec_t LoopbackRadioDevice::getTimeNow()
+{
+    return(uhd::time_spec_t(medium->now() - time_offset));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool LoopbackRadioDevice::isRefLocked()
+{
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,135 @@
+/* LoopbackRadioDevice.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef LOOPBACKRADIODEVICE_H_
+#define LOOPBACKRADIODEVICE_H_
+
+#include <cstdio>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <random>
+
+#include "RadioDevice.h"
+#include "LoopbackMedium.h"
+
+// Samples per recv in one-packet mode and per streamer send, matching the
+// fc32 payload of a standard 1500 byte UHD Ethernet frame
+#define LOOPBACK_MAX_PACKET_SAMPS                   363
+#define LOOPBACK_ASYNC_QUEUE_SIZE                   64
+
+// RadioDevice with no hardware behind it.  Transmitted bursts are added to
+// a LoopbackMedium at their timestamps and received samples are read back
+// from it, so a basestation and mobiles in one process hear each other.
+// Timestamps follow the medium's virtual clock; setTimeNow only moves this
+// device's offset from it, as it would on a USRP.  node_id names this radio
+// to the medium's link channels.
+//
+// Optionally the receiver reads raw interleaved fc32 samples from rx_file
+// (looping at the end) instead of the medium, and every transmitted sample
+// is also appended to tx_file in the same format.
+class LoopbackRadioDevice : public RadioDevice
+{
+public:
+    LoopbackRadioDevice(
+        std::string medium_name,
+        unsigned int node_id,
+        double sample_rate,
+        double time_scale,
+        double noise_floor_db,
+        std::string rx_file,
+        std::string tx_file
+    );
+    ~LoopbackRadioDevice();
+
+    void setRxAntenna(const std::string& antenna);
+    void setRxGain(double gain);
+    void setRxRate(double rate);
+    double getRxRate();
+    void setRxFreq(const uhd::tune_request_t& tune_req);
+    double getRxFreq();
+    bool isRxLoLocked();
+    void initRxStream();
+    size_t getMaxRecvSamps();
+    void issueStreamCmd(const uhd::stream_cmd_t& stream_cmd);
+    size_t recv(
+        std::complex<float>* buffer,
+        size_t num_samps,
+        uhd::rx_metadata_t& md,
+        double timeout,
+        bool one_packet
+    );
+
+    void setTxAntenna(const std::string& antenna);
+    void setTxGain(double gain);
+    void setTxRate(double rate);
+    double getTxRate();
+    void setTxFreq(const uhd::tune_request_t& tune_req);
+    bool isTxLoLocked();
+    void initTxStream();
+    size_t getMaxSendSamps();
+    size_t send(
+        const std::complex<float>* buffer,
+        size_t num_samps,
+        const uhd::tx_metadata_t& md,
+        double timeout
+    );
+    bool recvAsyncMsg(
+        uhd::async_metadata_t& md,
+        double timeout
+    );
+
+    void setTimeSource(const std::string& source);
+    void setTimeUnknownPps(const uhd::time_spec_t& time);
+    void setTimeNow(const uhd::time_spec_t& time);
+    uhd::time_spec_t getTimeNow();
+    bool isRefLocked();
+
+private:
+    long long deviceTime2Tick(const uhd::time_spec_t& time);
+    uhd::time_spec_t tick2DeviceTime(long long tick);
+    void readRxFile(
+        std::complex<float>* y,
+        size_t num_samps
+    );
+    void pushAsyncMsg(
+        uhd::async_metadata_t::event_code_t event_code,
+        long long tick
+    );
+
+    LoopbackMedium* medium;
+    unsigned int node_id;
+    double sample_rate;
+    // Device time is medium time minus this offset; the tx thread moves it
+    // while the rx thread reads it
+    std::atomic<double> time_offset;
+
+    // Receive side
+    double rx_freq;
+    double rx_gain;
+    std::mutex rx_mutex;
+    bool rx_continuous;
+    size_t rx_burst_remaining;
+    long long rx_tick;
+    float noise_std;
+    std::mt19937 noise_rng;
+    std::normal_distribution<float> noise_dist;
+    FILE* rx_fp;
+
+    // Transmit side
+    double tx_freq;
+    double tx_gain;
+    std::mutex tx_mutex;
+    bool tx_in_burst;
+    bool tx_burst_dropped;
+    long long tx_tick;
+    FILE* tx_fp;
+
+    std::mutex async_mutex;
+    std::deque<uhd::async_metadata_t> async_queue;
+};
+
+
+#endif // LOOPBACKRADIODEVICE_H_
@@ -0,0 +1,553 @@
+/* NetworkSimulator.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <utility>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "NetworkSimulator.h"
+#include "HeartbeatDefs.h"
+
+using namespace std;
+
+NetworkSimulator::NetworkSimulator(int argc, char **argv)
+{
+    // The shared settings; every node re-parses the same command line
+    optind = 0;
+    rc = new RadioConfig(argc, argv);
+    rc->display_config();
+
+    for (unsigned int i = 0; i < rc->num_nodes_in_net; i++) {
+        if (rc->nodes_in_net[i] != i + 1) {
+            cerr << "\nERROR in NetworkSimulator constructor: ";
+            cerr << "network_node_id must list 1 to " << rc->num_nodes_in_net;
+            cerr << " in order; the basestation is the highest ID" << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Holding the medium from here on lets the links be in place before
+    // any radio attaches and streams
+    medium = LoopbackMedium::attach(rc->loopback_medium,
+            RHC_NOMINAL_RESAMPLER_RATIO * rc->sample_rate,
+            rc->loopback_time_scale);
+    tun_tap = false;
+    readChannelConfig();
+
+    for (unsigned int i = 0; i < rc->num_nodes_in_net; i++)
+        nodes.push_back(createNode(argc, argv, rc->nodes_in_net[i]));
+
+    on_air_time = 0.0;
+    jammer_onset_time = 0.0;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+NetworkSimulator::~NetworkSimulator()
+{
+    for (unsigned int i = 0; i < nodes.size(); i++)
+        destroyNode(nodes[i]);
+    LoopbackMedium::detach(medium);
+    delete rc;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void NetworkSimulator::lookupLinkParams(
+        config_setting_t* setting,
+        link_channel_params_t* params
+        )
+{
+    double dtmp;
+    if( config_setting_lookup_float(setting, "snr_db", &dtmp) )
+        params->snr_db = dtmp;
+    if( config_setting_lookup_float(setting, "attenuation_db", &dtmp) )
+        params->attenuation_db = dtmp;
+    if( config_setting_lookup_float(setting, "cfo", &dtmp) )
+        params->cfo = dtmp;
+    if( config_setting_lookup_float(setting, "timing_offset", &dtmp) )
+        params->timing_offset = dtmp;
+
+    // Interleaved real and imaginary parts
+    config_setting_t* taps = config_setting_get_member(setting, "multipath_taps");
+    if (taps != NULL) {
+        int num_values = config_setting_length(taps);
+        if ((num_values == 0) || (num_values % 2 != 0)) {
+            cerr << "\nERROR in NetworkSimulator::lookupLinkParams: ";
+            cerr << "multipath_taps needs real, imaginary pairs" << endl;
+            exit(EXIT_FAILURE);
+        }
+        params->taps.clear();
+        for (int ctr = 0; ctr < num_values; ctr += 2) {
+            params->taps.push_back(std::complex<float>(
+                        (float)config_setting_get_float_elem(taps, ctr),
+                        (float)config_setting_get_float_elem(taps, ctr + 1)));
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void NetworkSimulator::readJammerConfig(config_setting_t* setting)
+{
+    double dtmp;
+    int itmp;
+    const char* stmp;
+
+    if( config_setting_lookup_string(setting, "profile", &stmp) )
+        jammer_params.profile = Jammer::profileFromString(string(stmp));
+    if( config_setting_lookup_float(setting, "js_db", &dtmp) )
+        jammer_params.js_db = dtmp;
+    if( config_setting_lookup_int(setting, "reference_node", &itmp) )
+        jammer_params.reference_node = (unsigned int)itmp;
+    if( config_setting_lookup_int(setting, "first_subcarrier", &itmp) )
+        jammer_params.first_subcarrier = (unsigned int)itmp;
+    if( config_setting_lookup_int(setting, "num_subcarriers", &itmp) )
+        jammer_params.num_subcarriers = (unsigned int)itmp;
+    if( config_setting_lookup_float(setting, "start_time", &dtmp) )
+        jammer_params.start_time = dtmp;
+    if( config_setting_lookup_float(setting, "stop_time", &dtmp) )
+        jammer_params.stop_time = dtmp;
+    if( config_setting_lookup_float(setting, "sweep_period", &dtmp) )
+        jammer_params.sweep_period = dtmp;
+    if( config_setting_lookup_float(setting, "pulse_period", &dtmp) )
+        jammer_params.pulse_period = dtmp;
+    if( config_setting_lookup_float(setting, "duty_cycle", &dtmp) )
+        jammer_params.duty_cycle = dtmp;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void NetworkSimulator::readChannelConfig()
+{
+    default_link.snr_db = 30.0;
+    default_link.attenuation_db = 0.0;
+    default_link.cfo = 0.0;
+    default_link.timing_offset = 0.0;
+    default_link.taps.clear();
+
+    // Jammer defaults: 20 dB partial band over the middle 100 subcarriers,
+    // on downlink, from 10 s into the run
+    jammer_params.profile = JAMMER_PROFILE_NONE;
+    jammer_params.js_db = 20.0;
+    jammer_params.reference_node = rc->num_nodes_in_net;
+    jammer_params.first_subcarrier = 206;
+    jammer_params.num_subcarriers = 100;
+    jammer_params.start_time = 10.0;
+    jammer_params.stop_time = -1.0;
+    jammer_params.sweep_period = 1.0;
+    jammer_params.pulse_period = 0.1;
+    jammer_params.duty_cycle = 0.5;
+
+    config_t cfg;
+    config_init(&cfg);
+    if(! config_read_file(&cfg, rc->config_file.c_str()) ) {
+        fprintf(stderr, "ERROR: problem processing configuration file %s on line %d: %s\n", \
+                config_error_file(&cfg), config_error_line(&cfg), config_error_text(&cfg));
+        config_destroy(&cfg);
+        exit(EXIT_FAILURE);
+    }
+
+    std::map<std::pair<unsigned int, unsigned int>, link_channel_params_t> overrides;
+    config_setting_t* sim = config_lookup(&cfg, "simulator");
+    if (sim != NULL) {
+        lookupLinkParams(sim, &default_link);
+
+        int itmp;
+        if( config_setting_lookup_int(sim, "tun_tap", &itmp) )
+            tun_tap = (itmp != 0);
+
+        config_setting_t* jammer = config_setting_get_member(sim, "jammer");
+        if (jammer != NULL)
+            readJammerConfig(jammer);
+
+        config_setting_t* links = config_setting_get_member(sim, "links");
+        if (links != NULL) {
+            for (int ctr = 0; ctr < config_setting_length(links); ctr++) {
+                config_setting_t* link = config_setting_get_elem(links, ctr);
+                int tx_node_id;
+                int rx_node_id;
+                if ( !config_setting_lookup_int(link, "tx_node", &tx_node_id) ||
+                        !config_setting_lookup_int(link, "rx_node", &rx_node_id) ) {
+                    cerr << "\nERROR in NetworkSimulator::readChannelConfig: ";
+                    cerr << "each entry of links needs tx_node and rx_node" << endl;
+                    exit(EXIT_FAILURE);
+                }
+                link_channel_params_t params = default_link;
+                lookupLinkParams(link, &params);
+                overrides[std::make_pair((unsigned int)tx_node_id,
+                        (unsigned int)rx_node_id)] = params;
+            }
+        }
+    }
+    config_destroy(&cfg);
+
+    for (unsigned int tx = 1; tx <= rc->num_nodes_in_net; tx++) {
+        for (unsigned int rx = 1; rx <= rc->num_nodes_in_net; rx++) {
+            if (tx == rx)
+                continue;
+            std::map<std::pair<unsigned int, unsigned int>, link_channel_params_t>::iterator it =
+                overrides.find(std::make_pair(tx, rx));
+            if (it != overrides.end())
+                medium->setLinkChannel(tx, rx, it->second);
+            else
+                medium->setLinkChannel(tx, rx, default_link);
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+sim_node_t* NetworkSimulator::createNode(
+        int argc,
+        char **argv,
+        unsigned char node_id
+        )
+{
+    sim_node_t* node = new sim_node_t;
+
+    // Restart getopt so the command line is parsed from the beginning
+    optind = 0;
+    node->rc = new RadioConfig(argc, argv);
+    node->rc->node_id = node_id;
+    node->rc->node_ip_address = "10.10.10." + std::to_string(node_id);
+    node->rc->node_is_basestation = (node_id == rc->num_nodes_in_net);
+    node->rc->radio_hardware = "RADIO_MODEL_LOOPBACK";
+    node->rc->loopback_rx_file = "";
+    node->rc->loopback_tx_file = "";
+    node->rc->using_tun_tap = tun_tap;
+    node->rc->manual_mode = false;
+    std::string tap_name = SIM_TAP_PREFIX + std::to_string(node_id);
+    std::string prefix = "sim_node" + std::to_string(node_id) + "_";
+    node->rc->app_log_file = prefix + "app.log";
+    node->rc->rf_log_file = prefix + "rf.log";
+    node->rc->alloc_log_file = prefix + "alloc.log";
+    node->rc->packet_log_file = prefix + "packets.log";
+    if (!node->rc->evm_log_file.empty())
+        node->rc->evm_log_file = prefix + "evm.bin";
+    if (!node->rc->iq_capture_file.empty())
+        node->rc->iq_capture_file = prefix + "iq.cap";
+
+    // Same order of initialization as main.cc
+    RadioConfig* nrc = node->rc;
+    node->startup_profiler = new StartupProfiler();
+    node->app = new AppManager(nrc->run_time, nrc->debug);
+    node->app_log = new Logger(nrc->app_log_file);
+    node->app->doAppLogReport(node->app_log, APP_LOG_REPORT_STARTED);
+    node->rf_log = new Logger(nrc->rf_log_file);
+    node->rx_timer = timer_create();
+    timer_tic(node->rx_timer);
+    node->rxf_event_log = new Logger(prefix + "rxf_event.log");
+    node->uhd_error_log = new Logger(prefix + "uhd_error.log");
+    node->ps = new PacketStore(tap_name, nrc->node_id, nrc->num_nodes_in_net,
+            nrc->nodes_in_net, nrc->frame_size, nrc->using_tun_tap,
+            nrc->using_tun_tap ? SIM_NETNS_PREFIX + std::to_string(node_id) : "");
+    node->startup_profiler->begin("RadioHardwareConfig");
+    node->rhc = new RadioHardwareConfig(nrc->radio_hardware, nrc->usrp_address_name,
+            nrc->radio_hardware_clock, nrc->node_is_basestation, nrc->node_id,
+            nrc->num_nodes_in_net, nrc->frame_size,
+            nrc->normal_freq, nrc->rf_gain_rx, nrc->rf_gain_tx, nrc->sample_rate,
+            node->app_log, node->rf_log,
+            RXF_LOG_LEVEL_FILE_ONLY, node->rxf_event_log,
+            UHD_ERROR_LOG_LEVEL_FILE_ONLY, node->uhd_error_log,
+            nrc->debug, nrc->u4, nrc->using_tun_tap, node->ps, node->app,
+            node->rx_timer, nrc->slow, nrc->ofdma_tx_window, nrc->mc_tx_window,
+            nrc->anti_jam, nrc, node->startup_profiler);
+    node->startup_profiler->end();
+
+    node->ftg = new FreqTableGenerator(nrc->node_is_basestation, nrc->normal_freq,
+            node->rhc->getTx2RxFreqSeparation(),
+            nrc->fh_freq_min, nrc->fh_freq_max, nrc->num_fh_prohibited_ranges,
+            nrc->fh_prohibited_range_begin, nrc->fh_prohibited_range_end,
+            node->rhc->getFhWindowSmall(), node->rhc->getFhWindowMedium(),
+            nrc->num_channels, node->rhc->isUhdRxTuningBugPresent(), nrc->debug);
+    node->rs = new RadioScheduler(nrc->node_is_basestation, nrc->node_id,
+            nrc->num_nodes_in_net, nrc->nodes_in_net, HEARTBEAT_ACTIVITY_PER_SCHEDULE,
+            nrc->num_channels, node->rhc->getRxRateMeasured(),
+            node->rhc->getTxRateMeasured(), node->rhc->getTxBurstLength(),
+            node->rhc->getUhdRetuneDelay(), nrc->debug, nrc->u4, nrc->uplink);
+    node->p2m = new Phy2Mac(nrc->node_is_basestation, nrc->node_id,
+            nrc->num_nodes_in_net, nrc->nodes_in_net,
+            HEARTBEAT_ACTIVITY_PER_SCHEDULE, HEARTBEAT_POLICY_A,
+            P2M_FRAME_HEADER_DEFAULT_SIZE, P2M_FRAME_PAYLOAD_DEFAULT_SIZE,
+            tap_name, nrc->debug, nrc->using_tun_tap, node->ps);
+    node->fsg = new FhSeqGenerator(FH_SEQ_RESTART_ALG_A, node->rs->getFhTaskSchedSize(),
+            node->ftg->getRfTableSize(), node->ftg->getDspTableSize(),
+            nrc->num_channels, nrc->debug);
+    node->fsg->makeSeq();
+    node->rtm = new RadioTaskManager(node->fsg, node->ftg, node->rhc, node->rs,
+            node->p2m, nrc->debug, nrc->u4);
+    node->rs->calcU4Schedule();
+    node->ajc = new AntiJamController(nrc, node->rhc, node->rs, node->app,
+            node->app_log, medium->getTimeScale());
+    node->medium = medium;
+    node->jammer = NULL;
+
+    node->app->doAppLogReport(node->app_log, APP_LOG_REPORT_INIT_DONE);
+    node->app_log->write_log();
+    node->schedules_run = 0;
+
+    return(node);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void NetworkSimulator::destroyNode(sim_node_t* node)
+{
+    delete node->ajc;
+    delete node->rtm;
+    delete node->fsg;
+    delete node->p2m;
+    delete node->rs;
+    delete node->ftg;
+    delete node->rhc;
+    if (node->rc->using_tun_tap)
+        node->ps->close_interface();
+    delete node->ps;
+    delete node->uhd_error_log;
+    delete node->rxf_event_log;
+    timer_destroy(node->rx_timer);
+    delete node->rf_log;
+    delete node->app_log;
+    delete node->app;
+    delete node->startup_profiler;
+    delete node->rc;
+    delete node;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+int NetworkSimulator::run(volatile sig_atomic_t* terminate)
+{
+    pthread_attr_t pthread_attr;
+    pthread_attr_init(&pthread_attr);
+    pthread_attr_setdetachstate(&pthread_attr, PTHREAD_CREATE_JOINABLE);
+    void* thread_status;
+    unsigned int i;
+
+    // The jammer works the downlink the mobiles receive
+    Jammer* jammer = NULL;
+    if (jammer_params.profile != JAMMER_PROFILE_NONE)
+        jammer = new Jammer(jammer_params, medium, rc->normal_freq,
+                RHC_NOMINAL_RESAMPLER_RATIO);
+
+    timer on_air_timer = timer_create();
+    timer_tic(on_air_timer);
+    for (i = 0; i < nodes.size(); i++) {
+        sim_node_t* node = nodes[i];
+        node->jammer = jammer;
+        node->batches.clear();
+        node->ajc->start();
+        node->rx_thread_args.run_time = node->rc->run_time -
+            node->app->getElapsedTime() + 1.0;
+        node->rx_thread_args.rhc_ptr = node->rhc;
+        node->rx_thread_args.timer = NULL;
+        if (pthread_create(&node->rx_thread, &pthread_attr,
+                    node->rc->node_is_basestation ? run_mc_rx : run_ofdma_rx,
+                    (void*)&node->rx_thread_args) != 0) {
+            cerr << "\nERROR in NetworkSimulator::run: ";
+            cerr << "unable to create rx thread for node " << (int)node->rc->node_id << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Let every receiver come up before the first transmit
+    usleep((useconds_t)(SIM_RX_SETTLE_TIME * 1.0E6));
+    if (jammer != NULL) {
+        jammer->start();
+        jammer_onset_time = jammer->getOnsetTime();
+    }
+    for (i = 0; i < nodes.size(); i++) {
+        sim_node_t* node = nodes[i];
+        node->startup_profiler->report(node->app_log, node->app->getElapsedTime());
+        if (pthread_create(&node->schedule_thread, &pthread_attr,
+                    runSimNodeSchedule, (void*)node) != 0) {
+            cerr << "\nERROR in NetworkSimulator::run: ";
+            cerr << "unable to create schedule thread for node " << (int)node->rc->node_id << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    bool running = true;
+    while (running) {
+        usleep(SIM_POLL_INTERVAL_US);
+        running = false;
+        for (i = 0; i < nodes.size(); i++) {
+            if (*terminate) {
+                nodes[i]->rhc->exit_rx_thread();
+                nodes[i]->app->setManualTerminationState(true);
+            }
+            if (nodes[i]->app->isContinuing())
+                running = true;
+        }
+    }
+
+    for (i = 0; i < nodes.size(); i++) {
+        if (pthread_join(nodes[i]->schedule_thread, &thread_status) != 0)
+            cout << "Error joining schedule thread" << endl;
+    }
+    for (i = 0; i < nodes.size(); i++) {
+        if (pthread_join(nodes[i]->rx_thread, &thread_status) != 0)
+            cout << "Error joining rx thread" << endl;
+    }
+    on_air_time = timer_toc(on_air_timer) * medium->getTimeScale();
+    timer_destroy(on_air_timer);
+    if (jammer != NULL) {
+        jammer->stop();
+        for (i = 0; i < nodes.size(); i++)
+            nodes[i]->jammer = NULL;
+        delete jammer;
+    }
+    pthread_attr_destroy(&pthread_attr);
+
+    for (i = 0; i < nodes.size(); i++) {
+        nodes[i]->app->doAppLogReport(nodes[i]->app_log, APP_LOG_REPORT_RUN_COMPLETE);
+        nodes[i]->rhc->writeRfEventLog();
+        nodes[i]->app->doAppLogReport(nodes[i]->app_log, APP_LOG_REPORT_FINALIZATION_DONE);
+        nodes[i]->app_log->write_log();
+    }
+
+    return(EXIT_SUCCESS);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void NetworkSimulator::printReport()
+{
+    double downlink_bytes = 0.0;
+    double uplink_bytes = 0.0;
+
+    cout << endl;
+    cout << "Simulated network of " << nodes.size() << " nodes, frame_size ";
+    cout << rc->frame_size << ", hardened " << rc->hardened << endl;
+    cout << "On air for " << on_air_time << " seconds (time scale ";
+    cout << medium->getTimeScale() << ")" << endl;
+    cout << "Default link: snr " << default_link.snr_db << " dB, attenuation ";
+    cout << default_link.attenuation_db << " dB, cfo " << default_link.cfo;
+    cout << " Hz, timing offset " << default_link.timing_offset << " samples, ";
+    cout << (default_link.taps.empty() ? 1 : default_link.taps.size()) << " taps" << endl;
+    if (jammer_params.profile != JAMMER_PROFILE_NONE) {
+        cout << "Jammer: " << Jammer::profileToString(jammer_params.profile);
+        cout << ", J/S " << jammer_params.js_db << " dB, subcarriers ";
+        cout << jammer_params.first_subcarrier << " to ";
+        cout << jammer_params.first_subcarrier + jammer_params.num_subcarriers - 1;
+        cout << ", on " << jammer_params.start_time << " s after start" << endl;
+    }
+    if (tun_tap) {
+        cout << "Tap interfaces: " << SIM_TAP_PREFIX << "<node> with 10.10.10.<node>";
+        cout << " in namespace " << SIM_NETNS_PREFIX << "<node>" << endl;
+    }
+    cout << endl;
+    cout << "node  role         tx        rx valid     bad hdr   bad pld   kbps";
+    if (tun_tap)
+        cout << "   ip read  ip written  incomplete";
+    cout << endl;
+    for (unsigned int i = 0; i < nodes.size(); i++) {
+        RadioHardwareConfig* rhc = nodes[i]->rhc;
+        double kbps = (on_air_time > 0.0) ?
+            ((rhc->valid_bytes_received * 8) / 1024) / on_air_time : 0.0;
+        cout << setw(4) << (int)nodes[i]->rc->node_id << "  ";
+        cout << left << setw(11) << (nodes[i]->rc->node_is_basestation ?
+                "basestation" : "mobile") << right;
+        cout << setw(8) << rhc->total_packets_transmitted;
+        cout << setw(10) << rhc->valid_payloads_received;
+        cout << setw(12) << rhc->invalid_headers_received;
+        cout << setw(10) << rhc->invalid_payloads_received;
+        cout << setw(10) << fixed << setprecision(1) << kbps;
+        if (tun_tap) {
+            cout << setw(10) << nodes[i]->ps->get_read_packets();
+            cout << setw(12) << nodes[i]->ps->get_written_packets();
+            cout << setw(12) << nodes[i]->ps->get_incomplete_packets();
+        }
+        cout << endl;
+        cout.unsetf(ios_base::floatfield);
+        cout << setprecision(6);
+        if (nodes[i]->rc->node_is_basestation)
+            uplink_bytes += rhc->valid_bytes_received;
+        else
+            downlink_bytes += rhc->valid_bytes_received;
+    }
+    if (on_air_time > 0.0) {
+        cout << endl;
+        cout << "OFDMA downlink throughput: " << (downlink_bytes * 8 / 1024) / on_air_time;
+        cout << " kbps" << endl;
+        cout << "Multichannel uplink throughput: " << (uplink_bytes * 8 / 1024) / on_air_time;
+        cout << " kbps" << endl;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void NetworkSimulator::setJammerProfile(JammerProfileType profile)
+{
+    jammer_params.profile = profile;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+const jammer_params_t& NetworkSimulator::getJammerParams()
+{
+    return(jammer_params);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double NetworkSimulator::getJammerOnsetTime()
+{
+    return(jammer_onset_time);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned int NetworkSimulator::getNumNodes()
+{
+    return(nodes.size());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+sim_node_t* NetworkSimulator::getNode(unsigned int node_idx)
+{
+    return(nodes[node_idx]);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void* runSimNodeSchedule(void* thread_args)
+{
+    sim_node_t* node = (sim_node_t*)thread_args;
+    unsigned int task_ctr;
+    unsigned int num_scheduled_tasks;
+    unsigned int batch_count = 0;
+    sim_batch_t batch;
+
+    // The U4 loop of main.cc, always in normal (FDD) mode
+    while( node->app->isContinuing() ) {
+        num_scheduled_tasks = node->rs->getActiveSchedSize(true);
+        for (task_ctr = 0; task_ctr < num_scheduled_tasks; task_ctr++)
+            node->rtm->doTask(true, task_ctr);
+
+        node->app->doAppLogReport(node->app_log, APP_LOG_REPORT_SCHEDULE_COUNT);
+        node->rf_log->write_log();
+        node->app->updateStatus();
+
+        batch.throughput = node->ajc->evaluateThroughput();
+        node->ajc->update(batch.throughput, batch_count);
+        batch.time = node->medium->now();
+        batch.jammer_active = (node->jammer != NULL) && node->jammer->isActive();
+        batch.mitigation_running = node->ajc->isMitigationRunning();
+        batch.left_edge = node->ajc->getLeftEdge();
+        node->batches.push_back(batch);
+        batch_count++;
+        node->schedules_run++;
+    }
+    node->rhc->exit_rx_thread();
+
+    pthread_exit(NULL);
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,142 @@
+/* NetworkSimulator.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef NETWORKSIMULATOR_H_
+#define NETWORKSIMULATOR_H_
+
+#include <csignal>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <libconfig.h>
+
+#include "AntiJamController.h"
+#include "AppManager.h"
+#include "FhSeqGenerator.h"
+#include "FreqTableGenerator.h"
+#include "Jammer.h"
+#include "LinkChannel.h"
+#include "LoopbackMedium.h"
+#include "Logger.hh"
+#include "PacketStore.hh"
+#include "Phy2Mac.h"
+#include "RadioConfig.hh"
+#include "RadioHardwareConfig.h"
+#include "RadioScheduler.h"
+#include "RadioTaskManager.h"
+#include "StartupProfiler.h"
+#include "timer.h"
+
+// Wall-clock seconds the receivers run before the first scheduled transmit,
+// as in the U4 application
+#define SIM_RX_SETTLE_TIME                          1.0
+// Wall-clock interval at which the simulator polls for termination
+#define SIM_POLL_INTERVAL_US                        100000
+// With tun_tap set, node N's tap interface and the network namespace it is
+// moved to are these prefixes followed by N
+#define SIM_TAP_PREFIX                              "u4tap"
+#define SIM_NETNS_PREFIX                            "u4ns"
+
+// One batch of scheduled tasks as seen by a node's anti-jam controller
+typedef struct {
+    double time;                // medium seconds at the end of the batch
+    double throughput;          // kbps over the batch
+    bool jammer_active;
+    bool mitigation_running;
+    int left_edge;
+} sim_batch_t;
+
+// Everything one radio of the simulated network owns; the same objects
+// main.cc builds for a single node
+typedef struct {
+    RadioConfig*            rc;
+    AppManager*             app;
+    StartupProfiler*        startup_profiler;
+    Logger*                 app_log;
+    Logger*                 rf_log;
+    Logger*                 rxf_event_log;
+    Logger*                 uhd_error_log;
+    timer                   rx_timer;
+    PacketStore*            ps;
+    RadioHardwareConfig*    rhc;
+    FreqTableGenerator*     ftg;
+    RadioScheduler*         rs;
+    Phy2Mac*                p2m;
+    FhSeqGenerator*         fsg;
+    RadioTaskManager*       rtm;
+    AntiJamController*      ajc;
+    LoopbackMedium*         medium;
+    Jammer*                 jammer;
+    std::vector<sim_batch_t> batches;
+    rx_thread_args_t        rx_thread_args;
+    pthread_t               rx_thread;
+    pthread_t               schedule_thread;
+    unsigned int            schedules_run;
+} sim_node_t;
+
+// Runs a whole U4 network -- the basestation and every mobile listed in
+// network_node_id -- in one process over a shared LoopbackMedium.  Each
+// node gets its own copy of the configuration with node_id,
+// node_is_basestation and the log file names overridden and the loopback
+// radio model.  By default there is no tap interface, so the payloads are
+// the PacketStore's dummy frames; with tun_tap set in the "simulator"
+// group each node gets a tap interface with 10.10.10.<node_id> in a
+// network namespace of its own, and real IP traffic crosses the simulated
+// radio (see ip_harness.sh).  The basestation is the highest node ID, as
+// the MAC assumes.
+//
+// Every directional link between nodes passes through a LinkChannel.  The
+// defaults and per-link overrides come from the "simulator" group of the
+// configuration file (see config_files/sim.cfg), as is an optional jammer
+// on the downlink.  Each node runs main.cc's anti-jam state machine once
+// per batch and records the batch throughput.  With loopback_time_scale
+// above 1 the waveform runs faster than real time for as long as the host
+// keeps up.
+class NetworkSimulator
+{
+public:
+    NetworkSimulator(int argc, char **argv);
+    ~NetworkSimulator();
+
+    // Runs every node until run_time elapses or *terminate is set
+    int run(volatile sig_atomic_t* terminate);
+    void printReport();
+
+    // Replaces the configured jammer profile for the next run
+    void setJammerProfile(JammerProfileType profile);
+    const jammer_params_t& getJammerParams();
+    // Medium time the jammer first came on in the last run
+    double getJammerOnsetTime();
+    unsigned int getNumNodes();
+    sim_node_t* getNode(unsigned int node_idx);
+
+private:
+    void readChannelConfig();
+    void readJammerConfig(config_setting_t* setting);
+    void lookupLinkParams(
+        config_setting_t* setting,
+        link_channel_params_t* params
+    );
+    sim_node_t* createNode(
+        int argc,
+        char **argv,
+        unsigned char node_id
+    );
+    void destroyNode(sim_node_t* node);
+
+    RadioConfig* rc;
+    LoopbackMedium* medium;
+    link_channel_params_t default_link;
+    jammer_params_t jammer_params;
+    double jammer_onset_time;
+    bool tun_tap;
+    std::vector<sim_node_t*> nodes;
+    double on_air_time;
+};
+
+void* runSimNodeSchedule(void* thread_args);
+
+
+#endif // NETWORKSIMULATOR_H_
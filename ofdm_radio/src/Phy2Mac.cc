@@ -419,7 +419,8 @@ int Phy2Mac::deliverRxFrame()
     unsigned int packet_id = (  rx_header_buffer[P2M_HEADER_FIELD_FRAME_ID] << 8 |
                                 rx_header_buffer[P2M_HEADER_FIELD_FRAME_ID + 1]);
     if(using_tun_tap)
-        ps->add_frame(packet_id, 0, rx_payload_buffer, P2M_FRAME_PAYLOAD_DEFAULT_SIZE);
+        ps->add_frame(rx_header_buffer[P2M_HEADER_FIELD_SOURCE_ID], packet_id, 0, rx_payload_buffer,
+                P2M_FRAME_PAYLOAD_DEFAULT_SIZE);
     rx_num_delivered2net_frames++;
     return(EXIT_SUCCESS);
 }
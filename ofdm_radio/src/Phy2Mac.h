@@ -25,6 +25,7 @@
 #define P2M_HEADER_FIELD_DESTINATION_ID             3
 #define P2M_HEADER_FIELD_FRAME_TYPE                 4
 #define P2M_HEADER_FIELD_PADDED_FRAME		    5
+#define P2M_HEADER_FIELD_EVM_REPORT                 6
 
 #define P2M_DESTINATION_ID_NULL                     0
 #define P2M_DESTINATION_ID_BROADCAST                255
@@ -34,6 +35,7 @@
 #define P2M_FRAME_TYPE_HEARTBEAT                    2
 #define P2M_FRAME_TYPE_CONTROL                      3
 #define P2M_FRAME_TYPE_NEW_ALLOC                    4
+#define P2M_FRAME_TYPE_KEEPALIVE                    5
 
 #define P2M_FRAME_TYPE_TEST                         255
 //------------------------------------------------------------------------
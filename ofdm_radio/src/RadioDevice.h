@@ -0,0 +1,84 @@
+/* RadioDevice.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef RADIODEVICE_H_
+#define RADIODEVICE_H_
+
+#include <complex>
+#include <cstdlib>
+#include <string>
+
+// UHD value types are kept in the interface so the burst and streaming code
+// in RadioHardwareConfig and RadioTaskManager is unchanged between backends
+#include <uhd/types/time_spec.hpp>
+#include <uhd/types/tune_request.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/types/stream_cmd.hpp>
+
+// Radio front end as seen by RadioHardwareConfig: one rx and one tx channel
+// of fc32 samples, a hardware clock, tuning and gains.  UhdRadioDevice drives
+// a USRP; LoopbackRadioDevice exchanges samples with other in-process
+// devices through a LoopbackMedium on a virtual clock; ReplayRadioDevice
+// plays back an IQ capture that RecordingRadioDevice wrote.
+class RadioDevice
+{
+public:
+    virtual ~RadioDevice() {}
+
+    // Receive side
+    virtual void setRxAntenna(const std::string& antenna) = 0;
+    virtual void setRxGain(double gain) = 0;
+    virtual void setRxRate(double rate) = 0;
+    virtual double getRxRate() = 0;
+    virtual void setRxFreq(const uhd::tune_request_t& tune_req) = 0;
+    virtual double getRxFreq() = 0;
+    virtual bool isRxLoLocked() = 0;
+    // Creates the rx streamer; call after the rx rate is set
+    virtual void initRxStream() = 0;
+    virtual size_t getMaxRecvSamps() = 0;
+    virtual void issueStreamCmd(const uhd::stream_cmd_t& stream_cmd) = 0;
+    // With one_packet false the call waits for num_samps samples
+    virtual size_t recv(
+        std::complex<float>* buffer,
+        size_t num_samps,
+        uhd::rx_metadata_t& md,
+        double timeout,
+        bool one_packet
+    ) = 0;
+    // True once a finite sample source has delivered its last sample; a
+    // live radio never runs out
+    virtual bool isEndOfStream() { return(false); }
+
+    // Transmit side
+    virtual void setTxAntenna(const std::string& antenna) = 0;
+    virtual void setTxGain(double gain) = 0;
+    virtual void setTxRate(double rate) = 0;
+    virtual double getTxRate() = 0;
+    virtual void setTxFreq(const uhd::tune_request_t& tune_req) = 0;
+    virtual bool isTxLoLocked() = 0;
+    // Creates the tx streamer; call after the tx rate is set
+    virtual void initTxStream() = 0;
+    virtual size_t getMaxSendSamps() = 0;
+    virtual size_t send(
+        const std::complex<float>* buffer,
+        size_t num_samps,
+        const uhd::tx_metadata_t& md,
+        double timeout
+    ) = 0;
+    virtual bool recvAsyncMsg(
+        uhd::async_metadata_t& md,
+        double timeout
+    ) = 0;
+
+    // Hardware clock
+    virtual void setTimeSource(const std::string& source) = 0;
+    virtual void setTimeUnknownPps(const uhd::time_spec_t& time) = 0;
+    virtual void setTimeNow(const uhd::time_spec_t& time) = 0;
+    virtual uhd::time_spec_t getTimeNow() = 0;
+    virtual bool isRefLocked() = 0;
+};
+
+
+#endif // RADIODEVICE_H_
@@ -4,14 +4,13 @@
  *
  */
 #include "RadioHardwareConfig.h"
+#include "UhdRadioDevice.h"
+#include "LoopbackRadioDevice.h"
+#include "ReplayRadioDevice.h"
+#include "RecordingRadioDevice.h"
 #include "Allocations.h"
-bool ext_using_tun_tap = false;
 bool ext_debug = false;
 
-PacketStore* ext_ps_ptr;
-RadioHardwareConfig* ext_rhc_ptr;
-AppManager* ext_am_ptr;
-Logger* ext_packet_log_ptr;
 int evm_cutoff = 3;
 double evm_sum = 0;
 double evm_min = 1000;
@@ -30,18 +29,26 @@ int ofdmaCallback(
         void *           _userdata
         )
 {
-    ext_rhc_ptr->total_packets_received++;
-    timer rx_timer = (timer_s*)_userdata;
-    timer_tic(rx_timer);
-    if(ext_debug)printf("***** rssi=%7.2fdB evm=%7.2fdB, ", _stats.rssi, _stats.evm);
-    std::stringstream report;
-    report << "***** rssi:" << setw(10) << _stats.rssi << "db evm:" << setw(10) << _stats.evm << "db, ";
+    RHC_ALLOC_REGION(ALLOC_REGION_CALLBACK);
+    RadioHardwareConfig* rhc = (RadioHardwareConfig*)_userdata;
+    rhc->total_packets_received++;
+    timer_tic(rhc->rx_timer);
+    // The synchronizer holds this frame's per-subcarrier EVM until it resets
+    // after the callback returns
+    rhc->evm_telemetry->record(
+            ofdmflexframesync_get_evm_db(rhc->getActiveOfdmaSync()),
+            rhc->app->getElapsedTime());
+    RHC_DEBUG_PRINTF("***** rssi=%7.2fdB evm=%7.2fdB, ", _stats.rssi, _stats.evm);
     if (_header_valid) 
     {
-        ext_rhc_ptr->valid_headers_received++;
+        rhc->valid_headers_received++;
+        // The header is always BPSK, so its EVM tracks the channel whatever
+        // payload scheme the basestation picked for this frame
+        if(rhc->link_adaptation != NULL)
+            rhc->link_adaptation->recordFrameEvm(_stats.evm, rhc->app->getElapsedTime());
         if(_header[P2M_HEADER_FIELD_FRAME_TYPE] == P2M_FRAME_TYPE_DATA)
         {
-            if (_payload_valid)
+            if (_payload_valid && _payload_len > 0)
             {
                 unsigned int key1 = _payload[0];
                 unsigned int key2 = _payload[1];
@@ -50,60 +57,51 @@ int ofdmaCallback(
                     long int* li_payload = (long int*)(_payload + 2);
                     unsigned long packet_id = li_payload[0];
                     unsigned int source_id = _header[P2M_HEADER_FIELD_SOURCE_ID];
-                    if(ext_debug)printf("rx packet id: %6lu", packet_id);
-                    report << "rx packet id: " << packet_id;
-                    if(ext_debug)printf(" payload_len: %u", _payload_len);
-                    report << " payload_len: " << _payload_len;
+                    rhc->readArqAck(source_id, _payload);
+                    RHC_DEBUG_PRINTF("rx packet id: %6lu", packet_id);
+                    RHC_DEBUG_PRINTF(" payload_len: %u", _payload_len);
 
                     unsigned int total_packet_len = (_payload[2 + sizeof(long int)] << 8 | _payload[2 + sizeof(long int) + 1]);
                     if(total_packet_len == 0)	
                         return 1;
+                    RHC_LOG_PACKET(rhc, _stats, "rx packet id: " << packet_id
+                            << " payload_len: " << _payload_len);
                     unsigned int frame_id = _payload[2 + sizeof(long int) + 2];
-                    if(ext_using_tun_tap)
+                    if(rhc->using_tun_tap)
                     {
-                        ext_ps_ptr->add_frame(packet_id, frame_id, _payload + PADDED_BYTES, total_packet_len);
+                        rhc->ps->add_frame(source_id, packet_id, frame_id, _payload + PADDED_BYTES, total_packet_len);
                     }
-                    ext_rhc_ptr->valid_bytes_received += _payload_len - PADDED_BYTES;
-                    ext_rhc_ptr->network_packets_received++;
+                    rhc->valid_bytes_received += _payload_len - PADDED_BYTES;
+                    rhc->network_packets_received++;
 
                 }
                 else
                 {
-                    if(ext_debug)printf(" payload_len: %u", _payload_len);
-                    report << " payload_len: " << _payload_len;
-                    ext_rhc_ptr->valid_bytes_received += _payload_len;
-                    ext_rhc_ptr->dummy_packets_received++;
+                    RHC_DEBUG_PRINTF(" payload_len: %u", _payload_len);
+                    RHC_LOG_PACKET(rhc, _stats, " payload_len: " << _payload_len);
+                    rhc->valid_bytes_received += _payload_len;
+                    rhc->dummy_packets_received++;
                 }
-                ext_rhc_ptr->valid_payloads_received++;
-                if(ext_debug)printf("\n");
+                rhc->valid_payloads_received++;
+                RHC_DEBUG_PRINTF("\n");
                 // If valid frame received then generate a report
-                rf_log_report_t rf_log_report;
-                switch (ext_rhc_ptr->rf_log_level) {
-                    case(RF_LOG_LEVEL_NONE) :
-                        // no logging
-                        break;
-                    case(RF_LOG_LEVEL_NORMAL) :
-                        rf_log_report.hardware_timestamp_nominal = ext_am_ptr->getElapsedTime();
-                        rf_log_report.rf_event = RF_LOG_EVENT_RX_OFDMA_DATA;
-                        rf_log_report.frequency_nominal = ext_rhc_ptr->getRxAbsoluteFreq();
-                        rf_log_report.bandwidth = ext_rhc_ptr->sample_rate;
-                        ext_rhc_ptr->logRfEvent(rf_log_report);
-                        break;
-                    case(RF_LOG_LEVEL_DETAIL) :
-                        // PLACEHOLDER for development version of logging
-                        break;
-                    default :
-                        cerr << "\nERROR in RadioHardwareConfig::rxFrameBurst: ";
-                        cerr << "Unknown rf_log_level\n" << endl;
-                        exit(EXIT_FAILURE);
-                        break;
-                }
+                RHC_LOG_RF_EVENT(rhc, rhc->app->getElapsedTime(),
+                        RF_LOG_EVENT_RX_OFDMA_DATA,
+                        rhc->getRxAbsoluteFreq());
+            }
+            else if(_payload == NULL || _payload_len == 0)
+            {
+                // The basestation had nothing for this mobile, or the
+                // downlink scheduler gave it no subcarriers
+                RHC_DEBUG_PRINTF(" NOT SCHEDULED\n");
+                RHC_LOG_PACKET(rhc, _stats, " NOT SCHEDULED");
+                rhc->idle_frames_received++;
             }
             else
             {
-                if(ext_debug)printf(" PAYLOAD INVALID\n");
-                report << " PAYLOAD INVALID";
-                ext_rhc_ptr->invalid_payloads_received++;
+                RHC_DEBUG_PRINTF(" PAYLOAD INVALID\n");
+                RHC_LOG_PACKET(rhc, _stats, " PAYLOAD INVALID");
+                rhc->invalid_payloads_received++;
                 //else printf("p");
             }
         }
@@ -112,47 +110,35 @@ int ofdmaCallback(
         {
             std::cout << "received control packet" << std::endl;
             // If valid frame received then generate a report
-            rf_log_report_t rf_log_report;
-            switch (ext_rhc_ptr->rf_log_level) {
-                case(RF_LOG_LEVEL_NONE) :
-                    // no logging
-                    break;
-                case(RF_LOG_LEVEL_NORMAL) :
-                    rf_log_report.hardware_timestamp_nominal = ext_am_ptr->getElapsedTime();
-                    rf_log_report.rf_event = RF_LOG_EVENT_RX_CONTROL_DATA;
-                    rf_log_report.frequency_nominal = ext_rhc_ptr->getRxAbsoluteFreq();
-                    rf_log_report.bandwidth = ext_rhc_ptr->sample_rate;
-                    ext_rhc_ptr->logRfEvent(rf_log_report);
-                    break;
-                case(RF_LOG_LEVEL_DETAIL) :
-                    // PLACEHOLDER for development version of logging
-                    break;
-                default :
-                    cerr << "\nERROR in RadioHardwareConfig::rxFrameBurst: ";
-                    cerr << "Unknown rf_log_level\n" << endl;
-                    exit(EXIT_FAILURE);
-                    break;
-            }
+            RHC_LOG_RF_EVENT(rhc, rhc->app->getElapsedTime(),
+                    RF_LOG_EVENT_RX_CONTROL_DATA,
+                    rhc->getRxAbsoluteFreq());
         }
         else if(_header[P2M_HEADER_FIELD_FRAME_TYPE] == P2M_FRAME_TYPE_NEW_ALLOC)
         {
             if(_payload_valid)
             {
-                ext_rhc_ptr->received_new_alloc = true;
-                memcpy(ext_rhc_ptr->new_alloc, _payload, RHC_OFDMA_M);
+                rhc->received_new_alloc = true;
+                memcpy(rhc->new_alloc, _payload, RHC_OFDMA_M);
             }
         }
+        else if(_header[P2M_HEADER_FIELD_FRAME_TYPE] == P2M_FRAME_TYPE_KEEPALIVE)
+        {
+            rhc->keepalive_packets_received++;
+            rhc->idle_frames_received++;
+        }
+        // Non-data frames only contribute the rssi/evm line to the packet log
+        if(_header[P2M_HEADER_FIELD_FRAME_TYPE] != P2M_FRAME_TYPE_DATA)
+            RHC_LOG_PACKET(rhc, _stats, "");
     }
     //Packet detected but header invalid
     else
     {
-        if(ext_debug)printf("HEADER INVALID\n");
-        report << "HEADER INVALID";
-        ext_rhc_ptr->invalid_headers_received++;
+        RHC_DEBUG_PRINTF("HEADER INVALID\n");
+        RHC_LOG_PACKET(rhc, _stats, "HEADER INVALID");
+        rhc->invalid_headers_received++;
     }
-    ext_packet_log_ptr->log(report.str());
-    ext_packet_log_ptr->write_log();
-    //ext_rhc_ptr->setHardwareTimestamp(0.0);
+    //rhc->setHardwareTimestamp(0.0);
     return 0;
 }
 int mcCallback(
@@ -165,17 +151,19 @@ int mcCallback(
         void *           _userdata
         )
 {
-    ext_rhc_ptr->total_packets_received++;
-    timer rx_timer = (timer_s*)_userdata;
-    timer_tic(rx_timer);
-    if(ext_debug)printf("***** rssi=%7.2fdB evm=%7.2fdB, ", _stats.rssi, _stats.evm);
-    std::stringstream report;
-    report << "***** rssi:" << setw(10) << _stats.rssi << "db evm:" << setw(10) << _stats.evm << "db, ";
+    RHC_ALLOC_REGION(ALLOC_REGION_CALLBACK);
+    RadioHardwareConfig* rhc = (RadioHardwareConfig*)_userdata;
+    rhc->total_packets_received++;
+    timer_tic(rhc->rx_timer);
+    RHC_DEBUG_PRINTF("***** rssi=%7.2fdB evm=%7.2fdB, ", _stats.rssi, _stats.evm);
     if (_header_valid) {
+        if(rhc->link_adaptation != NULL)
+            rhc->link_adaptation->recordEvmReport(_header[P2M_HEADER_FIELD_SOURCE_ID] - 1,
+                    _header[P2M_HEADER_FIELD_EVM_REPORT], rhc->app->getElapsedTime());
         if(_header[P2M_HEADER_FIELD_FRAME_TYPE] == P2M_FRAME_TYPE_DATA)
         {
-            ext_rhc_ptr->valid_headers_received++;
-            if (_payload_valid)
+            rhc->valid_headers_received++;
+            if (_payload_valid && _payload_len > 0)
             {   
                 unsigned int key1 = _payload[0];
                 unsigned int key2 = _payload[1];
@@ -184,104 +172,82 @@ int mcCallback(
                     long int* li_payload = (long int*)(_payload + 2);
                     unsigned long packet_id = li_payload[0];
                     unsigned int source_id = _header[P2M_HEADER_FIELD_SOURCE_ID];
-                    if(ext_debug)printf("rx packet id: %6lu", packet_id);
-                    report << "rx packet id: " << packet_id << " from " << source_id;
-                    if(ext_debug)printf(" payload_len: %u", _payload_len);
-                    report << " payload_len: " << _payload_len;
+                    rhc->readArqAck(source_id, _payload);
+                    RHC_DEBUG_PRINTF("rx packet id: %6lu", packet_id);
+                    RHC_DEBUG_PRINTF(" payload_len: %u", _payload_len);
                     unsigned int total_packet_len = (_payload[2 + sizeof(long int)] << 8 | _payload[2 + sizeof(long int) + 1]);
                     if(total_packet_len == 0)	
                         return 1;
+                    RHC_LOG_PACKET(rhc, _stats, "rx packet id: " << packet_id << " from " << source_id
+                            << " payload_len: " << _payload_len);
                     unsigned int frame_id = _payload[2 + sizeof(long int) + 2];
-                    if(ext_using_tun_tap)
+                    if(rhc->using_tun_tap)
                     {
-                        ext_ps_ptr->add_frame(packet_id, frame_id, _payload + PADDED_BYTES, total_packet_len);
+                        rhc->ps->add_frame(source_id, packet_id, frame_id, _payload + PADDED_BYTES, total_packet_len);
                     }
-                    ext_rhc_ptr->valid_bytes_received += _payload_len - PADDED_BYTES;
-                    ext_rhc_ptr->network_packets_received++;
+                    rhc->valid_bytes_received += _payload_len - PADDED_BYTES;
+                    rhc->network_packets_received++;
                 }
                 else
                 {
-                    if(ext_debug)printf(" payload_len: %u", _payload_len);
-                    report << " payload_len: " << _payload_len;
-                    ext_rhc_ptr->valid_bytes_received += _payload_len;
-                    ext_rhc_ptr->dummy_packets_received++;
-                }
-                ext_rhc_ptr->valid_payloads_received++;
-                if(ext_debug)printf("\n");
-                rf_log_report_t rf_log_report;
-                switch (ext_rhc_ptr->rf_log_level) {
-                    case(RF_LOG_LEVEL_NONE) :
-                        // no logging
-                        break;
-                    case(RF_LOG_LEVEL_NORMAL) :
-                        rf_log_report.hardware_timestamp_nominal = ext_am_ptr->getElapsedTime();
-                        rf_log_report.rf_event = RF_LOG_EVENT_RX_MC_DATA;
-                        rf_log_report.frequency_nominal = ext_rhc_ptr->getRxAbsoluteFreq();
-                        rf_log_report.bandwidth = ext_rhc_ptr->sample_rate;
-                        ext_rhc_ptr->logRfEvent(rf_log_report);
-                        break;
-                    case(RF_LOG_LEVEL_DETAIL) :
-                        // PLACEHOLDER for development version of logging
-                        break;
-                    default :
-                        cerr << "\nERROR in RadioHardwareConfig::rxFrameBurst: ";
-                        cerr << "Unknown rf_log_level\n" << endl;
-                        exit(EXIT_FAILURE);
-                        break;
+                    RHC_DEBUG_PRINTF(" payload_len: %u", _payload_len);
+                    RHC_LOG_PACKET(rhc, _stats, " payload_len: " << _payload_len);
+                    rhc->valid_bytes_received += _payload_len;
+                    rhc->dummy_packets_received++;
                 }
+                rhc->valid_payloads_received++;
+                RHC_DEBUG_PRINTF("\n");
+                RHC_LOG_RF_EVENT(rhc, rhc->app->getElapsedTime(),
+                        RF_LOG_EVENT_RX_MC_DATA,
+                        rhc->getRxAbsoluteFreq());
+            }
+            else if(_payload_valid)
+            {
+                // The mobile's queue drained after it chose to send data
+                RHC_DEBUG_PRINTF(" EMPTY\n");
+                RHC_LOG_PACKET(rhc, _stats, " EMPTY");
+                rhc->idle_frames_received++;
             }
             else
             {
-                ext_rhc_ptr->invalid_payloads_received++;
-                if(ext_debug)printf(" PAYLOAD INVALID\n");
-                report << " PAYLOAD_INVALID";
+                rhc->invalid_payloads_received++;
+                RHC_DEBUG_PRINTF(" PAYLOAD INVALID\n");
+                RHC_LOG_PACKET(rhc, _stats, " PAYLOAD_INVALID");
             }
         }
         else if(_header[P2M_HEADER_FIELD_FRAME_TYPE] == P2M_FRAME_TYPE_CONTROL)
         {
             std::cout << "control packet received" << std::endl;
             // If valid frame received then generate a report
-            rf_log_report_t rf_log_report;
-            switch (ext_rhc_ptr->rf_log_level) {
-                case(RF_LOG_LEVEL_NONE) :
-                    // no logging
-                    break;
-                case(RF_LOG_LEVEL_NORMAL) :
-                    rf_log_report.hardware_timestamp_nominal = ext_am_ptr->getElapsedTime();
-                    rf_log_report.rf_event = RF_LOG_EVENT_RX_CONTROL_DATA;
-                    rf_log_report.frequency_nominal = ext_rhc_ptr->getRxAbsoluteFreq();
-                    rf_log_report.bandwidth = ext_rhc_ptr->sample_rate;
-                    ext_rhc_ptr->logRfEvent(rf_log_report);
-                    break;
-                case(RF_LOG_LEVEL_DETAIL) :
-                    // PLACEHOLDER for development version of logging
-                    break;
-                default :
-                    cerr << "\nERROR in RadioHardwareConfig::rxFrameBurst: ";
-                    cerr << "Unknown rf_log_level\n" << endl;
-                    exit(EXIT_FAILURE);
-                    break;
-            }
-            ext_rhc_ptr->switch_allocation();
+            RHC_LOG_RF_EVENT(rhc, rhc->app->getElapsedTime(),
+                    RF_LOG_EVENT_RX_CONTROL_DATA,
+                    rhc->getRxAbsoluteFreq());
+            rhc->switch_allocation();
         }
         else if(_header[P2M_HEADER_FIELD_FRAME_TYPE] == P2M_FRAME_TYPE_NEW_ALLOC)
         {
             if(_payload_valid)
             {
-                memcpy(ext_rhc_ptr->new_alloc, _payload, RHC_OFDMA_M);
-                ext_rhc_ptr->recreate_modem();
+                memcpy(rhc->new_alloc, _payload, RHC_OFDMA_M);
+                rhc->recreate_modem();
             }
         }
+        else if(_header[P2M_HEADER_FIELD_FRAME_TYPE] == P2M_FRAME_TYPE_KEEPALIVE)
+        {
+            rhc->keepalive_packets_received++;
+            rhc->idle_frames_received++;
+        }
+        // Non-data frames only contribute the rssi/evm line to the packet log
+        if(_header[P2M_HEADER_FIELD_FRAME_TYPE] != P2M_FRAME_TYPE_DATA)
+            RHC_LOG_PACKET(rhc, _stats, "");
     }
     else
     {
-        ext_rhc_ptr->invalid_headers_received++;
-        report << "HEADER INVALID";
-        if(ext_debug)printf("HEADER INVALID\n");
+        rhc->invalid_headers_received++;
+        RHC_LOG_PACKET(rhc, _stats, "HEADER INVALID");
+        RHC_DEBUG_PRINTF("HEADER INVALID\n");
     }
     fflush(stdout);
-    ext_packet_log_ptr->log(report.str());
-    ext_packet_log_ptr->write_log();
     return 0;
 }
 
@@ -360,12 +326,12 @@ RadioHardwareConfig::RadioHardwareConfig(
         bool debug, bool u4, bool using_tun_tap,
         PacketStore* ps, AppManager* app,
         timer_s* rx_timer, bool slow, float ofdma_tx_window, float mc_tx_window, bool anti_jam,
-        RadioConfig* rc
+        RadioConfig* rc, StartupProfiler* startup_profiler
 )
 {
-    ext_using_tun_tap = using_tun_tap;
-    ext_ps_ptr = ps;
-    ext_am_ptr = app;
+    this->using_tun_tap = using_tun_tap;
+    this->ps = ps;
+    this->app = app;
     ext_debug = debug;
     if (radio_hardware.compare("USRP_MODEL_N210") == 0) {
         usrp_hardware = USRP_MODEL_N210;
@@ -379,9 +345,19 @@ RadioHardwareConfig::RadioHardwareConfig(
                 usrp_hardware = USRP_MODEL_X300_GBE;
 
             } else {
-                cerr << "ERROR: in RadioHardwareConfig::RadioHardwareConfig"<< endl;
-                cerr << "       " << radio_hardware << " is unsupported" << endl;
-                exit(EXIT_FAILURE);
+                if (radio_hardware.compare("RADIO_MODEL_LOOPBACK") == 0) {
+                    usrp_hardware = RADIO_MODEL_LOOPBACK;
+
+                } else {
+                    if (radio_hardware.compare("RADIO_MODEL_REPLAY") == 0) {
+                        usrp_hardware = RADIO_MODEL_REPLAY;
+
+                    } else {
+                        cerr << "ERROR: in RadioHardwareConfig::RadioHardwareConfig"<< endl;
+                        cerr << "       " << radio_hardware << " is unsupported" << endl;
+                        exit(EXIT_FAILURE);
+                    }
+                }
             }
         }
     }
@@ -429,8 +405,19 @@ RadioHardwareConfig::RadioHardwareConfig(
     this->anti_jam = anti_jam;
     this->rc = rc;
     this->alloc_log_ptr = new Logger(this->rc->alloc_log_file);
-    ext_packet_log_ptr = new Logger(this->rc->packet_log_file);
+    packet_log_ptr = new Logger(this->rc->packet_log_file);
     hardened = this->rc->hardened;
+    soft_decoding = this->rc->soft_decoding;
+    if(soft_decoding)
+    {
+        payload_fec0 = LIQUID_FEC_RS_M8;
+        payload_fec1 = RHC_fec0;
+    }
+    else
+    {
+        payload_fec0 = RHC_fec0;
+        payload_fec1 = LIQUID_FEC_RS_M8;
+    }
     
     //Initialize stats
     valid_bytes_received = 0;
@@ -444,6 +431,11 @@ RadioHardwareConfig::RadioHardwareConfig(
     network_packets_received = 0;
     dummy_packets_transmitted = 0;
     dummy_packets_received = 0;
+    keepalive_packets_transmitted = 0;
+    keepalive_packets_received = 0;
+    idle_bursts_skipped = 0;
+    idle_frames_received = 0;
+    last_burst_time = 0.0;
 
     //Initialize subcarrier allocation mode for U4
     allocation = DEFAULT_ALLOCATION;
@@ -461,6 +453,10 @@ RadioHardwareConfig::RadioHardwareConfig(
     // RF event logging is configured and controlled exclusively
     // within this class, unlike the overall application logging
     rf_log_level = RF_LOG_LEVEL_NORMAL;
+    if (rf_log_level > RHC_RF_LOG_LEVEL_MAX) {
+        // Events above the compile-time ceiling can never be reported
+        rf_log_level = RF_LOG_LEVEL_NONE;
+    }
     switch(rf_log_level) {
         case RF_LOG_LEVEL_NONE :
             break;
@@ -505,6 +501,13 @@ RadioHardwareConfig::RadioHardwareConfig(
             fh_window_medium = RHC_USRP_X300_FH_WINDOW_MEDIUM;
             uhd_retune_delay = RHC_USRP_X300_RETUNE_DELAY;
             break;
+        case RADIO_MODEL_LOOPBACK :
+        case RADIO_MODEL_REPLAY :
+            tx2rx_freq_separation = rc->fdd_separation;
+            fh_window_small = sample_rate;
+            fh_window_medium = RHC_LOOPBACK_FH_WINDOW_MEDIUM;
+            uhd_retune_delay = RHC_LOOPBACK_RETUNE_DELAY;
+            break;
         default :
             cerr << "ERROR: In RadioHardwareConfig unsupported type of USRP.\n" <<endl;
             exit(EXIT_FAILURE);
@@ -514,60 +517,114 @@ RadioHardwareConfig::RadioHardwareConfig(
     // USRP manual state thats the message handler should be the first call
     uhd::msg::register_handler(&handleUhdMessage);
 
-    uhd::device_addr_t dev_addr;     
-    if (usrp_hardware == USRP_MODEL_X300_PCIE) {
-        dev_addr["resource"] = "RIO0";
+    if (usrp_hardware == RADIO_MODEL_LOOPBACK) {
+        startup_profiler->begin("loopback radio device");
+        radio_device = new LoopbackRadioDevice(rc->loopback_medium, node_id,
+                RHC_NOMINAL_RESAMPLER_RATIO * sample_rate, rc->loopback_time_scale,
+                rc->loopback_noise_floor, rc->loopback_rx_file, rc->loopback_tx_file);
+        startup_profiler->end();
+    } else if (usrp_hardware == RADIO_MODEL_REPLAY) {
+        startup_profiler->begin("replay radio device");
+        radio_device = new ReplayRadioDevice(rc->replay_file);
+        startup_profiler->end();
     } else {
-        if(usrp_address_name != "")
-        dev_addr["addr0"] = usrp_address_name;
-    }
-    try {
-        usrp = uhd::usrp::multi_usrp::make(dev_addr);
-    } catch (...) {
-        cerr << "ERROR: In RadioHardwareConfig initialization: ";
-        cerr << "Unable to access the specified USRP" << endl;
+        uhd::device_addr_t dev_addr;     
         if (usrp_hardware == USRP_MODEL_X300_PCIE) {
-            cerr << "\nNOTE: When USRP_MODEL_X300_PCIE is specified " << endl;
-            cerr << "ensure that the X300 has the appropriate FPGA bit file" << endl;
-            cerr << "Also, confirm that the NI real time I/O module is loaded:" << endl;
-            cerr << "  sudo /usr/local/bin/niusrprio_pcie start \n" << endl;
+            dev_addr["resource"] = "RIO0";
+        } else {
+            if(usrp_address_name != "")
+            dev_addr["addr0"] = usrp_address_name;
+        }
+        startup_profiler->begin("multi_usrp::make");
+        try {
+            radio_device = new UhdRadioDevice(dev_addr);
+        } catch (...) {
+            cerr << "ERROR: In RadioHardwareConfig initialization: ";
+            cerr << "Unable to access the specified USRP" << endl;
+            if (usrp_hardware == USRP_MODEL_X300_PCIE) {
+                cerr << "\nNOTE: When USRP_MODEL_X300_PCIE is specified " << endl;
+                cerr << "ensure that the X300 has the appropriate FPGA bit file" << endl;
+                cerr << "Also, confirm that the NI real time I/O module is loaded:" << endl;
+                cerr << "  sudo /usr/local/bin/niusrprio_pcie start \n" << endl;
+            }
+            exit(EXIT_FAILURE);
         }
-        exit(EXIT_FAILURE);
+        startup_profiler->end();
+    }
+
+    // Everything the receiver delivers from here on, calibration included,
+    // goes to the capture file
+    if (!rc->iq_capture_file.empty()) {
+        radio_device = new RecordingRadioDevice(radio_device, rc->iq_capture_file,
+                IqCaptureWriter::formatFromString(rc->iq_capture_format));
     }
 
     resetUhdErrorStats();
 
     // Receive side USRP configuration -----------------------------------
-    usrp->set_rx_antenna("RX2");
-    usrp->set_rx_gain(rf_gain_rx);
+    startup_profiler->begin("rx antenna and gain");
+    radio_device->setRxAntenna("RX2");
+    radio_device->setRxGain(rf_gain_rx);
+    startup_profiler->end();
 
     // Configure receiver for manual frequency tuning
     //  The actual frequency will change depending on operating mode, but
     //  this at least starts the node in the correct radio band
     rx_absolute_freq = 0;   tx_absolute_freq = 0; 
+    startup_profiler->begin("tune2NormalFreq (initial)");
     tune2NormalFreq();
+    startup_profiler->end();
 
-    usrp->set_rx_rate(RHC_NOMINAL_RESAMPLER_RATIO * sample_rate);
-    usrp_rx_rate = usrp->get_rx_rate();
+    startup_profiler->begin("rx rate, resampler and streamer");
+    radio_device->setRxRate(RHC_NOMINAL_RESAMPLER_RATIO * sample_rate);
+    usrp_rx_rate = radio_device->getRxRate();
     rx_resamp_rate = sample_rate / usrp_rx_rate; 
 
-    rx_resamp = msresamp_crcf_create(rx_resamp_rate, 60.0f);
+    // Anti-alias filter and decimate in one polyphase stage that computes
+    // only the retained outputs; fall back to the arbitrary resampler if
+    // the device could not give a rate that is a small rational multiple
+    rx_rresamp = NULL;
+    rx_resamp = NULL;
+    for(unsigned int q = 1; q <= RHC_RX_RESAMP_MAX_FACTOR && rx_rresamp == NULL; q++)
+    {
+        unsigned int p = (unsigned int)(rx_resamp_rate * q + 0.5);
+        if(p > 0 && fabs((double)p / q - rx_resamp_rate) < 1e-9 * rx_resamp_rate)
+            rx_rresamp = rresamp_crcf_create(p, q, RHC_RX_RESAMP_SEMI_LENGTH,
+                    RHC_RX_RESAMP_BANDWIDTH, RHC_RX_RESAMP_STOPBAND_ATTEN);
+    }
+    if(rx_rresamp == NULL)
+    {
+        cout << "INFO: rx rate ratio " << rx_resamp_rate
+            << " is not a small rational, using arbitrary resampler" << endl;
+        rx_resamp = msresamp_crcf_create(rx_resamp_rate, RHC_RX_RESAMP_STOPBAND_ATTEN);
+    }
     // Resampler buffers and UHD sample buffers now within the class 
     // methods that actually perform burst tx & rx
 
     // Create rx streamer object for burst receiption
-    uhd::stream_args_t rx_stream_args("fc32"); //complex floats
-    rx_stream = usrp->get_rx_stream(rx_stream_args); 
-    rx_uhd_transport_size = rx_stream->get_max_num_samps();
+    radio_device->initRxStream();
+    rx_uhd_transport_size = radio_device->getMaxRecvSamps();
     rx_uhd_max_buffer_size = rx_uhd_transport_size +64;
+    startup_profiler->end();
 
     // Set number of rx samples to a default to permit other stages of
     // initialization (e.g., heartbeat noise calibration) to work without
     // having first performed the normal radio task scheduling calculations
     initial_rx_recommended_sample_size = RHC_RX_RECOMMENDED_SAMPLE_SIZE_DEFAULT;
 
+    // The modem objects share one FFT plan per transform size, kept across
+    // recreate_modem(). With FFTW they are measured plans, and wisdom saved
+    // by an earlier run makes measuring them free.
+    if(!rc->fftw_wisdom_file.empty())
+    {
+        startup_profiler->begin("fftw wisdom import");
+        if(!liquid_fft_import_wisdom(rc->fftw_wisdom_file.c_str()))
+            cout << "INFO: no FFTW wisdom loaded from " << rc->fftw_wisdom_file << endl;
+        startup_profiler->end();
+    }
+
     // Receive side modem configuration ----------------------------------
-    rx_prefilt = firfilt_crcf_create_kaiser(31, 0.24f, 60.0f, 0.0f);
+    startup_profiler->begin("rx modem objects");
     rxf.samplerate = usrp_rx_rate;
     rxf.callback_debug = false;
 
@@ -575,7 +632,7 @@ RadioHardwareConfig::RadioHardwareConfig(
     framesync_callback callbacks[num_nodes_in_net];
     for(unsigned int i = 0; i < num_nodes_in_net; i++)
     {
-        userdata[i] = (void*)rx_timer;
+        userdata[i] = (void*)this;
         callbacks[i] = mcCallback;
     }
     if(u4)
@@ -591,11 +648,56 @@ RadioHardwareConfig::RadioHardwareConfig(
         //openNullHole(default_subcarrier_allocation, 150, 350);
        // ofdmframe_print_sctype(default_subcarrier_allocation, 512);
 
+        // only the basestation receives and only mobiles transmit multichannel
+        mcrx = NULL;
+        mctx = NULL;
+        evm_telemetry = NULL;
+        link_adaptation = NULL;
+        if(rc->amc)
+        {
+            link_adaptation = new LinkAdaptation(rc->amc_table,
+                    (fec_scheme)payload_fec0, (fec_scheme)payload_fec1,
+                    num_nodes_in_net - 1, rc->amc_evm_alpha, rc->amc_hysteresis,
+                    rc->amc_report_timeout);
+        }
+        downlink_scheduler = NULL;
+        if(rc->scheduler && node_is_basestation)
+        {
+            downlink_scheduler = new DownlinkScheduler(num_nodes_in_net - 1,
+                    rc->scheduler_blocks, rc->scheduler_fairness);
+            sched_payload_bytes.assign(num_nodes_in_net - 1, 0);
+            sched_payload_symbols.assign(num_nodes_in_net - 1, 0);
+        }
+        if((rc->scheduler || rc->traffic_aware) && node_is_basestation)
+            sched_blocks.assign(num_nodes_in_net - 1, 0);
+        if(rc->arq)
+        {
+            if(!rc->uplink)
+            {
+                cerr << "\nERROR in RadioHardwareConfig constructor: ";
+                cerr << "arq needs the uplink to carry acknowledgements" << endl;
+                exit(EXIT_FAILURE);
+            }
+            if(frame_len * PS_ARQ_MAX_FRAMES < RHC_FRAME_PAYLOAD_MAX_SIZE)
+            {
+                cerr << "\nERROR in RadioHardwareConfig constructor: ";
+                cerr << "arq needs a frame_size of at least "
+                    << (RHC_FRAME_PAYLOAD_MAX_SIZE + PS_ARQ_MAX_FRAMES - 1) / PS_ARQ_MAX_FRAMES << endl;
+                exit(EXIT_FAILURE);
+            }
+            ps->enable_arq(rc->arq_window, rc->arq_timeout, rc->arq_max_retransmissions);
+        }
         if(!node_is_basestation)
         {
-            ofdma_fs_inner = ofdmflexframesync_create_multi_user(RHC_OFDMA_M, RHC_cp_len, RHC_taper_len, inner_subcarrier_allocation, ofdmaCallback, (void *)rx_timer, node_id - 1, num_nodes_in_net - 1);
-            ofdma_fs_outer = ofdmflexframesync_create_multi_user(RHC_OFDMA_M, RHC_cp_len, RHC_taper_len, outer_subcarrier_allocation, ofdmaCallback, (void *)rx_timer, node_id - 1, num_nodes_in_net - 1);
-            ofdma_fs_default = ofdmflexframesync_create_multi_user(RHC_OFDMA_M, RHC_cp_len, RHC_taper_len, default_subcarrier_allocation, ofdmaCallback, (void *)rx_timer, node_id - 1, num_nodes_in_net - 1);
+            evm_telemetry = new EvmTelemetry(RHC_OFDMA_M, rc->evm_log_file,
+                    rc->evm_log_decimation, rc->evm_average_alpha,
+                    rc->evm_high_threshold, high_evm_counts);
+            ofdma_fs_inner = ofdmflexframesync_create_multi_user(RHC_OFDMA_M, RHC_cp_len, RHC_taper_len, inner_subcarrier_allocation, ofdmaCallback, (void *)this, node_id - 1, num_nodes_in_net - 1);
+            ofdma_fs_outer = ofdmflexframesync_create_multi_user(RHC_OFDMA_M, RHC_cp_len, RHC_taper_len, outer_subcarrier_allocation, ofdmaCallback, (void *)this, node_id - 1, num_nodes_in_net - 1);
+            ofdma_fs_default = ofdmflexframesync_create_multi_user(RHC_OFDMA_M, RHC_cp_len, RHC_taper_len, default_subcarrier_allocation, ofdmaCallback, (void *)this, node_id - 1, num_nodes_in_net - 1);
+            ofdmflexframesync_set_payload_soft(ofdma_fs_inner, soft_decoding);
+            ofdmflexframesync_set_payload_soft(ofdma_fs_outer, soft_decoding);
+            ofdmflexframesync_set_payload_soft(ofdma_fs_default, soft_decoding);
             unsigned int nulls, pilots, data;
             ofdmframe_validate_sctype(default_subcarrier_allocation, RHC_OFDMA_M, &nulls, &pilots, &data);
             std::cout << "Uplink Subcarrier Summary:" << std::endl;
@@ -612,10 +714,13 @@ RadioHardwareConfig::RadioHardwareConfig(
             ///ofdmframe_print_sctype(p, 512);
             mcrx = new multichannelrx(num_nodes_in_net - 1, subcarriers_per_channel, RHC_cp_len, RHC_taper_len,
                     p, userdata, callbacks);
+            mcrx->SetPayloadSoft(soft_decoding);
         }
     }
     fs = ofdmflexframesync_create(RHC_M, RHC_cp_len, RHC_taper_len, NULL,
             rxCallback, (void *) &rxf);
+    ofdmflexframesync_set_payload_soft(fs, soft_decoding);
+    startup_profiler->end();
 
     // Receive side sensing configuration --------------------------------
     rx_snapshot_was_triggered = false;
@@ -624,20 +729,21 @@ RadioHardwareConfig::RadioHardwareConfig(
     rx_snapshot_sample_idx = 0;
 
     // Transmit side USRP configuration ----------------------------------
-    usrp->set_tx_antenna("TX/RX");
-    usrp->set_tx_gain(rf_gain_tx);
+    startup_profiler->begin("tx antenna, gain, rate and streamer");
+    radio_device->setTxAntenna("TX/RX");
+    radio_device->setTxGain(rf_gain_tx);
 
     // Transmit frequency already set in receive stage tune2NormalFreq()
     if(u4 && !node_is_basestation)
     {
-        usrp->set_tx_rate(RHC_NOMINAL_RESAMPLER_RATIO * sample_rate);
-        usrp_tx_rate = usrp->get_tx_rate();
+        radio_device->setTxRate(RHC_NOMINAL_RESAMPLER_RATIO * sample_rate);
+        usrp_tx_rate = radio_device->getTxRate();
         tx_resamp_rate = usrp_tx_rate / sample_rate;
     }
     else
     {
-        usrp->set_tx_rate(RHC_NOMINAL_RESAMPLER_RATIO * sample_rate);
-        usrp_tx_rate = usrp->get_tx_rate();
+        radio_device->setTxRate(RHC_NOMINAL_RESAMPLER_RATIO * sample_rate);
+        usrp_tx_rate = radio_device->getTxRate();
         tx_resamp_rate = usrp_tx_rate / sample_rate;
     }
 
@@ -646,19 +752,22 @@ RadioHardwareConfig::RadioHardwareConfig(
     // methods that actually perform burst tx & rx
 
     // Create tx streamer object for burst transmissions
-    uhd::stream_args_t tx_stream_args("fc32");
-    tx_stream = usrp->get_tx_stream(tx_stream_args);
+    radio_device->initTxStream();
 
     // Using this constant in transport size makes a whole number of transfers;
     // this constant is compatible with both Gigabit Ethernet and PCIe interfaces
     tx_uhd_transport_size =  RHC_TX_UHD_TRANSPORT_SIZE; 
-    tx_uhd_max_buffer_size = tx_stream->get_max_num_samps() +64;
+    tx_uhd_max_buffer_size = radio_device->getMaxSendSamps() +64;
+    tx_usrp_buffer.resize(std::max(tx_uhd_max_buffer_size, (size_t)RHC_MC_TX_SEND_SIZE));
+    tx_padded_payload.resize(RHC_FRAME_PAYLOAD_DEFAULT_SIZE + PADDED_BYTES);
 
     // The following is for the check of tx_async_md that _seems_ to need
     // to be fetched after a burst
     tx_uhd_ack_received = false;
+    startup_profiler->end();
 
     // Transmit side modem configuration ---------------------------------
+    startup_profiler->begin("tx modem objects");
     ofdmflexframegenprops_init_default(&fgprops);
     fgprops.check           = RHC_check;  
     fgprops.fec0            = LIQUID_FEC_NONE;
@@ -666,8 +775,8 @@ RadioHardwareConfig::RadioHardwareConfig(
     fgprops.mod_scheme      = RHC_ms;
     if(hardened)
     {
-        fgprops.fec0            = RHC_fec0;
-        fgprops.fec1            = LIQUID_FEC_RS_M8;
+        fgprops.fec0            = payload_fec0;
+        fgprops.fec1            = payload_fec1;
     } 
 
     if(u4)
@@ -690,7 +799,7 @@ RadioHardwareConfig::RadioHardwareConfig(
             ofdma_fg_outer = ofdmflexframegen_create_multi_user(RHC_OFDMA_M, RHC_cp_len, RHC_taper_len, outer_subcarrier_allocation, &fgprops, num_nodes_in_net - 1);
             ofdma_fg_default = ofdmflexframegen_create_multi_user(RHC_OFDMA_M, RHC_cp_len, RHC_taper_len, default_subcarrier_allocation, &fgprops, num_nodes_in_net - 1);
             std::stringstream report;
-            report << scientific << ext_am_ptr->getElapsedTime();
+            report << scientific << app->getElapsedTime();
             report << "    RadioHardwareConfig: ";
             report << "DL Subcarrier Allocation" << std::endl;
             
@@ -732,6 +841,14 @@ RadioHardwareConfig::RadioHardwareConfig(
     {
         fg  = ofdmflexframegen_create(RHC_M, RHC_cp_len, RHC_taper_len, NULL, &fgprops);
     }
+    startup_profiler->end();
+
+    // every FFT size the radio uses has been planned; keep the wisdom
+    if(!rc->fftw_wisdom_file.empty())
+    {
+        if(!liquid_fft_export_wisdom(rc->fftw_wisdom_file.c_str()))
+            cerr << "WARNING: could not save FFTW wisdom to " << rc->fftw_wisdom_file << endl;
+    }
 
     if(u4)
     {
@@ -746,24 +863,25 @@ RadioHardwareConfig::RadioHardwareConfig(
 
 
     // Establish choice of USRP hardware clock
+    startup_profiler->begin("clock reference");
     switch (clock_ref_type) {
         case CLOCK_REF_GPSDO :
             try {
-                usrp->set_time_source("gpsdo");
-                usrp->set_time_unknown_pps(uhd::time_spec_t(0.0));
+                radio_device->setTimeSource("gpsdo");
+                radio_device->setTimeUnknownPps(uhd::time_spec_t(0.0));
             } catch (...) {
-                usrp->set_time_source("gpsdo");
-                usrp->set_time_unknown_pps(uhd::time_spec_t(0.0));
+                radio_device->setTimeSource("gpsdo");
+                radio_device->setTimeUnknownPps(uhd::time_spec_t(0.0));
             }
             break;
 
         case CLOCK_REF_LAB :
             try {
-                usrp->set_time_source("external");
-                usrp->set_time_unknown_pps(uhd::time_spec_t(0.0));
+                radio_device->setTimeSource("external");
+                radio_device->setTimeUnknownPps(uhd::time_spec_t(0.0));
             } catch (...) {
-                usrp->set_time_source("external");
-                usrp->set_time_unknown_pps(uhd::time_spec_t(0.0));
+                radio_device->setTimeSource("external");
+                radio_device->setTimeUnknownPps(uhd::time_spec_t(0.0));
             }
             break;
 
@@ -775,7 +893,7 @@ RadioHardwareConfig::RadioHardwareConfig(
                 cerr << "         communicate reliably with other radios in the network."<<endl;
                 cerr << "         Running without a reference only suitable for standalone testing."<<endl;
             }
-            usrp->set_time_now(uhd::time_spec_t(0.0));
+            radio_device->setTimeNow(uhd::time_spec_t(0.0));
 
             break;
 
@@ -785,16 +903,18 @@ RadioHardwareConfig::RadioHardwareConfig(
             break;
     }
 
-    uhd::sensor_value_t ref_locked = usrp->get_mboard_sensor("ref_locked", 0);
-    if ( ref_locked.to_bool() ) {
+    if ( radio_device->isRefLocked() ) {
         // Silent if everything working
     } else {
         cerr << "WARNING: Could not lock to a clock reference." <<endl;
         cerr << "         Running without a reference only suitable for standalone testing."<<endl;
     }
+    startup_profiler->end();
 
     // Calibration of receiver noise on normal frequency for idle channel
+    startup_profiler->begin("rxHeartbeatCalibration");
     rxHeartbeatCalibration( (getHardwareTimestamp() +0.01), initial_rx_recommended_sample_size);
+    startup_profiler->end();
 
     // Check for presence of a bug in UHD's manual tuning mode within the receive side
     // DSP stage, an error in the sign of the DSP stage's frequency 
@@ -805,17 +925,19 @@ RadioHardwareConfig::RadioHardwareConfig(
         cout << "       Probe trying to tune to 2.405e9 +1.0e6 = 2.406 GHz . . . "<<endl;
     }
 #endif
+    startup_profiler->begin("UHD rx tuning bug probe");
     rx_tune_req.rf_freq = 2.405e9;  
     rx_tune_req.rf_freq_policy = uhd::tune_request_t::POLICY_MANUAL;
     rx_tune_req.dsp_freq = 1.0e6;   
     rx_tune_req.dsp_freq_policy = uhd::tune_request_t::POLICY_MANUAL;
-    usrp->set_rx_freq(rx_tune_req);
-    double bug_check_freq = usrp->get_rx_freq();
+    radio_device->setRxFreq(rx_tune_req);
+    double bug_check_freq = radio_device->getRxFreq();
     if (bug_check_freq != 2.406e9) {
         uhd_rx_tuning_bug_is_present = true;
     } else {
         uhd_rx_tuning_bug_is_present = false;
     }
+    startup_profiler->end();
 #ifdef DEBUG_SUPPORTED
     if (debug) {
         cout << "       Probe complete.  Bug is ";
@@ -828,14 +950,14 @@ RadioHardwareConfig::RadioHardwareConfig(
     }
 #endif
 
+    startup_profiler->begin("tune2NormalFreq (final)");
     tune2NormalFreq();
+    startup_profiler->end();
 
     // Initialize RadioHardwareConfig debug tools
     initRxfEventLog(rxf_event_log_level);
     initUhdErrorLog(uhd_error_log_level);
 
-    ext_rhc_ptr = this;
-
 }
 //////////////////////////////////////////////////////////////////////////
 
@@ -862,6 +984,15 @@ RadioHardwareConfig::~RadioHardwareConfig()
     std::cout << "Detected: " << total_packets_received << " packets." << std::endl;
     std::cout << "Network: " << network_packets_received << std::endl;
     std::cout << "Dummy: " << dummy_packets_received << std::endl << std::endl;
+    if(rc->traffic_aware)
+    {
+        std::cout << "Keep-alive: " << keepalive_packets_transmitted << " sent, "
+            << keepalive_packets_received << " received" << std::endl;
+        std::cout << "Idle: " << idle_bursts_skipped << " bursts skipped, "
+            << idle_frames_received << " frames received" << std::endl << std::endl;
+    }
+    if(rc->arq)
+        ps->print_arq_summary();
     std::cout << valid_headers_received << " valid headers (" << 100 * (float)valid_headers_received / total_packets_received
         << "%)" << std::endl;
     std::cout << valid_payloads_received << " valid payloads (" << 100 * (float)valid_payloads_received / total_packets_received
@@ -870,9 +1001,13 @@ RadioHardwareConfig::~RadioHardwareConfig()
     rf_log_ptr->write_log();
     alloc_log_ptr->write_log();
     delete alloc_log_ptr;
+    packet_log_ptr->write_log();
+    delete packet_log_ptr;
     //Delete receiver side objects
-    firfilt_crcf_destroy(rx_prefilt);
-    msresamp_crcf_destroy(rx_resamp);
+    if(rx_rresamp != NULL)
+        rresamp_crcf_destroy(rx_rresamp);
+    if(rx_resamp != NULL)
+        msresamp_crcf_destroy(rx_resamp);
     ofdmflexframesync_destroy(fs);
 
     // Delete transmitter side objects
@@ -882,12 +1017,37 @@ RadioHardwareConfig::~RadioHardwareConfig()
     //Delete OFDMA objects
     if(u4)
     {
+        if(evm_telemetry != NULL)
+        {
+            std::cout << "EVM telemetry: " << evm_telemetry->getFramesRecorded()
+                << " frames recorded, " << evm_telemetry->getFramesDropped()
+                << " dropped" << std::endl;
+            delete evm_telemetry;
+        }
+        if(link_adaptation != NULL)
+        {
+            if(rc->node_is_basestation)
+                link_adaptation->printSummary();
+            delete link_adaptation;
+        }
+        if(downlink_scheduler != NULL)
+        {
+            downlink_scheduler->printSummary();
+            delete downlink_scheduler;
+        }
         delete mcrx;
         delete mctx;
         timer_destroy(transmit_timer);
-        ofdmflexframesync_destroy(ofdma_fs_inner);
-        ofdmflexframegen_destroy_multi_user(ofdma_fg_inner);
+        if(node_is_basestation)
+            ofdmflexframegen_destroy_multi_user(ofdma_fg_inner);
+        else
+            ofdmflexframesync_destroy(ofdma_fs_inner);
     }
+
+    // release the FFT plans no object uses any more
+    liquid_fft_plan_cache_clear();
+
+    delete radio_device;
 }
 //////////////////////////////////////////////////////////////////////////
 
@@ -944,7 +1104,7 @@ double RadioHardwareConfig::getFhWindowMedium()
 
 double RadioHardwareConfig::getHardwareTimestamp()
 {
-    uhd::time_spec_t uhd_system_time_now = usrp->get_time_now(0);
+    uhd::time_spec_t uhd_system_time_now = radio_device->getTimeNow();
 
     // The following approach may do better at keeping full precision of 
     // underlying time_spec_t data than the .get_real_secs() method 
@@ -954,7 +1114,7 @@ double RadioHardwareConfig::getHardwareTimestamp()
 //////////////////////////////////////////////////////////////////////////
 int RadioHardwareConfig::setHardwareTimestamp(uhd::time_spec_t time)
 {
-    usrp->set_time_now(time);
+    radio_device->setTimeNow(time);
     return(1);
 }
 
@@ -967,7 +1127,7 @@ double RadioHardwareConfig::getHardwareNextSecond()
     // a starting schedule too close to current time
     const double END_OF_SECOND_MARGIN = 0.01;
 
-    uhd::time_spec_t uhd_system_time_now = usrp->get_time_now(0);
+    uhd::time_spec_t uhd_system_time_now = radio_device->getTimeNow();
 
     return(1.0 + floor( END_OF_SECOND_MARGIN +
                 (double)uhd_system_time_now.get_full_secs() +  
@@ -1030,7 +1190,7 @@ int RadioHardwareConfig::tuneRxManual(double rf_freq, double dsp_freq)
     rx_tune_req.rf_freq_policy = uhd::tune_request_t::POLICY_MANUAL;
     rx_tune_req.dsp_freq = dsp_freq;
     rx_tune_req.dsp_freq_policy = uhd::tune_request_t::POLICY_MANUAL;
-    usrp->set_rx_freq(rx_tune_req);
+    radio_device->setRxFreq(rx_tune_req);
 
     if (uhd_rx_tuning_bug_is_present) {
         rx_absolute_freq = rx_tune_req.rf_freq - rx_tune_req.dsp_freq;
@@ -1038,7 +1198,7 @@ int RadioHardwareConfig::tuneRxManual(double rf_freq, double dsp_freq)
         rx_absolute_freq = rx_tune_req.rf_freq + rx_tune_req.dsp_freq;
     }
 
-    while( !(usrp->get_rx_sensor("lo_locked",0).to_bool()) ) {
+    while( !(radio_device->isRxLoLocked()) ) {
         usleep(20);
     }
 
@@ -1058,10 +1218,10 @@ int RadioHardwareConfig::tuneTxManual(double rf_freq, double dsp_freq)
     tx_tune_req.rf_freq_policy = uhd::tune_request_t::POLICY_MANUAL;
     tx_tune_req.dsp_freq = dsp_freq;
     tx_tune_req.dsp_freq_policy = uhd::tune_request_t::POLICY_MANUAL;
-    usrp->set_tx_freq(tx_tune_req);
+    radio_device->setTxFreq(tx_tune_req);
     tx_absolute_freq = tx_tune_req.rf_freq + tx_tune_req.dsp_freq;
 
-    while( !(usrp->get_tx_sensor("lo_locked",0).to_bool()) ) {
+    while( !(radio_device->isTxLoLocked()) ) {
         usleep(20);
     }
 
@@ -1105,41 +1265,216 @@ int RadioHardwareConfig::tune2NormalFreq()
             tx_tune_req.rf_freq = normal_freq + tx2rx_freq_separation ;
         }
     }
-    usrp->set_rx_freq(rx_tune_req);
+    radio_device->setRxFreq(rx_tune_req);
     rx_absolute_freq = rx_tune_req.rf_freq + rx_tune_req.dsp_freq;
 
-    usrp->set_tx_freq(tx_tune_req);
+    radio_device->setTxFreq(tx_tune_req);
     tx_absolute_freq = tx_tune_req.rf_freq + tx_tune_req.dsp_freq;
 
-    while( !(usrp->get_rx_sensor("lo_locked",0).to_bool()) ) {
+    while( !(radio_device->isRxLoLocked()) ) {
         usleep(200+(rand()%100));
     }
-    while( !(usrp->get_tx_sensor("lo_locked",0).to_bool()) ) {
+    while( !(radio_device->isTxLoLocked()) ) {
         usleep(200+(rand()%100));
     }
 
     return(EXIT_SUCCESS);
 }
 //////////////////////////////////////////////////////////////////////////    
+
+
+// Apply each mobile's adaptive modulation and coding mode to the generator
+// for the next downlink frame; must be called with gen_mutex held
+void RadioHardwareConfig::setUserModes(ofdmflexframegen gen)
+{
+    double now = app->getElapsedTime();
+    ofdmflexframegenprops_s props = fgprops;
+    LinkAdaptationMode mode;
+    for(unsigned int i = 0; i < num_nodes_in_net - 1; i++)
+    {
+        link_adaptation->selectMode(i, now, &mode);
+        props.mod_scheme = mode.mod_scheme;
+        props.fec0 = mode.fec0;
+        props.fec1 = mode.fec1;
+        ofdmflexframegen_set_user_props(gen, i, &props);
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+// Choose the mobiles the next downlink frame serves and their shares of the
+// subcarriers, from the head of each mobile's queue and the modulation and
+// coding it gets. Mobiles not served get no subcarriers and only the frame
+// header. Returns false, with the even split restored, when no mobile has
+// anything queued. Must be called with gen_mutex held, after setUserModes()
+bool RadioHardwareConfig::scheduleUsers(ofdmflexframegen gen)
+{
+    unsigned int num_users = num_nodes_in_net - 1;
+    ofdmflexframegenprops_s props;
+    bool any_queued = false;
+    for(unsigned int i = 0; i < num_users; i++)
+    {
+        sched_payload_bytes[i] = getNextPayloadSize(i + 1);
+        if(sched_payload_bytes[i] == 0 && !using_tun_tap && !rc->traffic_aware)
+            sched_payload_bytes[i] = frame_len;
+        any_queued |= (sched_payload_bytes[i] > 0);
+
+        ofdmflexframegen_get_user_props(gen, i, &props);
+        unsigned int enc_len = packetizer_compute_enc_msg_len(sched_payload_bytes[i],
+                props.check, props.fec0, props.fec1);
+        unsigned int bps = modulation_types[props.mod_scheme].bps;
+        sched_payload_symbols[i] = (8 * enc_len + bps - 1) / bps;
+    }
+    if(!any_queued)
+    {
+        std::fill(sched_blocks.begin(), sched_blocks.end(), 0);
+        ofdmflexframegen_set_user_shares(gen, &sched_blocks.front());
+        return false;
+    }
+
+    // Frames may take as long as a full payload to every mobile in the
+    // frame-wide modulation and coding
+    unsigned int enc_len = packetizer_compute_enc_msg_len(frame_len + PADDED_BYTES,
+            fgprops.check, fgprops.fec0, fgprops.fec1);
+    unsigned int bps = modulation_types[fgprops.mod_scheme].bps;
+    unsigned int symbol_budget = num_users * ((8 * enc_len + bps - 1) / bps);
+
+    downlink_scheduler->schedule(&sched_payload_bytes.front(), &sched_payload_symbols.front(),
+            symbol_budget, &sched_blocks.front());
+    ofdmflexframegen_set_user_shares(gen, &sched_blocks.front());
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+// Traffic-aware mode without the downlink scheduler: mobiles with something
+// queued split the subcarriers evenly, the others get none and only the
+// frame header. Returns false, with the even split restored, when no mobile
+// has anything queued. Must be called with gen_mutex held
+bool RadioHardwareConfig::shareAmongQueuedUsers(ofdmflexframegen gen)
+{
+    bool any_queued = false;
+    for(unsigned int i = 0; i < num_nodes_in_net - 1; i++)
+    {
+        sched_blocks[i] = (getNextPayloadSize(i + 1) > 0) ? 1 : 0;
+        any_queued |= (sched_blocks[i] > 0);
+    }
+    ofdmflexframegen_set_user_shares(gen, &sched_blocks.front());
+    return any_queued;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+// Traffic-aware mode, for a data burst with nothing queued: returns false
+// when a keep-alive is due, otherwise waits out the transmit window without
+// running the modem and returns true
+bool RadioHardwareConfig::skipIdleBurst(double tx_window)
+{
+    if(app->getElapsedTime() - last_burst_time >= rc->keepalive_interval)
+        return false;
+    idle_bursts_skipped++;
+    setHardwareTimestamp(0.0);
+    while(getHardwareTimestamp() < tx_window)
+    {
+        usleep(100);
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+// Payload bytes of the next frame to a destination: the next fragment from
+// the packet store with its control bytes, the control bytes alone when
+// there is only an ARQ acknowledgement to send, or 0 when there is nothing
+unsigned int RadioHardwareConfig::getNextPayloadSize(unsigned int dest_id)
+{
+    unsigned int next_frame_size = 0;
+    ps->get_queued_bytes(dest_id, &next_frame_size);
+    if(next_frame_size > 0)
+        return next_frame_size + PADDED_BYTES;
+    return (rc->arq && ps->has_pending_ack(dest_id)) ? PADDED_BYTES : 0;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+// Lays out the control bytes and the fragment (none for an
+// acknowledgement-only frame) in tx_padded_payload and returns it
+unsigned char* RadioHardwareConfig::padPayload(
+        unsigned int dest_id,
+        unsigned char* payload_data,
+        unsigned int payload_len,
+        long int packet_id,
+        unsigned int total_packet_len,
+        unsigned int frame_id
+        )
+{
+    if (tx_padded_payload.size() < payload_len + PADDED_BYTES)
+        tx_padded_payload.resize(payload_len + PADDED_BYTES);
+    unsigned char* padded_data = &tx_padded_payload.front();
+    if(payload_len > 0)
+        memmove(padded_data + PADDED_BYTES, payload_data, payload_len);
+    //Set 2 "keys" so we can check in the callback to see if we received one
+    //of these packets with extra control data in the front of the payload
+    padded_data[0] = 42;
+    padded_data[1] = 37;
+    long int* li_padded_data = (long int*)(padded_data + 2);
+    li_padded_data[0] = packet_id;
+    padded_data[2 + sizeof(long int)] = (total_packet_len >> 8) & 0xff;
+    padded_data[2 + sizeof(long int) + 1] = (total_packet_len) & 0xff;
+    padded_data[2 + sizeof(long int) + 2] = frame_id;
+
+    long int ack_packet_id = 0;
+    unsigned int ack_bitmap = 0;
+    if(rc->arq)
+        ps->get_ack(dest_id, &ack_packet_id, &ack_bitmap);
+    long int* li_ack = (long int*)(padded_data + PADDED_ACK_PACKET_ID);
+    li_ack[0] = ack_packet_id;
+    padded_data[PADDED_ACK_BITMAP] = (ack_bitmap >> 24) & 0xff;
+    padded_data[PADDED_ACK_BITMAP + 1] = (ack_bitmap >> 16) & 0xff;
+    padded_data[PADDED_ACK_BITMAP + 2] = (ack_bitmap >> 8) & 0xff;
+    padded_data[PADDED_ACK_BITMAP + 3] = (ack_bitmap) & 0xff;
+    return padded_data;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+// Hands the ARQ acknowledgement in a received payload's control bytes to
+// the packet store; source_id is the node that sent the payload
+void RadioHardwareConfig::readArqAck(unsigned int source_id, unsigned char* padded_data)
+{
+    if(!rc->arq)
+        return;
+    long int* li_ack = (long int*)(padded_data + PADDED_ACK_PACKET_ID);
+    unsigned int ack_bitmap = (padded_data[PADDED_ACK_BITMAP] << 24 |
+            padded_data[PADDED_ACK_BITMAP + 1] << 16 |
+            padded_data[PADDED_ACK_BITMAP + 2] << 8 |
+            padded_data[PADDED_ACK_BITMAP + 3]);
+    ps->ack_frames(source_id, li_ack[0], ack_bitmap);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
 void RadioHardwareConfig::recreate_modem()
 {
+    RHC_ALLOC_REGION(ALLOC_REGION_RECONFIGURE);
     std::stringstream report;
-    report << scientific << ext_am_ptr->getElapsedTime();
+    report << scientific << app->getElapsedTime();
     report << "    RadioHardwareConfig: ";
     if(node_is_basestation)
     {
+        // the generator switches allocation in place, keeping its
+        // transform plan and payload objects, at the next frame boundary
+        gen_mutex.lock();
         if(!hardened)
         {
             fgprops.check           = RHC_check;  
-            fgprops.fec0            = RHC_fec0;
-            fgprops.fec1            = LIQUID_FEC_RS_M8;
+            fgprops.fec0            = payload_fec0;
+            fgprops.fec1            = payload_fec1;
             fgprops.mod_scheme      = RHC_ms;
             hardened = true;
+            ofdmflexframegen_setprops(ofdma_fg_default, &fgprops);
         }
-        gen_mutex.lock();
-        ofdmflexframegen_destroy(ofdma_fg_default);
-        ofdma_fg_default = ofdmflexframegen_create_multi_user(RHC_OFDMA_M, RHC_cp_len, RHC_taper_len, new_alloc,
-        &fgprops, num_nodes_in_net - 1);
+        ofdmflexframegen_update_subcarrier_allocation(ofdma_fg_default, new_alloc);
         gen_mutex.unlock();
         report << "New DL Subcarrier Allocation" << std::endl;
         unsigned char* map = ofdmflexframegen_get_subcarrier_map(ofdma_fg_default);
@@ -1159,20 +1494,56 @@ void RadioHardwareConfig::recreate_modem()
     }
     else
     {
-        //get a lock on the sync so we dont try to destroy it while it is
-        //executing symbols
+        //get a lock on the sync so we dont change it while it is
+        //executing symbols; a frame being received finishes with the old
+        //allocation
         sync_mutex.lock();
-        ofdmflexframesync_destroy(ofdma_fs_default);
-        ofdma_fs_default = ofdmflexframesync_create_multi_user(RHC_OFDMA_M, RHC_cp_len, RHC_taper_len, new_alloc, ofdmaCallback, (void *)rx_timer, node_id - 1, num_nodes_in_net - 1);
+        ofdmflexframesync_update_subcarrier_allocation(ofdma_fs_default, new_alloc);
         received_new_alloc = false;
         sync_mutex.unlock();
     }
 }
 //////////////////////////////////////////////////////////////////////////    
+void RadioHardwareConfig::rxFrontEndReset()
+{
+    if(rx_rresamp != NULL)
+        rresamp_crcf_reset(rx_rresamp);
+    else
+        msresamp_crcf_reset(rx_resamp);
+}
+//////////////////////////////////////////////////////////////////////////    
+// Anti-alias filter and resample a block of USRP samples to the modem rate;
+// modem_samples must hold num_usrp_samples * rx_resamp_rate + 2 samples
+void RadioHardwareConfig::rxFrontEndExecute(
+        std::complex<float>* usrp_samples,
+        unsigned int num_usrp_samples,
+        std::complex<float>* modem_samples,
+        unsigned int* num_modem_samples
+        )
+{
+    if(rx_rresamp != NULL)
+        rresamp_crcf_execute(rx_rresamp, usrp_samples, num_usrp_samples,
+                modem_samples, num_modem_samples);
+    else
+        msresamp_crcf_execute(rx_resamp, usrp_samples, num_usrp_samples,
+                modem_samples, num_modem_samples);
+}
+//////////////////////////////////////////////////////////////////////////    
+ofdmflexframesync RadioHardwareConfig::getActiveOfdmaSync()
+{
+    if(allocation == INNER_ALLOCATION)
+        return ofdma_fs_inner;
+    else if(allocation == OUTER_ALLOCATION)
+        return ofdma_fs_outer;
+    else
+        return ofdma_fs_default;
+}
+//////////////////////////////////////////////////////////////////////////    
 void RadioHardwareConfig::switch_allocation()
 {
+    RHC_ALLOC_REGION(ALLOC_REGION_RECONFIGURE);
     std::stringstream report;
-    report << scientific << ext_am_ptr->getElapsedTime();
+    report << scientific << app->getElapsedTime();
     report << "    RadioHardwareConfig: ";
     if(allocation == INNER_ALLOCATION)
     {
@@ -1217,9 +1588,8 @@ int RadioHardwareConfig::rxFrameBurst(
     rxf.frame_is_valid = false;    
     rxf.rx_complete_timestamp = 0.0;
     ofdmflexframesync_reset(fs);
-    firfilt_crcf_reset(rx_prefilt);
+    rxFrontEndReset();
     unsigned int rx_num_resamples;
-    size_t ctr;
     unsigned int n;
 
     // Reset noise calculation variables
@@ -1236,14 +1606,14 @@ int RadioHardwareConfig::rxFrameBurst(
     rx_stream_cmd.num_samps = rx_total_requested_samples;
     rx_stream_cmd.stream_now = false; 
     rx_stream_cmd.time_spec = uhd::time_spec_t(rx_start_time);
-    rx_stream->issue_stream_cmd(rx_stream_cmd);
+    radio_device->issueStreamCmd(rx_stream_cmd);
 
     // Keep fetching samples until requested amount delivered or UHD error
     uhd_error_stats.rx_attempts++;
     unsigned int rx_uhd_recv_ctr = 0;
     while (uhd_total_delivered_samples < rx_total_requested_samples) {
 
-        uhd_num_delivered_samples = rx_stream->recv(&rx_usrp_buffer.front(),
+        uhd_num_delivered_samples = radio_device->recv(&rx_usrp_buffer.front(),
                 rx_uhd_transport_size, rx_md, rx_timeout, true);
 
         // Check for UHD errors
@@ -1263,17 +1633,11 @@ int RadioHardwareConfig::rxFrameBurst(
                 return(EXIT_FAILURE);
         }
 
-        // Prefilter samples; this may be optional in a lab environment
-        for (ctr = 0; ctr < uhd_num_delivered_samples; ctr++) {
-            firfilt_crcf_push(rx_prefilt, rx_usrp_buffer[ctr] );
-            firfilt_crcf_execute(rx_prefilt, &rx_usrp_buffer[ctr] );
-        }
-
-        // Apply resampler to reduce UHD sample rate to modem's receive rate
+        // Filter and reduce UHD sample rate to modem's receive rate
         rx_num_resamples = 0;
-        msresamp_crcf_execute(rx_resamp, &rx_usrp_buffer[0], 
-                (unsigned int)uhd_num_delivered_samples, 
-                &rx_temp_resample_buf[0], &rx_num_resamples);  
+        rxFrontEndExecute(&rx_usrp_buffer[0],
+                (unsigned int)uhd_num_delivered_samples,
+                &rx_temp_resample_buf[0], &rx_num_resamples);
 
         // Input samples to modem
         ofdmflexframesync_execute(fs, &rx_temp_resample_buf[0], rx_num_resamples);
@@ -1302,33 +1666,15 @@ int RadioHardwareConfig::rxFrameBurst(
 
 
     // If rxf logging active then report attributes of any detected frame
-    if (rxf.frame_was_detected) {
+    if (RHC_RXF_LOG_ENABLED && rxf.frame_was_detected) {
         reportRxfEvent();
     } 
 
     // If valid frame received then generate a report
-    rf_log_report_t rf_log_report;
     if (rxf.frame_is_valid) {   // Condition for RF_LOG_EVENT_RX_DATA
-        switch (rf_log_level) {
-            case(RF_LOG_LEVEL_NONE) :
-                // no logging
-                break;
-            case(RF_LOG_LEVEL_NORMAL) :
-                rf_log_report.hardware_timestamp_nominal = rx_start_time;
-                rf_log_report.rf_event = RF_LOG_EVENT_RX_DATA;
-                rf_log_report.frequency_nominal = getRxAbsoluteFreq();
-                rf_log_report.bandwidth = sample_rate;
-                logRfEvent(rf_log_report);
-                break;
-            case(RF_LOG_LEVEL_DETAIL) :
-                // PLACEHOLDER for development version of logging
-                break;
-            default :
-                cerr << "\nERROR in RadioHardwareConfig::rxFrameBurst: ";
-                cerr << "Unknown rf_log_level\n" << endl;
-                exit(EXIT_FAILURE);
-                break;
-        }
+        RHC_LOG_RF_EVENT(this, rx_start_time,
+                RF_LOG_EVENT_RX_DATA,
+                getRxAbsoluteFreq());
     }
 
     return(EXIT_SUCCESS);
@@ -1349,9 +1695,8 @@ int RadioHardwareConfig::rxHeartbeatBurst(
     rxf.frame_is_valid = false;    
     rxf.rx_complete_timestamp = 0.0;
     if(!u4)ofdmflexframesync_reset(fs);
-    firfilt_crcf_reset(rx_prefilt);
+    rxFrontEndReset();
     unsigned int rx_num_resamples;
-    size_t ctr;
     unsigned int n;
 
     // Reset noise calculation variables
@@ -1368,14 +1713,14 @@ int RadioHardwareConfig::rxHeartbeatBurst(
     rx_stream_cmd.num_samps = rx_total_requested_samples;
     rx_stream_cmd.stream_now = false; 
     rx_stream_cmd.time_spec = uhd::time_spec_t(rx_start_time);
-    rx_stream->issue_stream_cmd(rx_stream_cmd);
+    radio_device->issueStreamCmd(rx_stream_cmd);
 
     // Keep fetching samples until requested amount delivered or UHD error
     uhd_error_stats.rx_attempts++;
     unsigned int rx_uhd_recv_ctr = 0;
     while (uhd_total_delivered_samples < rx_total_requested_samples) {
 
-        uhd_num_delivered_samples = rx_stream->recv(&rx_usrp_buffer.front(),
+        uhd_num_delivered_samples = radio_device->recv(&rx_usrp_buffer.front(),
                 rx_uhd_transport_size, rx_md, rx_timeout, true);
 
         // Check for UHD errors
@@ -1395,17 +1740,11 @@ int RadioHardwareConfig::rxHeartbeatBurst(
                 return(EXIT_FAILURE);
         }
 
-        // Prefilter samples; this may be optional in a lab environment
-        for (ctr = 0; ctr < uhd_num_delivered_samples; ctr++) {
-            firfilt_crcf_push(rx_prefilt, rx_usrp_buffer[ctr] );
-            firfilt_crcf_execute(rx_prefilt, &rx_usrp_buffer[ctr] );
-        }
-
-        // Apply resampler to reduce UHD sample rate to modem's receive rate
+        // Filter and reduce UHD sample rate to modem's receive rate
         rx_num_resamples = 0;
-        msresamp_crcf_execute(rx_resamp, &rx_usrp_buffer[0], 
-                (unsigned int)uhd_num_delivered_samples, 
-                &rx_temp_resample_buf[0], &rx_num_resamples);  
+        rxFrontEndExecute(&rx_usrp_buffer[0],
+                (unsigned int)uhd_num_delivered_samples,
+                &rx_temp_resample_buf[0], &rx_num_resamples);
 
         // Input samples to modem
         ofdmflexframesync_execute(fs, &rx_temp_resample_buf[0], rx_num_resamples);
@@ -1434,33 +1773,15 @@ int RadioHardwareConfig::rxHeartbeatBurst(
 
 
     // If rxf logging active then report attributes of any detected frame
-    if (rxf.frame_was_detected) {
+    if (RHC_RXF_LOG_ENABLED && rxf.frame_was_detected) {
         reportRxfEvent();
     } 
 
     // If valid frame received then generate a report
-    rf_log_report_t rf_log_report;
     if (rxf.frame_is_valid) {   // Condition for RF_LOG_EVENT_RX_DATA
-        switch (rf_log_level) {
-            case(RF_LOG_LEVEL_NONE) :
-                // no logging
-                break;
-            case(RF_LOG_LEVEL_NORMAL) :
-                rf_log_report.hardware_timestamp_nominal = rx_start_time;
-                rf_log_report.rf_event = RF_LOG_EVENT_RX_HEARTBEAT;
-                rf_log_report.frequency_nominal = getRxAbsoluteFreq();
-                rf_log_report.bandwidth = sample_rate;
-                logRfEvent(rf_log_report);
-                break;
-            case(RF_LOG_LEVEL_DETAIL) :
-                // PLACEHOLDER for development version of logging
-                break;
-            default :
-                cerr << "\nERROR in RadioHardwareConfig::rxFrameBurst: ";
-                cerr << "Unknown rf_log_level\n" << endl;
-                exit(EXIT_FAILURE);
-                break;
-        }
+        RHC_LOG_RF_EVENT(this, rx_start_time,
+                RF_LOG_EVENT_RX_HEARTBEAT,
+                getRxAbsoluteFreq());
     }
 
     return(EXIT_SUCCESS);
@@ -1479,9 +1800,8 @@ int RadioHardwareConfig::rxHeartbeatCalibration(
 
     // For now no RF event logging of calibration
 
-    firfilt_crcf_reset(rx_prefilt);
+    rxFrontEndReset();
     unsigned int rx_num_resamples;
-    size_t ctr;
     unsigned int n;
 
     // Reset noise calculation variables
@@ -1503,7 +1823,7 @@ int RadioHardwareConfig::rxHeartbeatCalibration(
     rx_stream_cmd.num_samps = rx_total_requested_samples;
     rx_stream_cmd.stream_now = false; 
     rx_stream_cmd.time_spec = uhd::time_spec_t(rx_start_time);
-    rx_stream->issue_stream_cmd(rx_stream_cmd);
+    radio_device->issueStreamCmd(rx_stream_cmd);
 
     // This rxHeartbeatCalibration process matches all the sample processing
     // steps of rxHeartbeatBurst except for passing samples to the modem
@@ -1511,7 +1831,7 @@ int RadioHardwareConfig::rxHeartbeatCalibration(
     unsigned int rx_uhd_recv_ctr = 0;
     while (uhd_total_delivered_samples < rx_total_requested_samples) {
 
-        uhd_num_delivered_samples = rx_stream->recv(&rx_usrp_buffer.front(),
+        uhd_num_delivered_samples = radio_device->recv(&rx_usrp_buffer.front(),
                 rx_uhd_transport_size, rx_md, rx_timeout, true);
 
         // Check for UHD errors
@@ -1531,17 +1851,11 @@ int RadioHardwareConfig::rxHeartbeatCalibration(
                 return(EXIT_FAILURE);
         }
 
-        // Prefilter samples; this may be optional in a lab environment
-        for (ctr = 0; ctr < uhd_num_delivered_samples; ctr++) {
-            firfilt_crcf_push(rx_prefilt, rx_usrp_buffer[ctr] );
-            firfilt_crcf_execute(rx_prefilt, &rx_usrp_buffer[ctr] );
-        }
-
-        // Apply resampler to reduce UHD sample rate to modem's receive rate
+        // Filter and reduce UHD sample rate to modem's receive rate
         rx_num_resamples = 0;
-        msresamp_crcf_execute(rx_resamp, &rx_usrp_buffer[0], 
-                (unsigned int)uhd_num_delivered_samples, 
-                &rx_temp_resample_buf[0], &rx_num_resamples);  
+        rxFrontEndExecute(&rx_usrp_buffer[0],
+                (unsigned int)uhd_num_delivered_samples,
+                &rx_temp_resample_buf[0], &rx_num_resamples);
 
         // Prep for next set of samples
         rx_uhd_recv_ctr++;
@@ -1594,9 +1908,8 @@ int RadioHardwareConfig::rxSnapshotBurst(
     std::vector<std::complex<float> > rx_usrp_buffer(rx_uhd_max_buffer_size); 
     std::vector<std::complex<float> > rx_temp_resample_buf(rx_uhd_max_buffer_size);        
 
-    firfilt_crcf_reset(rx_prefilt);
+    rxFrontEndReset();
     unsigned int rx_num_resamples;
-    size_t ctr;
 
     // Prepare for timed data acquisition
     size_t uhd_num_delivered_samples = 0;
@@ -1606,7 +1919,7 @@ int RadioHardwareConfig::rxSnapshotBurst(
     rx_stream_cmd.num_samps = rx_total_requested_samples;
     rx_stream_cmd.stream_now = false; 
     rx_stream_cmd.time_spec = uhd::time_spec_t(rx_start_time);
-    rx_stream->issue_stream_cmd(rx_stream_cmd);
+    radio_device->issueStreamCmd(rx_stream_cmd);
 
     // This rxSnapshotBurst process applies the same sample pre-processing
     // steps as in the functions for receiving a frame
@@ -1614,7 +1927,7 @@ int RadioHardwareConfig::rxSnapshotBurst(
     unsigned int rx_uhd_recv_ctr = 0;
     while (uhd_total_delivered_samples < rx_total_requested_samples) {
 
-        uhd_num_delivered_samples = rx_stream->recv(&rx_usrp_buffer.front(),
+        uhd_num_delivered_samples = radio_device->recv(&rx_usrp_buffer.front(),
                 rx_uhd_transport_size, rx_md, rx_timeout, true);
 
         // Check for UHD errors
@@ -1634,17 +1947,11 @@ int RadioHardwareConfig::rxSnapshotBurst(
                 return(EXIT_FAILURE);
         }
 
-        // Prefilter samples; this may be optional in a lab environment
-        for (ctr = 0; ctr < uhd_num_delivered_samples; ctr++) {
-            firfilt_crcf_push(rx_prefilt, rx_usrp_buffer[ctr] );
-            firfilt_crcf_execute(rx_prefilt, &rx_usrp_buffer[ctr] );
-        }
-
-        // Apply resampler to reduce UHD sample rate to modem's receive rate
+        // Filter and reduce UHD sample rate to modem's receive rate
         rx_num_resamples = 0;
-        msresamp_crcf_execute(rx_resamp, &rx_usrp_buffer[0], 
-                (unsigned int)uhd_num_delivered_samples, 
-                &rx_temp_resample_buf[0], &rx_num_resamples);  
+        rxFrontEndExecute(&rx_usrp_buffer[0],
+                (unsigned int)uhd_num_delivered_samples,
+                &rx_temp_resample_buf[0], &rx_num_resamples);
 
         // Add processed samples to snapshot buffer
         if (uhd_num_delivered_samples > 0) {
@@ -1759,8 +2066,8 @@ int RadioHardwareConfig::txHearbeatBurst(
 
                 if (tx_usrp_sample_counter == tx_uhd_transport_size) {    
                     tx_usrp_sample_counter = 0;
-                    // Could check (size_t)actual_uhd_transport_size = tx_stream->send(...)
-                    tx_stream->send(
+                    // Could check (size_t)actual_uhd_transport_size = radio_device->send(...)
+                    radio_device->send(
                             &tx_usrp_buffer.front(), tx_uhd_transport_size, tx_md, tx_timeout );
 
                     // prep metadata for next set of samples
@@ -1775,37 +2082,19 @@ int RadioHardwareConfig::txHearbeatBurst(
     tx_md.start_of_burst = false;
     tx_md.has_time_spec = false;
     tx_md.end_of_burst = true;
-    tx_stream->send(&tx_usrp_buffer.front(), 0, tx_md, tx_timeout);
+    radio_device->send(&tx_usrp_buffer.front(), 0, tx_md, tx_timeout);
 
     // Fetching of UHD async messages seems to be required 
     tx_uhd_ack_received = false;
-    while ( !tx_uhd_ack_received && tx_stream->recv_async_msg(tx_async_md, tx_timeout) ) {
+    while ( !tx_uhd_ack_received && radio_device->recvAsyncMsg(tx_async_md, tx_timeout) ) {
         tx_uhd_ack_received = (tx_async_md.event_code == uhd::async_metadata_t::EVENT_CODE_BURST_ACK);
     }
     frame_was_transmitted = true;
 
     // Prepare RF event log entry 
-    rf_log_report_t rf_log_report;
-    switch (rf_log_level) {
-        case(RF_LOG_LEVEL_NONE) :
-            // no logging
-            break;
-        case(RF_LOG_LEVEL_NORMAL) :
-            rf_log_report.hardware_timestamp_nominal = tx_start_time;
-            rf_log_report.rf_event = RF_LOG_EVENT_TX_HEARTBEAT;
-            rf_log_report.frequency_nominal = getTxAbsoluteFreq();
-            rf_log_report.bandwidth = sample_rate;
-            logRfEvent(rf_log_report);
-            break;
-        case(RF_LOG_LEVEL_DETAIL) :
-            // PLACEHOLDER for development version of logging
-            break;
-        default :
-            cerr << "\nERROR in RadioHardwareConfig::txHearbeatBurst: ";
-            cerr << "Unknown rf_log_level\n" << endl;
-            exit(EXIT_FAILURE);
-            break;
-    }
+    RHC_LOG_RF_EVENT(this, tx_start_time,
+            RF_LOG_EVENT_TX_HEARTBEAT,
+            getTxAbsoluteFreq());
 
     return(EXIT_SUCCESS);
 }
@@ -1861,8 +2150,8 @@ int RadioHardwareConfig::txFrameBurst(
 
                 if (tx_usrp_sample_counter == tx_uhd_transport_size) {    
                     tx_usrp_sample_counter = 0;
-                    // Could check (size_t)actual_uhd_transport_size = tx_stream->send(...)
-                    tx_stream->send(
+                    // Could check (size_t)actual_uhd_transport_size = radio_device->send(...)
+                    radio_device->send(
                             &tx_usrp_buffer.front(), tx_uhd_transport_size, tx_md, tx_timeout );
 
                     // prep metadata for next set of samples
@@ -1877,37 +2166,19 @@ int RadioHardwareConfig::txFrameBurst(
     tx_md.start_of_burst = false;
     tx_md.has_time_spec = false;
     tx_md.end_of_burst = true;
-    tx_stream->send(&tx_usrp_buffer.front(), 0, tx_md, tx_timeout);
+    radio_device->send(&tx_usrp_buffer.front(), 0, tx_md, tx_timeout);
 
     // Fetching of UHD async messages seems to be required 
     tx_uhd_ack_received = false;
-    while ( !tx_uhd_ack_received && tx_stream->recv_async_msg(tx_async_md, tx_timeout) ) {
+    while ( !tx_uhd_ack_received && radio_device->recvAsyncMsg(tx_async_md, tx_timeout) ) {
         tx_uhd_ack_received = (tx_async_md.event_code == uhd::async_metadata_t::EVENT_CODE_BURST_ACK);
     }
     frame_was_transmitted = true;
 
     // Prepare RF event log entry 
-    rf_log_report_t rf_log_report;
-    switch (rf_log_level) {
-        case(RF_LOG_LEVEL_NONE) :
-            // no logging
-            break;
-        case(RF_LOG_LEVEL_NORMAL) :
-            rf_log_report.hardware_timestamp_nominal = tx_start_time;
-            rf_log_report.rf_event = RF_LOG_EVENT_TX_DATA;
-            rf_log_report.frequency_nominal = getTxAbsoluteFreq();
-            rf_log_report.bandwidth = sample_rate;
-            logRfEvent(rf_log_report);
-            break;
-        case(RF_LOG_LEVEL_DETAIL) :
-            // PLACEHOLDER for development version of logging
-            break;
-        default :
-            cerr << "\nERROR in RadioHardwareConfig::txFrameBurst: ";
-            cerr << "Unknown rf_log_level\n" << endl;
-            exit(EXIT_FAILURE);
-            break;
-    }
+    RHC_LOG_RF_EVENT(this, tx_start_time,
+            RF_LOG_EVENT_TX_DATA,
+            getTxAbsoluteFreq());
 
     return(EXIT_SUCCESS);
 }
@@ -1917,8 +2188,24 @@ int RadioHardwareConfig::txOFDMAFrameBurst(
         OFDMATransmissionType tx_type
         )
 {
+    RHC_ALLOC_REGION(ALLOC_REGION_TX_BURST);
     timer_tic(transmit_timer);
 
+    // Traffic-aware mode: with nothing queued for any mobile only a
+    // keep-alive goes out, once every keepalive_interval
+    if(rc->traffic_aware && tx_type == DATA)
+    {
+        bool any_queued = false;
+        for(unsigned int i = 0; i < num_nodes_in_net - 1 && !any_queued; i++)
+            any_queued = (getNextPayloadSize(i + 1) > 0);
+        if(!any_queued)
+        {
+            if(skipIdleBurst(ofdma_tx_window))
+                return(EXIT_SUCCESS);
+            tx_type = KEEPALIVE;
+        }
+    }
+
     uhd::time_spec_t time_of_burst;
     //Wait for transmission timer to end before transmitting next packet
     /*double time_since_tic = timer_toc(transmit_timer);
@@ -1927,13 +2214,12 @@ int RadioHardwareConfig::txOFDMAFrameBurst(
         usleep(time_to_sleep*1000000);
     //restart timer to begin tx window 
     */
-    // USRP and resampler buffers
-    std::vector<std::complex<float> > tx_usrp_buffer(tx_uhd_max_buffer_size);
+    // Resampler buffers; the USRP buffer is a member
     unsigned int tx_usrp_sample_counter = 0;
     //std::complex<float> tx_frame_resample_buf[(int)(2*tx_resamp_rate) + 64];
     std::complex<float> tx_frame_resample_buf[(int)(2*tx_resamp_rate) * RHC_OFDMA_SYMBOL_LENGTH];
     std::complex<float> ofdm_symbol[RHC_OFDMA_SYMBOL_LENGTH];
-    unsigned char* header_buf = new unsigned char[P2M_FRAME_HEADER_DEFAULT_SIZE];
+    unsigned char header_buf[P2M_FRAME_HEADER_DEFAULT_SIZE];
     header_buf[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_DATA;
     gen_mutex.lock();
     ofdmflexframegen gen;
@@ -1948,6 +2234,8 @@ int RadioHardwareConfig::txOFDMAFrameBurst(
 
     setHardwareTimestamp(0.0);
     time_of_burst = ofdma_tx_window/4;
+    if(link_adaptation != NULL)
+        setUserModes(gen);
     if(tx_type == DATA)
     {
         unsigned char* payload_data;
@@ -1955,30 +2243,42 @@ int RadioHardwareConfig::txOFDMAFrameBurst(
         unsigned int frame_id;
         long int packet_id;
         unsigned int total_packet_len;
+        bool scheduled = (downlink_scheduler != NULL) ? scheduleUsers(gen) :
+            (rc->traffic_aware && shareAmongQueuedUsers(gen));
         for(unsigned int i = 0; i < num_nodes_in_net - 1; i++)
         {
+            if(scheduled && sched_blocks[i] == 0)
+            {
+                // not served this frame; the mobile only gets the header
+                ofdmflexframegen_multi_user_update_data(gen, tx_frame_payload, 0, i);
+                continue;
+            }
             payload_len = 0;
-            payload_data = ext_ps_ptr->get_next_frame_for_destination(i + 1, &packet_id, &frame_id, &payload_len, &total_packet_len);
+            payload_data = ps->get_next_frame_for_destination(i + 1, &packet_id, &frame_id, &payload_len, &total_packet_len);
             //std::cout << "dest: " << i + 1 << ", packet id: " << packet_id << ", size: " << total_packet_len << std::endl;
             if(payload_len > 0)
             {
-                unsigned char* padded_data = new unsigned char[payload_len + PADDED_BYTES];
-                memmove(padded_data + PADDED_BYTES, payload_data, payload_len);
-                //Set 2 "keys" so we can check in the callback to see if we received one
-                //of these packets with extra control data in the front of the payload
-                padded_data[0] = 42;
-                padded_data[1] = 37;
-                long int* li_padded_data = (long int*)(padded_data + 2);
-                li_padded_data[0] = packet_id;
-                padded_data[2 + sizeof(long int)] = (total_packet_len >> 8) & 0xff;
-                padded_data[2 + sizeof(long int) + 1] = (total_packet_len) & 0xff;
-                padded_data[2 + sizeof(long int) + 2] = frame_id;
+                // The generator copies the payload, so one buffer serves every user
+                unsigned char* padded_data = padPayload(i + 1, payload_data, payload_len,
+                        packet_id, total_packet_len, frame_id);
                 //std::cout << "loading " << packet_id << std::endl;
                 ofdmflexframegen_multi_user_update_data(gen, padded_data, payload_len + PADDED_BYTES, i);
 
                 network_packets_transmitted++;
                 total_packets_transmitted++;
             }
+            else if(rc->arq && ps->has_pending_ack(i + 1))
+            {
+                // nothing to send but an acknowledgement
+                unsigned char* padded_data = padPayload(i + 1, NULL, 0, 0, 0, 0);
+                ofdmflexframegen_multi_user_update_data(gen, padded_data, PADDED_BYTES, i);
+                total_packets_transmitted++;
+            }
+            else if(rc->traffic_aware)
+            {
+                // the queue drained since it was checked
+                ofdmflexframegen_multi_user_update_data(gen, tx_frame_payload, 0, i);
+            }
             else
             {
                 dummy_packets_transmitted++;
@@ -1995,7 +2295,15 @@ int RadioHardwareConfig::txOFDMAFrameBurst(
         {
             ofdmflexframegen_multi_user_update_data(gen, tx_frame_payload, 0, i);
         }
-        header_buf[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_CONTROL;
+        if(tx_type == KEEPALIVE)
+        {
+            header_buf[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_KEEPALIVE;
+            keepalive_packets_transmitted++;
+        }
+        else
+        {
+            header_buf[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_CONTROL;
+        }
     }
     header_buf[P2M_HEADER_FIELD_SOURCE_ID] = node_id;
     header_buf[P2M_HEADER_FIELD_DESTINATION_ID] = P2M_DESTINATION_ID_BROADCAST;
@@ -2007,7 +2315,7 @@ int RadioHardwareConfig::txOFDMAFrameBurst(
     tx_md.end_of_burst = false;
     tx_md.time_spec = time_of_burst;
     tx_md.has_time_spec = true;
-    //tx_stream->send("", 0, tx_md);
+    //radio_device->send(NULL, 0, tx_md, 0.1);
 
     unsigned int ctr;
     int last_symbol=0;
@@ -2031,9 +2339,9 @@ int RadioHardwareConfig::txOFDMAFrameBurst(
 
                 if (tx_usrp_sample_counter == tx_uhd_transport_size) {    
                     tx_usrp_sample_counter = 0;
-                    // Could check (size_t)actual_uhd_transport_size = tx_stream->send(...)
-                    tx_stream->send(
-                            &tx_usrp_buffer.front(), tx_uhd_transport_size, tx_md);
+                    // Could check (size_t)actual_uhd_transport_size = radio_device->send(...)
+                    radio_device->send(
+                            &tx_usrp_buffer.front(), tx_uhd_transport_size, tx_md, 0.1);
 
                     // prep metadata for next set of samples
                     tx_md.start_of_burst = false;
@@ -2047,42 +2355,22 @@ int RadioHardwareConfig::txOFDMAFrameBurst(
        tx_md.start_of_burst = false;
        tx_md.has_time_spec = false;
        tx_md.end_of_burst = true;
-       tx_stream->send("", 0, tx_md, 0.0);
+       radio_device->send(NULL, 0, tx_md, 0.0);
      
 
     // Fetching of UHD async messages seems to be required 
     /*tx_uhd_ack_received = false;
-      while ( !tx_uhd_ack_received && tx_stream->recv_async_msg(tx_async_md) ) {
+      while ( !tx_uhd_ack_received && radio_device->recvAsyncMsg(tx_async_md, 0.1) ) {
       tx_uhd_ack_received = (tx_async_md.event_code == uhd::async_metadata_t::EVENT_CODE_BURST_ACK);
       }*/
     frame_was_transmitted = true;
+    last_burst_time = app->getElapsedTime();
     gen_mutex.unlock();
 
     // Prepare RF event log entry 
-    rf_log_report_t rf_log_report;
-    switch (rf_log_level) {
-        case(RF_LOG_LEVEL_NONE) :
-            // no logging
-            break;
-        case(RF_LOG_LEVEL_NORMAL) :
-            rf_log_report.hardware_timestamp_nominal = ext_am_ptr->getElapsedTime();
-            if(tx_type == DATA)
-                rf_log_report.rf_event = RF_LOG_EVENT_TX_OFDMA_DATA;
-            else
-                rf_log_report.rf_event = RF_LOG_EVENT_TX_CONTROL_DATA;
-            rf_log_report.frequency_nominal = getTxAbsoluteFreq();
-            rf_log_report.bandwidth = sample_rate;
-            logRfEvent(rf_log_report);
-            break;
-        case(RF_LOG_LEVEL_DETAIL) :
-            // PLACEHOLDER for development version of logging
-            break;
-        default :
-            cerr << "\nERROR in RadioHardwareConfig::txFrameBurst: ";
-            cerr << "Unknown rf_log_level\n" << endl;
-            exit(EXIT_FAILURE);
-            break;
-    }
+    RHC_LOG_RF_EVENT(this, app->getElapsedTime(),
+            (tx_type == DATA) ? RF_LOG_EVENT_TX_OFDMA_DATA : RF_LOG_EVENT_TX_CONTROL_DATA,
+            getTxAbsoluteFreq());
     while(getHardwareTimestamp() < ofdma_tx_window)
     {
         usleep(100);
@@ -2107,15 +2395,31 @@ int RadioHardwareConfig::txMCFrameBurst(
         usleep(1000000*mc_tx_window);
         return 0;
     }
+    // Traffic-aware mode: with nothing queued for the basestation only a
+    // keep-alive goes out, once every keepalive_interval, to carry the EVM
+    // report
+    if(rc->traffic_aware && tx_type == DATA)
+    {
+        if(getNextPayloadSize(num_nodes_in_net) == 0)
+        {
+            if(skipIdleBurst(mc_tx_window))
+                return(EXIT_SUCCESS);
+            tx_type = KEEPALIVE;
+        }
+    }
+    RHC_ALLOC_REGION(ALLOC_REGION_TX_BURST);
     timer_tic(transmit_timer);
-    // USRP and resampler buffers
-    std::vector<std::complex<float> > tx_usrp_buffer(256);
-
+    // Channelizer output buffer; the USRP buffer is a member
     unsigned int mctx_buffer_len = 2 * (num_nodes_in_net - 1);
     std::complex<float> mctx_buffer[mctx_buffer_len];
     
-    unsigned char* header_buf = new unsigned char[P2M_FRAME_HEADER_DEFAULT_SIZE];
+    unsigned char header_buf[P2M_FRAME_HEADER_DEFAULT_SIZE];
     header_buf[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_DATA;
+    // Set on every frame, dummy and control ones included, since the
+    // basestation takes the EVM report from any valid header
+    header_buf[P2M_HEADER_FIELD_SOURCE_ID] = node_id;
+    header_buf[P2M_HEADER_FIELD_EVM_REPORT] = (link_adaptation != NULL) ?
+        link_adaptation->getEvmReport(app->getElapsedTime()) : LA_EVM_REPORT_NONE;
     if(tx_type == DATA)
     {
         unsigned char* payload_data;
@@ -2129,22 +2433,13 @@ int RadioHardwareConfig::txMCFrameBurst(
 
 
         //grab next frame from packetstore
-        payload_data = ext_ps_ptr->get_next_frame_for_destination(num_nodes_in_net, &packet_id, &frame_id,
+        payload_data = ps->get_next_frame_for_destination(num_nodes_in_net, &packet_id, &frame_id,
                 &payload_len, &total_packet_len);
 
         if(payload_len > 0)
         {
-            unsigned char* padded_data = new unsigned char[payload_len + PADDED_BYTES];
-            memmove(padded_data + PADDED_BYTES, payload_data, payload_len);
-            //Set 2 "keys" so we can check in the callback to see if we received one
-            //of these packets with extra control data in the front of the payload
-            padded_data[0] = 42;
-            padded_data[1] = 37;
-            long int* li_padded_data = (long int*)(padded_data + 2);
-            li_padded_data[0] = packet_id;
-            padded_data[2 + sizeof(long int)] = (total_packet_len >> 8) & 0xff;
-            padded_data[2 + sizeof(long int) + 1] = (total_packet_len) & 0xff;
-            padded_data[2 + sizeof(long int) + 2] = frame_id;
+            unsigned char* padded_data = padPayload(num_nodes_in_net, payload_data, payload_len,
+                    packet_id, total_packet_len, frame_id);
             header_buf[P2M_HEADER_FIELD_SOURCE_ID] = node_id;
             header_buf[P2M_HEADER_FIELD_DESTINATION_ID] = num_nodes_in_net;
             header_buf[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_DATA;
@@ -2152,21 +2447,41 @@ int RadioHardwareConfig::txMCFrameBurst(
             frame_was_transmitted = false;
             network_packets_transmitted++;
             mctx->UpdateData(node_id - 1, header_buf, padded_data, payload_len + PADDED_BYTES, RHC_ms,
-                    RHC_fec0, LIQUID_FEC_RS_M8);
+                    payload_fec0, payload_fec1);
 
         }
+        else if(rc->arq && ps->has_pending_ack(num_nodes_in_net))
+        {
+            // nothing to send but an acknowledgement
+            unsigned char* padded_data = padPayload(num_nodes_in_net, NULL, 0, 0, 0, 0);
+            header_buf[P2M_HEADER_FIELD_DESTINATION_ID] = num_nodes_in_net;
+            mctx->UpdateData(node_id - 1, header_buf, padded_data, PADDED_BYTES, RHC_ms,
+                    payload_fec0, payload_fec1);
+        }
+        else if(rc->traffic_aware)
+        {
+            // the queue drained since it was checked
+            mctx->UpdateData(node_id - 1, header_buf, tx_frame_payload, 0, RHC_ms, payload_fec0,
+                    payload_fec1);
+        }
         else
         {
             dummy_packets_transmitted++;
-            mctx->UpdateData(node_id - 1, header_buf, tx_frame_payload, frame_len, RHC_ms, RHC_fec0,
-                    LIQUID_FEC_RS_M8);
+            mctx->UpdateData(node_id - 1, header_buf, tx_frame_payload, frame_len, RHC_ms, payload_fec0,
+                    payload_fec1);
 
         }
     }
     else if(tx_type == CONTROL)
     {
         header_buf[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_CONTROL;
-        mctx->UpdateData(node_id - 1, header_buf, tx_frame_payload, 0, RHC_ms, RHC_fec0, LIQUID_FEC_RS_M8);
+        mctx->UpdateData(node_id - 1, header_buf, tx_frame_payload, 0, RHC_ms, payload_fec0, payload_fec1);
+    }
+    else if(tx_type == KEEPALIVE)
+    {
+        header_buf[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_KEEPALIVE;
+        keepalive_packets_transmitted++;
+        mctx->UpdateData(node_id - 1, header_buf, tx_frame_payload, 0, RHC_ms, payload_fec0, payload_fec1);
     }
     //while(getHardwareTimestamp() > 0.0005 && getHardwareTimestamp() < 2.0)
    // {
@@ -2191,19 +2506,12 @@ int RadioHardwareConfig::txMCFrameBurst(
             tx_usrp_buffer[usrp_sample_counter++] = 0.1f * mctx_buffer[i];
 
             // once USRP buffer is full, reset counter and send to device
-            if (usrp_sample_counter==256) {
+            if (usrp_sample_counter==RHC_MC_TX_SEND_SIZE) {
                 // reset counter
                 usrp_sample_counter=0;
 
                 // send the result to the USRP
-                /*
-                usrp->get_device()->send(
-                        &tx_usrp_buffer.front(), tx_usrp_buffer.size(), tx_md,
-                        uhd::io_type_t::COMPLEX_FLOAT32,
-                        uhd::device::SEND_MODE_FULL_BUFF
-                        );
-                */
-                tx_stream->send(&tx_usrp_buffer.front(), tx_usrp_buffer.size(), tx_md);
+                radio_device->send(&tx_usrp_buffer.front(), RHC_MC_TX_SEND_SIZE, tx_md, 0.1);
                 tx_md.start_of_burst = false;
                 tx_md.has_time_spec = false;
             }
@@ -2213,40 +2521,20 @@ int RadioHardwareConfig::txMCFrameBurst(
     tx_md.start_of_burst = false;
     tx_md.has_time_spec = false;
     tx_md.end_of_burst = true;
-    tx_stream->send("", 0, tx_md, 0.0);
+    radio_device->send(NULL, 0, tx_md, 0.0);
     /*
     // Fetching of UHD async messages seems to be required 
     tx_uhd_ack_received = false;
-    while ( !tx_uhd_ack_received && tx_stream->recv_async_msg(tx_async_md) ) {
+    while ( !tx_uhd_ack_received && radio_device->recvAsyncMsg(tx_async_md, 0.1) ) {
     tx_uhd_ack_received = (tx_async_md.event_code == uhd::async_metadata_t::EVENT_CODE_BURST_ACK);
     }*/
     frame_was_transmitted = true;    
+    last_burst_time = app->getElapsedTime();
     total_packets_transmitted++;
     // Prepare RF event log entry 
-    rf_log_report_t rf_log_report;
-    switch (rf_log_level) {
-        case(RF_LOG_LEVEL_NONE) :
-            // no logging
-            break;
-        case(RF_LOG_LEVEL_NORMAL) :
-            rf_log_report.hardware_timestamp_nominal = ext_am_ptr->getElapsedTime();
-            if(tx_type == DATA)
-                rf_log_report.rf_event = RF_LOG_EVENT_TX_MC_DATA;
-            else
-                rf_log_report.rf_event = RF_LOG_EVENT_TX_CONTROL_DATA;
-            rf_log_report.frequency_nominal = getTxAbsoluteFreq();
-            rf_log_report.bandwidth = sample_rate;
-            logRfEvent(rf_log_report);
-            break;
-        case(RF_LOG_LEVEL_DETAIL) :
-            // PLACEHOLDER for development version of logging
-            break;
-        default :
-            cerr << "\nERROR in RadioHardwareConfig::txFrameBurst: ";
-            cerr << "Unknown rf_log_level\n" << endl;
-            exit(EXIT_FAILURE);
-            break;
-    }
+    RHC_LOG_RF_EVENT(this, app->getElapsedTime(),
+            (tx_type == DATA) ? RF_LOG_EVENT_TX_MC_DATA : RF_LOG_EVENT_TX_CONTROL_DATA,
+            getTxAbsoluteFreq());
     while(getHardwareTimestamp() < mc_tx_window)
     {
         usleep(100);
@@ -2271,7 +2559,7 @@ int RadioHardwareConfig::txOFDMAAllocBurst(
     unsigned int tx_usrp_sample_counter = 0;
     std::complex<float> tx_frame_resample_buf[(int)(2*tx_resamp_rate) + 64];
     std::complex<float> ofdm_symbol[RHC_OFDMA_SYMBOL_LENGTH];
-    unsigned char* header_buf = new unsigned char[P2M_FRAME_HEADER_DEFAULT_SIZE];
+    unsigned char header_buf[P2M_FRAME_HEADER_DEFAULT_SIZE];
     header_buf[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_NEW_ALLOC;
     ofdmflexframegen gen;
     if(allocation == INNER_ALLOCATION)
@@ -2282,8 +2570,17 @@ int RadioHardwareConfig::txOFDMAAllocBurst(
         gen = ofdma_fg_default;
     // Prepare frame for modulation
     frame_was_transmitted = false;
+    if(!sched_blocks.empty())
+    {
+        std::fill(sched_blocks.begin(), sched_blocks.end(), 0);
+        ofdmflexframegen_set_user_shares(gen, &sched_blocks.front());
+    }
     for(unsigned int i = 0; i < num_nodes_in_net - 1; i++)
     {
+        // Every mobile must decode the new allocation, so send it with the
+        // frame-wide schemes rather than the user's adapted ones
+        if(link_adaptation != NULL)
+            ofdmflexframegen_set_user_props(gen, i, NULL);
         ofdmflexframegen_multi_user_update_data(gen, new_alloc, RHC_OFDMA_M, i);
     }
     header_buf[P2M_HEADER_FIELD_DESTINATION_ID] = P2M_DESTINATION_ID_BROADCAST;
@@ -2317,9 +2614,9 @@ int RadioHardwareConfig::txOFDMAAllocBurst(
 
                 if (tx_usrp_sample_counter == tx_uhd_transport_size) {    
                     tx_usrp_sample_counter = 0;
-                    // Could check (size_t)actual_uhd_transport_size = tx_stream->send(...)
-                    tx_stream->send(
-                            &tx_usrp_buffer.front(), tx_uhd_transport_size, tx_md);
+                    // Could check (size_t)actual_uhd_transport_size = radio_device->send(...)
+                    radio_device->send(
+                            &tx_usrp_buffer.front(), tx_uhd_transport_size, tx_md, 0.1);
 
                     // prep metadata for next set of samples
                     tx_md.start_of_burst = false;
@@ -2333,39 +2630,21 @@ int RadioHardwareConfig::txOFDMAAllocBurst(
        tx_md.start_of_burst = false;
        tx_md.has_time_spec = false;
        tx_md.end_of_burst = true;
-       tx_stream->send(&tx_usrp_buffer.front(), 0, tx_md);
+       radio_device->send(&tx_usrp_buffer.front(), 0, tx_md, 0.1);
      */
 
     // Fetching of UHD async messages seems to be required 
     /*tx_uhd_ack_received = false;
-      while ( !tx_uhd_ack_received && tx_stream->recv_async_msg(tx_async_md) ) {
+      while ( !tx_uhd_ack_received && radio_device->recvAsyncMsg(tx_async_md, 0.1) ) {
       tx_uhd_ack_received = (tx_async_md.event_code == uhd::async_metadata_t::EVENT_CODE_BURST_ACK);
       }*/
     frame_was_transmitted = true;
 
 
     // Prepare RF event log entry 
-    rf_log_report_t rf_log_report;
-    switch (rf_log_level) {
-        case(RF_LOG_LEVEL_NONE) :
-            // no logging
-            break;
-        case(RF_LOG_LEVEL_NORMAL) :
-            rf_log_report.hardware_timestamp_nominal = ext_am_ptr->getElapsedTime();
-            rf_log_report.rf_event = RF_LOG_EVENT_TX_CONTROL_DATA;
-            rf_log_report.frequency_nominal = getTxAbsoluteFreq();
-            rf_log_report.bandwidth = sample_rate;
-            logRfEvent(rf_log_report);
-            break;
-        case(RF_LOG_LEVEL_DETAIL) :
-            // PLACEHOLDER for development version of logging
-            break;
-        default :
-            cerr << "\nERROR in RadioHardwareConfig::txFrameBurst: ";
-            cerr << "Unknown rf_log_level\n" << endl;
-            exit(EXIT_FAILURE);
-            break;
-    }
+    RHC_LOG_RF_EVENT(this, app->getElapsedTime(),
+            RF_LOG_EVENT_TX_CONTROL_DATA,
+            getTxAbsoluteFreq());
     return(EXIT_SUCCESS);
 }
 //////////////////////////////////////////////////////////////////////////
@@ -2379,14 +2658,15 @@ int RadioHardwareConfig::txMCAllocBurst(
     if(time_to_sleep > 0)
         usleep(time_to_sleep*1000000);
 
+    // A new allocation switches the generator's FEC, so this burst may
+    // re-create its packetizer
+    RHC_ALLOC_REGION(ALLOC_REGION_RECONFIGURE);
     timer_tic(transmit_timer);
-    // USRP and resampler buffers
-    std::vector<std::complex<float> > tx_usrp_buffer(256);
-
+    // Channelizer output buffer; the USRP buffer is a member
     unsigned int mctx_buffer_len = 2 * (num_nodes_in_net - 1);
     std::complex<float> mctx_buffer[mctx_buffer_len];
     
-    unsigned char* header_buf = new unsigned char[P2M_FRAME_HEADER_DEFAULT_SIZE];
+    unsigned char header_buf[P2M_FRAME_HEADER_DEFAULT_SIZE];
     header_buf[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_NEW_ALLOC;
     mctx->UpdateData(node_id - 1, header_buf, new_alloc, RHC_OFDMA_M, RHC_ms, RHC_fec0, RHC_fec1);
 
@@ -2406,16 +2686,12 @@ int RadioHardwareConfig::txMCAllocBurst(
             tx_usrp_buffer[usrp_sample_counter++] = 0.1f * mctx_buffer[i];
 
             // once USRP buffer is full, reset counter and send to device
-            if (usrp_sample_counter==256) {
+            if (usrp_sample_counter==RHC_MC_TX_SEND_SIZE) {
                 // reset counter
                 usrp_sample_counter=0;
 
                 // send the result to the USRP
-                usrp->get_device()->send(
-                        &tx_usrp_buffer.front(), tx_usrp_buffer.size(), tx_md,
-                        uhd::io_type_t::COMPLEX_FLOAT32,
-                        uhd::device::SEND_MODE_FULL_BUFF
-                        );
+                radio_device->send(&tx_usrp_buffer.front(), RHC_MC_TX_SEND_SIZE, tx_md, 0.1);
             }
         }
     }
@@ -2423,37 +2699,19 @@ int RadioHardwareConfig::txMCAllocBurst(
     /* tx_md.start_of_burst = false;
        tx_md.has_time_spec = false;
        tx_md.end_of_burst = true;
-       tx_stream->send(&tx_usrp_buffer.front(), 0, tx_md);
+       radio_device->send(&tx_usrp_buffer.front(), 0, tx_md, 0.1);
 
     // Fetching of UHD async messages seems to be required 
     tx_uhd_ack_received = false;
-    while ( !tx_uhd_ack_received && tx_stream->recv_async_msg(tx_async_md) ) {
+    while ( !tx_uhd_ack_received && radio_device->recvAsyncMsg(tx_async_md, 0.1) ) {
     tx_uhd_ack_received = (tx_async_md.event_code == uhd::async_metadata_t::EVENT_CODE_BURST_ACK);
     }*/
     frame_was_transmitted = true;    
     total_packets_transmitted++;
     // Prepare RF event log entry 
-    rf_log_report_t rf_log_report;
-    switch (rf_log_level) {
-        case(RF_LOG_LEVEL_NONE) :
-            // no logging
-            break;
-        case(RF_LOG_LEVEL_NORMAL) :
-            rf_log_report.hardware_timestamp_nominal = ext_am_ptr->getElapsedTime();
-            rf_log_report.rf_event = RF_LOG_EVENT_TX_CONTROL_DATA;
-            rf_log_report.frequency_nominal = getTxAbsoluteFreq();
-            rf_log_report.bandwidth = sample_rate;
-            logRfEvent(rf_log_report);
-            break;
-        case(RF_LOG_LEVEL_DETAIL) :
-            // PLACEHOLDER for development version of logging
-            break;
-        default :
-            cerr << "\nERROR in RadioHardwareConfig::txFrameBurst: ";
-            cerr << "Unknown rf_log_level\n" << endl;
-            exit(EXIT_FAILURE);
-            break;
-    }
+    RHC_LOG_RF_EVENT(this, app->getElapsedTime(),
+            RF_LOG_EVENT_TX_CONTROL_DATA,
+            getTxAbsoluteFreq());
     return(EXIT_SUCCESS);
 }
 //////////////////////////////////////////////////////////////////////////
@@ -2493,17 +2751,17 @@ int RadioHardwareConfig::txNoiseBurst(
     }
 
     // Send in a single burst
-    tx_stream->send(&tx_usrp_buffer.front(), tx_nw, tx_md, tx_timeout);
+    radio_device->send(&tx_usrp_buffer.front(), tx_nw, tx_md, tx_timeout);
 
     // End burst
     tx_md.start_of_burst = false;
     tx_md.has_time_spec = false;
     tx_md.end_of_burst = true;
-    tx_stream->send(&tx_usrp_buffer.front(), 0, tx_md, tx_timeout);
+    radio_device->send(&tx_usrp_buffer.front(), 0, tx_md, tx_timeout);
 
     // Fetching of UHD async messages seems to be required 
     tx_uhd_ack_received = false;
-    while ( !tx_uhd_ack_received && tx_stream->recv_async_msg(tx_async_md, tx_timeout) ) {
+    while ( !tx_uhd_ack_received && radio_device->recvAsyncMsg(tx_async_md, tx_timeout) ) {
         tx_uhd_ack_received = (tx_async_md.event_code == uhd::async_metadata_t::EVENT_CODE_BURST_ACK);
     }
 
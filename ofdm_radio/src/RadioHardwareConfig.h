@@ -13,14 +13,15 @@
 #include <cstdlib>
 #include <string>
 #include <sstream>
+#include <iomanip>
 #include <mutex>
+#include <vector>
 
 #include <time.h>
 #include <unistd.h>
 #include <math.h>
 
 // Ettus UHD header
-#include <uhd/usrp/multi_usrp.hpp>
 #include <uhd/utils/msg.hpp>
 
 // Liquid-dsp, usrp lib headers
@@ -34,6 +35,12 @@
 #include "timer.h"
 #include "StructDefs.h"
 #include "RadioConfig.hh"
+#include "EvmTelemetry.h"
+#include "LinkAdaptation.h"
+#include "DownlinkScheduler.h"
+#include "StartupProfiler.h"
+#include "RadioDevice.h"
+#include "AllocTracker.h"
 // USRP hardware-specific constants
 // Not clear at this point if USRP X-Series better or worse than N210
 #define RHC_USRP_N210_TX2RX_SEPARATION              100.0E6
@@ -47,9 +54,21 @@
 #define RHC_USRP_N210_FH_WINDOW_MEDIUM              20.0E6
 #define RHC_USRP_X300_FH_WINDOW_MEDIUM              20.0E6
 
+// The software loopback radio mimics an N210 so schedules are unchanged
+#define RHC_LOOPBACK_RETUNE_DELAY                   RHC_USRP_N210_RETUNE_DELAY
+#define RHC_LOOPBACK_FH_WINDOW_MEDIUM               RHC_USRP_N210_FH_WINDOW_MEDIUM
+
 // Resampler ratio applies to both rx (decimate ratio) and to
 // transmit (interpolate ratio)
 #define RHC_NOMINAL_RESAMPLER_RATIO                 2
+// Receive front end: one polyphase stage filters and decimates from the
+// USRP rate to the modem rate when their ratio is P/Q with Q no larger
+// than RHC_RX_RESAMP_MAX_FACTOR; its cutoff (fraction of the modem
+// Nyquist rate) matches the old 0.24 prefilter at the nominal ratio
+#define RHC_RX_RESAMP_MAX_FACTOR                    32
+#define RHC_RX_RESAMP_SEMI_LENGTH                   12
+#define RHC_RX_RESAMP_BANDWIDTH                     0.96f
+#define RHC_RX_RESAMP_STOPBAND_ATTEN                60.0f
 #define RHC_RX_RECOMMENDED_SAMPLE_SIZE_DEFAULT      8786
 #define RHC_TX_UHD_TRANSPORT_SIZE                   300
 #define RHC_TX_BURST_LENGTH                         8100
@@ -75,14 +94,24 @@
 #define RHC_CALIBRATE_RX_NOISE_RATIO                2.0
 #define RHC_CALIBRATE_RX_NOISE_THRESHOLD_DEFAULT    1.0E-2
 
-#define PADDED_BYTES				                13
+// Control bytes in front of every OFDMA and multichannel payload: keys 42
+// and 37, packet id, total packet length, frame id, then the ARQ
+// acknowledgement of one packet received from the peer (its id and a
+// bitmap of its frames, 0 when there is nothing to acknowledge)
+#define PADDED_BYTES				                25
+#define PADDED_ACK_PACKET_ID                        13
+#define PADDED_ACK_BITMAP                           (PADDED_ACK_PACKET_ID + sizeof(long int))
+// Samples per send() in the multichannel tx bursts
+#define RHC_MC_TX_SEND_SIZE                         256
 #define RHC_THROUGHPUT_THRESHOLD		            25
 
 //Types of USRP hardware supported by this application
 enum UsrpHardwareType{
     USRP_MODEL_N210,
     USRP_MODEL_X300_PCIE,
-    USRP_MODEL_X300_GBE
+    USRP_MODEL_X300_GBE,
+    RADIO_MODEL_LOOPBACK,
+    RADIO_MODEL_REPLAY
 };
 
 // Types of reference clock available for the USRP hardware 
@@ -125,7 +154,8 @@ enum SubcarrierAllocation {
 
 enum OFDMATransmissionType {
     DATA        = 201,
-    CONTROL     = 202
+    CONTROL     = 202,
+    KEEPALIVE   = 203
 };
 
 typedef struct {
@@ -136,6 +166,59 @@ typedef struct {
     double               bandwidth;
 } rf_log_report_t;
 
+// Compile-time ceilings for the per-frame logging.  Call sites above the
+// ceiling reduce to a constant-false branch that the compiler removes, so a
+// production build (see LOG_DEFS in the Makefile) pays neither formatting
+// nor branch cost in the rx/tx callbacks.  Below the ceiling the runtime
+// level still applies and arguments are only evaluated once it passes.
+#ifndef RHC_RF_LOG_LEVEL_MAX
+#define RHC_RF_LOG_LEVEL_MAX                        RF_LOG_LEVEL_NORMAL
+#endif
+#ifndef RHC_DEBUG_LOG_ENABLED
+#define RHC_DEBUG_LOG_ENABLED                       1
+#endif
+#ifndef RHC_PACKET_LOG_ENABLED
+#define RHC_PACKET_LOG_ENABLED                      1
+#endif
+#ifndef RHC_RXF_LOG_ENABLED
+#define RHC_RXF_LOG_ENABLED                         1
+#endif
+
+// RF_LOG_LEVEL_NORMAL event report; _rhc is a RadioHardwareConfig pointer
+#define RHC_LOG_RF_EVENT(_rhc, _timestamp, _event, _frequency)              \
+    do {                                                                    \
+        if ((RF_LOG_LEVEL_NORMAL <= RHC_RF_LOG_LEVEL_MAX) &&                \
+                ((_rhc)->rf_log_level == RF_LOG_LEVEL_NORMAL)) {            \
+            rf_log_report_t rf_log_report;                                  \
+            rf_log_report.hardware_timestamp_nominal = (_timestamp);        \
+            rf_log_report.rf_event = (_event);                              \
+            rf_log_report.frequency_nominal = (_frequency);                 \
+            rf_log_report.bandwidth = (_rhc)->sample_rate;                  \
+            (_rhc)->logRfEvent(rf_log_report);                              \
+        }                                                                   \
+    } while (0)
+
+// Console output enabled by the --debug option
+#define RHC_DEBUG_PRINTF(...)                                               \
+    do {                                                                    \
+        if (RHC_DEBUG_LOG_ENABLED && ext_debug)                             \
+            printf(__VA_ARGS__);                                            \
+    } while (0)
+
+// One line of the packet log; _details is a stream expression appended
+// after the rssi/evm fields of _stats
+#define RHC_LOG_PACKET(_rhc, _stats, _details)                              \
+    do {                                                                    \
+        if (RHC_PACKET_LOG_ENABLED && ((_rhc)->packet_log_ptr != NULL)) {   \
+            std::stringstream report;                                       \
+            report << "***** rssi:" << std::setw(10) << (_stats).rssi       \
+                << "db evm:" << std::setw(10) << (_stats).evm << "db, "     \
+                << _details;                                                \
+            (_rhc)->packet_log_ptr->log(report.str());                      \
+            (_rhc)->packet_log_ptr->write_log();                            \
+        }                                                                   \
+    } while (0)
+
 
 // Structure for capturing received frame and its metadata 
 typedef struct {
@@ -244,7 +327,7 @@ public:
         bool debug, bool u4, bool using_tun_tap,
         PacketStore* ps, AppManager* app,
 	timer_s* rx_timer, bool slow, float ofdma_tx_window, float mc_tx_window, bool anti_jam,
-        RadioConfig* rc
+        RadioConfig* rc, StartupProfiler* startup_profiler
     );
     ~RadioHardwareConfig();  
     
@@ -275,6 +358,13 @@ public:
         double dsp_freq
         );
     int tune2NormalFreq();
+    void rxFrontEndReset();
+    void rxFrontEndExecute(
+        std::complex<float>* usrp_samples,
+        unsigned int num_usrp_samples,
+        std::complex<float>* modem_samples,
+        unsigned int* num_modem_samples
+        );
     int rxFrameBurst(
         double rx_start_time,
         size_t rx_total_requested_samples
@@ -339,6 +429,21 @@ public:
   
     void switch_allocation();
     void recreate_modem(); 
+    void setUserModes(ofdmflexframegen gen);
+    bool scheduleUsers(ofdmflexframegen gen);
+    bool shareAmongQueuedUsers(ofdmflexframegen gen);
+    bool skipIdleBurst(double tx_window);
+    unsigned int getNextPayloadSize(unsigned int dest_id);
+    unsigned char* padPayload(
+        unsigned int dest_id,
+        unsigned char* payload_data,
+        unsigned int payload_len,
+        long int packet_id,
+        unsigned int total_packet_len,
+        unsigned int frame_id
+    );
+    void readArqAck(unsigned int source_id, unsigned char* padded_data);
+    ofdmflexframesync getActiveOfdmaSync();
     // Working copy of constructor parameters
     double normal_freq;
     double rf_gain_rx;
@@ -358,6 +463,10 @@ public:
     UhdErrorLogLevelType uhd_error_log_level;
     Logger* uhd_error_log_ptr;
     Logger* alloc_log_ptr;
+    Logger* packet_log_ptr;
+    PacketStore* ps;
+    AppManager* app;
+    bool using_tun_tap;
     bool debug;
     bool u4;
     timer_s* rx_timer;
@@ -395,13 +504,16 @@ public:
     uhd::tune_request_t rx_tune_req;
     double usrp_rx_rate;
     double rx_resamp_rate;
+    // Exactly one of these is created: rx_rresamp when the rate ratio is
+    // a small rational, otherwise the arbitrary rx_resamp
+    rresamp_crcf rx_rresamp;
     msresamp_crcf rx_resamp;
-    uhd::rx_streamer::sptr rx_stream;
     uhd::rx_metadata_t rx_md;
     std::mutex sync_mutex;
     std::mutex gen_mutex;
     // General USRP variables
-    uhd::usrp::multi_usrp::sptr usrp;
+    // UHD or loopback front end, selected by radio_hardware
+    RadioDevice* radio_device;
     unsigned int uhd_transport_size;
     double tx2rx_freq_separation;
     double fh_window_small;
@@ -415,6 +527,11 @@ public:
     unsigned char new_alloc[RHC_OFDMA_M];
 
     bool hardened;
+    // Payload codes used when FEC is on; with soft decoding the
+    // convolutional code is applied last so it sits next to the channel
+    bool soft_decoding;
+    int payload_fec0;
+    int payload_fec1;
 
     RadioConfig* rc; 
     //Stats
@@ -429,11 +546,27 @@ public:
     unsigned int network_packets_received;
     unsigned int dummy_packets_transmitted;
     unsigned int dummy_packets_received; 
+    // Traffic-aware mode: keep-alive frames sent and received, bursts left
+    // out for lack of traffic, and valid headers that carried no payload
+    // for this node (keep-alives and unscheduled slots)
+    unsigned int keepalive_packets_transmitted;
+    unsigned int keepalive_packets_received;
+    unsigned int idle_bursts_skipped;
+    unsigned int idle_frames_received;
+    double last_burst_time;
     unsigned int high_evm_counts[RHC_OFDMA_M];
+    // Per-subcarrier EVM of received OFDMA frames (mobiles only, else NULL)
+    EvmTelemetry* evm_telemetry;
+    // Adaptive modulation and coding of the OFDMA downlink (NULL unless amc)
+    LinkAdaptation* link_adaptation;
+    // Downlink subcarrier scheduling (basestation with scheduler, else NULL)
+    DownlinkScheduler* downlink_scheduler;
+    std::vector<unsigned int> sched_payload_bytes;
+    std::vector<unsigned int> sched_payload_symbols;
+    std::vector<unsigned int> sched_blocks;
     SubcarrierAllocation allocation;
 
     // Receive side modem variables/objects
-    firfilt_crcf rx_prefilt;
     //For receiving heartbeats/snapshots at either basestation or mobile
     ofdmflexframesync fs;
     //For receiving ofdma data at mobiles
@@ -467,7 +600,6 @@ private:
     double usrp_tx_rate;
     double tx_resamp_rate;
     msresamp_crcf tx_resamp;
-    uhd::tx_streamer::sptr tx_stream;
     uhd::async_metadata_t tx_async_md;
     bool tx_uhd_ack_received; 
     uhd::tx_metadata_t  tx_md;
@@ -484,6 +616,10 @@ private:
     bool frame_was_transmitted;
     unsigned char tx_frame_header[RHC_FRAME_HEADER_MAX_SIZE];
     unsigned char tx_frame_payload[RHC_FRAME_PAYLOAD_MAX_SIZE];
+    // Reused by every data burst so the steady-state tx path does not
+    // allocate; the padded payload grows to the largest frame seen
+    std::vector<std::complex<float> > tx_usrp_buffer;
+    std::vector<unsigned char> tx_padded_payload;
 };
 
 
@@ -903,7 +903,7 @@ void* run_mc_rx(void* thread_args)
     rx_thread_args_t* args;
     args = (rx_thread_args_t*)thread_args;
     RadioHardwareConfig* rhc_ptr = args->rhc_ptr;
-    const size_t max_samps_per_packet = rhc_ptr->usrp->get_device()->get_max_recv_samps_per_packet();
+    const size_t max_samps_per_packet = rhc_ptr->radio_device->getMaxRecvSamps();
     std::vector<std::complex<float> > rx_usrp_buffer(max_samps_per_packet);
 
     uhd_error_stats_t uhd_error_stats;
@@ -911,19 +911,18 @@ void* run_mc_rx(void* thread_args)
     unsigned int rx_uhd_recv_ctr = 0;
     uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
     stream_cmd.stream_now = true;
-    rhc_ptr->usrp->issue_stream_cmd(stream_cmd);
+    rhc_ptr->radio_device->issueStreamCmd(stream_cmd);
     int continue_running = 1;
     timer t0 = timer_create();
     timer_tic(t0);
     double num_seconds = args->run_time;
     while (continue_running) 
     {
+        RHC_ALLOC_REGION(ALLOC_REGION_RX_LOOP);
         // grab data from device
-        size_t uhd_num_delivered_samples = rhc_ptr->usrp->get_device()->recv(
+        size_t uhd_num_delivered_samples = rhc_ptr->radio_device->recv(
                 &rx_usrp_buffer.front(), rx_usrp_buffer.size(), rx_md,
-                uhd::io_type_t::COMPLEX_FLOAT32,
-                uhd::device::RECV_MODE_ONE_PACKET
-                );
+                0.1, true);
         //std::cout << "grabbed " << uhd_num_delivered_samples << " samples" << std::endl;
 
         // Check for UHD errors
@@ -983,7 +982,8 @@ void* run_mc_rx(void* thread_args)
             }
 
         }
-        if((num_seconds > 0 && timer_toc(t0) >= num_seconds) || rhc_ptr->join_rx_thread)
+        if((num_seconds > 0 && timer_toc(t0) >= num_seconds) || rhc_ptr->join_rx_thread ||
+                rhc_ptr->radio_device->isEndOfStream())
         {
             continue_running = 0;
         }
@@ -1000,30 +1000,33 @@ void* run_ofdma_rx(void* thread_args)
     ofdmflexframesync sync;
     ofdmflexframesync_reset(rhc_ptr->ofdma_fs_inner);
     ofdmflexframesync_reset(rhc_ptr->ofdma_fs_outer);
-    msresamp_crcf_reset(rhc_ptr->rx_resamp);
-    firfilt_crcf_reset(rhc_ptr->rx_prefilt);
+    rhc_ptr->rxFrontEndReset();
     //ofdmflexframesync_print(sync);
-    const size_t max_samps_per_packet = rhc_ptr->usrp->get_device()->get_max_recv_samps_per_packet();
+    const size_t max_samps_per_packet = rhc_ptr->radio_device->getMaxRecvSamps();
     std::vector<std::complex<float> > rx_usrp_buffer(20*max_samps_per_packet);
-    std::complex<float> rx_temp_resample_buf[(int)(2.0f/rhc_ptr->rx_resamp_rate) + 64];
+    std::vector<std::complex<float> > rx_temp_resample_buf(
+            (size_t)(rx_usrp_buffer.size() * rhc_ptr->rx_resamp_rate) + 64);
 
     uhd_error_stats_t uhd_error_stats;
     uhd::rx_metadata_t rx_md;
     unsigned int rx_uhd_recv_ctr = 0;
-    rhc_ptr->usrp->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    stream_cmd.stream_now = true;
+    rhc_ptr->radio_device->issueStreamCmd(stream_cmd);
     int continue_running = 1;
     timer t0 = timer_create();
     timer_tic(t0);
     double num_seconds = args->run_time;
     while (continue_running)
     {
+        RHC_ALLOC_REGION(ALLOC_REGION_RX_LOOP);
         // grab data from device
-        size_t uhd_num_delivered_samples = rhc_ptr->usrp->get_device()->recv(
+        size_t uhd_num_delivered_samples = rhc_ptr->radio_device->recv(
                     &rx_usrp_buffer.front(),
                     rx_usrp_buffer.size(),
                     rx_md,
-                    uhd::io_type_t::COMPLEX_FLOAT32,
-                    uhd::device::RECV_MODE_FULL_BUFF
+                    0.1,
+                    false
                     );
 
         // Check for UHD errors
@@ -1050,28 +1053,18 @@ void* run_ofdma_rx(void* thread_args)
             rhc_ptr->sync_mutex.lock();
             if(uhd_num_delivered_samples > 0)
             {
-                if(rhc_ptr->allocation == INNER_ALLOCATION)
-                    sync = rhc_ptr->ofdma_fs_inner;
-                else if(rhc_ptr->allocation == OUTER_ALLOCATION)
-                    sync = rhc_ptr->ofdma_fs_outer;
-                else 
-                    sync = rhc_ptr->ofdma_fs_default;
-                for(unsigned int j = 0; j < uhd_num_delivered_samples; j++)
-                {
-                    // Prefilter samples; this may be optional in a lab environment
-                    std::complex<float> usrp_sample = rx_usrp_buffer[j];
-                    firfilt_crcf_push(rhc_ptr->rx_prefilt, usrp_sample);
-                    firfilt_crcf_execute(rhc_ptr->rx_prefilt, &usrp_sample);
-
-                    unsigned int nw;
-                    msresamp_crcf_execute(rhc_ptr->rx_resamp, &usrp_sample, 1,
-                            rx_temp_resample_buf, &nw);
-                    ofdmflexframesync_execute(sync, rx_temp_resample_buf, nw);
-                }
+                sync = rhc_ptr->getActiveOfdmaSync();
+                // Filter and decimate the whole block, then run the modem
+                unsigned int nw;
+                rhc_ptr->rxFrontEndExecute(&rx_usrp_buffer[0],
+                        (unsigned int)uhd_num_delivered_samples,
+                        &rx_temp_resample_buf[0], &nw);
+                ofdmflexframesync_execute(sync, &rx_temp_resample_buf[0], nw);
 
             }
             rhc_ptr->sync_mutex.unlock();
-            if((num_seconds > 0 && timer_toc(t0) >= num_seconds) || rhc_ptr->join_rx_thread)
+            if((num_seconds > 0 && timer_toc(t0) >= num_seconds) || rhc_ptr->join_rx_thread ||
+                    rhc_ptr->radio_device->isEndOfStream())
             {
                 continue_running = 0;
             }
@@ -0,0 +1,233 @@
+/* RecordingRadioDevice.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include "RecordingRadioDevice.h"
+
+RecordingRadioDevice::RecordingRadioDevice(
+        RadioDevice* device,
+        std::string file_name,
+        IqSampleFormat format
+        )
+{
+    this->device = device;
+    writer = new IqCaptureWriter(file_name, format);
+    rx_freq = 0.0;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+RecordingRadioDevice::~RecordingRadioDevice()
+{
+    delete writer;
+    delete device;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setRxAntenna(const std::string& antenna)
+{
+    device->setRxAntenna(antenna);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setRxGain(double gain)
+{
+    device->setRxGain(gain);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setRxRate(double rate)
+{
+    device->setRxRate(rate);
+    writer->setSampleRate(device->getRxRate());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double RecordingRadioDevice::getRxRate()
+{
+    return(device->getRxRate());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setRxFreq(const uhd::tune_request_t& tune_req)
+{
+    device->setRxFreq(tune_req);
+    rx_freq = device->getRxFreq();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double RecordingRadioDevice::getRxFreq()
+{
+    return(device->getRxFreq());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool RecordingRadioDevice::isRxLoLocked()
+{
+    return(device->isRxLoLocked());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::initRxStream()
+{
+    device->initRxStream();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t RecordingRadioDevice::getMaxRecvSamps()
+{
+    return(device->getMaxRecvSamps());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::issueStreamCmd(const uhd::stream_cmd_t& stream_cmd)
+{
+    device->issueStreamCmd(stream_cmd);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t RecordingRadioDevice::recv(
+        std::complex<float>* buffer,
+        size_t num_samps,
+        uhd::rx_metadata_t& md,
+        double timeout,
+        bool one_packet
+        )
+{
+    size_t n = device->recv(buffer, num_samps, md, timeout, one_packet);
+    writer->write(buffer, n, md, rx_freq);
+    return(n);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool RecordingRadioDevice::isEndOfStream()
+{
+    return(device->isEndOfStream());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setTxAntenna(const std::string& antenna)
+{
+    device->setTxAntenna(antenna);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setTxGain(double gain)
+{
+    device->setTxGain(gain);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setTxRate(double rate)
+{
+    device->setTxRate(rate);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double RecordingRadioDevice::getTxRate()
+{
+    return(device->getTxRate());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setTxFreq(const uhd::tune_request_t& tune_req)
+{
+    device->setTxFreq(tune_req);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool RecordingRadioDevice::isTxLoLocked()
+{
+    return(device->isTxLoLocked());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::initTxStream()
+{
+    device->initTxStream();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t RecordingRadioDevice::getMaxSendSamps()
+{
+    return(device->getMaxSendSamps());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t RecordingRadioDevice::send(
+        const std::complex<float>* buffer,
+        size_t num_samps,
+        const uhd::tx_metadata_t& md,
+        double timeout
+        )
+{
+    return(device->send(buffer, num_samps, md, timeout));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool RecordingRadioDevice::recvAsyncMsg(
+        uhd::async_metadata_t& md,
+        double timeout
+        )
+{
+    return(device->recvAsyncMsg(md, timeout));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setTimeSource(const std::string& source)
+{
+    device->setTimeSource(source);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setTimeUnknownPps(const uhd::time_spec_t& time)
+{
+    device->setTimeUnknownPps(time);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void RecordingRadioDevice::setTimeNow(const uhd::time_spec_t& time)
+{
+    device->setTimeNow(time);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+uhd::time_spec_t RecordingRadioDevice::getTimeNow()
+{
+    return(device->getTimeNow());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool RecordingRadioDevice::isRefLocked()
+{
+    return(device->isRefLocked());
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,77 @@
+/* RecordingRadioDevice.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef RECORDINGRADIODEVICE_H_
+#define RECORDINGRADIODEVICE_H_
+
+#include "RadioDevice.h"
+#include "IqCapture.h"
+
+// Wraps another RadioDevice and writes everything its receiver delivers --
+// samples, timestamps, tuned frequency and overflows -- to an IQ capture
+// that ReplayRadioDevice can play back.  Takes ownership of the device.
+class RecordingRadioDevice : public RadioDevice
+{
+public:
+    RecordingRadioDevice(
+        RadioDevice* device,
+        std::string file_name,
+        IqSampleFormat format
+    );
+    ~RecordingRadioDevice();
+
+    void setRxAntenna(const std::string& antenna);
+    void setRxGain(double gain);
+    void setRxRate(double rate);
+    double getRxRate();
+    void setRxFreq(const uhd::tune_request_t& tune_req);
+    double getRxFreq();
+    bool isRxLoLocked();
+    void initRxStream();
+    size_t getMaxRecvSamps();
+    void issueStreamCmd(const uhd::stream_cmd_t& stream_cmd);
+    size_t recv(
+        std::complex<float>* buffer,
+        size_t num_samps,
+        uhd::rx_metadata_t& md,
+        double timeout,
+        bool one_packet
+    );
+    bool isEndOfStream();
+
+    void setTxAntenna(const std::string& antenna);
+    void setTxGain(double gain);
+    void setTxRate(double rate);
+    double getTxRate();
+    void setTxFreq(const uhd::tune_request_t& tune_req);
+    bool isTxLoLocked();
+    void initTxStream();
+    size_t getMaxSendSamps();
+    size_t send(
+        const std::complex<float>* buffer,
+        size_t num_samps,
+        const uhd::tx_metadata_t& md,
+        double timeout
+    );
+    bool recvAsyncMsg(
+        uhd::async_metadata_t& md,
+        double timeout
+    );
+
+    void setTimeSource(const std::string& source);
+    void setTimeUnknownPps(const uhd::time_spec_t& time);
+    void setTimeNow(const uhd::time_spec_t& time);
+    uhd::time_spec_t getTimeNow();
+    bool isRefLocked();
+
+private:
+    RadioDevice* device;
+    IqCaptureWriter* writer;
+    // Read back from the device once per retune rather than per recv
+    double rx_freq;
+};
+
+
+#endif // RECORDINGRADIODEVICE_H_
@@ -0,0 +1,350 @@
+/* ReplayRadioDevice.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <unistd.h>
+
+#include "ReplayRadioDevice.h"
+
+using namespace std;
+
+ReplayRadioDevice::ReplayRadioDevice(std::string file_name)
+{
+    reader = new IqCaptureReader(file_name);
+    capture_rate = reader->getHeader().sample_rate;
+    time_offset = uhd::time_spec_t(0.0);
+    capture_now = uhd::time_spec_t(0.0);
+
+    rx_freq = 0.0;
+    rx_continuous = false;
+    rx_burst_remaining = 0;
+    overflow_pending = false;
+    samps_delivered = 0;
+    end_of_stream = false;
+
+    tx_rate = capture_rate;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+ReplayRadioDevice::~ReplayRadioDevice()
+{
+    delete reader;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setRxAntenna(const std::string& antenna)
+{
+    // The capture was taken on whatever antenna it was
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setRxGain(double gain)
+{
+    // The recorded samples already include the receiver gain
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setRxRate(double rate)
+{
+    // A capture that was never closed may not know its rate; trust the caller
+    if (capture_rate <= 0.0) {
+        capture_rate = rate;
+        return;
+    }
+    if (fabs(rate - capture_rate) > 1.0E-6 * capture_rate) {
+        cerr << "\nERROR in ReplayRadioDevice::setRxRate: ";
+        cerr << "the capture was recorded at " << capture_rate << " S/s, not ";
+        cerr << rate << " S/s" << endl;
+        exit(EXIT_FAILURE);
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double ReplayRadioDevice::getRxRate()
+{
+    return(capture_rate);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setRxFreq(const uhd::tune_request_t& tune_req)
+{
+    if (tune_req.rf_freq_policy == uhd::tune_request_t::POLICY_MANUAL) {
+        rx_freq = tune_req.rf_freq + tune_req.dsp_freq;
+    } else {
+        rx_freq = tune_req.target_freq;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double ReplayRadioDevice::getRxFreq()
+{
+    return(rx_freq);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool ReplayRadioDevice::isRxLoLocked()
+{
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::initRxStream()
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t ReplayRadioDevice::getMaxRecvSamps()
+{
+    return(REPLAY_MAX_PACKET_SAMPS);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::issueStreamCmd(const uhd::stream_cmd_t& stream_cmd)
+{
+    std::lock_guard<std::mutex> lock(rx_mutex);
+
+    switch (stream_cmd.stream_mode) {
+        case uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS :
+            rx_continuous = true;
+            rx_burst_remaining = 0;
+            break;
+        case uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS :
+            rx_continuous = false;
+            rx_burst_remaining = 0;
+            break;
+        case uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE :
+        case uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_MORE :
+            rx_continuous = false;
+            rx_burst_remaining = stream_cmd.num_samps;
+            break;
+    }
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t ReplayRadioDevice::recv(
+        std::complex<float>* buffer,
+        size_t num_samps,
+        uhd::rx_metadata_t& md,
+        double timeout,
+        bool one_packet
+        )
+{
+    std::lock_guard<std::mutex> lock(rx_mutex);
+
+    md.has_time_spec = false;
+    md.more_fragments = false;
+    md.fragment_offset = 0;
+    md.start_of_burst = false;
+    md.end_of_burst = false;
+    md.error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+
+    if (!rx_continuous && (rx_burst_remaining == 0)) {
+        md.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+        return(0);
+    }
+    // An overflow found while filling the last buffer is reported now
+    if (overflow_pending) {
+        overflow_pending = false;
+        md.has_time_spec = true;
+        md.time_spec = overflow_time - time_offset;
+        md.error_code = uhd::rx_metadata_t::ERROR_CODE_OVERFLOW;
+        return(0);
+    }
+    if (end_of_stream)
+        return(0);
+
+    size_t n_max = num_samps;
+    if (one_packet && (n_max > REPLAY_MAX_PACKET_SAMPS))
+        n_max = REPLAY_MAX_PACKET_SAMPS;
+    if (!rx_continuous && (n_max > rx_burst_remaining))
+        n_max = rx_burst_remaining;
+
+    size_t n = 0;
+    while (n < n_max) {
+        size_t nr;
+        uhd::time_spec_t t;
+        double center_freq;
+        bool overflow;
+        if (!reader->read(&buffer[n], n_max - n, &nr, &t, &center_freq, &overflow)) {
+            end_of_stream = true;
+            break;
+        }
+        if (overflow) {
+            if (n == 0) {
+                md.has_time_spec = true;
+                md.time_spec = t - time_offset;
+                md.error_code = uhd::rx_metadata_t::ERROR_CODE_OVERFLOW;
+                return(0);
+            }
+            overflow_pending = true;
+            overflow_time = t;
+            break;
+        }
+        if (n == 0) {
+            md.has_time_spec = true;
+            md.time_spec = t - time_offset;
+        }
+        n += nr;
+        capture_now = t + uhd::time_spec_t((double)nr / capture_rate);
+        // A packet never spans two recorded packets
+        if (one_packet)
+            break;
+    }
+
+    samps_delivered += n;
+    if (!rx_continuous) {
+        rx_burst_remaining -= n;
+        md.end_of_burst = (rx_burst_remaining == 0);
+    }
+
+    return(n);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool ReplayRadioDevice::isEndOfStream()
+{
+    return(end_of_stream);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setTxAntenna(const std::string& antenna)
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setTxGain(double gain)
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setTxRate(double rate)
+{
+    tx_rate = rate;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double ReplayRadioDevice::getTxRate()
+{
+    return(tx_rate);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setTxFreq(const uhd::tune_request_t& tune_req)
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool ReplayRadioDevice::isTxLoLocked()
+{
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::initTxStream()
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t ReplayRadioDevice::getMaxSendSamps()
+{
+    return(REPLAY_MAX_PACKET_SAMPS);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t ReplayRadioDevice::send(
+        const std::complex<float>* buffer,
+        size_t num_samps,
+        const uhd::tx_metadata_t& md,
+        double timeout
+        )
+{
+    return(num_samps);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool ReplayRadioDevice::recvAsyncMsg(
+        uhd::async_metadata_t& md,
+        double timeout
+        )
+{
+    usleep((useconds_t)(1.0E6 * timeout));
+    return(false);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setTimeSource(const std::string& source)
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setTimeUnknownPps(const uhd::time_spec_t& time)
+{
+    setTimeNow(time);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void ReplayRadioDevice::setTimeNow(const uhd::time_spec_t& time)
+{
+    std::lock_guard<std::mutex> lock(rx_mutex);
+    time_offset = capture_now - time;
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+uhd::time_spec_t ReplayRadioDevice::getTimeNow()
+{
+    std::lock_guard<std::mutex> lock(rx_mutex);
+    return(capture_now - time_offset);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool ReplayRadioDevice::isRefLocked()
+{
+    return(true);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned long long ReplayRadioDevice::getSampsDelivered()
+{
+    return(samps_delivered);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double ReplayRadioDevice::getCaptureRate()
+{
+    return(capture_rate);
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,103 @@
+/* ReplayRadioDevice.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef REPLAYRADIODEVICE_H_
+#define REPLAYRADIODEVICE_H_
+
+#include <atomic>
+#include <mutex>
+
+#include "RadioDevice.h"
+#include "IqCapture.h"
+
+// Samples per recv in one-packet mode, as for LoopbackRadioDevice
+#define REPLAY_MAX_PACKET_SAMPS                     363
+
+// RadioDevice whose receiver plays back an IQ capture (see
+// RecordingRadioDevice) as fast as the caller takes the samples, so the
+// unchanged receive chain can be benchmarked or regression tested on
+// recorded signals.  The capture plays in order: stream commands only
+// bound how many samples a burst delivers and their time specs are
+// ignored, which suits the continuous receivers of u4 mode.  Timestamps
+// and overflows are the recorded ones, and isEndOfStream turns true after
+// the last sample.  Transmitted samples are discarded.
+class ReplayRadioDevice : public RadioDevice
+{
+public:
+    ReplayRadioDevice(std::string file_name);
+    ~ReplayRadioDevice();
+
+    void setRxAntenna(const std::string& antenna);
+    void setRxGain(double gain);
+    void setRxRate(double rate);
+    double getRxRate();
+    void setRxFreq(const uhd::tune_request_t& tune_req);
+    double getRxFreq();
+    bool isRxLoLocked();
+    void initRxStream();
+    size_t getMaxRecvSamps();
+    void issueStreamCmd(const uhd::stream_cmd_t& stream_cmd);
+    size_t recv(
+        std::complex<float>* buffer,
+        size_t num_samps,
+        uhd::rx_metadata_t& md,
+        double timeout,
+        bool one_packet
+    );
+    bool isEndOfStream();
+
+    void setTxAntenna(const std::string& antenna);
+    void setTxGain(double gain);
+    void setTxRate(double rate);
+    double getTxRate();
+    void setTxFreq(const uhd::tune_request_t& tune_req);
+    bool isTxLoLocked();
+    void initTxStream();
+    size_t getMaxSendSamps();
+    size_t send(
+        const std::complex<float>* buffer,
+        size_t num_samps,
+        const uhd::tx_metadata_t& md,
+        double timeout
+    );
+    bool recvAsyncMsg(
+        uhd::async_metadata_t& md,
+        double timeout
+    );
+
+    void setTimeSource(const std::string& source);
+    void setTimeUnknownPps(const uhd::time_spec_t& time);
+    void setTimeNow(const uhd::time_spec_t& time);
+    uhd::time_spec_t getTimeNow();
+    bool isRefLocked();
+
+    // Samples played back so far and the capture's sample rate
+    unsigned long long getSampsDelivered();
+    double getCaptureRate();
+
+private:
+    IqCaptureReader* reader;
+    double capture_rate;
+    // Device time is capture time minus this offset
+    uhd::time_spec_t time_offset;
+    // Capture time of the next sample
+    uhd::time_spec_t capture_now;
+
+    // Receive side
+    double rx_freq;
+    std::mutex rx_mutex;
+    bool rx_continuous;
+    size_t rx_burst_remaining;
+    bool overflow_pending;
+    uhd::time_spec_t overflow_time;
+    std::atomic<unsigned long long> samps_delivered;
+    std::atomic<bool> end_of_stream;
+
+    // Transmit side
+    double tx_rate;
+};
+
+
+#endif // REPLAYRADIODEVICE_H_
@@ -0,0 +1,112 @@
+/* StartupProfiler.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+#include "StartupProfiler.h"
+
+using namespace std;
+
+StartupProfiler::StartupProfiler()
+{
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+StartupProfiler::~StartupProfiler()
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double StartupProfiler::now()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return( (double)(t.tv_sec - t0.tv_sec) + 1.0E-9 * (double)(t.tv_nsec - t0.tv_nsec) );
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void StartupProfiler::begin(std::string phase)
+{
+    startup_span_t span;
+    span.phase = phase;
+    span.depth = open_spans.size();
+    span.duration = -1.0;
+    span.start = now();
+
+    open_spans.push_back(spans.size());
+    spans.push_back(span);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void StartupProfiler::end()
+{
+    if (open_spans.empty()) {
+        cerr << "\nERROR in StartupProfiler::end: ";
+        cerr << "no startup phase is open" << endl;
+        exit(EXIT_FAILURE);
+    }
+    startup_span_t* span = &spans[open_spans.back()];
+    span->duration = now() - span->start;
+    open_spans.pop_back();
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double StartupProfiler::getTotalTime()
+{
+    return(now());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+unsigned int StartupProfiler::getNumSpans()
+{
+    return(spans.size());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+startup_span_t StartupProfiler::getSpan(unsigned int span_idx)
+{
+    return(spans.at(span_idx));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+int StartupProfiler::report(
+        Logger* log_ptr,
+        float elapsed_time
+        )
+{
+    std::stringstream report;
+
+    report << scientific << elapsed_time;
+    report << "    StartupProfiler: ";
+    report << "Startup phases (start offset, duration) in ms" << std::endl;
+    for (unsigned int i = 0; i < spans.size(); i++) {
+        report << "    " << std::fixed << setprecision(3);
+        report << setw(10) << 1.0E3 * spans[i].start << "  ";
+        if (spans[i].duration < 0.0) {
+            report << setw(10) << "open" << "  ";
+        } else {
+            report << setw(10) << 1.0E3 * spans[i].duration << "  ";
+        }
+        report << std::string(2 * spans[i].depth, ' ') << spans[i].phase << std::endl;
+    }
+    report << "    total: " << std::fixed << setprecision(3) << 1.0E3 * now() << " ms";
+
+    log_ptr->log(report.str());
+    log_ptr->write_log();
+
+    return(EXIT_SUCCESS);
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,51 @@
+/* StartupProfiler.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef STARTUPPROFILER_H_
+#define STARTUPPROFILER_H_
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <time.h>
+
+#include "Logger.hh"
+
+typedef struct {
+    std::string phase;
+    double start;           // seconds since the profiler was created
+    double duration;        // seconds, negative while the span is open
+    unsigned int depth;     // nesting level, 0 for top-level phases
+} startup_span_t;
+
+// Wall-clock spans for the phases of radio bring-up.  Spans nest, so a
+// phase such as the RadioHardwareConfig constructor can be broken down
+// into its own hardware and modem setup steps.
+class StartupProfiler
+{
+public:
+    StartupProfiler();
+    ~StartupProfiler();
+
+    void begin(std::string phase);
+    void end();
+    double getTotalTime();
+    unsigned int getNumSpans();
+    startup_span_t getSpan(unsigned int span_idx);
+    int report(
+        Logger* log_ptr,
+        float elapsed_time
+    );
+
+private:
+    double now();
+
+    struct timespec t0;
+    std::vector<startup_span_t> spans;
+    std::vector<unsigned int> open_spans;
+};
+
+
+#endif // STARTUPPROFILER_H_
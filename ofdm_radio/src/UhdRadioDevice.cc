@@ -0,0 +1,218 @@
+/* UhdRadioDevice.cc
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include "UhdRadioDevice.h"
+
+using namespace std;
+
+UhdRadioDevice::UhdRadioDevice(const uhd::device_addr_t& dev_addr)
+{
+    usrp = uhd::usrp::multi_usrp::make(dev_addr);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+UhdRadioDevice::~UhdRadioDevice()
+{
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setRxAntenna(const std::string& antenna)
+{
+    usrp->set_rx_antenna(antenna);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setRxGain(double gain)
+{
+    usrp->set_rx_gain(gain);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setRxRate(double rate)
+{
+    usrp->set_rx_rate(rate);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double UhdRadioDevice::getRxRate()
+{
+    return(usrp->get_rx_rate());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setRxFreq(const uhd::tune_request_t& tune_req)
+{
+    usrp->set_rx_freq(tune_req);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double UhdRadioDevice::getRxFreq()
+{
+    return(usrp->get_rx_freq());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool UhdRadioDevice::isRxLoLocked()
+{
+    return(usrp->get_rx_sensor("lo_locked", 0).to_bool());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::initRxStream()
+{
+    uhd::stream_args_t rx_stream_args("fc32"); //complex floats
+    rx_stream = usrp->get_rx_stream(rx_stream_args);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t UhdRadioDevice::getMaxRecvSamps()
+{
+    return(rx_stream->get_max_num_samps());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::issueStreamCmd(const uhd::stream_cmd_t& stream_cmd)
+{
+    rx_stream->issue_stream_cmd(stream_cmd);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t UhdRadioDevice::recv(
+        std::complex<float>* buffer,
+        size_t num_samps,
+        uhd::rx_metadata_t& md,
+        double timeout,
+        bool one_packet
+        )
+{
+    return(rx_stream->recv(buffer, num_samps, md, timeout, one_packet));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setTxAntenna(const std::string& antenna)
+{
+    usrp->set_tx_antenna(antenna);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setTxGain(double gain)
+{
+    usrp->set_tx_gain(gain);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setTxRate(double rate)
+{
+    usrp->set_tx_rate(rate);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+double UhdRadioDevice::getTxRate()
+{
+    return(usrp->get_tx_rate());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setTxFreq(const uhd::tune_request_t& tune_req)
+{
+    usrp->set_tx_freq(tune_req);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool UhdRadioDevice::isTxLoLocked()
+{
+    return(usrp->get_tx_sensor("lo_locked", 0).to_bool());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::initTxStream()
+{
+    uhd::stream_args_t tx_stream_args("fc32");
+    tx_stream = usrp->get_tx_stream(tx_stream_args);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t UhdRadioDevice::getMaxSendSamps()
+{
+    return(tx_stream->get_max_num_samps());
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+size_t UhdRadioDevice::send(
+        const std::complex<float>* buffer,
+        size_t num_samps,
+        const uhd::tx_metadata_t& md,
+        double timeout
+        )
+{
+    return(tx_stream->send(buffer, num_samps, md, timeout));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool UhdRadioDevice::recvAsyncMsg(
+        uhd::async_metadata_t& md,
+        double timeout
+        )
+{
+    return(tx_stream->recv_async_msg(md, timeout));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setTimeSource(const std::string& source)
+{
+    usrp->set_time_source(source);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setTimeUnknownPps(const uhd::time_spec_t& time)
+{
+    usrp->set_time_unknown_pps(time);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+void UhdRadioDevice::setTimeNow(const uhd::time_spec_t& time)
+{
+    usrp->set_time_now(time);
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+uhd::time_spec_t UhdRadioDevice::getTimeNow()
+{
+    return(usrp->get_time_now(0));
+}
+//////////////////////////////////////////////////////////////////////////
+
+
+bool UhdRadioDevice::isRefLocked()
+{
+    return(usrp->get_mboard_sensor("ref_locked", 0).to_bool());
+}
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,72 @@
+/* UhdRadioDevice.h
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#ifndef UHDRADIODEVICE_H_
+#define UHDRADIODEVICE_H_
+
+#include <uhd/usrp/multi_usrp.hpp>
+
+#include "RadioDevice.h"
+
+// RadioDevice backed by a USRP through uhd::usrp::multi_usrp.  The
+// constructor throws whatever multi_usrp::make throws when the device
+// cannot be opened.
+class UhdRadioDevice : public RadioDevice
+{
+public:
+    UhdRadioDevice(const uhd::device_addr_t& dev_addr);
+    ~UhdRadioDevice();
+
+    void setRxAntenna(const std::string& antenna);
+    void setRxGain(double gain);
+    void setRxRate(double rate);
+    double getRxRate();
+    void setRxFreq(const uhd::tune_request_t& tune_req);
+    double getRxFreq();
+    bool isRxLoLocked();
+    void initRxStream();
+    size_t getMaxRecvSamps();
+    void issueStreamCmd(const uhd::stream_cmd_t& stream_cmd);
+    size_t recv(
+        std::complex<float>* buffer,
+        size_t num_samps,
+        uhd::rx_metadata_t& md,
+        double timeout,
+        bool one_packet
+    );
+
+    void setTxAntenna(const std::string& antenna);
+    void setTxGain(double gain);
+    void setTxRate(double rate);
+    double getTxRate();
+    void setTxFreq(const uhd::tune_request_t& tune_req);
+    bool isTxLoLocked();
+    void initTxStream();
+    size_t getMaxSendSamps();
+    size_t send(
+        const std::complex<float>* buffer,
+        size_t num_samps,
+        const uhd::tx_metadata_t& md,
+        double timeout
+    );
+    bool recvAsyncMsg(
+        uhd::async_metadata_t& md,
+        double timeout
+    );
+
+    void setTimeSource(const std::string& source);
+    void setTimeUnknownPps(const uhd::time_spec_t& time);
+    void setTimeNow(const uhd::time_spec_t& time);
+    uhd::time_spec_t getTimeNow();
+    bool isRefLocked();
+
+private:
+    uhd::usrp::multi_usrp::sptr usrp;
+    uhd::rx_streamer::sptr rx_stream;
+    uhd::tx_streamer::sptr tx_stream;
+};
+
+
+#endif // UHDRADIODEVICE_H_
@@ -0,0 +1,156 @@
+/* antijam_bench.cc -- Anti-jam convergence under each simulated jammer profile
+ *
+ * Runs the simulated network once per jammer profile and reports, for each
+ * mobile, its throughput before the jammer, how long after jammer onset
+ * the anti-jam state machine first held a null hole with throughput back
+ * above jamming_threshold, and the throughput lost on the way.  The
+ * per-batch throughput of every run is written to antijam_<profile>.csv.
+ *
+ * Takes the same command line and configuration file as U4_sim; the
+ * configuration must enable anti_jam_mode and the jammer's band, power and
+ * timing come from its simulator.jammer group.
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cstdlib>
+#include <csignal>
+
+#include "NetworkSimulator.h"
+
+using namespace std;
+
+volatile sig_atomic_t console_manual_termination_detected = false;
+void consoleSignalHandler(int s) {
+    console_manual_termination_detected = true;
+}
+
+typedef struct {
+    unsigned int node_id;
+    double baseline;            // kbps before the jammer came on
+    double time_to_mitigation;  // < 0 if never mitigated
+    double jammed;              // kbps from onset to mitigation (or the end)
+    double mitigated;           // kbps after mitigation
+    double lost_kbit;           // throughput below baseline after onset
+} antijam_result_t;
+
+antijam_result_t evaluateNode(sim_node_t* node, double onset, double threshold)
+{
+    antijam_result_t result;
+    result.node_id = node->rc->node_id;
+    result.time_to_mitigation = -1.0;
+    result.lost_kbit = 0.0;
+
+    double sum[3] = {0.0, 0.0, 0.0};
+    double duration[3] = {0.0, 0.0, 0.0};
+    double prev_time = 0.0;
+    for (unsigned int i = 0; i < node->batches.size(); i++) {
+        sim_batch_t* batch = &node->batches[i];
+        // The state machine ignores the first batches while links come up
+        if (i <= 3) {
+            prev_time = batch->time;
+            continue;
+        }
+        double dt = batch->time - prev_time;
+        prev_time = batch->time;
+
+        int phase;
+        if (batch->time < onset) {
+            phase = 0;
+        } else if (result.time_to_mitigation < 0.0) {
+            phase = 1;
+            if (batch->mitigation_running && (batch->throughput >= threshold))
+                result.time_to_mitigation = batch->time - onset;
+        } else {
+            phase = 2;
+        }
+        sum[phase] += batch->throughput * dt;
+        duration[phase] += dt;
+    }
+
+    result.baseline = (duration[0] > 0.0) ? sum[0] / duration[0] : 0.0;
+    result.jammed = (duration[1] > 0.0) ? sum[1] / duration[1] : 0.0;
+    result.mitigated = (duration[2] > 0.0) ? sum[2] / duration[2] : 0.0;
+    result.lost_kbit = result.baseline * (duration[1] + duration[2]) - sum[1] - sum[2];
+    if (result.lost_kbit < 0.0)
+        result.lost_kbit = 0.0;
+
+    return(result);
+}
+
+void writeTimeline(NetworkSimulator* sim, std::string profile_name, double onset)
+{
+    std::string file_name = "antijam_" + profile_name + ".csv";
+    ofstream csv(file_name.c_str());
+    csv << "time_since_onset,node_id,throughput_kbps,jammer_active,mitigation_running,left_edge" << endl;
+    for (unsigned int n = 0; n < sim->getNumNodes(); n++) {
+        sim_node_t* node = sim->getNode(n);
+        if (node->rc->node_is_basestation)
+            continue;
+        for (unsigned int i = 0; i < node->batches.size(); i++) {
+            csv << node->batches[i].time - onset << ",";
+            csv << (int)node->rc->node_id << ",";
+            csv << node->batches[i].throughput << ",";
+            csv << node->batches[i].jammer_active << ",";
+            csv << node->batches[i].mitigation_running << ",";
+            csv << node->batches[i].left_edge << endl;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    signal(SIGINT, consoleSignalHandler);
+    signal(SIGTERM, consoleSignalHandler);
+    signal(SIGABRT, consoleSignalHandler);
+
+    std::vector<std::string> summary;
+    for (int p = JAMMER_PROFILE_TONE; p < JAMMER_NUM_PROFILES; p++) {
+        if (console_manual_termination_detected)
+            break;
+        JammerProfileType profile = (JammerProfileType)p;
+        std::string profile_name = Jammer::profileToString(profile);
+
+        NetworkSimulator sim(argc, argv);
+        if (!sim.getNode(0)->rc->anti_jam) {
+            cerr << "\nERROR in antijam_bench: ";
+            cerr << "set anti_jam_mode = 1 (or -n) to benchmark anti-jam convergence" << endl;
+            exit(EXIT_FAILURE);
+        }
+        sim.setJammerProfile(profile);
+        cout << endl << "===== jammer profile " << profile_name << " =====" << endl;
+        sim.run(&console_manual_termination_detected);
+        sim.printReport();
+        writeTimeline(&sim, profile_name, sim.getJammerOnsetTime());
+
+        for (unsigned int n = 0; n < sim.getNumNodes(); n++) {
+            sim_node_t* node = sim.getNode(n);
+            if (node->rc->node_is_basestation)
+                continue;
+            antijam_result_t result = evaluateNode(node, sim.getJammerOnsetTime(),
+                    node->rc->jamming_threshold);
+            stringstream line;
+            line << left << setw(14) << profile_name << right;
+            line << setw(6) << result.node_id;
+            line << fixed << setprecision(1);
+            line << setw(11) << result.baseline;
+            if (result.time_to_mitigation < 0.0)
+                line << setw(11) << "never";
+            else
+                line << setw(11) << result.time_to_mitigation;
+            line << setw(11) << result.jammed;
+            line << setw(11) << result.mitigated;
+            line << setw(12) << result.lost_kbit;
+            summary.push_back(line.str());
+        }
+    }
+
+    cout << endl;
+    cout << "profile         node   base kbps   ttm [s]  jam kbps   mit kbps   lost kbit" << endl;
+    for (unsigned int i = 0; i < summary.size(); i++)
+        cout << summary[i] << endl;
+
+    return(EXIT_SUCCESS);
+}
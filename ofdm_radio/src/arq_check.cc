@@ -0,0 +1,246 @@
+/* arq_check.cc -- Checks of the PacketStore selective-repeat ARQ
+ *
+ * Drives the ack and retransmit state machine of PacketStore directly,
+ * without a radio or tap interface, with a short timeout so that frames
+ * time out in real time:
+ *
+ *   window       at most window packets per destination are in flight
+ *   sizing       get_queued_bytes changes nothing and sizes the frame
+ *                get_next_frame_for_destination then returns
+ *   ack          a partial bitmap leaves the unacknowledged frames to
+ *                time out; the full one frees the packet and its slot
+ *   retransmit   a timed-out frame goes out again with the same bytes
+ *   give up      a frame out of retransmissions drops its packet
+ *   receiver     acknowledgement bitmaps, completion and duplicates
+ *
+ * Prints each check and exits non-zero if any failed.
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <cstring>
+#include <unistd.h>
+
+#include "PacketStore.hh"
+
+using namespace std;
+
+// Frame size of the store; packets up to 3 frames are used
+#define ARQ_CHECK_FRAME_LEN                         100
+#define ARQ_CHECK_WINDOW                            4
+#define ARQ_CHECK_TIMEOUT                           0.05
+#define ARQ_CHECK_MAX_RETRANSMISSIONS               2
+#define ARQ_CHECK_NUM_NODES                         3
+
+static unsigned int num_failed = 0;
+
+static void check(bool ok, const char* what)
+{
+    cout << (ok ? "  ok      " : "  FAILED  ") << what << endl;
+    if(!ok)
+        num_failed++;
+}
+
+// Waits out the retransmission timeout
+static void wait_timeout()
+{
+    usleep((useconds_t)(ARQ_CHECK_TIMEOUT * 1.5e6));
+}
+
+typedef struct {
+    unsigned char* data;
+    long int packet_id;
+    unsigned int frame_id;
+    unsigned int frame_size;
+    unsigned int total_len;
+} arq_check_frame_t;
+
+static arq_check_frame_t next_frame(PacketStore* ps, unsigned int dest_id)
+{
+    arq_check_frame_t f;
+    f.frame_size = 0;
+    f.data = ps->get_next_frame_for_destination(dest_id, &f.packet_id, &f.frame_id,
+            &f.frame_size, &f.total_len);
+    return f;
+}
+
+static PacketStore* create_store()
+{
+    unsigned char nodes_in_net[ARQ_CHECK_NUM_NODES] = {1, 2, 3};
+    PacketStore* ps = new PacketStore("", ARQ_CHECK_NUM_NODES, ARQ_CHECK_NUM_NODES, nodes_in_net,
+            ARQ_CHECK_FRAME_LEN, false);
+    ps->enable_arq(ARQ_CHECK_WINDOW, ARQ_CHECK_TIMEOUT, ARQ_CHECK_MAX_RETRANSMISSIONS);
+    return ps;
+}
+
+// Packet of len bytes whose byte i is seed + i
+static void add_packet(PacketStore* ps, unsigned int dest_id, unsigned int len, unsigned char seed)
+{
+    unsigned char data[3 * ARQ_CHECK_FRAME_LEN];
+    for(unsigned int i = 0; i < len; i++)
+        data[i] = (unsigned char)(seed + i);
+    ps->add_packet(dest_id, data, len);
+}
+
+void check_window()
+{
+    cout << "window" << endl;
+    PacketStore* ps = create_store();
+    for(unsigned int i = 0; i < ARQ_CHECK_WINDOW + 2; i++)
+        add_packet(ps, 1, 50, i);
+    add_packet(ps, 2, 50, 0);
+    unsigned int sent = 0;
+    while(next_frame(ps, 1).data != NULL)
+        sent++;
+    check(sent == ARQ_CHECK_WINDOW, "a full window stops new packets");
+    check(next_frame(ps, 2).data != NULL, "the window is per destination");
+    ps->ack_frames(1, 0, 0x1);
+    arq_check_frame_t f = next_frame(ps, 1);
+    check(f.data != NULL && f.packet_id == ARQ_CHECK_WINDOW, "an acknowledgement frees a slot");
+    delete ps;
+}
+
+void check_sizing()
+{
+    cout << "sizing" << endl;
+    PacketStore* ps = create_store();
+    add_packet(ps, 1, 250, 0);
+    unsigned int next_size = 0;
+    unsigned int queued = 0;
+    for(unsigned int i = 0; i < 10; i++)
+        queued = ps->get_queued_bytes(1, &next_size);
+    check(queued == 250 && next_size == ARQ_CHECK_FRAME_LEN, "queued bytes and next frame size");
+    check(ps->size() == 1, "sizing left the packet queued");
+    arq_check_frame_t f = next_frame(ps, 1);
+    check(f.packet_id == 0 && f.frame_id == 0 && f.frame_size == next_size,
+            "sizing did not send anything");
+
+    // fill the window so the only candidate is a retransmission
+    for(unsigned int i = 1; i < ARQ_CHECK_WINDOW; i++)
+        add_packet(ps, 1, 50, i);
+    while(next_frame(ps, 1).data != NULL)
+        ;
+    ps->ack_frames(1, 0, 0x3);
+    wait_timeout();
+    queued = ps->get_queued_bytes(1, &next_size);
+    f = next_frame(ps, 1);
+    check(f.data != NULL && f.frame_size == next_size, "the sized frame is the one sent");
+    delete ps;
+
+    // a packet out of retransmissions is not sized, nor given up before a send
+    ps = create_store();
+    add_packet(ps, 1, 50, 0);
+    next_frame(ps, 1);
+    for(unsigned int i = 0; i < ARQ_CHECK_MAX_RETRANSMISSIONS; i++)
+    {
+        wait_timeout();
+        next_frame(ps, 1);
+    }
+    wait_timeout();
+    check(ps->get_queued_bytes(1, &next_size) == 0 && next_size == 0, "nothing due once out of retransmissions");
+    add_packet(ps, 1, 50, 1);
+    for(unsigned int i = 0; i < 10; i++)
+        ps->get_queued_bytes(1, &next_size);
+    check(ps->size() == 1 && next_size == 50, "sizing passed over the packet given up");
+    f = next_frame(ps, 1);
+    check(f.data != NULL && f.packet_id == 1, "the next send gives it up");
+    delete ps;
+}
+
+void check_ack_and_retransmit()
+{
+    cout << "ack and retransmit" << endl;
+    PacketStore* ps = create_store();
+    add_packet(ps, 1, 250, 7);
+    arq_check_frame_t f[3];
+    unsigned char sent[3][ARQ_CHECK_FRAME_LEN];
+    for(unsigned int i = 0; i < 3; i++)
+    {
+        f[i] = next_frame(ps, 1);
+        memcpy(sent[i], f[i].data, f[i].frame_size);
+    }
+    check(f[0].frame_id == 0 && f[1].frame_id == 1 && f[2].frame_id == 2 &&
+            f[2].frame_size == 50 && f[2].total_len == 250, "frames of a packet in order");
+    check(next_frame(ps, 1).data == NULL, "nothing to send before the timeout");
+
+    ps->ack_frames(1, 0, 0x5);
+    wait_timeout();
+    arq_check_frame_t r = next_frame(ps, 1);
+    check(r.data != NULL && r.packet_id == 0 && r.frame_id == 1 &&
+            memcmp(r.data, sent[1], r.frame_size) == 0,
+            "the unacknowledged frame goes out again unchanged");
+    check(next_frame(ps, 1).data == NULL, "acknowledged frames are not retransmitted");
+
+    ps->ack_frames(1, 0, 0x2);
+    add_packet(ps, 1, 50, 0);
+    wait_timeout();
+    r = next_frame(ps, 1);
+    check(r.data != NULL && r.packet_id == 1, "a fully acknowledged packet is done");
+
+    // the frame handed out outlives its packet
+    unsigned char copy[ARQ_CHECK_FRAME_LEN];
+    memcpy(copy, r.data, r.frame_size);
+    ps->ack_frames(1, 1, 0x1);
+    check(memcmp(copy, r.data, r.frame_size) == 0, "a frame stays valid after its packet is freed");
+    delete ps;
+}
+
+void check_give_up()
+{
+    cout << "give up" << endl;
+    PacketStore* ps = create_store();
+    add_packet(ps, 1, 50, 0);
+    unsigned int transmissions = 0;
+    for(unsigned int i = 0; i < ARQ_CHECK_MAX_RETRANSMISSIONS + 2; i++)
+    {
+        if(next_frame(ps, 1).data != NULL)
+            transmissions++;
+        wait_timeout();
+    }
+    check(transmissions == ARQ_CHECK_MAX_RETRANSMISSIONS + 1, "sent once plus the retransmissions");
+    add_packet(ps, 1, 50, 1);
+    arq_check_frame_t f = next_frame(ps, 1);
+    check(f.data != NULL && f.packet_id == 1, "the packet given up frees its slot");
+    delete ps;
+}
+
+void check_receiver()
+{
+    cout << "receiver" << endl;
+    PacketStore* ps = create_store();
+    unsigned char data[ARQ_CHECK_FRAME_LEN];
+    memset(data, 0, sizeof(data));
+    long int packet_id = 0;
+    unsigned int bitmap = 0;
+    check(!ps->has_pending_ack(2), "nothing to acknowledge at first");
+    ps->add_frame(2, 5, 0, data, 250);
+    ps->add_frame(2, 5, 2, data, 250);
+    check(ps->get_ack(2, &packet_id, &bitmap) && packet_id == 5 && bitmap == 0x5,
+            "bitmap of the frames received");
+    check(!ps->has_pending_ack(2), "one acknowledgement per packet");
+    check(ps->add_frame(2, 5, 1, data, 250) == PACKET_COMPLETE, "the last frame completes the packet");
+    check(ps->add_frame(2, 5, 1, data, 250) == PACKET_NOT_COMPLETE && ps->get_written_packets() == 1,
+            "a duplicate is not delivered again");
+    check(ps->get_ack(2, &packet_id, &bitmap) && packet_id == 5 && bitmap == 0x7,
+            "a duplicate is acknowledged again");
+    ps->add_frame(1, 5, 0, data, 250);
+    check(ps->get_ack(1, &packet_id, &bitmap) && bitmap == 0x1, "packets are kept per source");
+    delete ps;
+}
+
+int main(int argc, char** argv)
+{
+    check_window();
+    check_sizing();
+    check_ack_and_retransmit();
+    check_give_up();
+    check_receiver();
+    if(num_failed > 0)
+    {
+        cout << num_failed << " checks FAILED" << endl;
+        return 1;
+    }
+    cout << "all checks passed" << endl;
+    return 0;
+}
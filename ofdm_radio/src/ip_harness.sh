@@ -0,0 +1,111 @@
+#!/bin/bash
+# ip_harness.sh -- End-to-end IP throughput and latency over the simulated radio
+#
+# Runs U4_sim with tun_tap set (config_files/ip_harness.cfg by default), so
+# node N has the tap interface u4tapN with 10.10.10.N in its own network
+# namespace u4nsN, and the basestation and mobiles can only reach each
+# other through the waveform: PacketStore, fragmentation into frames, the
+# OFDMA downlink and multichannel uplink, the receive callbacks and the
+# schedule.  For each mobile it then runs, one at a time:
+#
+#   ping from the basestation            round-trip time and loss
+#   UDP downlink and uplink              goodput, loss, reordering and
+#                                        one-way latency percentiles
+#   TCP downlink                         goodput
+#
+# with U4_iptraffic on both ends.  Every report goes to the results
+# directory; the simulator's own report at the end adds, per node, the IP
+# packets read from and written to its tap interface and the packets that
+# were never reassembled.  Nothing leaves the host and no USRP is used,
+# but creating the namespaces needs root (or sudo).
+#
+# Usage: ./ip_harness.sh [config file] [results directory]
+# Flow settings come from the environment: FLOW_SECONDS (10), UDP_KBPS
+# (200), UDP_LENGTH (1000), PING_COUNT (20)
+#
+# Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+
+CONFIG=${1:-config_files/ip_harness.cfg}
+RESULTS=${2:-ip_harness_results}
+FLOW_SECONDS=${FLOW_SECONDS:-10}
+UDP_KBPS=${UDP_KBPS:-200}
+UDP_LENGTH=${UDP_LENGTH:-1000}
+PING_COUNT=${PING_COUNT:-20}
+TAP_PREFIX=u4tap
+NETNS_PREFIX=u4ns
+PORT=5201
+IPTRAFFIC=$(pwd)/U4_iptraffic
+
+if [ ! -x ./U4_sim ] || [ ! -x ./U4_iptraffic ]; then
+    echo "Build U4_sim and U4_iptraffic first (make U4_sim U4_iptraffic)"
+    exit 1
+fi
+if [ "$(id -u)" != "0" ]; then
+    SUDO=sudo
+fi
+
+mkdir -p $RESULTS
+./U4_sim -C $CONFIG > $RESULTS/sim.txt 2>&1 &
+SIM_PID=$!
+
+cleanup() {
+    if kill -0 $SIM_PID 2> /dev/null; then
+        kill -INT $SIM_PID
+        wait $SIM_PID
+    fi
+}
+trap cleanup EXIT
+
+in_ns() {
+    local node=$1
+    shift
+    $SUDO ip netns exec $NETNS_PREFIX$node "$@"
+}
+
+# Every namespace exists once its node's PacketStore is up; the
+# basestation, the highest node ID, is created last
+NUM_NODES=$(sed -n 's/^network_node_id *= *\[\(.*\)\].*/\1/p' $CONFIG | tr ',' '\n' | wc -l)
+BASESTATION=$NUM_NODES
+for attempt in $(seq 60); do
+    if in_ns $BASESTATION ip link show $TAP_PREFIX$BASESTATION > /dev/null 2>&1; then
+        break
+    fi
+    if ! kill -0 $SIM_PID 2> /dev/null; then
+        echo "U4_sim exited early; see $RESULTS/sim.txt"
+        exit 1
+    fi
+    sleep 1
+done
+# The receivers settle and the first schedules run before any traffic
+sleep 5
+echo "Network of $NUM_NODES nodes up; basestation 10.10.10.$BASESTATION"
+
+# Receiver in one namespace, sender in another
+run_flow() {
+    local name=$1 rx_node=$2 tx_node=$3
+    shift 3
+    in_ns $rx_node $IPTRAFFIC -s "$@" -p $PORT -w $((FLOW_SECONDS + 10)) \
+        -j $RESULTS/$name.json > $RESULTS/$name.txt 2>&1 &
+    local rx_pid=$!
+    sleep 1
+    in_ns $tx_node $IPTRAFFIC -c 10.10.10.$rx_node "$@" -p $PORT -d $FLOW_SECONDS \
+        >> $RESULTS/${name}_sender.txt 2>&1
+    wait $rx_pid
+    echo "  $name: $(head -1 $RESULTS/$name.txt)"
+}
+
+for mobile in $(seq $((NUM_NODES - 1))); do
+    echo "Mobile $mobile (10.10.10.$mobile):"
+    if command -v ping > /dev/null; then
+        in_ns $BASESTATION ping -c $PING_COUNT -i 0.2 10.10.10.$mobile > $RESULTS/ping_$mobile.txt 2>&1
+        echo "  ping: $(grep -E 'packet loss|rtt' $RESULTS/ping_$mobile.txt | tr '\n' ' ')"
+    fi
+    run_flow udp_down_$mobile $mobile $BASESTATION -b $UDP_KBPS -l $UDP_LENGTH
+    run_flow udp_up_$mobile $BASESTATION $mobile -b $UDP_KBPS -l $UDP_LENGTH
+    run_flow tcp_down_$mobile $mobile $BASESTATION -T
+done
+
+cleanup
+trap - EXIT
+echo
+sed -n '/^Simulated network/,$p' $RESULTS/sim.txt
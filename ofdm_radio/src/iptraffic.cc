@@ -0,0 +1,387 @@
+/* iptraffic.cc -- UDP and TCP test flows for the end-to-end IP harness
+ *
+ * A small iperf-like sender and receiver that needs nothing outside this
+ * tree.  UDP datagrams carry a sequence number and the send time, so the
+ * receiver reports loss, reordering, goodput and one-way latency
+ * percentiles; sender and receiver run on the same host (in different
+ * network namespaces, see ip_harness.sh) and so share CLOCK_REALTIME.  A
+ * TCP flow is a bulk transfer and reports goodput only.
+ *
+ *   receiver:  U4_iptraffic -s [-T] [-p port] [-w idle] [-j file]
+ *   sender:    U4_iptraffic -c <ip> [-T] [-p port] [-b kbps] [-l bytes] [-d seconds]
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "ChainBench.h"
+
+using namespace std;
+
+#define IPTRAFFIC_MAGIC                             0x55344950
+#define IPTRAFFIC_DEFAULT_PORT                      5201
+// Datagrams marking the end of a UDP flow, in case some are lost
+#define IPTRAFFIC_NUM_END_MARKERS                   5
+#define IPTRAFFIC_FLAG_END                          0x1
+#define IPTRAFFIC_MAX_DATAGRAM                      1472
+#define IPTRAFFIC_TCP_CHUNK                         16384
+
+typedef struct {
+    uint32_t magic;
+    uint32_t flags;
+    uint32_t seq;
+    // On end markers, the number of data datagrams sent
+    uint32_t total;
+    int64_t sec;
+    int64_t nsec;
+} iptraffic_header_t;
+
+typedef struct {
+    bool server;
+    bool tcp;
+    std::string address;
+    unsigned short port;
+    double rate_kbps;
+    unsigned int length;
+    double duration;
+    double idle_timeout;
+    std::string json_file;
+} iptraffic_opts_t;
+
+void usage()
+{
+    cout << "U4_iptraffic -- UDP/TCP test flows through the U4 radio" << endl;
+    cout << "  -s            receive and report" << endl;
+    cout << "  -c <ip>       send to this address" << endl;
+    cout << "  -T            TCP bulk transfer instead of UDP" << endl;
+    cout << "  -p <port>     port, default " << IPTRAFFIC_DEFAULT_PORT << endl;
+    cout << "  -b <kbps>     UDP send rate, default 200" << endl;
+    cout << "  -l <bytes>    UDP datagram size, default 1000" << endl;
+    cout << "  -d <seconds>  send duration, default 10" << endl;
+    cout << "  -w <seconds>  receiver gives up after this long without data, default 10" << endl;
+    cout << "  -j <file>     receiver writes its report as JSON" << endl;
+}
+
+double nowSeconds(clockid_t clock_id)
+{
+    struct timespec ts;
+    clock_gettime(clock_id, &ts);
+    return((double)ts.tv_sec + 1.0E-9 * (double)ts.tv_nsec);
+}
+
+int openSocket(const iptraffic_opts_t& opts)
+{
+    int fd = socket(AF_INET, opts.tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (fd < 0) {
+        cerr << "\nERROR in iptraffic: socket: " << strerror(errno) << endl;
+        exit(EXIT_FAILURE);
+    }
+    return(fd);
+}
+
+struct sockaddr_in makeAddress(const std::string& address, unsigned short port)
+{
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (address.empty()) {
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    } else if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        cerr << "\nERROR in iptraffic: bad address " << address << endl;
+        exit(EXIT_FAILURE);
+    }
+    return(addr);
+}
+
+// Waits up to timeout seconds for fd to become readable
+bool waitReadable(int fd, double timeout)
+{
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    return(poll(&pfd, 1, (int)(1000.0 * timeout)) > 0);
+}
+
+double percentile(std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return(0.0);
+    size_t idx = (size_t)(p * (double)(sorted.size() - 1) + 0.5);
+    return(sorted[idx]);
+}
+
+void reportResult(const iptraffic_opts_t& opts, ChainBenchResult& result)
+{
+    cout << result.getName() << ":";
+    cout << " received " << (unsigned long)result.get("bytes") << " bytes";
+    cout << fixed << setprecision(1);
+    cout << ", goodput " << result.get("goodput_kbps") << " kbps";
+    if (!opts.tcp) {
+        cout << ", " << (unsigned long)result.get("received") << "/";
+        cout << (unsigned long)result.get("sent") << " datagrams";
+        cout << setprecision(2) << ", loss " << result.get("loss_percent") << "%";
+        cout << ", reordered " << (unsigned long)result.get("reordered");
+        cout << setprecision(1);
+        cout << ", one-way latency ms p50 " << result.get("latency_p50_ms");
+        cout << " p90 " << result.get("latency_p90_ms");
+        cout << " p99 " << result.get("latency_p99_ms");
+        cout << " max " << result.get("latency_max_ms");
+    }
+    cout << endl;
+    cout.unsetf(ios_base::floatfield);
+    cout << setprecision(6);
+
+    if (!opts.json_file.empty()) {
+        ofstream json(opts.json_file.c_str());
+        result.writeJson(json);
+        json << endl;
+    }
+}
+
+int receiveUdp(const iptraffic_opts_t& opts)
+{
+    int fd = openSocket(opts);
+    struct sockaddr_in addr = makeAddress("", opts.port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        cerr << "\nERROR in iptraffic: bind: " << strerror(errno) << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<unsigned char> buffer(65536);
+    std::vector<bool> seen;
+    std::vector<double> latencies;
+    unsigned long long bytes = 0;
+    unsigned int received = 0;
+    unsigned int duplicates = 0;
+    unsigned int reordered = 0;
+    unsigned int total = 0;
+    long long highest_seq = -1;
+    double first_arrival = 0.0;
+    double last_arrival = 0.0;
+
+    while (waitReadable(fd, opts.idle_timeout)) {
+        ssize_t n = recv(fd, &buffer[0], buffer.size(), 0);
+        if (n < (ssize_t)sizeof(iptraffic_header_t))
+            continue;
+        double arrival = nowSeconds(CLOCK_REALTIME);
+        iptraffic_header_t header;
+        memcpy(&header, &buffer[0], sizeof(header));
+        if (header.magic != IPTRAFFIC_MAGIC)
+            continue;
+        if (header.flags & IPTRAFFIC_FLAG_END) {
+            total = header.total;
+            break;
+        }
+        if (header.seq >= seen.size())
+            seen.resize(header.seq + 1, false);
+        if (seen[header.seq]) {
+            duplicates++;
+            continue;
+        }
+        seen[header.seq] = true;
+        if ((long long)header.seq < highest_seq)
+            reordered++;
+        else
+            highest_seq = header.seq;
+        if (received == 0)
+            first_arrival = arrival;
+        last_arrival = arrival;
+        received++;
+        bytes += n;
+        double sent = (double)header.sec + 1.0E-9 * (double)header.nsec;
+        latencies.push_back(1.0E3 * (arrival - sent));
+    }
+    close(fd);
+
+    // Without an end marker the sender's count is a lower bound
+    if (total == 0)
+        total = (unsigned int)(highest_seq + 1);
+    std::sort(latencies.begin(), latencies.end());
+    double elapsed = last_arrival - first_arrival;
+
+    ChainBenchResult result("udp");
+    result.set("port", (double)opts.port);
+    result.set("sent", (double)total);
+    result.set("received", (double)received);
+    result.set("lost", (double)(total > received ? total - received : 0));
+    result.set("loss_percent", total > 0 ? 100.0 * (double)(total - std::min(total, received)) / total : 0.0);
+    result.set("duplicates", (double)duplicates);
+    result.set("reordered", (double)reordered);
+    result.set("bytes", (double)bytes);
+    result.set("seconds", elapsed);
+    result.set("goodput_kbps", elapsed > 0.0 ? (bytes * 8 / 1024) / elapsed : 0.0);
+    result.set("latency_p50_ms", percentile(latencies, 0.50));
+    result.set("latency_p90_ms", percentile(latencies, 0.90));
+    result.set("latency_p99_ms", percentile(latencies, 0.99));
+    result.set("latency_max_ms", latencies.empty() ? 0.0 : latencies.back());
+    reportResult(opts, result);
+    return(received > 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+int sendUdp(const iptraffic_opts_t& opts)
+{
+    int fd = openSocket(opts);
+    struct sockaddr_in addr = makeAddress(opts.address, opts.port);
+    std::vector<unsigned char> buffer(opts.length, 0);
+    double interval = (8.0 * opts.length) / (1024.0 * opts.rate_kbps);
+
+    iptraffic_header_t header;
+    header.magic = IPTRAFFIC_MAGIC;
+    header.flags = 0;
+    header.total = 0;
+    uint32_t seq = 0;
+    double start = nowSeconds(CLOCK_MONOTONIC);
+    double next_send = start;
+    while (next_send < start + opts.duration) {
+        double now = nowSeconds(CLOCK_MONOTONIC);
+        if (now < next_send)
+            usleep((useconds_t)(1.0E6 * (next_send - now)));
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        header.seq = seq++;
+        header.sec = ts.tv_sec;
+        header.nsec = ts.tv_nsec;
+        memcpy(&buffer[0], &header, sizeof(header));
+        sendto(fd, &buffer[0], buffer.size(), 0, (struct sockaddr*)&addr, sizeof(addr));
+        next_send += interval;
+    }
+
+    // Give the radio time to drain before the markers
+    usleep(1000000);
+    header.flags = IPTRAFFIC_FLAG_END;
+    header.total = seq;
+    for (unsigned int i = 0; i < IPTRAFFIC_NUM_END_MARKERS; i++) {
+        memcpy(&buffer[0], &header, sizeof(header));
+        sendto(fd, &buffer[0], sizeof(header), 0, (struct sockaddr*)&addr, sizeof(addr));
+        usleep(200000);
+    }
+    close(fd);
+    cout << "udp: sent " << seq << " datagrams of " << opts.length << " bytes to ";
+    cout << opts.address << ":" << opts.port << endl;
+    return(EXIT_SUCCESS);
+}
+
+int receiveTcp(const iptraffic_opts_t& opts)
+{
+    int listen_fd = openSocket(opts);
+    int on = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    struct sockaddr_in addr = makeAddress("", opts.port);
+    if ((bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) ||
+            (listen(listen_fd, 1) < 0)) {
+        cerr << "\nERROR in iptraffic: bind/listen: " << strerror(errno) << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned long long bytes = 0;
+    double first_arrival = 0.0;
+    double last_arrival = 0.0;
+    if (waitReadable(listen_fd, opts.idle_timeout)) {
+        int fd = accept(listen_fd, NULL, NULL);
+        std::vector<unsigned char> buffer(IPTRAFFIC_TCP_CHUNK);
+        while ((fd >= 0) && waitReadable(fd, opts.idle_timeout)) {
+            ssize_t n = recv(fd, &buffer[0], buffer.size(), 0);
+            if (n <= 0)
+                break;
+            last_arrival = nowSeconds(CLOCK_MONOTONIC);
+            if (bytes == 0)
+                first_arrival = last_arrival;
+            bytes += n;
+        }
+        if (fd >= 0)
+            close(fd);
+    }
+    close(listen_fd);
+
+    double elapsed = last_arrival - first_arrival;
+    ChainBenchResult result("tcp");
+    result.set("port", (double)opts.port);
+    result.set("bytes", (double)bytes);
+    result.set("seconds", elapsed);
+    result.set("goodput_kbps", elapsed > 0.0 ? (bytes * 8 / 1024) / elapsed : 0.0);
+    reportResult(opts, result);
+    return(bytes > 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+int sendTcp(const iptraffic_opts_t& opts)
+{
+    int fd = openSocket(opts);
+    struct sockaddr_in addr = makeAddress(opts.address, opts.port);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        cerr << "\nERROR in iptraffic: connect: " << strerror(errno) << endl;
+        exit(EXIT_FAILURE);
+    }
+    std::vector<unsigned char> buffer(IPTRAFFIC_TCP_CHUNK, 0);
+    unsigned long long bytes = 0;
+    double start = nowSeconds(CLOCK_MONOTONIC);
+    while (nowSeconds(CLOCK_MONOTONIC) < start + opts.duration) {
+        ssize_t n = send(fd, &buffer[0], buffer.size(), 0);
+        if (n <= 0)
+            break;
+        bytes += n;
+    }
+    close(fd);
+    cout << "tcp: sent " << bytes << " bytes to " << opts.address << ":" << opts.port << endl;
+    return(EXIT_SUCCESS);
+}
+
+int main(int argc, char **argv) {
+    iptraffic_opts_t opts;
+    opts.server = false;
+    opts.tcp = false;
+    opts.port = IPTRAFFIC_DEFAULT_PORT;
+    opts.rate_kbps = 200.0;
+    opts.length = 1000;
+    opts.duration = 10.0;
+    opts.idle_timeout = 10.0;
+
+    int c;
+    while ((c = getopt(argc, argv, "hsc:Tp:b:l:d:w:j:")) != -1) {
+        switch (c) {
+            case 'h': usage(); return(EXIT_SUCCESS);
+            case 's': opts.server = true; break;
+            case 'c': opts.address = optarg; break;
+            case 'T': opts.tcp = true; break;
+            case 'p': opts.port = (unsigned short)atoi(optarg); break;
+            case 'b': opts.rate_kbps = atof(optarg); break;
+            case 'l': opts.length = atoi(optarg); break;
+            case 'd': opts.duration = atof(optarg); break;
+            case 'w': opts.idle_timeout = atof(optarg); break;
+            case 'j': opts.json_file = optarg; break;
+            default:  usage(); return(EXIT_FAILURE);
+        }
+    }
+    if (!opts.server && opts.address.empty()) {
+        usage();
+        return(EXIT_FAILURE);
+    }
+    if ((opts.length < sizeof(iptraffic_header_t)) || (opts.length > IPTRAFFIC_MAX_DATAGRAM) ||
+            (opts.rate_kbps <= 0.0)) {
+        cerr << "\nERROR in iptraffic: datagram size must be " << sizeof(iptraffic_header_t);
+        cerr << " to " << IPTRAFFIC_MAX_DATAGRAM << " bytes and the rate positive" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (opts.server)
+        return(opts.tcp ? receiveTcp(opts) : receiveUdp(opts));
+    return(opts.tcp ? sendTcp(opts) : sendUdp(opts));
+}
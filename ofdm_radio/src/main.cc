@@ -12,6 +12,7 @@
 #include <csignal>
 
 // Header files for U1 waveform application
+#include "AntiJamController.h"
 #include "AppManager.h"
 #include "FhSeqGenerator.h"
 #include "FreqTableGenerator.h"
@@ -25,34 +26,23 @@
 #include "RadioTaskDefs.h"
 #include "RadioTaskManager.h"
 #include "RxPayload.hh"
+#include "StartupProfiler.h"
 #include "TxPayload.hh"
 #include "TunTap.hh"
 #include "timer.h"
 
 long int bytes_received = 0;
-long int last_bytes_received = 0;
 long int last_bad_headers = 0;
 long int last_bad_payloads = 0;
 long int last_packets_received = 0;
 long int last_packets_transmitted = 0;
 int bad_counts[RHC_OFDMA_M] = {0};
 using namespace std;
-void openNullHole(unsigned char*, int, int);
 volatile sig_atomic_t console_manual_termination_detected = false;
 void consoleSignalHandler(int s) {
     console_manual_termination_detected = true;
 }
 
-double evaluate_throughput(timer t1, RadioHardwareConfig* rhc_ptr)
-{
-    long int total_bytes_received = rhc_ptr->valid_bytes_received;	
-    long int difference = total_bytes_received - last_bytes_received;
-    double throughput = (difference * 8 / 1024) / timer_toc(t1);
-    last_bytes_received = total_bytes_received;
-    timer_tic(t1);
-    return throughput;
-} 
-
 void summarize_batch(unsigned int batch_count, float throughput, RadioHardwareConfig* rhc_ptr, bool mitigation_enabled,  bool jam_mitigation_running, int left_edge)
 {
     long int new_bad_headers = rhc_ptr->invalid_headers_received - last_bad_headers;
@@ -110,8 +100,13 @@ int main(int argc, char **argv) {
     // Init Stage -----------------------------------------------
     //  Order of object initialization IS important 
 
+    // Wall-clock breakdown of radio bring-up, reported to the app log
+    StartupProfiler startup_profiler;
+
     // Parse and validate settings in configuration file
+    startup_profiler.begin("RadioConfig");
     RadioConfig rc(argc, argv);
+    startup_profiler.end();
     rc.display_config();     //if (rc.debug) rc.display_config(); 
 
     // Overall application control
@@ -123,8 +118,10 @@ int main(int argc, char **argv) {
     Logger rf_log(rc.rf_log_file);
 
     //Just in case this hasn't already been done 
+    startup_profiler.begin("sysctl socket buffer limits");
     std::system("sudo sysctl -w net.core.wmem_max=1048576");
     std::system("sudo sysctl -w net.core.rmem_max=50000000");
+    startup_profiler.end();
 
     timer rx_timer = timer_create();
     timer_tic(rx_timer);
@@ -133,17 +130,23 @@ int main(int argc, char **argv) {
     // derive waveform parameters based on physical capabilities of the radio
     Logger rxf_event_log("rxf_event.log");
     Logger uhd_error_log("uhd_error.log");  
+    // PacketStore brings up tap0 through TunTap's sudo ifconfig/ip/arp calls
+    startup_profiler.begin("PacketStore and TunTap");
     PacketStore ps("tap0", rc.node_id, rc.num_nodes_in_net, rc.nodes_in_net, 
             rc.frame_size, rc.using_tun_tap);
+    startup_profiler.end();
+    startup_profiler.begin("RadioHardwareConfig");
     RadioHardwareConfig rhc(rc.radio_hardware, rc.usrp_address_name, 
             rc.radio_hardware_clock, rc.node_is_basestation, rc.node_id, rc.num_nodes_in_net, rc.frame_size,
             rc.normal_freq, rc.rf_gain_rx, rc.rf_gain_tx, rc.sample_rate, &app_log, &rf_log, 
             RXF_LOG_LEVEL_FILE_ONLY, &rxf_event_log, 
             UHD_ERROR_LOG_LEVEL_FILE_ONLY, &uhd_error_log,
             rc.debug, rc.u4, rc.using_tun_tap, &ps, &app, rx_timer, rc.slow, rc.ofdma_tx_window, rc.mc_tx_window,
-            rc.anti_jam, &rc);
+            rc.anti_jam, &rc, &startup_profiler);
+    startup_profiler.end();
 
     // Precompute set of frequencies used in frequency hopping mode
+    startup_profiler.begin("schedule and MAC objects");
     FreqTableGenerator ftg(rc.node_is_basestation, rc.normal_freq,
             rhc.getTx2RxFreqSeparation(), 
             rc.fh_freq_min, rc.fh_freq_max, rc.num_fh_prohibited_ranges, 
@@ -181,6 +184,7 @@ int main(int argc, char **argv) {
     RadioTaskManager rtm(&fsg, &ftg, &rhc, &rs, &p2m, rc.debug, rc.u4);
 
     rs.calcU4Schedule();
+    startup_profiler.end();
     // Initialization complete 
     // Log details of actual operating configuration
     app.doAppLogReport(&app_log, APP_LOG_REPORT_INIT_DONE); 
@@ -207,20 +211,10 @@ int main(int argc, char **argv) {
     double remaining = 0.0;
 
     timer rx_runtime = timer_create();
-    timer throughput_timer = timer_create();
-    timer good_throughput_timer = timer_create();
-    timer mitigation_timer = timer_create();
-    timer enable_mitigation_timer = timer_create();
-    timer resend_alloc_timer = timer_create();
-    timer_tic(resend_alloc_timer);
-
-    bool sweeping = true;
-    int left_edge = 0;
-    int direction = 1;
-    bool jam_mitigation_running = false;
-    bool mitigation_enabled = true;
-    bool resuming = false;
-    bool check_full_band = true;
+
+    // Watches throughput per batch and moves the null hole when jammed
+    AntiJamController ajc(&rc, &rhc, &rs, &app, &app_log,
+            (rc.radio_hardware == "RADIO_MODEL_LOOPBACK") ? rc.loopback_time_scale : 1.0);
 
     if(rc.u4)
     {
@@ -247,13 +241,16 @@ int main(int argc, char **argv) {
 
         }
         timer_tic(rx_runtime);
-        timer_tic(throughput_timer);
+        ajc.start();
         //Wait 1 second to let other nodes start their receivers before transmitting
+        startup_profiler.begin("receiver settle wait");
         timer t1 = timer_create();
         timer_tic(t1);
         while(timer_toc(t1) < 1.0);
         timer_destroy(t1);
+        startup_profiler.end();
     }
+    startup_profiler.report(&app_log, app.getElapsedTime());
     unsigned int task_ctr;
     unsigned int num_scheduled_tasks;
     unsigned int batch_count = 0;
@@ -284,198 +281,10 @@ int main(int argc, char **argv) {
         app.updateStatus();
 
         //Evaluate throughput and engage anti-jamming mode if necessary
-        throughput = evaluate_throughput(throughput_timer, &rhc);
-        summarize_batch(batch_count, throughput, &rhc, mitigation_enabled, jam_mitigation_running, left_edge);
-        if(mitigation_enabled && rhc.valid_payloads_received > 0)
-        {
-            if(rc.anti_jam && !rc.node_is_basestation && batch_count > 3)
-            {
-                //Threshold to start or continue anti-jamming mode
-                if(throughput < rc.jamming_threshold)
-                {
-                    if(jam_mitigation_running)
-                    {
-                        //If jam mitigation has been on for 10 seconds and the throughput is still below
-                        //the threshold, turn it off since it's not working.
-                        if(timer_toc(mitigation_timer) > rc.mitigation_timeout && false)
-                        {
-                            std::stringstream report;
-                            report << scientific << app.getElapsedTime();
-                            report << "    Main: ";
-                            report << "jam mitigation ineffective, resuming normal mode";
-                            std::cout << "jam mitigation ineffective, resuming normal mode" << std::endl;
-                            app_log.log(report.str());
-                            app_log.write_log();
-                            unsigned char* alloc = new unsigned char[RHC_OFDMA_M];
-                            ofdmframe_init_sctype(RHC_OFDMA_M, alloc, .05);
-
-                            if(rc.node_id == 1)
-                            {
-                                rhc.txMCAllocBurst(alloc);
-                            }
-                            memcpy(rhc.new_alloc, alloc, RHC_OFDMA_M);
-
-                            rhc.recreate_modem();
-
-                            jam_mitigation_running = false;
-                            //If the jammer has not been turned off, we'll want to reopen the hole
-                            //in the same place. The resuming variablre is used below to keep it from moving when 
-                            //the hole initially opens back up
-                            resuming = true;
-                            direction *= -1;
-                            timer_tic(enable_mitigation_timer);
-                            mitigation_enabled = false;
-                            sweeping = false;
-                            rs.setU4ScheduleSize(40);
-                            continue;
-                        }
-                    }
-                    //If not already sweeping, switch to anti-jam mode
-                    if(!sweeping)
-                    {
-                        std::stringstream report;
-                        report << scientific << app.getElapsedTime();
-                        report << "    Main: ";
-                        report << "switched to anti-jam mode";
-                        app_log.log(report.str());
-                        app_log.write_log();
-                        timer_tic(mitigation_timer);
-                        jam_mitigation_running = true;
-                        std::cout << "activating anti-jam mode" << std::endl;
-                    }
-
-                    sweeping = true;
-                    rs.setU4ScheduleSize(5);
-                    timer_tic(good_throughput_timer);
-                }
-                //Throughput is above threshold
-                //Jammer might be off or anti-jam mode has found jammer and is successfully mitigating
-                else
-                {
-
-                    check_full_band = true;
-                    timer_tic(mitigation_timer);
-                    //Stop sweeping null nole
-                    sweeping = false;
-                    rs.setU4ScheduleSize(40);
-                    //If a hole is currently open...
-                    if(jam_mitigation_running)
-                    {
-                        //...periodically try closing hole in case jammer has been turned off
-                        if(timer_toc(good_throughput_timer) > rc.close_hole_timeout)
-                        {
-                            std::stringstream report;
-                            report << scientific << app.getElapsedTime();
-                            report << "    Main: ";
-                            report << "resuming normal mode";
-                            std::cout << "resuming normal mode" << std::endl;
-                            app_log.log(report.str());
-                            app_log.write_log();
-                            unsigned char* alloc = new unsigned char[RHC_OFDMA_M];
-                            ofdmframe_init_sctype(RHC_OFDMA_M, alloc, .05);
-                            memcpy(rhc.new_alloc, alloc, RHC_OFDMA_M);
-                            rhc.recreate_modem();
-                            if(rc.node_id == 1)
-                            {
-                                rhc.txMCAllocBurst(alloc);
-                                rhc.txMCAllocBurst(alloc);
-                                rhc.txMCAllocBurst(alloc);
-                                rhc.txMCAllocBurst(alloc);
-                                rhc.txMCAllocBurst(alloc);
-                            }
-                            jam_mitigation_running = false;
-                            //If the jammer has not been turned off, we'll want to reopen the hole
-                            //in the same place. The resuming variablre is used below to keep it from moving when 
-                            //the hole initially opens back up
-                            resuming = true;
-                            direction *= -1;
-                            rs.setU4ScheduleSize(40);
-                            usleep(.05*1000000);
-                        }
-                    }
-                }
-                if(sweeping)
-                {
-                    if(check_full_band && rc.node_id > 1)
-                    {
-                        unsigned char* alloc = new unsigned char[RHC_OFDMA_M];
-                        ofdmframe_init_sctype(RHC_OFDMA_M, alloc, .05);
-                        memcpy(rhc.new_alloc, alloc, RHC_OFDMA_M);
-                        rhc.recreate_modem();
-                        jam_mitigation_running = false;
-                        check_full_band = false;
-                        rs.setU4ScheduleSize(10);
-                    }
-                    else
-                    {
-                        std::stringstream report;
-                        report << scientific << app.getElapsedTime();
-                        report << "    Main: ";
-                        report << "Repositioning null hole, left edge: " << left_edge;
-                        std::cout << "Repositioning null hole, left edge: " << left_edge << std::endl;;
-
-                        app_log.log(report.str());
-                        app_log.write_log();
-                        unsigned char* alloc = new unsigned char[RHC_OFDMA_M];
-                        ofdmframe_init_sctype(RHC_OFDMA_M, alloc, .05);
-                        openNullHole(alloc, left_edge, left_edge + 150);
-                        if(rc.node_id == 1)
-                        {
-                            rhc.txMCAllocBurst(alloc);
-                            rhc.txMCAllocBurst(alloc);
-                            rhc.txMCAllocBurst(alloc);
-                            rhc.txMCAllocBurst(alloc);
-                            rhc.txMCAllocBurst(alloc);
-                        }
-                        memcpy(rhc.new_alloc, alloc, RHC_OFDMA_M);
-                        rhc.recreate_modem();
-                        jam_mitigation_running = true;
-                        if(left_edge <= 0)
-                        {
-                            left_edge = 0;
-                            direction = 1;
-                            check_full_band = true;
-                        }
-                        else if(left_edge >= 412)
-                        {
-                            direction = -1;
-                            check_full_band = true;
-                        }
-                        //After a hole is opened and a jammer is found, the radio will periodically try to 
-                        //fill the whole in case the jammer is gone. If it's not, we want the hole to open 
-                        //again where it was before to stay right on the jammer
-                        //The resuming boolean does this
-                        if(!resuming)
-                            left_edge += (direction * 25); 
-                        else
-                        {
-                            resuming = false;
-                            rs.setU4ScheduleSize(10);
-                        }
-
-                    }
-
-                }
-            }
-        }
-        else
-        {
-            if(!rc.node_is_basestation)
-            {	
-                if(timer_toc(resend_alloc_timer) > 1.0 && rc.node_id == 1)
-                {
-                    timer_tic(resend_alloc_timer);
-                    unsigned char* alloc = new unsigned char[RHC_OFDMA_M];
-                    ofdmframe_init_sctype(RHC_OFDMA_M, alloc, .05);
-                    rhc.txMCAllocBurst(alloc);
-                }
-                if(timer_toc(enable_mitigation_timer) > rc.mitigation_reenable_timeout)
-                {
-                    std::cout << "re-enabling anti-jam mode" << std::endl;
-                    mitigation_enabled = true;
-                }
-            }
-        }
+        throughput = ajc.evaluateThroughput();
+        summarize_batch(batch_count, throughput, &rhc, ajc.isMitigationEnabled(),
+                ajc.isMitigationRunning(), ajc.getLeftEdge());
+        ajc.update(throughput, batch_count);
         if (console_manual_termination_detected) {
             rhc.exit_rx_thread();
             app.setManualTerminationState(true);
@@ -514,6 +323,12 @@ int main(int argc, char **argv) {
     p2m.printFrameStats();
 #endif
 
+#if RHC_ALLOC_TRACKING
+    std::cout << std::endl;
+    if (AllocTracker::report(std::cout) > 0)
+        return(EXIT_FAILURE);
+#endif
+
     return(EXIT_SUCCESS);
 }
 
@@ -0,0 +1,107 @@
+/* replay_main.cc -- Plays an IQ capture through the U4 receive chain
+ *
+ * Builds one node from the usual command line and configuration file with
+ * the RADIO_MODEL_REPLAY radio, runs its continuous receiver (run_mc_rx on
+ * the basestation, run_ofdma_rx on a mobile) until the capture runs out and
+ * reports what was decoded and how much faster than real time the chain
+ * ran.  Set replay_file to a capture recorded with iq_capture_file on a
+ * node with the same node_is_basestation, sample_rate and frame_size.
+ * The same capture always decodes to the same counts, so they serve as a
+ * regression check; the packet log holds the per-packet detail.
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <pthread.h>
+
+#include "AppManager.h"
+#include "Logger.hh"
+#include "PacketStore.hh"
+#include "RadioConfig.hh"
+#include "RadioHardwareConfig.h"
+#include "RadioTaskManager.h"
+#include "ReplayRadioDevice.h"
+#include "StartupProfiler.h"
+#include "timer.h"
+
+using namespace std;
+
+int main(int argc, char **argv) {
+    RadioConfig rc(argc, argv);
+    if (rc.replay_file.empty()) {
+        cerr << "\nERROR in replay_main: ";
+        cerr << "set replay_file to the IQ capture to play back" << endl;
+        exit(EXIT_FAILURE);
+    }
+    rc.radio_hardware = "RADIO_MODEL_REPLAY";
+    rc.iq_capture_file = "";
+    rc.using_tun_tap = false;
+    rc.display_config();
+
+    // Same order of initialization as main.cc
+    StartupProfiler startup_profiler;
+    AppManager app(rc.run_time, rc.debug);
+    Logger app_log(rc.app_log_file);
+    app.doAppLogReport(&app_log, APP_LOG_REPORT_STARTED);
+    Logger rf_log(rc.rf_log_file);
+    timer rx_timer = timer_create();
+    timer_tic(rx_timer);
+    Logger rxf_event_log("rxf_event.log");
+    Logger uhd_error_log("uhd_error.log");
+    PacketStore ps("tap0", rc.node_id, rc.num_nodes_in_net, rc.nodes_in_net,
+            rc.frame_size, rc.using_tun_tap);
+    RadioHardwareConfig rhc(rc.radio_hardware, rc.usrp_address_name,
+            rc.radio_hardware_clock, rc.node_is_basestation, rc.node_id, rc.num_nodes_in_net, rc.frame_size,
+            rc.normal_freq, rc.rf_gain_rx, rc.rf_gain_tx, rc.sample_rate, &app_log, &rf_log,
+            RXF_LOG_LEVEL_FILE_ONLY, &rxf_event_log,
+            UHD_ERROR_LOG_LEVEL_FILE_ONLY, &uhd_error_log,
+            rc.debug, rc.u4, rc.using_tun_tap, &ps, &app, rx_timer, rc.slow, rc.ofdma_tx_window, rc.mc_tx_window,
+            rc.anti_jam, &rc, &startup_profiler);
+    ReplayRadioDevice* replay = dynamic_cast<ReplayRadioDevice*>(rhc.radio_device);
+
+    // The receiver stops at the end of the capture rather than after run_time
+    rx_thread_args_t rx_thread_args;
+    rx_thread_args.run_time = 0.0;
+    rx_thread_args.rhc_ptr = &rhc;
+    rx_thread_args.timer = rx_timer;
+
+    unsigned long long calibration_samps = replay->getSampsDelivered();
+    timer t0 = timer_create();
+    timer_tic(t0);
+    pthread_t rx_thread;
+    if (pthread_create(&rx_thread, NULL, rc.node_is_basestation ? run_mc_rx : run_ofdma_rx,
+                (void*)&rx_thread_args) != 0) {
+        cerr << "\nERROR in replay_main: unable to create the rx thread" << endl;
+        exit(EXIT_FAILURE);
+    }
+    pthread_join(rx_thread, NULL);
+    double elapsed = timer_toc(t0);
+    timer_destroy(t0);
+
+    unsigned long long samps = replay->getSampsDelivered() - calibration_samps;
+    double capture_time = (double)samps / replay->getCaptureRate();
+    cout << endl;
+    cout << "Replayed " << samps << " samples (" << capture_time << " s of capture, ";
+    cout << calibration_samps << " more for noise calibration) through ";
+    cout << (rc.node_is_basestation ? "run_mc_rx" : "run_ofdma_rx") << endl;
+    cout << "  wall time:           " << elapsed << " s" << endl;
+    if (elapsed > 0.0) {
+        cout << "  rate:                " << 1.0E-6 * samps / elapsed << " MS/s, ";
+        cout << capture_time / elapsed << " x real time" << endl;
+    }
+    cout << "  valid payloads:      " << rhc.valid_payloads_received << endl;
+    cout << "  valid bytes:         " << rhc.valid_bytes_received << endl;
+    cout << "  invalid headers:     " << rhc.invalid_headers_received << endl;
+    cout << "  invalid payloads:    " << rhc.invalid_payloads_received << endl;
+
+#if RHC_ALLOC_TRACKING
+    cout << endl;
+    if (AllocTracker::report(cout) > 0)
+        return(EXIT_FAILURE);
+#endif
+
+    return(EXIT_SUCCESS);
+}
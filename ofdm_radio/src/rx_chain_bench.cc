@@ -0,0 +1,475 @@
+/* rx_chain_bench.cc -- Throughput of the U4 receive chains
+ *
+ * Synthesizes frames with the waveform's own generators and times the
+ * receivers as run_ofdma_rx and run_mc_rx drive them:
+ *
+ *   ofdma_rx     mobile: the rresamp front end and the multi-user
+ *                ofdmflexframesync (RHC_OFDMA_M subcarriers, RHC_cp_len,
+ *                RHC_taper_len, the default sctype allocation, RHC_ms),
+ *                with the payload FEC off and with RHC_fec0 + RS(M8)
+ *   mc_rx        basestation: multichannelrx over 1 to 16 uplink channels
+ *                carrying RHC_fec0 + RS(M8) frames, as the mobiles send
+ *   rx_frontend  the front end alone, one block call per packet: the fused
+ *                polyphase rresamp decimator the radio runs, and the
+ *                31-tap prefilter + msresamp chain it replaced
+ *                ("prefilt+msr", reference only)
+ *
+ * Each case reports MS/s per core (device-rate samples over the thread's
+ * CPU time), frames decoded per second, cycles per sample (time stamp
+ * counter, x86 only) and how many times real time that is at the device
+ * rate of RHC_NOMINAL_RESAMPLER_RATIO * sample_rate.  -j writes the same
+ * results as JSON; with -r the exit status is nonzero when any case that
+ * runs on a radio falls short of real time.
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <complex>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <liquid/liquid.h>
+#include <liquid/multichannelrx.h>
+#include <liquid/multichanneltx.h>
+
+#include "RadioHardwareConfig.h"
+#include "ChainBench.h"
+
+using namespace std;
+
+// Zero symbols between synthesized frames, as the tx window leaves idle air
+#define RX_BENCH_GAP_SYMBOLS                        4
+// Receiver noise floor of the synthesized signal, dB below full scale
+#define RX_BENCH_NOISE_FLOOR_DB                     -60.0f
+// Scale the mobiles apply to multichanneltx output before sending
+#define RX_BENCH_MC_TX_SCALE                        0.1f
+
+typedef struct {
+    double sample_rate;
+    unsigned int frame_size;
+    unsigned int num_users;
+    unsigned int num_frames;
+    unsigned int min_samples;
+    std::string json_file;
+    bool require_realtime;
+} rx_bench_opts_t;
+
+typedef struct {
+    unsigned int headers_valid;
+    unsigned int payloads_valid;
+} rx_bench_counts_t;
+
+int benchCallback(
+        unsigned char *  _header,
+        int              _header_valid,
+        unsigned char *  _payload,
+        unsigned int     _payload_len,
+        int              _payload_valid,
+        framesyncstats_s _stats,
+        void *           _userdata
+        )
+{
+    rx_bench_counts_t* counts = (rx_bench_counts_t*)_userdata;
+    if (_header_valid)
+        counts->headers_valid++;
+    if (_header_valid && _payload_valid)
+        counts->payloads_valid++;
+    return(0);
+}
+
+void usage()
+{
+    cout << "U4_rx_bench -- throughput of the U4 receive chains" << endl;
+    cout << "  -s <rate>   modem sample rate [S/s], default 5e6" << endl;
+    cout << "  -f <bytes>  frame (payload) size, default 1024" << endl;
+    cout << "  -u <users>  OFDMA users (mobiles), default 3" << endl;
+    cout << "  -n <num>    frames synthesized per case, default 20" << endl;
+    cout << "  -t <num>    minimum samples processed per case, default 2e7" << endl;
+    cout << "  -j <file>   write results as JSON" << endl;
+    cout << "  -r          exit with failure if a radio case is below real time" << endl;
+}
+
+void addNoise(std::vector<std::complex<float> >& x)
+{
+    float noise_std = sqrtf(0.5f * powf(10.0f, RX_BENCH_NOISE_FLOOR_DB / 10.0f));
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] += noise_std * std::complex<float>(randnf(), randnf());
+}
+
+void fillPayload(std::vector<unsigned char>& payload)
+{
+    for (size_t i = 0; i < payload.size(); i++)
+        payload[i] = rand() & 0xff;
+}
+
+void initHeader(unsigned char* header, unsigned char source_id)
+{
+    memset(header, 0, RHC_FRAME_HEADER_DEFAULT_SIZE);
+    header[P2M_HEADER_FIELD_SOURCE_ID] = source_id;
+    header[P2M_HEADER_FIELD_DESTINATION_ID] = P2M_DESTINATION_ID_BROADCAST;
+    header[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_DATA;
+}
+
+// Downlink frames from the basestation's multi-user generator, at the
+// device rate after the transmit resampler
+std::vector<std::complex<float> > synthesizeOfdma(
+        const rx_bench_opts_t& opts,
+        unsigned char* allocation,
+        int fec0,
+        int fec1
+        )
+{
+    ofdmflexframegenprops_s fgprops;
+    ofdmflexframegenprops_init_default(&fgprops);
+    fgprops.check = RHC_check;
+    fgprops.fec0 = fec0;
+    fgprops.fec1 = fec1;
+    fgprops.mod_scheme = RHC_ms;
+    ofdmflexframegen gen = ofdmflexframegen_create_multi_user(RHC_OFDMA_M, RHC_cp_len,
+            RHC_taper_len, allocation, &fgprops, opts.num_users);
+    msresamp_crcf tx_resamp = msresamp_crcf_create((float)RHC_NOMINAL_RESAMPLER_RATIO, 60.0f);
+
+    std::vector<unsigned char> payload(opts.frame_size);
+    unsigned char header[RHC_FRAME_HEADER_DEFAULT_SIZE];
+    initHeader(header, opts.num_users + 1);
+    std::vector<std::complex<float> > symbol(RHC_OFDMA_SYMBOL_LENGTH);
+    std::vector<std::complex<float> > resampled(2 * RHC_NOMINAL_RESAMPLER_RATIO *
+            RHC_OFDMA_SYMBOL_LENGTH);
+    std::vector<std::complex<float> > y;
+
+    for (unsigned int f = 0; f < opts.num_frames; f++) {
+        for (unsigned int u = 0; u < opts.num_users; u++) {
+            fillPayload(payload);
+            ofdmflexframegen_multi_user_update_data(gen, &payload[0], opts.frame_size, u);
+        }
+        ofdmflexframegen_assemble_multi_user(gen, header);
+        int last_symbol = 0;
+        unsigned int gap = RX_BENCH_GAP_SYMBOLS;
+        while (!last_symbol || gap > 0) {
+            if (!last_symbol) {
+                last_symbol = ofdmflexframegen_writesymbol(gen, &symbol[0]);
+            } else {
+                gap--;
+                std::fill(symbol.begin(), symbol.end(), std::complex<float>(0.0f, 0.0f));
+            }
+            unsigned int nw = 0;
+            msresamp_crcf_execute(tx_resamp, &symbol[0], RHC_OFDMA_SYMBOL_LENGTH,
+                    &resampled[0], &nw);
+            for (unsigned int i = 0; i < nw; i++)
+                y.push_back(0.1f * resampled[i]);
+        }
+    }
+
+    msresamp_crcf_destroy(tx_resamp);
+    ofdmflexframegen_destroy_multi_user(gen);
+    addNoise(y);
+    return(y);
+}
+
+// Uplink frames from every mobile at once, each on its own channel
+std::vector<std::complex<float> > synthesizeMultichannel(
+        const rx_bench_opts_t& opts,
+        unsigned int num_channels,
+        unsigned char* allocation
+        )
+{
+    unsigned int subcarriers_per_channel = RHC_OFDMA_M / num_channels;
+    multichanneltx mctx(num_channels, subcarriers_per_channel, RHC_cp_len, RHC_taper_len,
+            allocation);
+
+    std::vector<unsigned char> payload(opts.frame_size);
+    unsigned char header[RHC_FRAME_HEADER_DEFAULT_SIZE];
+    std::vector<unsigned int> frames_sent(num_channels, 0);
+    std::vector<std::complex<float> > buffer(2 * num_channels);
+    std::vector<std::complex<float> > y;
+
+    // Run until every channel has sent its frames, plus a frame gap
+    unsigned int tail = RX_BENCH_GAP_SYMBOLS * (subcarriers_per_channel + RHC_cp_len);
+    while (tail > 0) {
+        bool all_done = true;
+        for (unsigned int c = 0; c < num_channels; c++) {
+            if (!mctx.IsChannelReadyForData(c)) {
+                all_done = false;
+            } else if (frames_sent[c] < opts.num_frames) {
+                initHeader(header, c + 1);
+                fillPayload(payload);
+                mctx.UpdateData(c, header, &payload[0], opts.frame_size, RHC_ms, RHC_fec0,
+                        LIQUID_FEC_RS_M8);
+                frames_sent[c]++;
+                all_done = false;
+            }
+        }
+        if (all_done)
+            tail--;
+        mctx.GenerateSamples(&buffer[0]);
+        for (unsigned int i = 0; i < buffer.size(); i++)
+            y.push_back(RX_BENCH_MC_TX_SCALE * buffer[i]);
+    }
+
+    addNoise(y);
+    return(y);
+}
+
+// Passes over the synthesized signal until at least min_samples were run
+unsigned int numPasses(const rx_bench_opts_t& opts, size_t num_samples)
+{
+    return((unsigned int)((opts.min_samples + num_samples - 1) / num_samples));
+}
+
+void setRates(
+        ChainBenchResult& result,
+        ChainBenchTimer& timer,
+        double num_samples,
+        double num_frames,
+        double device_rate
+        )
+{
+    double msps = 1.0E-6 * num_samples / timer.getCpuTime();
+    result.set("samples", num_samples);
+    result.set("wall_time", timer.getWallTime());
+    result.set("cpu_time", timer.getCpuTime());
+    result.set("msps_per_core", msps);
+    result.set("frames_per_sec", num_frames / timer.getCpuTime());
+    if (ChainBenchTimer::hasCycles())
+        result.set("cycles_per_sample", timer.getCycles() / num_samples);
+    result.set("realtime_factor", 1.0E6 * msps / device_rate);
+}
+
+ChainBenchResult benchOfdmaRx(
+        const rx_bench_opts_t& opts,
+        std::string fec_name,
+        int fec0,
+        int fec1
+        )
+{
+    unsigned char allocation[RHC_OFDMA_M];
+    ofdmframe_init_sctype(RHC_OFDMA_M, allocation, .05);
+    std::vector<std::complex<float> > x = synthesizeOfdma(opts, allocation, fec0, fec1);
+
+    rx_bench_counts_t counts = {0, 0};
+    ofdmflexframesync sync = ofdmflexframesync_create_multi_user(RHC_OFDMA_M, RHC_cp_len,
+            RHC_taper_len, allocation, benchCallback, (void*)&counts, 0, opts.num_users);
+    rresamp_crcf rx_rresamp = rresamp_crcf_create(1, RHC_NOMINAL_RESAMPLER_RATIO,
+            RHC_RX_RESAMP_SEMI_LENGTH, RHC_RX_RESAMP_BANDWIDTH, RHC_RX_RESAMP_STOPBAND_ATTEN);
+    // One UHD packet's worth of samples per block call
+    const size_t packet_size = RHC_RX_RECOMMENDED_SAMPLE_SIZE_DEFAULT;
+    std::vector<std::complex<float> > resampled(packet_size + 64);
+
+    unsigned int passes = numPasses(opts, x.size());
+    ChainBenchTimer timer;
+    timer.start();
+    for (unsigned int p = 0; p < passes; p++) {
+        for (size_t j = 0; j < x.size(); j += packet_size) {
+            unsigned int n = (unsigned int)std::min(packet_size, x.size() - j);
+            unsigned int nw;
+            rresamp_crcf_execute(rx_rresamp, &x[j], n, &resampled[0], &nw);
+            ofdmflexframesync_execute(sync, &resampled[0], nw);
+        }
+    }
+    timer.stop();
+
+    ofdmflexframesync_destroy(sync);
+    rresamp_crcf_destroy(rx_rresamp);
+
+    ChainBenchResult result("ofdma_rx");
+    result.set("fec", fec_name);
+    result.set("num_users", (double)opts.num_users);
+    result.set("frames_sent", (double)passes * opts.num_frames);
+    result.set("frames_decoded", (double)counts.payloads_valid);
+    setRates(result, timer, (double)passes * x.size(), counts.payloads_valid,
+            RHC_NOMINAL_RESAMPLER_RATIO * opts.sample_rate);
+    return(result);
+}
+
+ChainBenchResult benchMultichannelRx(
+        const rx_bench_opts_t& opts,
+        unsigned int num_channels
+        )
+{
+    unsigned int subcarriers_per_channel = RHC_OFDMA_M / num_channels;
+    std::vector<unsigned char> allocation(subcarriers_per_channel);
+    ofdmframe_init_sctype(subcarriers_per_channel, &allocation[0], .05);
+    std::vector<std::complex<float> > x = synthesizeMultichannel(opts, num_channels,
+            &allocation[0]);
+
+    rx_bench_counts_t counts = {0, 0};
+    std::vector<void*> userdata(num_channels, (void*)&counts);
+    std::vector<framesync_callback> callbacks(num_channels, benchCallback);
+    multichannelrx* mcrx = new multichannelrx(num_channels, subcarriers_per_channel,
+            RHC_cp_len, RHC_taper_len, &allocation[0], &userdata[0], &callbacks[0]);
+
+    unsigned int passes = numPasses(opts, x.size());
+    ChainBenchTimer timer;
+    timer.start();
+    for (unsigned int p = 0; p < passes; p++) {
+        for (size_t j = 0; j < x.size(); j++) {
+            std::complex<float> usrp_sample = x[j];
+            mcrx->Execute(&usrp_sample, 1);
+        }
+    }
+    timer.stop();
+    delete mcrx;
+
+    ChainBenchResult result("mc_rx");
+    result.set("fec", "v27+rs8");
+    result.set("num_channels", (double)num_channels);
+    result.set("frames_sent", (double)passes * opts.num_frames * num_channels);
+    result.set("frames_decoded", (double)counts.payloads_valid);
+    setRates(result, timer, (double)passes * x.size(), counts.payloads_valid,
+            RHC_NOMINAL_RESAMPLER_RATIO * opts.sample_rate);
+    return(result);
+}
+
+ChainBenchResult benchFrontEnd(
+        const rx_bench_opts_t& opts,
+        bool fused
+        )
+{
+    unsigned char allocation[RHC_OFDMA_M];
+    ofdmframe_init_sctype(RHC_OFDMA_M, allocation, .05);
+    std::vector<std::complex<float> > x = synthesizeOfdma(opts, allocation,
+            LIQUID_FEC_NONE, LIQUID_FEC_NONE);
+
+    rresamp_crcf rx_rresamp = rresamp_crcf_create(1, RHC_NOMINAL_RESAMPLER_RATIO,
+            RHC_RX_RESAMP_SEMI_LENGTH, RHC_RX_RESAMP_BANDWIDTH, RHC_RX_RESAMP_STOPBAND_ATTEN);
+    firfilt_crcf rx_prefilt = firfilt_crcf_create_kaiser(31, 0.24f, 60.0f, 0.0f);
+    msresamp_crcf rx_resamp = msresamp_crcf_create(1.0f / RHC_NOMINAL_RESAMPLER_RATIO, 60.0f);
+    // One UHD packet's worth of samples per block call
+    const size_t packet_size = RHC_RX_RECOMMENDED_SAMPLE_SIZE_DEFAULT;
+    std::vector<std::complex<float> > filtered(packet_size);
+    std::vector<std::complex<float> > resampled(packet_size + 64);
+    double sink = 0.0;
+
+    unsigned int passes = numPasses(opts, x.size());
+    ChainBenchTimer timer;
+    timer.start();
+    for (unsigned int p = 0; p < passes; p++) {
+        for (size_t j = 0; j < x.size(); j += packet_size) {
+            unsigned int n = (unsigned int)std::min(packet_size, x.size() - j);
+            unsigned int nw;
+            if (fused) {
+                rresamp_crcf_execute(rx_rresamp, &x[j], n, &resampled[0], &nw);
+            } else {
+                firfilt_crcf_execute_block(rx_prefilt, &x[j], n, &filtered[0]);
+                msresamp_crcf_execute(rx_resamp, &filtered[0], n, &resampled[0], &nw);
+            }
+            if (nw > 0)
+                sink += resampled[0].real();
+        }
+    }
+    timer.stop();
+
+    rresamp_crcf_destroy(rx_rresamp);
+    firfilt_crcf_destroy(rx_prefilt);
+    msresamp_crcf_destroy(rx_resamp);
+
+    ChainBenchResult result("rx_frontend");
+    result.set("mode", fused ? "rresamp" : "prefilt+msr");
+    // Keeps the loop from being optimized away
+    result.set("checksum", sink);
+    setRates(result, timer, (double)passes * x.size(), 0.0,
+            RHC_NOMINAL_RESAMPLER_RATIO * opts.sample_rate);
+    return(result);
+}
+
+int main(int argc, char **argv) {
+    rx_bench_opts_t opts;
+    opts.sample_rate = 5.0e6;
+    opts.frame_size = 1024;
+    opts.num_users = 3;
+    opts.num_frames = 20;
+    opts.min_samples = 20000000;
+    opts.require_realtime = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "hs:f:u:n:t:j:r")) != -1) {
+        switch (c) {
+            case 'h': usage(); return(EXIT_SUCCESS);
+            case 's': opts.sample_rate = atof(optarg); break;
+            case 'f': opts.frame_size = atoi(optarg); break;
+            case 'u': opts.num_users = atoi(optarg); break;
+            case 'n': opts.num_frames = atoi(optarg); break;
+            case 't': opts.min_samples = (unsigned int)atof(optarg); break;
+            case 'j': opts.json_file = optarg; break;
+            case 'r': opts.require_realtime = true; break;
+            default:  usage(); return(EXIT_FAILURE);
+        }
+    }
+    if ((opts.num_users == 0) || (opts.num_frames == 0) || (opts.frame_size == 0) ||
+            (opts.sample_rate <= 0.0)) {
+        cerr << "\nERROR in rx_chain_bench: ";
+        cerr << "users, frames, frame size and sample rate must be positive" << endl;
+        exit(EXIT_FAILURE);
+    }
+    // Same synthesized signal on every run
+    srand(1);
+
+    std::vector<ChainBenchResult> results;
+    results.push_back(benchOfdmaRx(opts, "none", LIQUID_FEC_NONE, LIQUID_FEC_NONE));
+    results.push_back(benchOfdmaRx(opts, "v27+rs8", RHC_fec0, LIQUID_FEC_RS_M8));
+    for (unsigned int num_channels = 1; num_channels <= 16; num_channels *= 2)
+        results.push_back(benchMultichannelRx(opts, num_channels));
+    results.push_back(benchFrontEnd(opts, true));
+    results.push_back(benchFrontEnd(opts, false));
+
+    double device_rate = RHC_NOMINAL_RESAMPLER_RATIO * opts.sample_rate;
+    cout << "Receive chains at " << 1.0E-6 * device_rate << " MS/s device rate, frame_size ";
+    cout << opts.frame_size << endl << endl;
+    cout << "case         variant           MS/s  x realtime   decoded/sent   frames/s  cycles/sample" << endl;
+    bool realtime = true;
+    for (unsigned int i = 0; i < results.size(); i++) {
+        ChainBenchResult& result = results[i];
+        stringstream variant;
+        if (result.getName() == "ofdma_rx")
+            variant << (int)result.get("num_users") << "u " << result.getText("fec");
+        else if (result.getName() == "mc_rx")
+            variant << (int)result.get("num_channels") << "ch " << result.getText("fec");
+        else
+            variant << result.getText("mode");
+        cout << left << setw(13) << result.getName() << setw(14) << variant.str() << right;
+        cout << fixed << setprecision(2);
+        cout << setw(9) << result.get("msps_per_core");
+        cout << setw(12) << result.get("realtime_factor");
+        if (result.getName() == "rx_frontend") {
+            cout << setw(15) << "-";
+            cout << setw(11) << "-";
+        } else {
+            stringstream ratio;
+            ratio << (int)result.get("frames_decoded") << "/" << (int)result.get("frames_sent");
+            cout << setw(15) << ratio.str();
+            cout << setw(11) << setprecision(1) << result.get("frames_per_sec");
+        }
+        if (ChainBenchTimer::hasCycles())
+            cout << setw(15) << setprecision(1) << result.get("cycles_per_sample");
+        else
+            cout << setw(15) << "-";
+        cout << endl;
+        cout.unsetf(ios_base::floatfield);
+        cout << setprecision(6);
+        // The block front end is a comparison, not what runs on the radio
+        if ((result.get("realtime_factor") < 1.0) && (result.getText("mode") != "prefilt+msr"))
+            realtime = false;
+    }
+
+    if (!opts.json_file.empty()) {
+        ChainBenchResult settings("U4_rx_bench");
+        settings.set("sample_rate", opts.sample_rate);
+        settings.set("device_rate", device_rate);
+        settings.set("frame_size", (double)opts.frame_size);
+        settings.set("num_users", (double)opts.num_users);
+        settings.set("num_frames", (double)opts.num_frames);
+        ofstream json(opts.json_file.c_str());
+        writeChainBenchJson(json, settings, results);
+    }
+
+    if (opts.require_realtime && !realtime) {
+        cerr << "\nrx_chain_bench: a receive chain is slower than real time" << endl;
+        return(EXIT_FAILURE);
+    }
+    return(EXIT_SUCCESS);
+}
@@ -0,0 +1,34 @@
+/* sim_main.cc -- Runs a whole U4 network in one process over simulated links
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <cstdlib>
+#include <csignal>
+
+#include "NetworkSimulator.h"
+
+volatile sig_atomic_t console_manual_termination_detected = false;
+void consoleSignalHandler(int s) {
+    console_manual_termination_detected = true;
+}
+
+int main(int argc, char **argv) {
+    signal(SIGINT, consoleSignalHandler);
+    signal(SIGTERM, consoleSignalHandler);
+    signal(SIGABRT, consoleSignalHandler);
+
+    // Takes the same command line and configuration file as U4
+    NetworkSimulator sim(argc, argv);
+    sim.run(&console_manual_termination_detected);
+    sim.printReport();
+
+#if RHC_ALLOC_TRACKING
+    std::cout << std::endl;
+    if (AllocTracker::report(std::cout) > 0)
+        return(EXIT_FAILURE);
+#endif
+
+    return(EXIT_SUCCESS);
+}
@@ -0,0 +1,359 @@
+/* tx_chain_bench.cc -- Throughput of the U4 transmit chains
+ *
+ * Times frame generation the way txOFDMAFrameBurst and txMCFrameBurst do
+ * it, without a radio:
+ *
+ *   ofdma_tx     basestation downlink: the multi-user ofdmflexframegen
+ *                (update_data per user, assemble_multi_user, writesymbol
+ *                with one zero pad symbol) and the transmit msresamp, for
+ *                1 to 32 users, frame sizes of 256 to 4096 bytes and the
+ *                payload FEC off or RHC_fec0 + RS(M8) as with hardened
+ *   mc_tx        mobile uplink: multichanneltx::UpdateData on the mobile's
+ *                channel and GenerateSamples until the channel is free
+ *                again, for 1 to 16 channels
+ *
+ * Each case reports frames per second and microseconds per frame (thread
+ * CPU time), the frame's airtime at the device rate and the duty cycle one
+ * core can sustain: airtime over generation time, capped at 1.  The time
+ * to create the generator is reported on its own, since the radio creates
+ * it at start-up and on reallocation rather than per frame.  The summary
+ * lists how many mobiles one core can feed at a full downlink duty cycle.
+ *
+ * Distribution Statement “A” (Approved for Public Release, Distribution Unlimited)
+ *
+ */
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <complex>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <liquid/liquid.h>
+#include <liquid/multichanneltx.h>
+
+#include "RadioHardwareConfig.h"
+#include "ChainBench.h"
+
+using namespace std;
+
+// Software backoff the radio applies to resampled downlink samples
+#define TX_BENCH_SOFTWARE_BACKOFF                   0.1f
+// Scale the mobiles apply to multichanneltx output before sending
+#define TX_BENCH_MC_TX_SCALE                        0.1f
+
+typedef struct {
+    double sample_rate;
+    unsigned int num_frames;
+    std::string json_file;
+    bool require_realtime;
+} tx_bench_opts_t;
+
+static const unsigned int tx_bench_users[] = {1, 2, 4, 8, 16, 32};
+static const unsigned int tx_bench_channels[] = {1, 2, 4, 8, 16};
+static const unsigned int tx_bench_frame_sizes[] = {256, 1024, 4096};
+
+void usage()
+{
+    cout << "U4_tx_bench -- throughput of the U4 transmit chains" << endl;
+    cout << "  -s <rate>   modem sample rate [S/s], default 5e6" << endl;
+    cout << "  -n <num>    frames generated per case, default 20" << endl;
+    cout << "  -j <file>   write results as JSON" << endl;
+    cout << "  -r          exit with failure if a downlink case with the radio's" << endl;
+    cout << "              default 3 mobiles cannot sustain a full duty cycle" << endl;
+}
+
+void fillPayload(std::vector<unsigned char>& payload)
+{
+    for (size_t i = 0; i < payload.size(); i++)
+        payload[i] = rand() & 0xff;
+}
+
+void initHeader(unsigned char* header, unsigned char source_id)
+{
+    memset(header, 0, RHC_FRAME_HEADER_DEFAULT_SIZE);
+    header[P2M_HEADER_FIELD_SOURCE_ID] = source_id;
+    header[P2M_HEADER_FIELD_DESTINATION_ID] = P2M_DESTINATION_ID_BROADCAST;
+    header[P2M_HEADER_FIELD_FRAME_TYPE] = P2M_FRAME_TYPE_DATA;
+}
+
+void setRates(
+        ChainBenchResult& result,
+        ChainBenchTimer& timer,
+        double num_frames,
+        double num_samples,
+        double device_rate
+        )
+{
+    double us_per_frame = 1.0E6 * timer.getCpuTime() / num_frames;
+    double airtime_us = 1.0E6 * num_samples / num_frames / device_rate;
+    result.set("frames", num_frames);
+    result.set("samples", num_samples);
+    result.set("wall_time", timer.getWallTime());
+    result.set("cpu_time", timer.getCpuTime());
+    result.set("frames_per_sec", num_frames / timer.getCpuTime());
+    result.set("us_per_frame", us_per_frame);
+    result.set("airtime_us", airtime_us);
+    result.set("airtime_factor", airtime_us / us_per_frame);
+    result.set("duty_cycle", std::min(1.0, airtime_us / us_per_frame));
+    if (ChainBenchTimer::hasCycles())
+        result.set("cycles_per_sample", timer.getCycles() / num_samples);
+}
+
+ChainBenchResult benchOfdmaTx(
+        const tx_bench_opts_t& opts,
+        unsigned int num_users,
+        unsigned int frame_size,
+        std::string fec_name,
+        int fec0,
+        int fec1
+        )
+{
+    unsigned char allocation[RHC_OFDMA_M];
+    ofdmframe_init_sctype(RHC_OFDMA_M, allocation, .05);
+    ofdmflexframegenprops_s fgprops;
+    ofdmflexframegenprops_init_default(&fgprops);
+    fgprops.check = RHC_check;
+    fgprops.fec0 = fec0;
+    fgprops.fec1 = fec1;
+    fgprops.mod_scheme = RHC_ms;
+
+    ChainBenchTimer create_timer;
+    create_timer.start();
+    ofdmflexframegen gen = ofdmflexframegen_create_multi_user(RHC_OFDMA_M, RHC_cp_len,
+            RHC_taper_len, allocation, &fgprops, num_users);
+    create_timer.stop();
+    float tx_resamp_rate = (float)RHC_NOMINAL_RESAMPLER_RATIO;
+    msresamp_crcf tx_resamp = msresamp_crcf_create(tx_resamp_rate, 60.0f);
+
+    // Fresh payloads for every user and frame, prepared outside the timing
+    std::vector<std::vector<unsigned char> > payloads(num_users * opts.num_frames,
+            std::vector<unsigned char>(frame_size));
+    for (size_t i = 0; i < payloads.size(); i++)
+        fillPayload(payloads[i]);
+    unsigned char header[RHC_FRAME_HEADER_DEFAULT_SIZE];
+    initHeader(header, num_users + 1);
+    std::complex<float> ofdm_symbol[RHC_OFDMA_SYMBOL_LENGTH];
+    std::vector<std::complex<float> > resampled((int)(2 * tx_resamp_rate) *
+            RHC_OFDMA_SYMBOL_LENGTH);
+    std::vector<std::complex<float> > tx_usrp_buffer(resampled.size());
+    double num_samples = 0.0;
+
+    ChainBenchTimer timer;
+    timer.start();
+    for (unsigned int f = 0; f < opts.num_frames; f++) {
+        for (unsigned int u = 0; u < num_users; u++) {
+            ofdmflexframegen_multi_user_update_data(gen, &payloads[f * num_users + u][0],
+                    frame_size, u);
+        }
+        ofdmflexframegen_assemble_multi_user(gen, header);
+
+        int last_symbol = 0;
+        unsigned int zero_pad = 1;
+        while (!last_symbol || zero_pad > 0) {
+            if (!last_symbol) {
+                last_symbol = ofdmflexframegen_writesymbol(gen, ofdm_symbol);
+            } else {
+                zero_pad--;
+                for (unsigned int i = 0; i < RHC_OFDMA_SYMBOL_LENGTH; i++)
+                    ofdm_symbol[i] = 0.0f;
+            }
+            unsigned int tx_nw = 0;
+            msresamp_crcf_execute(tx_resamp, ofdm_symbol, RHC_OFDMA_SYMBOL_LENGTH,
+                    &resampled[0], &tx_nw);
+            for (unsigned int i = 0; i < tx_nw; i++)
+                tx_usrp_buffer[i] = TX_BENCH_SOFTWARE_BACKOFF * resampled[i];
+            num_samples += tx_nw;
+        }
+    }
+    timer.stop();
+
+    msresamp_crcf_destroy(tx_resamp);
+    ofdmflexframegen_destroy_multi_user(gen);
+
+    ChainBenchResult result("ofdma_tx");
+    result.set("fec", fec_name);
+    result.set("num_users", (double)num_users);
+    result.set("frame_size", (double)frame_size);
+    result.set("create_us", 1.0E6 * create_timer.getCpuTime());
+    setRates(result, timer, opts.num_frames, num_samples,
+            RHC_NOMINAL_RESAMPLER_RATIO * opts.sample_rate);
+    return(result);
+}
+
+ChainBenchResult benchMultichannelTx(
+        const tx_bench_opts_t& opts,
+        unsigned int num_channels,
+        unsigned int frame_size,
+        std::string fec_name,
+        int fec0,
+        int fec1
+        )
+{
+    unsigned int subcarriers_per_channel = RHC_OFDMA_M / num_channels;
+    std::vector<unsigned char> allocation(subcarriers_per_channel);
+    ofdmframe_init_sctype(subcarriers_per_channel, &allocation[0], .05);
+
+    ChainBenchTimer create_timer;
+    create_timer.start();
+    multichanneltx* mctx = new multichanneltx(num_channels, subcarriers_per_channel,
+            RHC_cp_len, RHC_taper_len, &allocation[0]);
+    create_timer.stop();
+
+    std::vector<std::vector<unsigned char> > payloads(opts.num_frames,
+            std::vector<unsigned char>(frame_size));
+    for (size_t i = 0; i < payloads.size(); i++)
+        fillPayload(payloads[i]);
+    // The mobile sends on its own channel; the others stay idle
+    const unsigned int channel = 0;
+    unsigned char header[RHC_FRAME_HEADER_DEFAULT_SIZE];
+    initHeader(header, channel + 1);
+    unsigned int mctx_buffer_len = 2 * num_channels;
+    std::vector<std::complex<float> > mctx_buffer(mctx_buffer_len);
+    std::vector<std::complex<float> > tx_usrp_buffer(mctx_buffer_len);
+    double num_samples = 0.0;
+
+    ChainBenchTimer timer;
+    timer.start();
+    for (unsigned int f = 0; f < opts.num_frames; f++) {
+        mctx->UpdateData(channel, header, &payloads[f][0], frame_size, RHC_ms, fec0, fec1);
+        while (!mctx->IsChannelReadyForData(channel)) {
+            mctx->GenerateSamples(&mctx_buffer[0]);
+            for (unsigned int i = 0; i < mctx_buffer_len; i++)
+                tx_usrp_buffer[i] = TX_BENCH_MC_TX_SCALE * mctx_buffer[i];
+            num_samples += mctx_buffer_len;
+        }
+    }
+    timer.stop();
+    delete mctx;
+
+    ChainBenchResult result("mc_tx");
+    result.set("fec", fec_name);
+    result.set("num_channels", (double)num_channels);
+    result.set("frame_size", (double)frame_size);
+    result.set("create_us", 1.0E6 * create_timer.getCpuTime());
+    setRates(result, timer, opts.num_frames, num_samples,
+            RHC_NOMINAL_RESAMPLER_RATIO * opts.sample_rate);
+    return(result);
+}
+
+void printResult(ChainBenchResult& result)
+{
+    stringstream variant;
+    if (result.getName() == "ofdma_tx")
+        variant << (int)result.get("num_users") << "u ";
+    else
+        variant << (int)result.get("num_channels") << "ch ";
+    variant << (int)result.get("frame_size") << "B " << result.getText("fec");
+
+    cout << left << setw(10) << result.getName() << setw(20) << variant.str() << right;
+    cout << fixed << setprecision(1);
+    cout << setw(10) << result.get("frames_per_sec");
+    cout << setw(12) << result.get("us_per_frame");
+    cout << setw(12) << result.get("airtime_us");
+    cout << setprecision(2);
+    cout << setw(8) << result.get("duty_cycle");
+    cout << setprecision(1);
+    cout << setw(11) << result.get("create_us");
+    cout << endl;
+    cout.unsetf(ios_base::floatfield);
+    cout << setprecision(6);
+}
+
+int main(int argc, char **argv) {
+    tx_bench_opts_t opts;
+    opts.sample_rate = 5.0e6;
+    opts.num_frames = 20;
+    opts.require_realtime = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "hs:n:j:r")) != -1) {
+        switch (c) {
+            case 'h': usage(); return(EXIT_SUCCESS);
+            case 's': opts.sample_rate = atof(optarg); break;
+            case 'n': opts.num_frames = atoi(optarg); break;
+            case 'j': opts.json_file = optarg; break;
+            case 'r': opts.require_realtime = true; break;
+            default:  usage(); return(EXIT_FAILURE);
+        }
+    }
+    if ((opts.num_frames == 0) || (opts.sample_rate <= 0.0)) {
+        cerr << "\nERROR in tx_chain_bench: ";
+        cerr << "frames and sample rate must be positive" << endl;
+        exit(EXIT_FAILURE);
+    }
+    srand(1);
+
+    const char* fec_names[2] = {"none", "v27+rs8"};
+    const int fec0s[2] = {LIQUID_FEC_NONE, RHC_fec0};
+    const int fec1s[2] = {LIQUID_FEC_NONE, LIQUID_FEC_RS_M8};
+    const unsigned int num_sizes = sizeof(tx_bench_frame_sizes) / sizeof(tx_bench_frame_sizes[0]);
+    const unsigned int num_user_counts = sizeof(tx_bench_users) / sizeof(tx_bench_users[0]);
+    const unsigned int num_channel_counts = sizeof(tx_bench_channels) / sizeof(tx_bench_channels[0]);
+
+    double device_rate = RHC_NOMINAL_RESAMPLER_RATIO * opts.sample_rate;
+    cout << "Transmit chains at " << 1.0E-6 * device_rate << " MS/s device rate, ";
+    cout << opts.num_frames << " frames per case" << endl << endl;
+    cout << "case      variant              frames/s    us/frame  airtime us    duty  create us" << endl;
+
+    std::vector<ChainBenchResult> results;
+    bool realtime = true;
+    for (unsigned int k = 0; k < 2; k++) {
+        for (unsigned int s = 0; s < num_sizes; s++) {
+            for (unsigned int u = 0; u < num_user_counts; u++) {
+                results.push_back(benchOfdmaTx(opts, tx_bench_users[u], tx_bench_frame_sizes[s],
+                        fec_names[k], fec0s[k], fec1s[k]));
+                printResult(results.back());
+                // The radio's default network is a basestation and 3 mobiles
+                if ((tx_bench_users[u] <= 3) && (results.back().get("duty_cycle") < 1.0))
+                    realtime = false;
+            }
+        }
+    }
+    for (unsigned int k = 0; k < 2; k++) {
+        for (unsigned int s = 0; s < num_sizes; s++) {
+            for (unsigned int ch = 0; ch < num_channel_counts; ch++) {
+                results.push_back(benchMultichannelTx(opts, tx_bench_channels[ch],
+                        tx_bench_frame_sizes[s], fec_names[k], fec0s[k], fec1s[k]));
+                printResult(results.back());
+            }
+        }
+    }
+
+    // Most mobiles one core keeps on the air continuously, per downlink setting
+    cout << endl << "Mobiles one basestation core can feed at full duty cycle:" << endl;
+    for (unsigned int k = 0; k < 2; k++) {
+        for (unsigned int s = 0; s < num_sizes; s++) {
+            // Up to the first user count that falls short
+            unsigned int max_users = 0;
+            for (unsigned int i = 0; i < results.size(); i++) {
+                if ((results[i].getName() != "ofdma_tx") ||
+                        (results[i].getText("fec") != fec_names[k]) ||
+                        (results[i].get("frame_size") != tx_bench_frame_sizes[s]))
+                    continue;
+                if (results[i].get("duty_cycle") < 1.0)
+                    break;
+                max_users = (unsigned int)results[i].get("num_users");
+            }
+            cout << "  " << setw(8) << left << fec_names[k] << right << setw(5);
+            cout << tx_bench_frame_sizes[s] << " B frames: " << max_users << endl;
+        }
+    }
+
+    if (!opts.json_file.empty()) {
+        ChainBenchResult settings("U4_tx_bench");
+        settings.set("sample_rate", opts.sample_rate);
+        settings.set("device_rate", device_rate);
+        settings.set("num_frames", (double)opts.num_frames);
+        ofstream json(opts.json_file.c_str());
+        writeChainBenchJson(json, settings, results);
+    }
+
+    if (opts.require_realtime && !realtime) {
+        cerr << "\ntx_chain_bench: the downlink cannot keep up with its airtime" << endl;
+        return(EXIT_FAILURE);
+    }
+    return(EXIT_SUCCESS);
+}
@@ -6,9 +6,10 @@
 
 #include<PacketStore.hh>
 #include<Phy2Mac.h>
+#include<string.h>
 PacketStore::PacketStore(std::string tap_name, unsigned int node_id, unsigned int num_nodes_in_net, 
                          unsigned char* nodes_in_net, unsigned int frame_size, bool
-                         using_tun_tap)
+                         using_tun_tap, std::string netns)
 {
     this->frame_len = frame_size;
     this->next_packet = 0;
@@ -16,10 +17,25 @@ PacketStore::PacketStore(std::string tap_name, unsigned int node_id, unsigned in
     this->continue_reading = true;
     this->using_tun_tap = using_tun_tap;
     this->written_packets = 0;
+    this->read_packets = 0;
     this->num_nodes_in_net = num_nodes_in_net;
+    this->clock = timer_create();
+    timer_tic(clock);
+    this->reassembly_timeout = PS_REASSEMBLY_TIMEOUT;
+    this->reassembly_failures = 0;
+    this->arq = false;
+    this->arq_window = 0;
+    this->arq_timeout = 0.0;
+    this->arq_max_retransmissions = 0;
+    this->arq_frames_sent = 0;
+    this->arq_frames_retransmitted = 0;
+    this->arq_packets_acked = 0;
+    this->arq_packets_dropped = 0;
+    this->tx_frame.resize(frame_size);
+    this->tt = NULL;
     if(using_tun_tap)
     {
-        tt = new TunTap(tap_name, node_id, num_nodes_in_net, nodes_in_net);
+        tt = new TunTap(tap_name, node_id, num_nodes_in_net, nodes_in_net, netns);
         readThread = std::thread(&PacketStore::readPackets, this);
     }
 }
@@ -28,10 +44,42 @@ PacketStore::~PacketStore()
 {
     if(using_tun_tap)
         delete tt;
+    std::lock_guard<std::mutex> tx_lock(tx_mutex);
+    for(std::list<TxPayload>::iterator it = tx_packets.begin(); it != tx_packets.end(); it++)
+        (*it).release();
+    for(std::list<TxPayload>::iterator it = arq_packets.begin(); it != arq_packets.end(); it++)
+        (*it).release();
+    std::lock_guard<std::mutex> rx_lock(rx_mutex);
+    for(std::list<RxPayload>::iterator it = rx_packets.begin(); it != rx_packets.end(); it++)
+        (*it).release();
+    timer_destroy(clock);
+}
+
+void PacketStore::enable_arq(unsigned int window, double timeout, unsigned int max_retransmissions)
+{
+    arq = true;
+    arq_window = window;
+    arq_timeout = timeout;
+    arq_max_retransmissions = max_retransmissions;
+    //Keep a partial packet until the sender has given up on it
+    reassembly_timeout = std::max(PS_REASSEMBLY_TIMEOUT, timeout * (max_retransmissions + 2));
+    arq_pending_acks.assign(num_nodes_in_net + 1, std::list<long int>());
+    arq_sized_at.assign(num_nodes_in_net + 1, -1.0);
+}
+
+long int PacketStore::add_packet(unsigned int dest_id, unsigned char* data, unsigned int len)
+{
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    long int id = read_packets;
+    TxPayload payload(id, dest_id, data, len, frame_len);
+    tx_packets.push_back(payload);
+    read_packets++;
+    return id;
 }
 //Tx Side Functions
 unsigned char* PacketStore::get_frame(long int packet_id, unsigned int frame_id)
 {
+    std::lock_guard<std::mutex> lock(tx_mutex);
     for(std::list<TxPayload>::iterator it = tx_packets.begin(); it != tx_packets.end(); it++)
     {
         if((*it).id == packet_id)
@@ -50,6 +98,7 @@ unsigned char* PacketStore::get_next_frame()
 
 int PacketStore::get_next_frame_destination()
 {
+    std::lock_guard<std::mutex> lock(tx_mutex);
     for(std::list<TxPayload>::iterator it = tx_packets.begin(); it != tx_packets.end(); it++)
     {
         if((*it).id == next_packet)
@@ -63,25 +112,199 @@ int PacketStore::get_next_frame_destination()
 unsigned char* PacketStore::get_next_frame_for_destination(unsigned int dest_id, long int *packet_id, unsigned int* frame_id, unsigned int*
         frame_size, unsigned int* total_packet_len)
 {
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    if(arq)
+    {
+        double now = timer_toc(clock);
+        //Decide at the time the frame was sized so the same frame goes out
+        if(arq_sized_at[dest_id] >= 0.0 && now - arq_sized_at[dest_id] < arq_timeout)
+            now = arq_sized_at[dest_id];
+        arq_sized_at[dest_id] = -1.0;
+        arq_drop_expired(dest_id, now);
+        bool retransmission;
+        TxPayload* p = arq_peek(dest_id, now, frame_id, &retransmission);
+        if(p == NULL)
+            return NULL;
+        if(p->next_frame == 0)
+        {
+            //First frame of a queued packet: it joins the retransmit buffer
+            for(std::list<TxPayload>::iterator it = tx_packets.begin(); it != tx_packets.end(); it++)
+            {
+                if(&(*it) == p)
+                {
+                    arq_packets.splice(arq_packets.end(), tx_packets, it);
+                    break;
+                }
+            }
+        }
+        if(retransmission)
+        {
+            p->frame_retransmissions[*frame_id]++;
+            arq_frames_retransmitted++;
+        }
+        else
+        {
+            p->next_frame++;
+            arq_frames_sent++;
+        }
+        p->frame_sent_time[*frame_id] = now;
+        *packet_id = p->id;
+        *frame_size = p->get_frame_size(*frame_id);
+        *total_packet_len = p->payload_size;
+        //An acknowledgement may free the packet before the caller is done
+        memcpy(&tx_frame[0], p->get_frame(*frame_id), *frame_size);
+        return &tx_frame[0];
+    }
     for(std::list<TxPayload>::iterator it = tx_packets.begin(); it != tx_packets.end(); it++)
     {
         if((*it).destination_id == dest_id && !(*it).retrieved)
         {
             unsigned char* result = (*it).get_next_frame(packet_id, frame_id, frame_size, total_packet_len);
-            tx_packets.erase(it);
-            return result;
-            //return (*it).get_next_frame(packet_id, frame_id, frame_size, total_packet_len); 
+            memcpy(&tx_frame[0], result, *frame_size);
+            //Keep a packet longer than one frame until its last frame is out
+            if((*it).retrieved)
+            {
+                (*it).release();
+                tx_packets.erase(it);
+            }
+            return &tx_frame[0];
         }
     }
     total_packet_len = 0;
     return NULL;
 }
 
+//Picks the frame to send next to dest_id without changing any state: a
+//timed-out frame first, then the next frame of a packet already in flight,
+//then the first frame of the oldest queued packet if the window has room.
+//Packets out of retransmissions are passed over for arq_drop_expired.
+//Must be called with tx_mutex held
+TxPayload* PacketStore::arq_peek(unsigned int dest_id, double now, unsigned int* frame_id, bool* retransmission)
+{
+    unsigned int in_flight = 0;
+    TxPayload* next = NULL;
+    for(std::list<TxPayload>::iterator it = arq_packets.begin(); it != arq_packets.end(); it++)
+    {
+        if((*it).destination_id != dest_id)
+            continue;
+        int expired = (*it).get_expired_frame(now - arq_timeout);
+        if(expired >= 0 && (*it).frame_retransmissions[expired] >= arq_max_retransmissions)
+            continue;
+        if(expired >= 0)
+        {
+            *frame_id = expired;
+            *retransmission = true;
+            return &(*it);
+        }
+        in_flight++;
+        if(next == NULL && (*it).next_frame < (*it).get_frames_per_packet())
+            next = &(*it);
+    }
+    *retransmission = false;
+    if(next != NULL)
+    {
+        *frame_id = next->next_frame;
+        return next;
+    }
+    if(in_flight >= arq_window)
+        return NULL;
+    for(std::list<TxPayload>::iterator it = tx_packets.begin(); it != tx_packets.end(); it++)
+    {
+        if((*it).destination_id == dest_id && !(*it).retrieved)
+        {
+            *frame_id = 0;
+            return &(*it);
+        }
+    }
+    return NULL;
+}
+
+//Gives up on the packets to dest_id with a timed-out frame that is out of
+//retransmissions. Must be called with tx_mutex held
+void PacketStore::arq_drop_expired(unsigned int dest_id, double now)
+{
+    std::list<TxPayload>::iterator it = arq_packets.begin();
+    while(it != arq_packets.end())
+    {
+        int expired = (*it).get_expired_frame(now - arq_timeout);
+        if((*it).destination_id == dest_id && expired >= 0 &&
+                (*it).frame_retransmissions[expired] >= arq_max_retransmissions)
+        {
+            arq_packets_dropped++;
+            (*it).release();
+            it = arq_packets.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
+void PacketStore::ack_frames(unsigned int dest_id, long int packet_id, unsigned int bitmap)
+{
+    if(!arq || bitmap == 0)
+        return;
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    for(std::list<TxPayload>::iterator it = arq_packets.begin(); it != arq_packets.end(); it++)
+    {
+        if((*it).destination_id == dest_id && (*it).id == packet_id)
+        {
+            (*it).ack_frames(bitmap);
+            if((*it).allFramesAcked())
+            {
+                arq_packets_acked++;
+                (*it).release();
+                arq_packets.erase(it);
+            }
+            return;
+        }
+    }
+}
+
+bool PacketStore::has_pending_ack(unsigned int dest_id)
+{
+    std::lock_guard<std::mutex> lock(rx_mutex);
+    return arq && dest_id < arq_pending_acks.size() && !arq_pending_acks[dest_id].empty();
+}
+
+bool PacketStore::get_ack(unsigned int dest_id, long int* packet_id, unsigned int* bitmap)
+{
+    std::lock_guard<std::mutex> lock(rx_mutex);
+    if(!arq || dest_id >= arq_pending_acks.size())
+        return false;
+    std::list<long int>& pending = arq_pending_acks[dest_id];
+    while(!pending.empty())
+    {
+        long int id = pending.front();
+        pending.pop_front();
+        for(std::list<RxPayload>::iterator it = rx_packets.begin(); it != rx_packets.end(); it++)
+        {
+            if((*it).source_id == dest_id && (*it).id == id)
+            {
+                *packet_id = id;
+                *bitmap = (*it).get_frame_bitmap();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void PacketStore::print_arq_summary()
+{
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    unsigned long total = arq_frames_sent + arq_frames_retransmitted;
+    std::cout << "ARQ: " << arq_frames_sent << " frames sent, " << arq_frames_retransmitted
+        << " retransmitted (" << (total > 0 ? 100.0 * arq_frames_retransmitted / total : 0.0)
+        << "%), " << arq_packets_acked << " packets acknowledged, " << arq_packets_dropped
+        << " given up" << std::endl;
+}
+
 void PacketStore::readPackets()
 {
     unsigned int dest_id = 0;
     unsigned char* data = new unsigned char[P2M_FRAME_PAYLOAD_MAX_SIZE];
-    long int i = 0;
     while(continue_reading)
     {
         
@@ -94,11 +317,7 @@ void PacketStore::readPackets()
             if(dest_id > 0 && dest_id <= num_nodes_in_net)
             {
                 data_flowing = true;
-                TxPayload payload(i, dest_id, data, total, frame_len);
-                tx_packets.push_back(payload);
-                i++;
-                std::stringstream report;
-                report << "storing " << i << " for " << dest_id << ", total: " << total;
+                add_packet(dest_id, data, total);
             }
         }
         else
@@ -115,62 +334,165 @@ bool PacketStore::data_is_streaming()
 
 int PacketStore::size()
 {
+    std::lock_guard<std::mutex> lock(tx_mutex);
     return tx_packets.size();
 }
 
+unsigned int PacketStore::get_queued_bytes(unsigned int dest_id, unsigned int* next_frame_size)
+{
+    std::lock_guard<std::mutex> lock(tx_mutex);
+    unsigned int queued = 0;
+    *next_frame_size = 0;
+    if(arq)
+    {
+        unsigned int frame_id;
+        bool retransmission;
+        double now = timer_toc(clock);
+        TxPayload* p = arq_peek(dest_id, now, &frame_id, &retransmission);
+        if(p == NULL)
+            return 0;
+        *next_frame_size = p->get_frame_size(frame_id);
+        arq_sized_at[dest_id] = now;
+        //Frames in flight count once they are due again
+        double cutoff = now - arq_timeout;
+        for(std::list<TxPayload>::iterator it = arq_packets.begin(); it != arq_packets.end(); it++)
+        {
+            if((*it).destination_id != dest_id)
+                continue;
+            int expired = (*it).get_expired_frame(cutoff);
+            if(expired >= 0 && (*it).frame_retransmissions[expired] >= arq_max_retransmissions)
+                continue;
+            for(unsigned int i = 0; i < (*it).get_frames_per_packet(); i++)
+            {
+                if(!(*it).frame_transmitted[i] ||
+                        (!(*it).frame_acked[i] && (*it).frame_sent_time[i] < cutoff))
+                    queued += (*it).get_frame_size(i);
+            }
+        }
+    }
+    for(std::list<TxPayload>::iterator it = tx_packets.begin(); it != tx_packets.end(); it++)
+    {
+        if((*it).destination_id == dest_id && !(*it).retrieved)
+        {
+            if(queued == 0)
+                *next_frame_size = (*it).get_next_frame_size();
+            queued += (*it).get_remaining_size();
+        }
+    }
+    return queued;
+}
+
 //Rx Side function
-int PacketStore::add_frame(long int packet_id, unsigned int frame_id, unsigned char* data, unsigned int total_packet_len)
-{
-    //Look through list of completed packets so we don't accidentally try to 
-	//send a packet to the tun interface more than once
-//	std::list<unsigned int>::iterator iter = std::find(completed_packets.begin(), completed_packets.end(), packet_id);
-//	if(iter == completed_packets.end())//If packet_id is not in list of competed packets
-//	{
-		//Look through list of received packets and see 
-		//if we've received any frames for packet with id packet_id
-		for(std::list<RxPayload>::iterator it = rx_packets.begin(); it != rx_packets.end(); it++)
-		{
-			if((*it).id == packet_id)
-			{
-				(*it).add_frame(frame_id, data);
-				if((*it).isComplete())
-				{
-					unsigned int result = tt->cwrite((char*)(*it)._payload, (*it).payload_size);
-					if(result == (*it).payload_size)
-					{
-                        written_packets++;
-						completed_packets.push_back(packet_id);
-						return PACKET_COMPLETE;
-					}
-				}
-				return PACKET_NOT_COMPLETE;
-			}
-		}
-		//packet with id packet_id must not have been added yet
-		RxPayload rxp(packet_id, total_packet_len, frame_len);
-		rxp.add_frame(frame_id, data);
-		if(rxp.isComplete())
-		{
-			unsigned int result = tt->cwrite((char*)rxp._payload, rxp.payload_size);
-			if(result == rxp.payload_size)
+int PacketStore::add_frame(unsigned int source_id, long int packet_id, unsigned int frame_id, unsigned char* data, unsigned int total_packet_len)
+{
+    std::lock_guard<std::mutex> lock(rx_mutex);
+    double now = timer_toc(clock);
+    purge_rx_packets(now);
+    //Acknowledge every frame, duplicates included, since the sender only
+    //retransmits when an acknowledgement went missing
+    if(arq && source_id < arq_pending_acks.size())
+    {
+        std::list<long int>& pending = arq_pending_acks[source_id];
+        pending.remove(packet_id);
+        pending.push_back(packet_id);
+        if(pending.size() > arq_window + 1)
+            pending.pop_front();
+    }
+    //Look through list of received packets and see 
+    //if we've received any frames for packet with id packet_id
+    for(std::list<RxPayload>::iterator it = rx_packets.begin(); it != rx_packets.end(); it++)
+    {
+        if((*it).id == packet_id && (*it).source_id == source_id)
+        {
+            (*it).last_frame_time = now;
+            //A duplicate of a frame already in a completed packet must not
+            //write the packet again
+            if((*it).add_frame(frame_id, data) && (*it).isComplete())
             {
-                written_packets++;
-                completed_packets.push_back(packet_id);
-				return PACKET_COMPLETE;
+                unsigned int result = using_tun_tap ?
+                    tt->cwrite((char*)(*it)._payload, (*it).payload_size) : (*it).payload_size;
+                if(result == (*it).payload_size)
+                {
+                    written_packets++;
+                    completed_packets.push_back(packet_id);
+                    return PACKET_COMPLETE;
+                }
             }
-		}
+            return PACKET_NOT_COMPLETE;
+        }
+    }
+    //packet with id packet_id must not have been added yet
+    RxPayload rxp(packet_id, total_packet_len, frame_len);
+    rxp.source_id = source_id;
+    rxp.last_frame_time = now;
+    rxp.add_frame(frame_id, data);
+    if(rxp.isComplete())
+    {
+        unsigned int result = using_tun_tap ?
+            tt->cwrite((char*)rxp._payload, rxp.payload_size) : rxp.payload_size;
+        //With ARQ the packet stays until it times out so that it can be
+        //acknowledged again and its retransmissions recognized
+        if(arq)
+            rx_packets.push_back(rxp);
+        else
+            rxp.release();
+        if(result == rxp.payload_size)
+        {
+            written_packets++;
+            completed_packets.push_back(packet_id);
+            return PACKET_COMPLETE;
+        }
+        return PACKET_NOT_COMPLETE;
+    }
 
-		rx_packets.push_back(rxp);
-		return PACKET_NOT_COMPLETE;
-//	}
-//	else
-//		return PACKET_COMPLETE;
+    rx_packets.push_back(rxp);
+    return PACKET_NOT_COMPLETE;
 }
+
+//Drops packets no frame has arrived for within the reassembly timeout;
+//incomplete ones count as reassembly failures. Must be called with
+//rx_mutex held
+void PacketStore::purge_rx_packets(double now)
+{
+    std::list<RxPayload>::iterator it = rx_packets.begin();
+    while(it != rx_packets.end())
+    {
+        if(now - (*it).last_frame_time > reassembly_timeout)
+        {
+            if(!(*it).isComplete())
+                reassembly_failures++;
+            (*it).release();
+            it = rx_packets.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
 unsigned int PacketStore::get_written_packets()
 {
     return written_packets;
 }
 
+unsigned int PacketStore::get_read_packets()
+{
+    return read_packets;
+}
+
+unsigned int PacketStore::get_incomplete_packets()
+{
+    std::lock_guard<std::mutex> lock(rx_mutex);
+    unsigned int result = reassembly_failures;
+    for(std::list<RxPayload>::iterator it = rx_packets.begin(); it != rx_packets.end(); it++)
+    {
+        if(!(*it).isComplete())
+            result++;
+    }
+    return result;
+}
+
 void PacketStore::close_interface()
 {
     continue_reading = false;
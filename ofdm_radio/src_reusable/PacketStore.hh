@@ -10,9 +10,12 @@
 #include <RxPayload.hh>
 #include <TunTap.hh>
 #include <list>
+#include <vector>
 #include <thread>
+#include <mutex>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 #include "timer.h"
 #include "Logger.hh"
@@ -20,37 +23,101 @@
 #define PACKET_NOT_COMPLETE 101
 #define PACKET_COMPLETE     102
 
+// Frames of a packet an ARQ acknowledgement bitmap can cover
+#define PS_ARQ_MAX_FRAMES           32
+// A packet still being reassembled is dropped once no frame of it has
+// arrived for this long [s]; with ARQ the sender's retransmissions stretch it
+#define PS_REASSEMBLY_TIMEOUT       1.0
+
 
 class PacketStore
 {
     public:
         PacketStore(std::string tap_name, unsigned int node_id, unsigned int num_nodes_in_net, 
-                    unsigned char* nodes_in_net, unsigned int frame_size, bool using_tun_tap);
+                    unsigned char* nodes_in_net, unsigned int frame_size, bool using_tun_tap,
+                    std::string netns = "");
         ~PacketStore();
-        int add_frame(long int packet_id, unsigned int frame_id, unsigned char* data, unsigned int total_packet_len);
+        int add_frame(unsigned int source_id, long int packet_id, unsigned int frame_id, unsigned char* data, unsigned int total_packet_len);
         void readPackets();
+        // Queues a packet for dest_id as if read from the interface;
+        // returns its packet id
+        long int add_packet(unsigned int dest_id, unsigned char* data, unsigned int len);
         bool data_is_streaming();
         unsigned char* get_frame(long int packet_id, unsigned int frame_id);
         unsigned char* get_next_frame();
         int get_next_frame_destination();
+        // The frame returned is a copy, valid until the next call
         unsigned char* get_next_frame_for_destination(unsigned int dest_id, long int* packet_id, unsigned int* frame_id, unsigned int* frame_size, unsigned int* total_packet_len);
         int size();
+        // Bytes queued for a destination; next_frame_size is the size of the
+        // frame get_next_frame_for_destination would return (0 when none)
+        unsigned int get_queued_bytes(unsigned int dest_id, unsigned int* next_frame_size);
         unsigned int get_written_packets();
+        // Packets taken from the interface for transmission
+        unsigned int get_read_packets();
+        // Packets with frames received but never completed; at the end of a
+        // run these are reassembly failures
+        unsigned int get_incomplete_packets();
         void close_interface();
+
+        // Selective-repeat ARQ. Frames handed out by
+        // get_next_frame_for_destination stay in a retransmit buffer of at
+        // most window packets per destination until acknowledged. A frame
+        // not acknowledged within timeout seconds goes out again, up to
+        // max_retransmissions times before its packet is given up.
+        void enable_arq(unsigned int window, double timeout, unsigned int max_retransmissions);
+        // Sender: acknowledgement from dest_id of the frames of packet_id
+        // set in bitmap (bit i for frame i)
+        void ack_frames(unsigned int dest_id, long int packet_id, unsigned int bitmap);
+        // Receiver: whether packets from dest_id are waiting to be
+        // acknowledged, and the next acknowledgement to send it
+        bool has_pending_ack(unsigned int dest_id);
+        bool get_ack(unsigned int dest_id, long int* packet_id, unsigned int* bitmap);
+        void print_arq_summary();
     private:
+        TxPayload* arq_peek(unsigned int dest_id, double now, unsigned int* frame_id, bool* retransmission);
+        void arq_drop_expired(unsigned int dest_id, double now);
+        void purge_rx_packets(double now);
+
         std::list<RxPayload> rx_packets;
         std::list<unsigned int> completed_packets;
         std::list<TxPayload> tx_packets;
+        // readPackets fills tx_packets while the transmit tasks drain it
+        std::mutex tx_mutex;
+        // add_frame runs on the receive thread, get_ack on the transmit one
+        std::mutex rx_mutex;
         std::thread readThread;
         std::string interface;
         TunTap* tt;
         unsigned int frame_len;
         unsigned int next_packet;
         unsigned int written_packets;
+        unsigned int read_packets;
         unsigned int num_nodes_in_net;
         bool data_flowing;
         bool continue_reading;
         bool using_tun_tap;
+        // Copy of the last frame handed out
+        std::vector<unsigned char> tx_frame;
+
+        timer clock;
+        double reassembly_timeout;
+        unsigned int reassembly_failures;
+        bool arq;
+        unsigned int arq_window;
+        double arq_timeout;
+        unsigned int arq_max_retransmissions;
+        // Packets with frames in flight, oldest first
+        std::list<TxPayload> arq_packets;
+        // Packets to acknowledge, indexed by the node they came from
+        std::vector<std::list<long int> > arq_pending_acks;
+        // When get_queued_bytes last sized each destination's next frame,
+        // -1 once sent; the send decides at that time so the two agree
+        std::vector<double> arq_sized_at;
+        unsigned long arq_frames_sent;
+        unsigned long arq_frames_retransmitted;
+        unsigned long arq_packets_acked;
+        unsigned long arq_packets_dropped;
 };
 
 
@@ -30,6 +30,11 @@ RadioConfig::RadioConfig(int argc, char **argv)
 	rf_log_file = "ofdm_rf.log";
     alloc_log_file = "ofdm_allocation.log";
     packet_log_file = "ofdm_packets.log";
+    evm_log_file = "";
+    fftw_wisdom_file = "";
+    evm_log_decimation = 10;
+    evm_average_alpha = 0.05;
+    evm_high_threshold = -10.0;
     using_tun_tap = true;
     u4 = true;
 
@@ -40,6 +45,14 @@ RadioConfig::RadioConfig(int argc, char **argv)
 	rf_gain_tx = 20.0;
 	usrp_address_is_specified = false;
 	usrp_address_name = "";
+    loopback_medium = "default";
+    loopback_time_scale = 1.0;
+    loopback_noise_floor = -60.0;
+    loopback_rx_file = "";
+    loopback_tx_file = "";
+    replay_file = "";
+    iq_capture_file = "";
+    iq_capture_format = "fc32";
 
 	//Waveform Configuration
 	node_is_basestation = false;
@@ -57,7 +70,22 @@ RadioConfig::RadioConfig(int argc, char **argv)
     close_hole_timeout = 30.0;
     jamming_threshold = 50.0;
     hardened = false;
+    soft_decoding = false;
     uplink = true;
+    amc = false;
+    amc_evm_alpha = 0.1;
+    amc_hysteresis = 2.0;
+    amc_report_timeout = 1.0;
+    amc_table = list<AmcTableEntry>();
+    scheduler = false;
+    scheduler_fairness = 1.0;
+    scheduler_blocks = 25;
+    traffic_aware = false;
+    keepalive_interval = 0.25;
+    arq = false;
+    arq_window = 8;
+    arq_timeout = 0.2;
+    arq_max_retransmissions = 4;
 
 
     slow = false;
@@ -239,6 +267,68 @@ RadioConfig::RadioConfig(int argc, char **argv)
             hardened = false;
     }
 
+    if( config_lookup_int(&cfg, "soft_decoding", &itmp) ) {
+        if(itmp == 1)
+            soft_decoding = true;
+        else
+            soft_decoding = false;
+    }
+
+    if( config_lookup_int(&cfg, "amc", &itmp) ) {
+        if(itmp == 1)
+            amc = true;
+        else
+            amc = false;
+    }
+    if( config_lookup_float(&cfg, "amc_evm_alpha", &dtmp) ) {
+        amc_evm_alpha = dtmp;
+    }
+    if( config_lookup_float(&cfg, "amc_hysteresis", &dtmp) ) {
+        amc_hysteresis = dtmp;
+    }
+    if( config_lookup_float(&cfg, "amc_report_timeout", &dtmp) ) {
+        amc_report_timeout = dtmp;
+    }
+
+    if( config_lookup_int(&cfg, "scheduler", &itmp) ) {
+        if(itmp == 1)
+            scheduler = true;
+        else
+            scheduler = false;
+    }
+    if( config_lookup_float(&cfg, "scheduler_fairness", &dtmp) ) {
+        scheduler_fairness = dtmp;
+    }
+    if( config_lookup_int(&cfg, "scheduler_blocks", &itmp) ) {
+        scheduler_blocks = itmp;
+    }
+
+    if( config_lookup_int(&cfg, "traffic_aware", &itmp) ) {
+        if(itmp == 1)
+            traffic_aware = true;
+        else
+            traffic_aware = false;
+    }
+    if( config_lookup_float(&cfg, "keepalive_interval", &dtmp) ) {
+        keepalive_interval = dtmp;
+    }
+
+    if( config_lookup_int(&cfg, "arq", &itmp) ) {
+        if(itmp == 1)
+            arq = true;
+        else
+            arq = false;
+    }
+    if( config_lookup_int(&cfg, "arq_window", &itmp) ) {
+        arq_window = itmp;
+    }
+    if( config_lookup_float(&cfg, "arq_timeout", &dtmp) ) {
+        arq_timeout = dtmp;
+    }
+    if( config_lookup_int(&cfg, "arq_max_retransmissions", &itmp) ) {
+        arq_max_retransmissions = itmp;
+    }
+
     if(lookup_app_log_file)
     {
 	    if( config_lookup_string(&cfg, "app_log_file", &stmp) ) {
@@ -263,6 +353,21 @@ RadioConfig::RadioConfig(int argc, char **argv)
             packet_log_file = string(stmp);
         }
     }
+    if( config_lookup_string(&cfg, "evm_log_file", &stmp) ) {
+        evm_log_file = string(stmp);
+    }
+    if( config_lookup_string(&cfg, "fftw_wisdom_file", &stmp) ) {
+        fftw_wisdom_file = string(stmp);
+    }
+    if( config_lookup_int(&cfg, "evm_log_decimation", &itmp) ) {
+        evm_log_decimation = (unsigned int)itmp;
+    }
+    if( config_lookup_float(&cfg, "evm_average_alpha", &dtmp) ) {
+        evm_average_alpha = dtmp;
+    }
+    if( config_lookup_float(&cfg, "evm_high_threshold", &dtmp) ) {
+        evm_high_threshold = dtmp;
+    }
     if( config_lookup_string(&cfg, "radio_hardware", &stmp) ) {
         radio_hardware = string(stmp);
 	}
@@ -285,6 +390,30 @@ RadioConfig::RadioConfig(int argc, char **argv)
 	    usrp_address_is_specified = true;
 	    usrp_address_name = stmp;
     }
+    if( config_lookup_string(&cfg, "loopback_medium", &stmp) ) {
+        loopback_medium = string(stmp);
+    }
+    if( config_lookup_float(&cfg, "loopback_time_scale", &dtmp) ) {
+        loopback_time_scale = dtmp;
+    }
+    if( config_lookup_float(&cfg, "loopback_noise_floor", &dtmp) ) {
+        loopback_noise_floor = dtmp;
+    }
+    if( config_lookup_string(&cfg, "loopback_rx_file", &stmp) ) {
+        loopback_rx_file = string(stmp);
+    }
+    if( config_lookup_string(&cfg, "loopback_tx_file", &stmp) ) {
+        loopback_tx_file = string(stmp);
+    }
+    if( config_lookup_string(&cfg, "replay_file", &stmp) ) {
+        replay_file = string(stmp);
+    }
+    if( config_lookup_string(&cfg, "iq_capture_file", &stmp) ) {
+        iq_capture_file = string(stmp);
+    }
+    if( config_lookup_string(&cfg, "iq_capture_format", &stmp) ) {
+        iq_capture_format = string(stmp);
+    }
 
     if( config_lookup_int(&cfg, "node_is_basestation", &itmp) ) {
 	    if (itmp == 1) {
@@ -365,6 +494,41 @@ RadioConfig::RadioConfig(int argc, char **argv)
         }
     }
     
+    ptmp = config_lookup(&cfg, "amc_table");
+    if(ptmp != NULL) {
+        for (ctr = 0; ctr < config_setting_length(ptmp); ctr++) {
+            config_setting_t* row = config_setting_get_elem(ptmp, ctr);
+            const char* mod = NULL;
+            const char* fec0 = NULL;
+            const char* fec1 = NULL;
+            if (config_setting_length(row) == 4) {
+                mod = config_setting_get_string_elem(row, 0);
+                fec0 = config_setting_get_string_elem(row, 1);
+                fec1 = config_setting_get_string_elem(row, 2);
+            }
+            if (mod == NULL || fec0 == NULL || fec1 == NULL) {
+                cerr << "ERROR:" <<endl;
+                cerr << "       Each amc_table row must be (modulation, fec0, fec1, max_evm)";
+                cerr << " but row " << ctr << " is not";
+                cerr << "\n" <<endl;
+                exit(EXIT_FAILURE);
+            }
+            AmcTableEntry entry;
+            entry.mod_scheme = string(mod);
+            entry.fec0 = string(fec0);
+            entry.fec1 = string(fec1);
+            entry.max_evm = config_setting_get_float_elem(row, 3);
+            if (!amc_table.empty() && entry.max_evm > amc_table.back().max_evm) {
+                cerr << "ERROR:" <<endl;
+                cerr << "       The amc_table rows must go from most to least robust,";
+                cerr << " so max_evm may not increase, but row " << ctr << " has " << entry.max_evm;
+                cerr << "\n" <<endl;
+                exit(EXIT_FAILURE);
+            }
+            amc_table.push_back(entry);
+        }
+    }
+
 	if( config_lookup_int(&cfg, "node_id", &itmp) ) {
 		node_id = (unsigned char)itmp;
 	}
@@ -517,6 +681,11 @@ void RadioConfig::display_config()
 	cout << "  rf_log_file:                 " << rf_log_file << endl;
 	cout << "  alloc_log_file:              " << alloc_log_file << endl;
 	cout << "  packet_log_file:             " << packet_log_file << endl;
+    cout << "  evm_log_file:                " << evm_log_file << endl;
+    cout << "  evm_log_decimation:          " << evm_log_decimation << endl;
+    cout << "  evm_average_alpha:           " << evm_average_alpha << endl;
+    cout << "  evm_high_threshold:          " << evm_high_threshold << "dB" << endl;
+    cout << "  fftw_wisdom_file:            " << fftw_wisdom_file << endl;
     cout << " " << endl;
     cout << "Radio Hardware Configuration:" << endl;
 	cout << "  radio_hardware:              " << radio_hardware << endl;
@@ -529,6 +698,20 @@ void RadioConfig::display_config()
     } else {
         cout << "  (no USRP address)" << endl;
     }
+    if (radio_hardware.compare("RADIO_MODEL_LOOPBACK") == 0) {
+        cout << "  loopback_medium:             " << loopback_medium << endl;
+        cout << "  loopback_time_scale:         " << loopback_time_scale << endl;
+        cout << "  loopback_noise_floor:        " << loopback_noise_floor << "dB" << endl;
+        cout << "  loopback_rx_file:            " << loopback_rx_file << endl;
+        cout << "  loopback_tx_file:            " << loopback_tx_file << endl;
+    }
+    if (radio_hardware.compare("RADIO_MODEL_REPLAY") == 0) {
+        cout << "  replay_file:                 " << replay_file << endl;
+    }
+    if (!iq_capture_file.empty()) {
+        cout << "  iq_capture_file:             " << iq_capture_file << endl;
+        cout << "  iq_capture_format:           " << iq_capture_format << endl;
+    }
     cout << " " << endl;
     cout << "Waveform Configuration:" << endl;
     cout << "  node_is_basestation:         " << node_is_basestation << endl;
@@ -539,7 +722,33 @@ void RadioConfig::display_config()
 	cout << "  node_ip_address:             " << node_ip_address << endl;
     cout << "  anti_jam_mode:               " << anti_jam << std::endl;
     cout << "  hardened:                    " << hardened << std::endl;
+    cout << "  soft_decoding:               " << soft_decoding << std::endl;
     cout << "  uplink:                      " << uplink << std::endl;
+    cout << "  amc:                         " << amc << std::endl;
+    if (amc) {
+        cout << "  amc_evm_alpha:               " << amc_evm_alpha << std::endl;
+        cout << "  amc_hysteresis:              " << amc_hysteresis << "dB" << std::endl;
+        cout << "  amc_report_timeout:          " << amc_report_timeout << "s" << std::endl;
+        for (list<AmcTableEntry>::iterator it = amc_table.begin(); it != amc_table.end(); it++) {
+            cout << "  amc_table:                   " << it->mod_scheme << ", " << it->fec0
+                << ", " << it->fec1 << ", up to " << it->max_evm << "dB" << std::endl;
+        }
+    }
+    cout << "  scheduler:                   " << scheduler << std::endl;
+    if (scheduler) {
+        cout << "  scheduler_fairness:          " << scheduler_fairness << std::endl;
+        cout << "  scheduler_blocks:            " << scheduler_blocks << std::endl;
+    }
+    cout << "  traffic_aware:               " << traffic_aware << std::endl;
+    if (traffic_aware) {
+        cout << "  keepalive_interval:          " << keepalive_interval << "s" << std::endl;
+    }
+    cout << "  arq:                         " << arq << std::endl;
+    if (arq) {
+        cout << "  arq_window:                  " << arq_window << std::endl;
+        cout << "  arq_timeout:                 " << arq_timeout << "s" << std::endl;
+        cout << "  arq_max_retransmissions:     " << arq_max_retransmissions << std::endl;
+    }
     cout << "  frame_size:                  " << frame_size << std::endl;
     cout << "  mitigation_timeout:          " << mitigation_timeout << std::endl;
     cout << "  mitigation_reenable_timeout: " << mitigation_reenable_timeout << std::endl;
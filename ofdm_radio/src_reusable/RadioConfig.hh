@@ -10,6 +10,17 @@
 #include <list>
 #include <string>
 #include <libconfig.h>
+
+// One row of the adaptive modulation and coding table (see amc_table in
+// the configuration files): liquid-dsp scheme names and the highest
+// smoothed EVM in dB at which the row may be used
+struct AmcTableEntry {
+    std::string mod_scheme;
+    std::string fec0;
+    std::string fec1;
+    double max_evm;
+};
+
 class RadioConfig
 {
 	public:
@@ -26,10 +37,30 @@ class RadioConfig
 		std::string rf_log_file;
         std::string alloc_log_file;
         std::string packet_log_file;
+        std::string evm_log_file;
+        std::string fftw_wisdom_file;
+        unsigned int evm_log_decimation;
+        float evm_average_alpha;
+        float evm_high_threshold;
         bool using_tun_tap;
         bool u4;
         bool hardened;
+        bool soft_decoding;
         bool uplink;
+        bool amc;
+        float amc_evm_alpha;
+        float amc_hysteresis;
+        float amc_report_timeout;
+        std::list<AmcTableEntry> amc_table;
+        bool scheduler;
+        float scheduler_fairness;
+        unsigned int scheduler_blocks;
+        bool traffic_aware;
+        float keepalive_interval;
+        bool arq;
+        unsigned int arq_window;
+        float arq_timeout;
+        unsigned int arq_max_retransmissions;
  
 		//Radio Hardware Configuration
         std::string radio_hardware;
@@ -38,6 +69,14 @@ class RadioConfig
         double rf_gain_tx;
         bool usrp_address_is_specified;
         std::string usrp_address_name;
+        std::string loopback_medium;
+        double loopback_time_scale;
+        double loopback_noise_floor;
+        std::string loopback_rx_file;
+        std::string loopback_tx_file;
+        std::string replay_file;
+        std::string iq_capture_file;
+        std::string iq_capture_format;
 
 		//Waveform Configuration
         bool node_is_basestation;
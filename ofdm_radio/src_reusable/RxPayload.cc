@@ -15,6 +15,8 @@ RxPayload::RxPayload(long int id, unsigned int payload_size, unsigned int frame_
 	this->id = id;
 	this->frame_size = frame_size;
 	this->payload_size = payload_size;
+	this->source_id = 0;
+	this->last_frame_time = 0.0;
 	frames_per_packet = payload_size / frame_size + 1;
 	last_frame_size = payload_size % frame_size;
 	if(last_frame_size == 0)
@@ -48,11 +50,10 @@ bool RxPayload::add_frame(unsigned int frame_id, unsigned char *data)
 		std::cout << "Invalid frame id: " << frame_id << std::endl;
 		return false;
 	}
+	//Duplicates are expected when ARQ retransmits a frame whose
+	//acknowledgement was lost
 	if(frame_received[frame_id])
-	{
-		std::cout << "Data for packet " << id << ", frame " << frame_id << " already added." << std::endl;
 		return false;
-	}
 	//If we're copying the last frame, it might be smaller than the rest
 	//The constructor sets last_frame_size appropriately
 	if(frame_id == frames_per_packet - 1)
@@ -85,3 +86,22 @@ unsigned int RxPayload::num_frames_remaining()
 
 	return result;
 }
+
+unsigned int RxPayload::get_frame_bitmap()
+{
+	unsigned int bitmap = 0;
+	for(unsigned int i = 0; i < frames_per_packet && i < 32; i++)
+	{
+		if(frame_received[i])
+			bitmap |= (1u << i);
+	}
+	return bitmap;
+}
+
+void RxPayload::release()
+{
+	delete[] _payload;
+	delete[] frame_received;
+	_payload = NULL;
+	frame_received = NULL;
+}
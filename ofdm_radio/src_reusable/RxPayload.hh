@@ -19,7 +19,13 @@ class RxPayload
 		unsigned int payload_size;
 		unsigned char *_payload;
 		unsigned int num_frames_remaining();
+		// Bit i set when frame i was received, for ARQ acknowledgements
+		unsigned int get_frame_bitmap();
+		// Frees the buffers; call once on the last copy
+		void release();
 		bool *frame_received;
+		unsigned int source_id;
+		double last_frame_time;
 	private:
 		unsigned int frames_per_packet;
 		unsigned int frame_size;
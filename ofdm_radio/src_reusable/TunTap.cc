@@ -90,8 +90,9 @@ int TunTap::tap_alloc(char *dev, int flags)
 
 }
 
-TunTap::TunTap(std::string tap, unsigned int node_id, unsigned int num_nodes_in_net, unsigned char* nodes_in_net)
-    :persistent_interface(true), node_id(node_id)
+TunTap::TunTap(std::string tap, unsigned int node_id, unsigned int num_nodes_in_net, unsigned char* nodes_in_net,
+        std::string netns)
+    :persistent_interface(true), node_id(node_id), netns(netns)
 {
 	BUFSIZE = 1500;
     std::string tap_ip_address = "10.10.10." + std::to_string(node_id);
@@ -102,8 +103,23 @@ TunTap::TunTap(std::string tap, unsigned int node_id, unsigned int num_nodes_in_
         tap_mac_address = "c6:ff:ff:ff:00:0" + std::to_string(node_id);
 	strcpy(tap_name, tap.c_str());
 	persistent_interface = false;
+    cmd_prefix = netns.empty() ? "sudo " : "sudo ip netns exec " + netns + " ";
 	if (!persistent_interface) 
     {
+        //Start from an empty namespace; one left by an earlier run goes
+        //away with its interfaces
+        if(!netns.empty())
+        {
+            strcpy(cmd, "sudo ip netns del ");
+            strcat(cmd, netns.c_str());
+            strcat(cmd, " > /dev/null 2>&1");
+            int res = system(cmd);
+            strcpy(cmd, "sudo ip netns add ");
+            strcat(cmd, netns.c_str());
+            res = system(cmd);
+            if(res != 0)
+                std::cout << "Error creating network namespace " << netns << "." << std::endl;
+        }
         //Check if tap is already up
         strcpy(cmd, "ifconfig ");
         strcat(cmd, tap_name);
@@ -121,8 +137,33 @@ TunTap::TunTap(std::string tap, unsigned int node_id, unsigned int num_nodes_in_
             strcat(cmd,user);
             if (system(cmd) < 0) perror("system() - /bin/ip");
         } 
+    }
+    //Attach before any move: the device is looked up by name in this
+    //process's own namespace
+    tap_fd = tap_alloc(tap_name, IFF_TAP | IFF_NO_PI); // Tun interface 
+    if (tap_fd < 0) {
+		printf("Error connecting to tap interface %s\n",tap_name);
+		exit(1);
+	}
+	if (!persistent_interface) 
+    {
+        if(!netns.empty())
+        {
+            strcpy(cmd, "sudo ip link set dev ");
+            strcat(cmd, tap_name);
+            strcat(cmd, " netns ");
+            strcat(cmd, netns.c_str());
+            if(system(cmd) != 0)
+                std::cout << "Error moving " << tap_name << " to " << netns << "." << std::endl;
+            strcpy(cmd, cmd_prefix.c_str());
+            strcat(cmd, "ifconfig lo up");
+            int res = system(cmd);
+            if(res < 0)
+                printf("system() - ifconfig lo\n");
+        }
         //Set MTU size to 1500 (the default size) in case U1 has been run recently and set it to 244
-        strcpy(cmd, "sudo ifconfig ");
+        strcpy(cmd, cmd_prefix.c_str());
+        strcat(cmd, "ifconfig ");
         strcat(cmd, tap_name);
         strcat(cmd, " mtu 1500");
         int res = system(cmd);
@@ -130,7 +171,8 @@ TunTap::TunTap(std::string tap, unsigned int node_id, unsigned int num_nodes_in_
             printf("system() - ifconfig mtu\n");
 
         //assign mac address
-        strcpy(cmd, "sudo ifconfig ");
+        strcpy(cmd, cmd_prefix.c_str());
+        strcat(cmd, "ifconfig ");
         strcat(cmd, tap_name);
         strcat(cmd, " hw ether ");
         strcat(cmd, tap_mac_address.c_str());
@@ -139,7 +181,8 @@ TunTap::TunTap(std::string tap, unsigned int node_id, unsigned int num_nodes_in_
             std::cout << "Error configuring mac address." << std::endl;
         
         //Assing IP address
-        strcpy(cmd, "sudo ifconfig ");
+        strcpy(cmd, cmd_prefix.c_str());
+        strcat(cmd, "ifconfig ");
         strcat(cmd, tap_name);
         strcat(cmd," ");
         strcat(cmd, tap_ip_address.c_str());
@@ -148,7 +191,8 @@ TunTap::TunTap(std::string tap, unsigned int node_id, unsigned int num_nodes_in_
             printf("system() - ifconfig\n");
 
         //Bring up the interface in case it's not up yet
-        strcpy(cmd, "sudo ifconfig ");
+        strcpy(cmd, cmd_prefix.c_str());
+        strcat(cmd, "ifconfig ");
         strcat(cmd, tap_name);
         strcat(cmd, " up");
         res = system(cmd);
@@ -157,11 +201,6 @@ TunTap::TunTap(std::string tap, unsigned int node_id, unsigned int num_nodes_in_
 
 
     }   	
-    tap_fd = tap_alloc(tap_name, IFF_TAP | IFF_NO_PI); // Tun interface 
-    if (tap_fd < 0) {
-		printf("Error connecting to tap interface %s\n",tap_name);
-		exit(1);
-	}
     add_arp_entries(num_nodes_in_net, nodes_in_net);
 }
 
@@ -182,7 +221,8 @@ void TunTap::add_arp_entries(unsigned int num_nodes_in_net, unsigned char* nodes
             else
                 mac_address = mac_address_base + "0" + std::to_string(current_node);
             ip_address = ip_address_base + std::to_string(current_node);
-            strcpy(cmd, "sudo arp -s ");
+            strcpy(cmd, cmd_prefix.c_str());
+            strcat(cmd, "arp -s ");
             strcat(cmd, ip_address.c_str());
             strcat(cmd, " ");
             strcat(cmd, mac_address.c_str());
@@ -198,7 +238,8 @@ void TunTap::close_interface()
 	close(tap_fd);
 
 	if (!persistent_interface) {
-		strcpy(cmd,"sudo ip tuntap del dev ");
+		strcpy(cmd,cmd_prefix.c_str());
+		strcat(cmd,"ip tuntap del dev ");
 		strcat(cmd,tap_name);
 		strcat(cmd," mode tap");
 		int res = system(cmd);
@@ -207,5 +248,12 @@ void TunTap::close_interface()
             perror("system() - tuntap del");
             std::cout << "error deleting tap" << std::endl;
         }
+        if(!netns.empty())
+        {
+            strcpy(cmd, "sudo ip netns del ");
+            strcat(cmd, netns.c_str());
+            if(system(cmd) != 0)
+                std::cout << "error deleting network namespace " << netns << std::endl;
+        }
 	}
 }
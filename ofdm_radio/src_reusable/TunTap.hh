@@ -36,16 +36,22 @@ class TunTap
 		int tap_alloc(char *dev, int flags);
 		void close_interface();
         void add_arp_entries(unsigned int num_nodes_in_net, unsigned char* nodes_in_net);
-		TunTap(std::string tap, unsigned int node_id, unsigned int num_nodes_in_net, unsigned char* nodes_in_net);
+		// With netns set, the interface is moved into that network namespace
+		// (created afresh) and configured there; the descriptor keeps working
+		TunTap(std::string tap, unsigned int node_id, unsigned int num_nodes_in_net, unsigned char* nodes_in_net,
+				std::string netns = "");
 	private:
 		int tap_fd;
 		fd_set tx_set;
 		unsigned int BUFSIZE;
 		bool persistent_interface;
 		char user[20];
-		char cmd[80];
+		char cmd[160];
 		char tap_name[IFNAMSIZ];
         unsigned char node_id;
+		std::string netns;
+		// "sudo " or "sudo ip netns exec <netns> "
+		std::string cmd_prefix;
 };
 
 #endif	// TUNTAP_HH_
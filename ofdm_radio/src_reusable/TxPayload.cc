@@ -35,8 +35,16 @@ TxPayload::TxPayload(long int id, unsigned int destination_id, unsigned char *pa
     }
 
     frame_transmitted = new bool[frames_per_packet];
+    frame_acked = new bool[frames_per_packet];
+    frame_sent_time = new double[frames_per_packet];
+    frame_retransmissions = new unsigned int[frames_per_packet];
     for(unsigned int i = 0; i < frames_per_packet; i++)
+    {
         frame_transmitted[i] = false;
+        frame_acked[i] = false;
+        frame_sent_time[i] = 0.0;
+        frame_retransmissions[i] = 0;
+    }
 
 }
 
@@ -45,6 +53,20 @@ TxPayload::~TxPayload()
 {
 }
 
+void TxPayload::release()
+{
+    delete[] _payload;
+    delete[] frame_transmitted;
+    delete[] frame_acked;
+    delete[] frame_sent_time;
+    delete[] frame_retransmissions;
+    _payload = NULL;
+    frame_transmitted = NULL;
+    frame_acked = NULL;
+    frame_sent_time = NULL;
+    frame_retransmissions = NULL;
+}
+
 
 unsigned int TxPayload::get_frames_per_packet()
 {
@@ -79,6 +101,56 @@ unsigned char* TxPayload::get_frame(unsigned int frame_id)
 	}
 }
 
+unsigned int TxPayload::get_next_frame_size()
+{
+    if(next_frame >= frames_per_packet)
+        return 0;
+    return (next_frame == frames_per_packet - 1) ? last_frame_size : frame_size;
+}
+
+unsigned int TxPayload::get_remaining_size()
+{
+    if(next_frame >= frames_per_packet)
+        return 0;
+    return payload_size - next_frame * frame_size;
+}
+
+unsigned int TxPayload::get_frame_size(unsigned int frame_id)
+{
+    if(frame_id >= frames_per_packet)
+        return 0;
+    return (frame_id == frames_per_packet - 1) ? last_frame_size : frame_size;
+}
+
+void TxPayload::ack_frames(unsigned int bitmap)
+{
+    for(unsigned int i = 0; i < frames_per_packet && i < 32; i++)
+    {
+        if(bitmap & (1u << i))
+            frame_acked[i] = true;
+    }
+}
+
+bool TxPayload::allFramesAcked()
+{
+    for(unsigned int i = 0; i < frames_per_packet; i++)
+    {
+        if(!frame_acked[i])
+            return false;
+    }
+    return true;
+}
+
+int TxPayload::get_expired_frame(double cutoff)
+{
+    for(unsigned int i = 0; i < frames_per_packet; i++)
+    {
+        if(frame_transmitted[i] && !frame_acked[i] && frame_sent_time[i] < cutoff)
+            return i;
+    }
+    return -1;
+}
+
 unsigned char* TxPayload::get_next_frame(long int *packet_id, unsigned int* frame_id, unsigned int* frame_size, unsigned int* total_packet_len)
 {
     if(next_frame < frames_per_packet)
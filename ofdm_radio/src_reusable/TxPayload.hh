@@ -16,6 +16,19 @@ class TxPayload
 		unsigned int get_frames_per_packet();
         unsigned char* get_next_frame(long int* packet_id, unsigned int* frame_id, unsigned int* frame_size, unsigned int* total_packet_len);
         bool allFramesTransmitted();
+        // Size of the frame get_next_frame would return, 0 once all are out
+        unsigned int get_next_frame_size();
+        // Bytes in the frames not yet returned by get_next_frame
+        unsigned int get_remaining_size();
+        unsigned int get_frame_size(unsigned int frame_id);
+        // Selective-repeat ARQ: marks the frames set in bitmap (bit i for
+        // frame i) acknowledged
+        void ack_frames(unsigned int bitmap);
+        bool allFramesAcked();
+        // First frame sent before cutoff and not acknowledged, -1 if none
+        int get_expired_frame(double cutoff);
+        // Frees the buffers; call once on the last copy
+        void release();
 		long int id;
         unsigned int destination_id;
 		unsigned int payload_size;
@@ -24,6 +37,9 @@ class TxPayload
         unsigned int next_frame;
         bool retrieved;
         bool* frame_transmitted;
+        bool* frame_acked;
+        double* frame_sent_time;
+        unsigned int* frame_retransmissions;
 	private:
 		unsigned int frames_per_packet;
 		unsigned char *_payload;